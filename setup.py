@@ -169,6 +169,9 @@ def create_extensions():
         pa.get_include(),
         'vinum_cpp/src/operators/aggregate',
         'vinum_cpp/src/operators/sort',
+        'vinum_cpp/src/operators/join',
+        'vinum_cpp/src/operators/filter',
+        'vinum_cpp/src/operators/window',
         'vinum_cpp/src/operators',
         'vinum_cpp/src/',
     ]
@@ -178,7 +181,7 @@ def create_extensions():
     library_dirs.extend(pa.get_library_dirs())
 
     libraries = [
-        VINUM_CPP_LIB_NAME, 'arrow', 'arrow_python'
+        VINUM_CPP_LIB_NAME, 'arrow', 'arrow_python', 'parquet'
     ]
     python_lib_linker_args = []
     python_lib_macros = None
@@ -29,12 +29,15 @@ from vinum.core.udf import (   # noqa: F401
 
 from vinum.io.arrow import (  # noqa: F401
     stream_csv,
+    stream_ipc,
+    stream_parquet,
     read_csv,
     read_json,
     read_parquet,
 )
 
 from vinum.api.table import Table  # noqa: F401
+from vinum.api.query_cache import query_cache
 from vinum.api.stream_reader import StreamReader  # noqa: F401
 
 from vinum._version import __version__
@@ -50,6 +53,7 @@ vectorized Numpy and Python functions as UDFs in SQL queries.
 """
 
 _batch_size = 10000
+_adaptive_batch_size = True
 
 
 def get_batch_size():
@@ -58,6 +62,166 @@ def get_batch_size():
 
 
 def set_batch_size(batch_size: int):
+    """
+    Set the number of rows of the batches. With the adaptive batch size,
+    see set_adaptive_batch_size(), the maximum number of rows of the
+    batches of a table scan.
+    """
     global _batch_size
     _batch_size = batch_size
 
+
+def get_adaptive_batch_size():
+    global _adaptive_batch_size
+    return _adaptive_batch_size
+
+
+def set_adaptive_batch_size(adaptive: bool):
+    """
+    Adapt the batches of the table scans to the width of the scanned
+    columns: wide rows are read in smaller batches, so that the columns
+    of a batch stay in the CPU cache. get_batch_size() remains
+    the maximum. True by default.
+    """
+    global _adaptive_batch_size
+    _adaptive_batch_size = adaptive
+
+
+_num_threads = 1
+
+
+def get_num_threads():
+    global _num_threads
+    return _num_threads
+
+
+def set_num_threads(num_threads: int):
+    """
+    Set the number of threads used by the grouped aggregation and the sort.
+    1 (default) aggregates and sorts all the batches in the calling thread.
+    """
+    global _num_threads
+    if num_threads < 1:
+        raise ValueError('Number of threads must be positive.')
+    _num_threads = num_threads
+
+
+_memory_limit = None
+_spill_dir = None
+
+
+def get_memory_limit():
+    global _memory_limit
+    return _memory_limit
+
+
+def set_memory_limit(memory_limit_bytes):
+    """
+    Set the memory limit of the grouped aggregation and of the sort in bytes.
+    Once the groups exceed the limit, the partial aggregates are spilled
+    to the spill directory, see set_spill_dir(). Once the buffered rows
+    of a sort exceed the limit, they are sorted and spilled as a sorted run,
+    the runs are merged into the output batch by batch.
+    None (default) aggregates all the groups and sorts all the rows in memory.
+    The limit is applied only to the single threaded aggregation and sort.
+    """
+    global _memory_limit
+    if memory_limit_bytes is not None and memory_limit_bytes < 1:
+        raise ValueError('Memory limit must be positive.')
+    _memory_limit = memory_limit_bytes
+
+
+def get_spill_dir():
+    """
+    Directory of the aggregation and sort spill files,
+    the system temporary directory if not set.
+    """
+    global _spill_dir
+    if _spill_dir is None:
+        import tempfile
+        return tempfile.gettempdir()
+    return _spill_dir
+
+
+def set_spill_dir(spill_dir: str):
+    global _spill_dir
+    _spill_dir = spill_dir
+
+
+_query_memory_limit = None
+_query_cache_size = None
+_memory_pool_backend = 'default'
+
+
+def get_query_memory_limit():
+    global _query_memory_limit
+    return _query_memory_limit
+
+
+def set_query_memory_limit(memory_limit_bytes):
+    """
+    Set the hard memory limit of a query in bytes.
+    Every query allocates the Arrow buffers of the native operators
+    from its own memory pool, the hash tables and the buffered batches
+    are accounted in the same pool. A query exceeding the limit fails
+    with MemoryError, unless the operator can spill, ie the single threaded
+    aggregation and sort with a memory limit, see set_memory_limit(),
+    which spill their state instead.
+    Allocations of the Python operators are not accounted.
+    None (default) does not limit the memory, the usage is still measured.
+    """
+    global _query_memory_limit
+    if memory_limit_bytes is not None and memory_limit_bytes < 1:
+        raise ValueError('Query memory limit must be positive.')
+    _query_memory_limit = memory_limit_bytes
+
+
+def get_memory_pool_backend():
+    global _memory_pool_backend
+    return _memory_pool_backend
+
+
+def set_memory_pool_backend(backend: str):
+    """
+    Set the allocator of the query memory pools: 'default' (the default
+    Arrow memory pool), 'system', 'jemalloc' or 'mimalloc'.
+    jemalloc and mimalloc are available only if Arrow was built with them.
+    """
+    global _memory_pool_backend
+    # Fails if the backend is unknown or not available.
+    vinum_lib.QueryMemoryPool(0, backend)
+    _memory_pool_backend = backend
+
+
+def get_query_cache_size():
+    global _query_cache_size
+    return _query_cache_size
+
+
+def set_query_cache_size(max_bytes):
+    """
+    Enable the cache of the query results and parsed queries,
+    bounded by the total size of the cached results in bytes.
+    Repeated :func:`vinum.Table.sql` queries on the same Table return
+    the cached result, the least recently used results are evicted
+    once the cache is full. Queries differing only in whitespace share
+    the entry. Registering a UDF clears the cache.
+    None (default) disables the cache.
+    """
+    global _query_cache_size
+    if max_bytes is not None and max_bytes < 0:
+        raise ValueError('Query cache size must not be negative.')
+    _query_cache_size = max_bytes
+    query_cache.resize(max_bytes)
+
+
+def clear_query_cache():
+    query_cache.clear()
+
+
+def query_cache_info():
+    """
+    Hits, misses, number of entries, bytes and the maximum bytes
+    of the query result cache.
+    """
+    return query_cache.info()
@@ -0,0 +1,234 @@
+import copy
+import re
+import threading
+import weakref
+from collections import OrderedDict, namedtuple
+from itertools import count
+from typing import Any, Callable, Hashable, Optional, TYPE_CHECKING
+
+import pyarrow as pa
+
+if TYPE_CHECKING:
+    from vinum.parser.query import Query
+
+
+# Parsed query trees are small, they are bounded by the number of entries.
+MAX_CACHED_QUERY_TREES = 256
+
+CacheInfo = namedtuple('CacheInfo',
+                       ['hits', 'misses', 'entries', 'bytes', 'max_bytes'])
+
+_QUOTED_OR_SPACES = re.compile(r"('(?:[^']|'')*'|\"(?:[^\"]|\"\")*\")|\s+")
+
+# Functions and datetime literals evaluated at the time of the execution.
+NON_DETERMINISTIC_FUNCTIONS = frozenset(('now',))
+NON_DETERMINISTIC_LITERALS = frozenset(('now', 'today'))
+
+
+def normalize_query(query: str) -> str:
+    """
+    Collapse the whitespace outside of the quoted literals and identifiers
+    and drop the trailing semicolon, so that the same query formatted
+    differently shares the cache entry.
+    """
+    normalized = _QUOTED_OR_SPACES.sub(
+        lambda match: match.group(1) or ' ', query
+    )
+    return normalized.strip().rstrip(';').rstrip()
+
+
+def is_deterministic(query_tree: 'Query') -> bool:
+    """
+    Return False if the result of the query may change between
+    the executions over the same table, ie the query uses the current
+    time, numpy random functions or the user defined functions.
+    """
+    from vinum.core.udf import _udf_registry
+    from vinum.util.util import is_expression, is_literal, traverse_exprs
+
+    branches = []
+    for expr_branch in (query_tree.select_expressions,
+                        query_tree.where_condition,
+                        query_tree.group_by,
+                        query_tree.having,
+                        query_tree.order_by,
+                        ):
+        if expr_branch:
+            branches.extend(traverse_exprs(expr_branch))
+    for expr in branches:
+        function_name = (expr.function_name or '').lower()
+        if (function_name in NON_DETERMINISTIC_FUNCTIONS
+                or function_name in _udf_registry
+                or function_name.startswith('np.random.')):
+            return False
+        for arg in expr.arguments:
+            if (is_literal(arg) and isinstance(arg.value, str)
+                    and arg.value.lower() in NON_DETERMINISTIC_LITERALS):
+                return False
+    return True
+
+
+class LRUCache:
+    """
+    Least recently used cache, bounded by the total size of its values.
+
+    Parameters
+    ----------
+    max_size : int
+        Maximum total size of the values.
+    size_of : Callable
+        Size of a value, 1 by default, ie the cache is bounded
+        by the number of entries.
+    """
+    def __init__(self,
+                 max_size: int,
+                 size_of: Callable[[Any], int] = lambda value: 1) -> None:
+        self.max_size = max_size
+        self.size = 0
+        self._size_of = size_of
+        self._entries: 'OrderedDict[Hashable, Any]' = OrderedDict()
+        self._sizes = {}
+        self._lock = threading.Lock()
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    def get(self, key: Hashable) -> Optional[Any]:
+        with self._lock:
+            if key not in self._entries:
+                return None
+            self._entries.move_to_end(key)
+            return self._entries[key]
+
+    def put(self, key: Hashable, value: Any) -> None:
+        value_size = self._size_of(value)
+        with self._lock:
+            self._discard(key)
+            # Values larger than the whole cache are not cached.
+            if value_size > self.max_size:
+                return
+            self._entries[key] = value
+            self._sizes[key] = value_size
+            self.size += value_size
+            self._evict()
+
+    def resize(self, max_size: int) -> None:
+        with self._lock:
+            self.max_size = max_size
+            self._evict()
+
+    def discard_if(self, predicate: Callable[[Hashable], bool]) -> None:
+        with self._lock:
+            for key in [key for key in self._entries if predicate(key)]:
+                self._discard(key)
+
+    def clear(self) -> None:
+        with self._lock:
+            self._entries.clear()
+            self._sizes.clear()
+            self.size = 0
+
+    def _discard(self, key: Hashable) -> None:
+        if key in self._entries:
+            del self._entries[key]
+            self.size -= self._sizes.pop(key)
+
+    def _evict(self) -> None:
+        while self.size > self.max_size:
+            key, _ = self._entries.popitem(last=False)
+            self.size -= self._sizes.pop(key)
+
+
+class QueryCache:
+    """
+    Cache of the parsed queries and of the query results over
+    the in-memory tables.
+
+    The query trees are keyed by the normalized query text and
+    the schema of the table. The planner mutates the tree,
+    hence every query is planned from a copy of the cached one.
+    The results are keyed by the normalized query text and the identity
+    of the table: a Table wraps an immutable Arrow table, so the identity
+    is also its version. The results of a table are evicted once
+    the table is garbage collected. The results of the queries using
+    the current time or the user defined functions are not cached.
+
+    The cache is disabled until its size is set, see
+    :func:`vinum.set_query_cache_size`.
+    """
+    def __init__(self) -> None:
+        self._query_trees = LRUCache(MAX_CACHED_QUERY_TREES)
+        self._results = LRUCache(0, lambda table: table.nbytes)
+        self._enabled = False
+        self._table_ids = count()
+        self._hits = 0
+        self._misses = 0
+
+    @property
+    def enabled(self) -> bool:
+        return self._enabled
+
+    def resize(self, max_bytes: Optional[int]) -> None:
+        self._enabled = max_bytes is not None
+        self._results.resize(max_bytes or 0)
+        if not self._enabled:
+            self.clear()
+
+    def clear(self) -> None:
+        self._query_trees.clear()
+        self._results.clear()
+        self._hits = 0
+        self._misses = 0
+
+    def info(self) -> CacheInfo:
+        return CacheInfo(self._hits, self._misses, len(self._results),
+                         self._results.size, self._results.max_size)
+
+    def table_id(self, table: object) -> int:
+        """
+        Cache identity of a Table, assigned on the first cached query.
+        """
+        table_id = getattr(table, '_query_cache_id', None)
+        if table_id is None:
+            table_id = next(self._table_ids)
+            table._query_cache_id = table_id
+            weakref.finalize(table, self._evict_table, table_id)
+        return table_id
+
+    def query_tree(self,
+                   query: str,
+                   schema: pa.Schema,
+                   parse: Callable[[], 'Query']) -> 'Query':
+        key = (
+            normalize_query(query),
+            tuple((field.name, str(field.type)) for field in schema),
+        )
+        query_tree = self._query_trees.get(key)
+        if query_tree is None:
+            query_tree = parse()
+            self._query_trees.put(key, query_tree)
+        return copy.deepcopy(query_tree)
+
+    def result(self,
+               table: object,
+               query: str,
+               query_tree: 'Query',
+               execute: Callable[[], pa.Table]) -> pa.Table:
+        # Results of the non-deterministic queries are never cached.
+        if not is_deterministic(query_tree):
+            return execute()
+        key = (self.table_id(table), normalize_query(query))
+        result = self._results.get(key)
+        if result is not None:
+            self._hits += 1
+            return result
+        self._misses += 1
+        result = execute()
+        self._results.put(key, result)
+        return result
+
+    def _evict_table(self, table_id: int) -> None:
+        self._results.discard_if(lambda key: key[0] == table_id)
+
+
+query_cache = QueryCache()
@@ -1,12 +1,13 @@
 import pyarrow as pa
 from typing import TYPE_CHECKING
 
-from vinum.executor.executor import RecursiveExecutor
+from vinum.executor.executor import ProfilingExecutor, RecursiveExecutor
 from vinum.parser.parser import parser_factory
 from vinum.planner.planner import QueryPlanner
 
 if TYPE_CHECKING:
     import pyarrow as pa
+    from vinum.executor.profile import QueryProfile
 
 
 class StreamReader:
@@ -18,12 +19,13 @@ class StreamReader:
     way to execute queries on large files.
 
     `StreamReader` instances are created by vinum.stream_* functions,
-    for example: :func:`vinum.stream_csv`.
+    for example: :func:`vinum.stream_csv` or :func:`vinum.stream_ipc`.
 
     Parameters
     ----------
     reader : pa.RecordBatchFileReader
-        Arrow Stream Reader
+        Arrow Stream Reader, a native vinum_lib.BatchSource,
+        or a ParquetSource opened by the query planner.
     """
     def __init__(self, reader):
         super().__init__()
@@ -93,6 +95,35 @@ class StreamReader:
 
         return Table(result_table.get_table())
 
+    def explain_analyze(self, query: str) -> 'QueryProfile':
+        """
+        Executes SQL SELECT query on an input stream and returns
+        the execution profile of every operator of the query plan.
+
+        Parameters
+        ----------
+        query : str
+            SQL SELECT query.
+
+        Returns
+        -------
+        :class:`vinum.executor.profile.QueryProfile`
+            Execution profile of the query.
+
+        See also
+        --------
+        vinum.Table.explain_analyze : Execution profile of a query
+            on a Table.
+        """
+        query_tree = parser_factory(query,
+                                    self._reader.schema).parse()
+        query_dag = QueryPlanner(query_tree, reader=self).plan_query()
+
+        executor = ProfilingExecutor()
+        executor.execute(query_dag)
+
+        return executor.profile
+
     @property
     def reader(self) -> pa.RecordBatchFileReader:
         return self._reader
@@ -1,8 +1,14 @@
 import pyarrow as pa
-from typing import Dict, TYPE_CHECKING
+from typing import Dict, Iterable, Optional, TYPE_CHECKING, Union
 
+from vinum.api.query_cache import query_cache
 from vinum.arrow.arrow_table import ArrowTable
-from vinum.executor.executor import RecursiveExecutor
+from vinum.core.algebra import (
+    HashJoinOperator,
+    MaterializeTableOperator,
+    TableReaderOperator,
+)
+from vinum.executor.executor import ProfilingExecutor, RecursiveExecutor
 from vinum.parser.parser import parser_factory
 from vinum.parser.query import Query
 from vinum.planner.planner import QueryPlanner
@@ -10,6 +16,7 @@ from vinum.planner.planner import QueryPlanner
 if TYPE_CHECKING:
     import pandas as pd
     from vinum.core.base import Operator
+    from vinum.executor.profile import QueryProfile
 
 
 class Table:
@@ -262,16 +269,34 @@ class Table:
         0    -5           1
         1    -3           1
         2    -2           4
+
+        With the query cache enabled, see :func:`vinum.set_query_cache_size`,
+        repeated queries on the same Table return the cached result.
         """
+        query_tree = self._cached_query_tree(query)
+        if query_cache.enabled:
+            return Table(query_cache.result(
+                self, query, query_tree, lambda: self._execute(query_tree)
+            ))
+        return Table(self._execute(query_tree))
+
+    def _cached_query_tree(self, query: str) -> Query:
+        schema = self._arrow_table.get_schema()
+        if query_cache.enabled:
+            return query_cache.query_tree(
+                query, schema,
+                lambda: self._create_query_tree(query, schema)
+            )
+        return self._create_query_tree(query, schema)
+
+    def _execute(self, query_tree: Query) -> pa.Table:
         query_table = self._arrow_table
-
-        query_tree = self._create_query_tree(query, query_table.get_schema())
         query_dag = self._create_plan_dag(query_tree, query_table)
 
         executor = RecursiveExecutor()
         result_table = executor.execute(query_dag)
 
-        return Table(result_table.get_table())
+        return result_table.get_table()
 
     def sql_pd(self, query: str):
         """
@@ -397,9 +422,7 @@ class Table:
                     Operator: ProjectOperator
                       VectorizedExpression: IntCastFunction
                           Column: fare_amount
-                      Operator: ProjectOperator
-                          Column: fare_amount
-                        Operator: TableReaderOperator
+                      Operator: NativeScanOperator
         """
         query_tree = self._create_query_tree(query,
                                              self._arrow_table.get_schema())
@@ -409,6 +432,149 @@ class Table:
         query_dag = self._create_plan_dag(query_tree, self._arrow_table)
         return f'{plan_str}\nQuery plan:\n {query_dag}'
 
+    def explain_analyze(self, query: str) -> 'QueryProfile':
+        """
+        Executes SQL SELECT query on a Table and returns the execution
+        profile of every operator of the query plan.
+
+        Parameters
+        ----------
+        query : str
+            SQL SELECT query.
+
+        Returns
+        -------
+        :class:`vinum.executor.profile.QueryProfile`
+            Wall and CPU time, rows and batches in and out,
+            peak bytes of the Arrow memory pool of every operator,
+            the batch size chosen for the scans, and the hash table
+            statistics of the aggregates, including the groups estimated
+            to reserve the hash table. Printable as the query plan,
+            or converted with ``to_dict()``.
+
+        See also
+        --------
+        explain : Returns a query plan as a string.
+
+        Notes
+        -----
+        Operators are timed at the boundaries of the batches they return.
+        A scan drained by the native pipeline of an aggregate or a sort
+        is fused with it, its time is accounted for by the parent.
+
+        Examples
+        --------
+        >>> import vinum as vn
+        >>> tbl = vn.read_csv('taxi.csv')
+        >>> profile = tbl.explain_analyze('select passenger_count pc, '
+        ...                               'count(*) from t group by pc')
+        >>> profile.root.rows_out
+        7
+        >>> print(profile)
+        """
+        query_table = self._arrow_table
+
+        query_tree = self._create_query_tree(query, query_table.get_schema())
+        query_dag = self._create_plan_dag(query_tree, query_table)
+
+        executor = ProfilingExecutor()
+        executor.execute(query_dag)
+
+        return executor.profile
+
+    def join(self,
+             other: 'Table',
+             on: Union[str, Iterable[str]],
+             right_on: Optional[Union[str, Iterable[str]]] = None,
+             how: str = 'inner',
+             suffix: str = '_right') -> 'Table':
+        """
+        Join the `Table` with another `Table` on equal keys.
+
+        The other table is the build side of a hash join and is hashed
+        in memory, the rows of this table are streamed in batches
+        through the join.
+
+        Parameters
+        ----------
+        other : :class:`vinum.Table`
+            Right side of the join.
+        on : str or list of str
+            Key columns of this table.
+        right_on : str or list of str, optional
+            Key columns of the other table, same as `on` by default.
+            Keys must have the same types on both sides.
+        how : str
+            'inner' or 'left'. Left join keeps the rows without a match,
+            with NULL values in the columns of the other table.
+        suffix : str
+            Suffix appended to the names of the columns of the other table
+            which are also present in this table.
+
+        Returns
+        -------
+        :class:`vinum.Table`
+            Columns of this table followed by the columns of the other
+            table. Key columns joined on the same name are not repeated.
+
+        Notes
+        -----
+        Rows with a NULL key never match.
+
+        Examples
+        --------
+        >>> import vinum as vn
+        >>> users = vn.Table.from_pydict({'id': [1, 2, 3],
+        ...                               'name': ['a', 'b', 'c']})
+        >>> orders = vn.Table.from_pydict({'id': [1, 1, 3],
+        ...                                'amount': [10, 20, 30]})
+        >>> orders.join(users, on='id').to_pandas()
+           id  amount name
+        0   1      10    a
+        1   1      20    a
+        2   3      30    c
+        """
+        probe_keys = (on,) if isinstance(on, str) else tuple(on)
+        if right_on is None:
+            build_keys = probe_keys
+        elif isinstance(right_on, str):
+            build_keys = (right_on,)
+        else:
+            build_keys = tuple(right_on)
+        if len(probe_keys) != len(build_keys):
+            raise ValueError('Join requires the same number of keys '
+                             'on both sides.')
+
+        build_table = other.to_arrow()
+        probe_names = set(self.schema.names)
+        renamed = {
+            name: name + suffix if name in probe_names else name
+            for name in build_table.schema.names
+        }
+        build_table = build_table.rename_columns(
+            [renamed[name] for name in build_table.schema.names]
+        )
+        renamed_keys = tuple(renamed.get(key, key) for key in build_keys)
+
+        join_op = HashJoinOperator(build_table,
+                                   probe_keys,
+                                   renamed_keys,
+                                   how,
+                                   self.schema,
+                                   TableReaderOperator(self._arrow_table))
+        executor = RecursiveExecutor()
+        result_table = executor.execute(MaterializeTableOperator(join_op))
+
+        # Keys joined on the same name are equal in the matched rows,
+        # only the copy of this table is kept.
+        duplicate_keys = [
+            renamed_key
+            for probe_key, build_key, renamed_key
+            in zip(probe_keys, build_keys, renamed_keys)
+            if probe_key == build_key
+        ]
+        return Table(result_table.get_table().drop(duplicate_keys))
+
     def head(self, n: int) -> 'pd.DataFrame':
         """
         Return first n rows of a table as Pandas DataFrame
@@ -1,4 +1,4 @@
-from typing import List, Iterable, Tuple
+from typing import Dict, List, Iterable, Optional, Tuple
 
 import numpy as np
 
@@ -14,19 +14,51 @@ class RecordBatch:
     """
     Apache Arrow RecordBatch.
 
+    The batch may carry a selection: indices of its rows selected by
+    a filter. The selected rows of a column are only taken once the column
+    is accessed, operators which accept a selection get the source batch
+    and the selection instead, without copying the rows at all.
+
     Parameters
     ----------
     table : pyarrow.RecordBatch
         Apache Arrow RecordBatch instance.
+    selection : Optional[pyarrow.Array]
+        Sorted indices of the selected rows, all the rows if None.
     """
-    def __init__(self, batch: pa.RecordBatch) -> None:
+    def __init__(self,
+                 batch: pa.RecordBatch,
+                 selection: Optional[pa.Array] = None) -> None:
         assert batch is not None
         self._batch: pa.RecordBatch = batch
+        if selection is not None and len(selection) == batch.num_rows:
+            selection = None
+        self._selection: Optional[pa.Array] = selection
+        self._selected_columns: Dict[int, pa.Array] = {}
         self._ensure_non_empty_col_names()
 
     def get_batch(self) -> pa.RecordBatch:
+        """
+        Return the batch of the selected rows.
+        """
+        if self._selection is not None:
+            self._batch = pa.RecordBatch.from_arrays(
+                self.columns,
+                schema=self._batch.schema
+            )
+            self._selection = None
+            self._selected_columns.clear()
+        return self._batch
+
+    def get_source_batch(self) -> pa.RecordBatch:
+        """
+        Return the batch the selection refers to.
+        """
         return self._batch
 
+    def get_selection(self) -> Optional[pa.Array]:
+        return self._selection
+
     def get_schema(self) -> pa.Schema:
         return self._batch.schema
 
@@ -36,10 +68,17 @@ class RecordBatch:
 
     @property
     def num_rows(self) -> int:
+        if self._selection is not None:
+            return len(self._selection)
         return self._batch.num_rows
 
     @property
     def columns(self) -> List[str]:
+        if self._selection is not None:
+            return [
+                self.get_pa_column_by_index(idx)
+                for idx in range(self._batch.num_columns)
+            ]
         return self._batch.columns
 
     @property
@@ -69,6 +108,12 @@ class RecordBatch:
         return self.get_pa_column_by_name(column.get_column_name())
 
     def get_pa_column_by_index(self, index: int) -> pa.Array:
+        if self._selection is not None:
+            if index not in self._selected_columns:
+                self._selected_columns[index] = (
+                    self._batch.column(index).take(self._selection)
+                )
+            return self._selected_columns[index]
         return self._batch.columns[index]
 
     def get_pa_column_by_name(self, column_name: str) -> pa.Array:
@@ -86,12 +131,13 @@ class RecordBatch:
         if is_numpy_array(bitmask):
             bitmask = pa.array(bitmask)
         return RecordBatch(
-            self._batch.filter(bitmask, null_selection_behavior='emit_null')
+            self.get_batch().filter(bitmask,
+                                    null_selection_behavior='emit_null')
         )
 
     def slice(self, length: int, offset: int = 0) -> 'RecordBatch':
         return RecordBatch(
-            self._batch.slice(offset, length)
+            self.get_batch().slice(offset, length)
         )
 
     def rename_columns(self, column_names: List[str]) -> None:
@@ -128,6 +174,8 @@ class RecordBatch:
                    columns: Tuple[Iterable],
                    column_names: Tuple[str, ...]) -> None:
         self._batch = pa.RecordBatch.from_arrays(columns, names=column_names)
+        self._selection = None
+        self._selected_columns.clear()
 
     def _ensure_non_empty_col_names(self):
         unnamed_count = 0
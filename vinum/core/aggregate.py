@@ -1,19 +1,24 @@
 import pyarrow as pa
 
-from typing import Iterable
+from collections import deque
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Dict, Iterable
 
 import vinum_lib
 
 from vinum.arrow.record_batch import RecordBatch
+from vinum.core.algebra import NativeScanOperator
 from vinum.core.base import Operator, VectorizedExpression
+from vinum.errors import FunctionError
 from vinum.parser.query import Column
+from vinum.util.util import is_literal
 
 
 class AggregateFunction(VectorizedExpression):
     """
     Abstract Base Class for all aggregate functions.
     """
-    def __init__(self, func, column: Column = None) -> None:
+    def __init__(self, func, column: Column = None, *params) -> None:
         super().__init__([])
         if not column:
             self._input_column_name = ''
@@ -21,6 +26,35 @@ class AggregateFunction(VectorizedExpression):
             self._input_column_name = column.get_column_name()
         assert func
         self._func = func
+        self._param = self._parse_param(func, params)
+
+    @staticmethod
+    def _parse_param(func, params) -> float:
+        """
+        Return the numeric literal parameter of the function,
+        the percentile of approx_percentile().
+        """
+        if func.lower() != 'approx_percentile':
+            if params:
+                raise FunctionError(
+                    f'{func}() expects a single column argument.'
+                )
+            return 0.0
+        if (
+                len(params) != 1
+                or not is_literal(params[0])
+                or isinstance(params[0].value, bool)
+                or not isinstance(params[0].value, (int, float))
+                or not 0 <= params[0].value <= 1
+        ):
+            raise FunctionError(
+                'approx_percentile() expects a column and '
+                'a percentile literal between 0 and 1.'
+            )
+        return float(params[0].value)
+
+    def get_param(self) -> float:
+        return self._param
 
     def get_input_column_name(self) -> str:
         return self._input_column_name
@@ -35,15 +69,54 @@ class AggregateOperator(Operator):
 
     Class is thin proxy which delegates all the work to C++ based
     physical operators.
+
+    If more than one thread is configured, grouped aggregation
+    feeds the batches to a parallel C++ aggregate from a thread pool.
+    Otherwise, if the memory limit is configured, the aggregate spills
+    the partial states to disk once the groups exceed the limit.
+
+    Groups are returned in batches of at most get_batch_size() groups.
+
+    Directly on top of the NativeScanOperator, the scan, filter and
+    aggregation of all the batches run as a single C++ pipeline.
     """
 
+    PARALLEL_CLASSES = {
+        vinum_lib.SingleNumericalHashAggregate:
+            vinum_lib.ParallelSingleNumericalHashAggregate,
+        vinum_lib.MultiNumericalHashAggregate:
+            vinum_lib.ParallelMultiNumericalHashAggregate,
+        vinum_lib.CompositeKeyHashAggregate:
+            vinum_lib.ParallelCompositeKeyHashAggregate,
+        vinum_lib.DictionaryHashAggregate:
+            vinum_lib.ParallelDictionaryHashAggregate,
+        vinum_lib.GenericHashAggregate:
+            vinum_lib.ParallelGenericHashAggregate,
+    }
+
+    SPILLING_CLASSES = {
+        vinum_lib.SingleNumericalHashAggregate:
+            vinum_lib.SpillingSingleNumericalHashAggregate,
+        vinum_lib.MultiNumericalHashAggregate:
+            vinum_lib.SpillingMultiNumericalHashAggregate,
+        vinum_lib.CompositeKeyHashAggregate:
+            vinum_lib.SpillingCompositeKeyHashAggregate,
+        vinum_lib.DictionaryHashAggregate:
+            vinum_lib.SpillingDictionaryHashAggregate,
+        vinum_lib.GenericHashAggregate:
+            vinum_lib.SpillingGenericHashAggregate,
+    }
+
     FUNCS = {
         'COUNT': vinum_lib.AggFuncType.COUNT,
         'COUNT_STAR': vinum_lib.AggFuncType.COUNT_STAR,
+        'COUNT_DISTINCT': vinum_lib.AggFuncType.COUNT_DISTINCT,
         'MIN': vinum_lib.AggFuncType.MIN,
         'MAX': vinum_lib.AggFuncType.MAX,
         'SUM': vinum_lib.AggFuncType.SUM,
         'AVG': vinum_lib.AggFuncType.AVG,
+        'APPROX_COUNT_DISTINCT': vinum_lib.AggFuncType.APPROX_COUNT_DISTINCT,
+        'APPROX_PERCENTILE': vinum_lib.AggFuncType.APPROX_PERCENTILE,
     }
 
     def __init__(self,
@@ -59,23 +132,47 @@ class AggregateOperator(Operator):
         self._agg_cols = agg_cols
 
         self.agg_obj = None
+        self._num_threads = 1
+        self._spill_stats = None
+        self._agg_stats = None
 
     def _is_numeric_type(self, field_type):
         return (pa.types.is_integer(field_type)
                 or pa.types.is_floating(field_type)
                 or pa.types.is_temporal(field_type))
 
-    def _init_agg_obj(self, batch):
-        schema = batch.get_schema()
+    def _is_composite_key_type(self, field_type):
+        """
+        Types supported by the byte-encoded keys of CompositeKeyHashAggregate.
+        """
+        return (self._is_numeric_type(field_type)
+                or pa.types.is_boolean(field_type)
+                or pa.types.is_string(field_type)
+                or pa.types.is_large_string(field_type)
+                or pa.types.is_binary(field_type)
+                or pa.types.is_large_binary(field_type)
+                or pa.types.is_fixed_size_binary(field_type)
+                or pa.types.is_decimal(field_type))
+
+    def _init_agg_obj(self, schema: pa.Schema):
+        from vinum import get_num_threads, get_memory_limit, get_spill_dir
 
         only_numer_groupby = True
+        only_composite_key_groupby = True
+        only_dictionary_groupby = True
         groupby_col_names = []
 
         for c in self._group_by_columns:
             col_name = c.get_column_name()
             groupby_col_names.append(col_name)
-            if not self._is_numeric_type(schema.field(col_name).type):
+            field_type = schema.field(col_name).type
+            if not self._is_numeric_type(field_type):
                 only_numer_groupby = False
+            if not self._is_composite_key_type(field_type):
+                only_composite_key_groupby = False
+            if not (pa.types.is_dictionary(field_type)
+                    and self._is_composite_key_type(field_type.value_type)):
+                only_dictionary_groupby = False
 
         agg_col_names = [
             c.get_column_name()
@@ -89,7 +186,8 @@ class AggregateOperator(Operator):
             func_def = vinum_lib.AggFuncDef(
                 self.FUNCS[func.get_agg_func_name()],
                 col_name,
-                out_col_name
+                out_col_name,
+                func.get_param()
             )
             agg_funcs.append(func_def)
 
@@ -100,25 +198,128 @@ class AggregateOperator(Operator):
                 agg_class = vinum_lib.SingleNumericalHashAggregate
             elif only_numer_groupby:
                 agg_class = vinum_lib.MultiNumericalHashAggregate
+            elif only_dictionary_groupby and len(groupby_col_names) == 1:
+                agg_class = vinum_lib.DictionaryHashAggregate
+            elif only_composite_key_groupby:
+                agg_class = vinum_lib.CompositeKeyHashAggregate
             else:
                 agg_class = vinum_lib.GenericHashAggregate
 
-            agg_obj = agg_class(
-                groupby_col_names,
-                agg_col_names,
-                agg_funcs
-            )
+            if get_num_threads() > 1:
+                self._num_threads = get_num_threads()
+                agg_obj = self.PARALLEL_CLASSES[agg_class](
+                    groupby_col_names,
+                    agg_col_names,
+                    agg_funcs,
+                    self._num_threads
+                )
+            elif get_memory_limit() is not None:
+                agg_obj = self.SPILLING_CLASSES[agg_class](
+                    groupby_col_names,
+                    agg_col_names,
+                    agg_funcs,
+                    get_memory_limit(),
+                    get_spill_dir()
+                )
+            else:
+                agg_obj = agg_class(
+                    groupby_col_names,
+                    agg_col_names,
+                    agg_funcs
+                )
 
+        if self._memory_pool is not None:
+            agg_obj.set_memory_pool(self._memory_pool)
+        # The hash table is reserved for the groups estimated from
+        # the first rows, the spilling aggregates stay within their limit.
+        expected_rows = self._parent_operator.expected_num_rows()
+        if expected_rows and hasattr(agg_obj, 'set_expected_rows'):
+            agg_obj.set_expected_rows(expected_rows)
         self.agg_obj = agg_obj
 
     def next(self) -> Iterable[RecordBatch]:
-        for batch in self._parent_operator.next():
-            if not self.agg_obj:
-                self._init_agg_obj(batch)
-
-            self.agg_obj.next(batch.get_batch())
+        if isinstance(self._parent_operator, NativeScanOperator):
+            self._init_agg_obj(self._parent_operator.get_schema())
+            num_batches = self._parent_operator.run(self.agg_obj,
+                                                    self._num_threads)
+            if not num_batches:
+                # Same as an aggregate which never received a batch.
+                self.agg_obj = None
+        else:
+            self._aggregate_batches()
 
         if self.agg_obj:
-            yield RecordBatch(self.agg_obj.result())
+            # Groups are summarized and returned batch by batch.
+            from vinum import get_batch_size
+            batch_size = get_batch_size()
+            while True:
+                result = self.agg_obj.next_result(batch_size)
+                if result is None:
+                    break
+                yield RecordBatch(result)
+            if hasattr(self.agg_obj, 'spill_stats'):
+                self._spill_stats = self.agg_obj.spill_stats()
+            self._agg_stats = self.agg_obj.agg_stats()
 
         del self.agg_obj
+
+    def _aggregate_batches(self) -> None:
+        executor = None
+        pending = deque()
+        try:
+            for batch in self._parent_operator.next():
+                if not self.agg_obj:
+                    self._init_agg_obj(batch.get_schema())
+
+                if self._num_threads == 1:
+                    self.agg_obj.next(batch.get_source_batch(),
+                                      batch.get_selection())
+                    continue
+
+                if executor is None:
+                    executor = ThreadPoolExecutor(
+                        max_workers=self._num_threads
+                    )
+                pending.append(
+                    executor.submit(self.agg_obj.next,
+                                    batch.get_source_batch(),
+                                    batch.get_selection())
+                )
+                # Bound the number of batches held in memory at once.
+                if len(pending) >= 2 * self._num_threads:
+                    pending.popleft().result()
+
+            for future in pending:
+                future.result()
+        finally:
+            if executor is not None:
+                executor.shutdown()
+
+    def get_spill_stats(self):
+        """
+        Bytes spilled, number of spills and spill partitions
+        of the last aggregation, None if the aggregate does not spill.
+        """
+        return self._spill_stats
+
+    def get_profile_details(self) -> Dict[str, Any]:
+        stats = self._agg_stats
+        if stats is None:
+            return {}
+        details = {
+            'rows_in': stats.num_rows,
+            'batches_in': stats.num_batches,
+            'groups': stats.num_groups,
+            'hash_table_capacity': stats.table_capacity,
+            'load_factor': stats.load_factor,
+            'resizes': stats.num_resizes,
+            'memory_bytes': stats.memory_bytes,
+            'update_time': stats.update_nanos / 1e9,
+            'result_time': stats.result_nanos / 1e9,
+        }
+        if stats.estimated_groups:
+            details['estimated_groups'] = stats.estimated_groups
+        if self._spill_stats is not None and self._spill_stats.num_spills:
+            details['spills'] = self._spill_stats.num_spills
+            details['bytes_spilled'] = self._spill_stats.bytes_spilled
+        return details
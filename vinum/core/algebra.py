@@ -3,8 +3,10 @@ from itertools import chain
 from typing import (
     Iterable,
     Any,
+    Dict,
     Tuple,
     Optional,
+    Union,
 )
 
 import numpy as np
@@ -110,11 +112,49 @@ class FilterOperator(Operator):
     Boolean Filter Operator.
 
     Apply boolean filter to the input RecordBatch.
+
+    Parameters
+    ----------
+    predicate : VectorizedExpression
+        Boolean expression.
+    parent_operator : Operator
+        Parent operator.
+    native_predicate : Optional[vinum_lib.Predicate]
+        Native version of the predicate. Used instead of the expression
+        if it can be bound to the schema of the input batches.
     """
     def __init__(self,
                  predicate: VectorizedExpression,
-                 parent_operator: Operator) -> None:
+                 parent_operator: Operator,
+                 native_predicate: Optional['vinum_lib.Predicate'] = None
+                 ) -> None:
         super().__init__(parent_operator, [predicate])
+        self._native_predicate = native_predicate
+
+    def expected_num_rows(self) -> Optional[int]:
+        # Batches filtered by the expression reach the parent without
+        # their rows before the filter, the selectivity is unknown.
+        return None
+
+    def next(self) -> Iterable[RecordBatch]:
+        is_native = None
+        for batch in self._parent_operator.next():
+            if is_native is None:
+                is_native = (
+                    self._native_predicate is not None
+                    and self._native_predicate.bind(batch.get_schema())
+                )
+            if is_native:
+                # The selected rows are taken lazily, by the operators
+                # which need them.
+                source_batch = batch.get_batch()
+                yield RecordBatch(
+                    source_batch,
+                    self._native_predicate.select(source_batch)
+                )
+            else:
+                args = self._process_arguments(self._arguments, batch=batch)
+                yield self._kernel(batch, args)
 
     def _kernel(self,
                 batch: RecordBatch,
@@ -129,6 +169,14 @@ class SortOperator(Operator):
 
     Sort the table by a list of provided columns or expressions.
 
+    If more than one thread is configured, the batches are sorted into runs
+    on a thread pool as they arrive and the runs are merged in parallel.
+    Otherwise, if the memory limit is configured, the sorted runs are spilled
+    to disk once the buffered rows exceed the limit.
+
+    Plain columns directly on top of the NativeScanOperator are sorted
+    in a single C++ pipeline with the scan and filter.
+
     Parameters
     ----------
     arguments : Tuple[OperatorBaseType, ...]
@@ -137,6 +185,9 @@ class SortOperator(Operator):
         List of SortOrders (ASC, DESC) corresponding to columns
         in the `arguments` parameter.
     """
+    # Min number of rows of a run sorted by a single task of ParallelSort.
+    PARALLEL_MIN_RUN_ROWS = 1 << 16
+
     def __init__(self,
                  arguments: Tuple[OperatorArgument, ...],
                  sort_order: Tuple[SortOrder, ...],
@@ -154,28 +205,104 @@ class SortOperator(Operator):
         ]
         self._expressions = []
 
-        self._sort_op = vinum_lib.Sort(self._col_names, self._sort_order)
+        self._sort_stats = None
+        self._sort_op = self._new_sort_op()
+
+    def _new_sort_op(self):
+        from vinum import (
+            get_num_threads,
+            get_memory_limit,
+            get_spill_dir,
+            get_batch_size,
+        )
+        self._is_external = (get_num_threads() == 1
+                             and get_memory_limit() is not None)
+        if get_num_threads() > 1:
+            return vinum_lib.ParallelSort(self._col_names,
+                                          self._sort_order,
+                                          get_num_threads(),
+                                          self.PARALLEL_MIN_RUN_ROWS)
+        elif self._is_external:
+            return vinum_lib.Sort(self._col_names,
+                                  self._sort_order,
+                                  get_memory_limit(),
+                                  get_spill_dir(),
+                                  get_batch_size())
+        else:
+            return vinum_lib.Sort(self._col_names, self._sort_order)
+
+    def set_memory_pool(self, memory_pool: vinum_lib.QueryMemoryPool) -> None:
+        super().set_memory_pool(memory_pool)
+        self._sort_op.set_memory_pool(memory_pool)
 
     def next(self) -> Iterable[RecordBatch]:
+        if (
+                isinstance(self._parent_operator, NativeScanOperator)
+                and all(isinstance(arg, Column) for arg in self._arguments)
+        ):
+            # Sort keys are plain columns of the scan, the batches are
+            # sorted without returning to Python.
+            self._verify_bool_columns(self._parent_operator.get_schema())
+            self._parent_operator.run(self._sort_op)
+            yield from self._sorted_batches()
+            del self._sort_op
+            return
+
         for batch in self._parent_operator.next():
             self._process_arguments(self._arguments, batch=batch)
-            col_names = tuple(i[0] for i in self._expressions)
-            exprs = tuple(i[1] for i in self._expressions)
-            batch = RecordBatch.from_arrays(
-                tuple(chain(batch.columns, exprs)),
-                tuple(chain(batch.column_names, col_names))
-            )
+            if self._expressions:
+                col_names = tuple(i[0] for i in self._expressions)
+                exprs = tuple(i[1] for i in self._expressions)
+                batch = RecordBatch.from_arrays(
+                    tuple(chain(batch.columns, exprs)),
+                    tuple(chain(batch.column_names, col_names))
+                )
 
             # Remove, once sorting by boolean columns is supported by Arrow
             self._verify_bool_columns(batch.get_schema())
 
-            self._sort_op.next(batch.get_batch())
+            self._sort_op.next(batch.get_source_batch(),
+                               batch.get_selection())
             self._expressions.clear()
 
-        yield RecordBatch(self._sort_op.sorted())
+        yield from self._sorted_batches()
 
         del self._sort_op
 
+    def _sorted_batches(self) -> Iterable[RecordBatch]:
+        if self._is_external:
+            # Sorted runs are merged and returned batch by batch.
+            while True:
+                sorted_batch = self._sort_op.next_sorted()
+                if sorted_batch is None:
+                    break
+                yield RecordBatch(sorted_batch)
+        else:
+            yield RecordBatch(self._sort_op.sorted())
+        # ParallelSort does not keep the stats.
+        if isinstance(self._sort_op, vinum_lib.Sort):
+            self._sort_stats = self._sort_op.sort_stats()
+
+    def get_sort_stats(self):
+        """
+        Activity of the sort, available once the operator is exhausted.
+        """
+        return self._sort_stats
+
+    def get_profile_details(self) -> Dict[str, Any]:
+        stats = self._sort_stats
+        if stats is None:
+            return {}
+        details = {
+            'rows_in': stats.num_rows,
+            'batches_in': stats.num_batches,
+            'sort_time': stats.sort_nanos / 1e9,
+        }
+        if stats.num_spilled_runs:
+            details['spilled_runs'] = stats.num_spilled_runs
+            details['bytes_spilled'] = stats.bytes_spilled
+        return details
+
     def _get_column(self, column: Column, batch: RecordBatch) -> pa.Array:
         return None
 
@@ -201,6 +328,46 @@ class SortOperator(Operator):
                 )
 
 
+class TopNOperator(SortOperator):
+    """
+    Top-N Operator.
+
+    Sort the table by a list of provided columns or expressions and
+    return the slice [offset: offset + limit] of the sorted rows.
+    Only the best offset + limit rows are kept in memory.
+
+    Parameters
+    ----------
+    arguments : Tuple[OperatorBaseType, ...]
+        Columns or expressions to sort by.
+    sort_order : Tuple[SortOrder, ...]
+        List of SortOrders (ASC, DESC) corresponding to columns
+        in the `arguments` parameter.
+    limit : int
+        Number of rows to retain.
+    offset : int
+        Offset where to start the slice.
+    """
+    def __init__(self,
+                 arguments: Tuple[OperatorArgument, ...],
+                 sort_order: Tuple[SortOrder, ...],
+                 limit: int,
+                 offset: int,
+                 parent_operator: Operator) -> None:
+        self._limit = limit
+        self._offset = offset
+        super().__init__(arguments, sort_order, parent_operator)
+
+    def _new_sort_op(self):
+        return vinum_lib.TopN(self._col_names,
+                              self._sort_order,
+                              self._limit,
+                              self._offset)
+
+    def _sorted_batches(self) -> Iterable[RecordBatch]:
+        yield RecordBatch(self._sort_op.result())
+
+
 class SliceOperator(Operator):
     """
     Slice Operator.
@@ -247,15 +414,121 @@ class SliceOperator(Operator):
             self._curr_offset += offset + slice_size
 
 
+class HashJoinOperator(Operator):
+    """
+    Hash Join Operator.
+
+    Join the batches of the parent operator (probe side) with the build table
+    on equal keys. The build table is hashed in memory, the probe side
+    is streamed batch by batch.
+    Output batches hold the columns of the probe side followed by
+    the columns of the build table.
+
+    Parameters
+    ----------
+    build_table : pa.Table
+        Build side of the join.
+    probe_keys : Tuple[str, ...]
+        Key columns of the probe side.
+    build_keys : Tuple[str, ...]
+        Key columns of the build table, with the same types as probe_keys.
+    join_type : str
+        'inner' or 'left'.
+    probe_schema : pa.Schema
+        Schema of the probe side, used if the parent yields no batches.
+    parent_operator : Operator
+        Parent operator.
+    """
+    JOIN_TYPES = {
+        'inner': vinum_lib.JoinType.INNER,
+        'left': vinum_lib.JoinType.LEFT,
+    }
+
+    def __init__(self,
+                 build_table: pa.Table,
+                 probe_keys: Tuple[str, ...],
+                 build_keys: Tuple[str, ...],
+                 join_type: str,
+                 probe_schema: pa.Schema,
+                 parent_operator: Operator) -> None:
+        super().__init__(parent_operator)
+        if join_type not in self.JOIN_TYPES:
+            raise OperatorError(f'Unsupported join type: {join_type}')
+
+        self._build_table = build_table
+        self._probe_keys = probe_keys
+        self._build_keys = build_keys
+        self._join_type = join_type
+        self._probe_schema = probe_schema
+
+    def expected_num_rows(self) -> Optional[int]:
+        # A probe row matches any number of the build rows,
+        # the rows of the probe side are not an upper bound.
+        return None
+
+    def next(self) -> Iterable[RecordBatch]:
+        join_op = vinum_lib.HashJoin(list(self._probe_keys),
+                                     list(self._build_keys),
+                                     self.JOIN_TYPES[self._join_type])
+        if self._memory_pool is not None:
+            join_op.set_memory_pool(self._memory_pool)
+        join_op.build(self._build_table)
+
+        has_batches = False
+        for batch in self._parent_operator.next():
+            has_batches = True
+            yield RecordBatch(join_op.next(batch.get_batch()))
+
+        if not has_batches:
+            empty_batch = pa.RecordBatch.from_arrays(
+                [pa.array([], type=field.type)
+                 for field in self._probe_schema],
+                schema=self._probe_schema
+            )
+            yield RecordBatch(join_op.next(empty_batch))
+
+
+def _scan_batch_size(table: pa.Table,
+                     column_names: Iterable[str]) -> Tuple[int, Optional[int]]:
+    """
+    Rows of the batches of a table scan and the average width of
+    the scanned rows in bytes, None if the batch size is not adapted.
+    """
+    from vinum import get_adaptive_batch_size, get_batch_size
+    if not get_adaptive_batch_size():
+        return get_batch_size(), None
+    row_width = vinum_lib.average_row_width(table, list(column_names))
+    return vinum_lib.adaptive_batch_size(row_width, get_batch_size()), row_width
+
+
+def _scan_profile_details(batch_size: Optional[int],
+                          row_width: Optional[int]) -> Dict[str, Any]:
+    details = {}
+    if batch_size is not None:
+        details['batch_size'] = batch_size
+    if row_width is not None:
+        details['row_width'] = row_width
+    return details
+
+
 class TableReaderOperator(Operator):
     def __init__(self,
                  table: ArrowTable) -> None:
         super().__init__(None)
+        self._num_rows = table.num_rows
         self._reader: vinum_lib.TableBatchReader = vinum_lib.TableBatchReader(
             table.get_table())
 
-        from vinum import get_batch_size
-        self._reader.set_batch_size(get_batch_size())
+        self._batch_size, self._row_width = _scan_batch_size(
+            table.get_table(), ()
+        )
+        self._reader.set_batch_size(self._batch_size)
+
+    def expected_num_rows(self) -> Optional[int]:
+        return self._num_rows
+
+    def get_profile_details(self) -> Dict[str, Any]:
+        return _scan_profile_details(self._batch_size, self._row_width)
 
     def next(self) -> RecordBatch:
         while True:
@@ -265,6 +538,98 @@ class TableReaderOperator(Operator):
             yield RecordBatch(batch)
 
 
+class NativeScanOperator(Operator):
+    """
+    Scan of a table or a native stream, fused with the native filter
+    into a C++ pipeline.
+
+    Aggregate and sort operators directly on top of the scan drain it
+    with run(): the batches are read, filtered and fed to their C++ sink
+    with the GIL released, never crossing into Python. Otherwise next()
+    yields the batches with the selection of the filtered rows.
+
+    The table is read in zero-copy morsels of get_batch_size() rows,
+    fewer if the rows of the scanned columns are wide, see
+    vinum.set_adaptive_batch_size().
+    run() with several threads processes the morsels on all of them.
+    A stream is read once, its batches are distributed over the threads.
+
+    Parameters
+    ----------
+    source : Union[ArrowTable, vinum_lib.BatchSource]
+        Table or stream to scan.
+    column_names : Iterable[str]
+        Columns of the scan, all the columns of the source if empty.
+    native_predicate : Optional[vinum_lib.Predicate]
+        Filter of the rows, must be bound to the schema of the scan.
+    """
+    def __init__(self,
+                 source: Union[ArrowTable, 'vinum_lib.BatchSource'],
+                 column_names: Iterable[str],
+                 native_predicate: Optional['vinum_lib.Predicate'] = None
+                 ) -> None:
+        super().__init__(None)
+        self._source = source
+        self._column_names = list(column_names)
+        self._native_predicate = native_predicate
+        self._batch_size: Optional[int] = None
+        self._row_width: Optional[int] = None
+
+    def get_schema(self) -> pa.Schema:
+        if isinstance(self._source, ArrowTable):
+            schema = self._source.get_schema()
+        else:
+            schema = self._source.schema
+        if not self._column_names:
+            return schema
+        return pa.schema([schema.field(name) for name in self._column_names])
+
+    def run(self, sink: Any, num_threads: int = 1) -> int:
+        """
+        Feed all the batches of the scan to the C++ sink.
+
+        Returns
+        -------
+        int
+            Number of batches read from the source.
+        """
+        return self._new_pipeline(num_threads).run(sink, num_threads)
+
+    def next(self) -> Iterable[RecordBatch]:
+        pipeline = self._new_pipeline(1)
+        while True:
+            next_batch = pipeline.next()
+            if next_batch is None:
+                break
+            yield RecordBatch(*next_batch)
+
+    def expected_num_rows(self) -> Optional[int]:
+        # Rows before the native filter, the aggregate scales them
+        # by the fraction of the rows selected in its sample.
+        if isinstance(self._source, ArrowTable):
+            return self._source.num_rows
+        return None
+
+    def get_profile_details(self) -> Dict[str, Any]:
+        return _scan_profile_details(self._batch_size, self._row_width)
+
+    def _new_pipeline(self, num_workers: int) -> 'vinum_lib.Pipeline':
+        if isinstance(self._source, ArrowTable):
+            self._batch_size, self._row_width = _scan_batch_size(
+                self._source.get_table(), self._column_names
+            )
+            reader = vinum_lib.ParallelTableBatchReader(
+                self._source.get_table(),
+                self._batch_size,
+                num_workers
+            )
+        else:
+            reader = self._source
+        return vinum_lib.Pipeline(reader,
+                                  self._column_names,
+                                  self._native_predicate)
+
+
 class FileReaderOperator(Operator):
     def __init__(self, reader: pa.csv.CSVStreamingReader) -> None:
         super().__init__(None)
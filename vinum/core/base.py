@@ -2,6 +2,7 @@ import warnings
 from typing import (
     Any,
     Callable,
+    Dict,
     Iterable,
     Optional,
     TYPE_CHECKING,
@@ -12,6 +13,8 @@ from typing import (
 import pyarrow as pa
 import numpy as np
 
+import vinum_lib
+
 from vinum._typing import OperatorArgument
 from vinum.arrow.record_batch import RecordBatch
 from vinum.parser.query import Literal, Column, HasColumnName
@@ -246,6 +249,7 @@ class Operator(BaseArgumentsProcessor, HasColumnName, RecursiveTreePrint):
         super().__init__()
 
         self._parent_operator: 'Operator' = parent_operator
+        self._memory_pool: Optional[vinum_lib.QueryMemoryPool] = None
 
         if arguments is None:
             arguments = []
@@ -267,6 +271,29 @@ class Operator(BaseArgumentsProcessor, HasColumnName, RecursiveTreePrint):
         """
         pass
 
+    def get_profile_details(self) -> Dict[str, Any]:
+        """
+        Operator specific counters of the last execution, for EXPLAIN ANALYZE.
+        """
+        return {}
+
+    def set_memory_pool(self, memory_pool: 'vinum_lib.QueryMemoryPool') -> None:
+        """
+        Memory pool of the query, the native operators allocate from it.
+        Set by the Executor before the execution.
+        """
+        self._memory_pool = memory_pool
+
+    def expected_num_rows(self) -> Optional[int]:
+        """
+        Upper bound of the rows returned by the operator, as far as
+        it is known before the execution, None if it is not known.
+        Operators pass through the rows of the scan by default.
+        """
+        if self._parent_operator is None:
+            return None
+        return self._parent_operator.expected_num_rows()
+
     def str_lines_repr(self, indent_level: int,) -> Tuple:
         lines = []
 
@@ -390,10 +390,13 @@ _default_functions_registry = {
 AGG_FUNCS = {
     'count_star',
     'count',
+    'count_distinct',
     'min',
     'max',
     'sum',
     'avg',
+    'approx_count_distinct',
+    'approx_percentile',
     'np.min',
     'np.max',
     'np.sum',
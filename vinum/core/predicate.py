@@ -0,0 +1,153 @@
+from typing import Any, Optional, Set
+
+import vinum_lib
+
+from vinum.parser.query import Expression, SQLExpression
+from vinum.util.util import is_column, is_expression, is_literal
+
+
+COMPARE_OPS = {
+    SQLExpression.EQUALS: vinum_lib.CompareOp.EQUALS,
+    SQLExpression.NOT_EQUALS: vinum_lib.CompareOp.NOT_EQUALS,
+    SQLExpression.LESS_THAN: vinum_lib.CompareOp.LESS,
+    SQLExpression.LESS_THAN_OR_EQUAL: vinum_lib.CompareOp.LESS_EQUAL,
+    SQLExpression.GREATER_THAN: vinum_lib.CompareOp.GREATER,
+    SQLExpression.GREATER_THAN_OR_EQUAL: vinum_lib.CompareOp.GREATER_EQUAL,
+}
+
+INT64_MIN = -2 ** 63
+INT64_MAX = 2 ** 63 - 1
+
+
+class UnsupportedPredicate(Exception):
+    pass
+
+
+def compile_predicate(
+        expr: Expression,
+        processed_shared_ids: Set[str]
+) -> Optional['vinum_lib.Predicate']:
+    """
+    Compile boolean Expression into the native Predicate.
+
+    Comparisons of columns and literals, IS [NOT] NULL, [NOT] BETWEEN,
+    [NOT] IN and their AND, OR, NOT combinations are evaluated natively,
+    in a single pass per conjunct over the batch.
+
+    Parameters
+    ----------
+    expr : Expression
+        Boolean expression.
+    processed_shared_ids : Set[str]
+        Set of shared expression IDs, that are already processed
+        and available as columns.
+
+    Returns
+    -------
+    Optional[vinum_lib.Predicate]
+        Predicate, or None if any of the sub-expressions
+        is not supported natively.
+    """
+    predicate = vinum_lib.Predicate()
+    try:
+        _PredicateCompiler(predicate, processed_shared_ids).compile(expr)
+    except UnsupportedPredicate:
+        return None
+    return predicate
+
+
+class _PredicateCompiler:
+    """
+    Append the nodes of the Expression tree to the Predicate program,
+    arguments first.
+    """
+    def __init__(self,
+                 predicate: 'vinum_lib.Predicate',
+                 processed_shared_ids: Set[str]) -> None:
+        self._predicate = predicate
+        self._processed_shared_ids = processed_shared_ids
+
+    def compile(self, expr: Any) -> int:
+        if not is_expression(expr):
+            raise UnsupportedPredicate()
+        if expr.is_shared():
+            # Shared expressions are computed by the expressions engine.
+            raise UnsupportedPredicate()
+
+        sql_operator = expr.sql_operator
+        args = expr.arguments
+        if sql_operator in COMPARE_OPS:
+            return self._predicate.compare(COMPARE_OPS[sql_operator],
+                                           self._operand(args[0]),
+                                           self._operand(args[1]))
+        elif sql_operator in (SQLExpression.IS_NULL,
+                              SQLExpression.IS_NOT_NULL):
+            node = self._predicate.is_null(self._column(args[0]))
+            if sql_operator == SQLExpression.IS_NOT_NULL:
+                node = self._predicate.not_(node)
+            return node
+        elif sql_operator in (SQLExpression.BETWEEN,
+                              SQLExpression.NOT_BETWEEN):
+            value = self._operand(args[0])
+            node = self._predicate.and_([
+                self._predicate.compare(vinum_lib.CompareOp.GREATER_EQUAL,
+                                        value,
+                                        self._operand(args[1])),
+                self._predicate.compare(vinum_lib.CompareOp.LESS_EQUAL,
+                                        value,
+                                        self._operand(args[2])),
+            ])
+            if sql_operator == SQLExpression.NOT_BETWEEN:
+                node = self._predicate.not_(node)
+            return node
+        elif sql_operator in (SQLExpression.IN, SQLExpression.NOT_IN):
+            value = self._column(args[0])
+            if not is_literal(args[1]) or not args[1].value:
+                raise UnsupportedPredicate()
+            node = self._predicate.or_([
+                self._predicate.compare(vinum_lib.CompareOp.EQUALS,
+                                        value,
+                                        self._literal(item))
+                for item in args[1].value
+            ])
+            if sql_operator == SQLExpression.NOT_IN:
+                node = self._predicate.not_(node)
+            return node
+        elif sql_operator in (SQLExpression.AND, SQLExpression.OR):
+            nodes = [self.compile(arg) for arg in args]
+            if sql_operator == SQLExpression.AND:
+                return self._predicate.and_(nodes)
+            return self._predicate.or_(nodes)
+        elif sql_operator == SQLExpression.NOT:
+            return self._predicate.not_(self.compile(args[0]))
+        else:
+            raise UnsupportedPredicate()
+
+    def _operand(self, arg: Any) -> int:
+        if is_literal(arg):
+            return self._literal(arg.value)
+        return self._column(arg)
+
+    def _column(self, arg: Any) -> int:
+        if is_column(arg):
+            return self._predicate.column(arg.get_column_name())
+        if (
+                is_expression(arg)
+                and arg.is_shared()
+                and arg.get_shared_id() in self._processed_shared_ids
+        ):
+            return self._predicate.column(arg.get_shared_id())
+        raise UnsupportedPredicate()
+
+    def _literal(self, value: Any) -> int:
+        if isinstance(value, bool):
+            raise UnsupportedPredicate()
+        elif isinstance(value, int):
+            if not INT64_MIN <= value <= INT64_MAX:
+                raise UnsupportedPredicate()
+            return self._predicate.int_literal(value)
+        elif isinstance(value, float):
+            return self._predicate.double_literal(value)
+        elif isinstance(value, str):
+            return self._predicate.string_literal(value)
+        raise UnsupportedPredicate()
@@ -4,6 +4,7 @@ from typing import Dict, Callable, Tuple
 from vinum.core.functions import (
     _default_functions_registry, FunctionType, )
 from vinum.errors import FunctionError
+from vinum.api.query_cache import query_cache
 
 _udf_registry: Dict[str, Callable] = {}
 
@@ -18,6 +19,8 @@ def _register_udf(name: str, function) -> None:
     function_name = _ensure_function_name_correctness(name)
     _remove_udf(name)
     _udf_registry[function_name] = function
+    # Cached queries might have used the previous definition.
+    query_cache.clear()
 
 
 def _remove_udf(name: str) -> None:
@@ -6,17 +6,150 @@
 #include <single_numerical_hash_aggregate.h>
 #include <multi_numerical_hash_aggregate.h>
 #include <generic_hash_aggregate.h>
+#include <composite_key_hash_aggregate.h>
+#include <dictionary_hash_aggregate.h>
 #include <one_group_aggregate.h>
+#include <parallel_hash_aggregate.h>
+#include <spilling_hash_aggregate.h>
 
 #include <sort.cpp>
+#include <top_n.h>
+#include <parallel_sort.h>
+
+#include <hash_join.h>
+
+#include <window.h>
+
+#include <predicate.h>
 
 #include <table_batch_reader.h>
+#include <csv_stream_reader.h>
+#include <ipc_file_reader.h>
+#include <parquet_file_reader.h>
+#include <pipeline.h>
 
 namespace py = pybind11;
 namespace agg = vinum::operators::aggregate;
 namespace sort = vinum::operators::sort;
+namespace join = vinum::operators::join;
+namespace window = vinum::operators::window;
+namespace filter = vinum::operators::filter;
+using vinum::operators::Pipeline;
 
 
+// Selection of the rows of a batch, nullptr if the selection is None and all the rows are selected.
+std::shared_ptr<arrow::Array> unwrap_selection(py::handle py_selection) {
+    if (py_selection.is_none()) {
+        return nullptr;
+    }
+    return arrow::py::unwrap_array(py_selection.ptr()).ValueOrDie();
+}
+
+
+// Batches are aggregated with the GIL released, so that
+// several python threads can feed the same aggregate concurrently.
+template<typename AGG>
+void bind_parallel_aggregate(py::module& m, const char* name) {
+    using ParallelAgg = agg::ParallelHashAggregate<AGG>;
+    py::class_<ParallelAgg>(m, name)
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<std::string>&,
+                    const std::vector<agg::AggFuncDef>&,
+                    size_t
+                    >())
+        .def("next", [](ParallelAgg &self,
+                        py::handle py_batch,
+                        py::handle py_selection) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto selection = unwrap_selection(py_selection);
+                py::gil_scoped_release release;
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
+        )
+        .def("result", [](ParallelAgg &self) {
+                std::shared_ptr<arrow::RecordBatch> result;
+                {
+                    py::gil_scoped_release release;
+                    result = self.Result();
+                }
+                return py::handle(arrow::py::wrap_batch(result));
+            }
+        )
+        .def("next_result", [](ParallelAgg &self, int64_t batch_size) {
+                std::shared_ptr<arrow::RecordBatch> result;
+                {
+                    py::gil_scoped_release release;
+                    result = self.NextResult(batch_size);
+                }
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &ParallelAgg::AggStats)
+        .def("set_memory_pool", &ParallelAgg::SetMemoryPool)
+        .def("set_expected_rows", &ParallelAgg::SetExpectedRows)
+        ;
+}
+
+
+// Hash aggregate with a memory limit, spills the partial states into spill_dir.
+template<typename AGG>
+void bind_spilling_aggregate(py::module& m, const char* name) {
+    using SpillingAgg = agg::SpillingHashAggregate<AGG>;
+    py::class_<SpillingAgg>(m, name)
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<std::string>&,
+                    const std::vector<agg::AggFuncDef>&,
+                    size_t,
+                    const std::string&
+                    >())
+        .def("next", [](SpillingAgg &self,
+                        py::handle py_batch,
+                        py::handle py_selection) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
+        )
+        .def("result", [](SpillingAgg &self) {
+                return py::handle(arrow::py::wrap_batch(self.Result()));
+            }
+        )
+        .def("next_result", [](SpillingAgg &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("spill_stats", &SpillingAgg::Stats)
+        .def("agg_stats", &SpillingAgg::AggStats)
+        .def("set_memory_pool", &SpillingAgg::SetMemoryPool)
+        ;
+}
+
+// The whole scan, filter and the Next() of the sink run with the GIL released.
+template<typename SINK>
+void bind_pipeline_sink(py::class_<Pipeline>& pipeline) {
+    pipeline.def("run", [](Pipeline &self, SINK &sink, size_t num_threads) {
+            py::gil_scoped_release release;
+            return self.Run(sink, num_threads);
+        },
+        py::arg("sink"), py::arg("num_threads") = 1
+    );
+}
+
 PYBIND11_MODULE(vinum_lib, m) {
 
     m.def("import_pyarrow",
@@ -25,10 +158,13 @@ PYBIND11_MODULE(vinum_lib, m) {
     py::enum_<vinum::operators::aggregate::AggFuncType>(m, "AggFuncType")
         .value("COUNT_STAR", agg::AggFuncType::COUNT_STAR)
         .value("COUNT", agg::AggFuncType::COUNT)
+        .value("COUNT_DISTINCT", agg::AggFuncType::COUNT_DISTINCT)
         .value("MIN", agg::AggFuncType::MIN)
         .value("MAX", agg::AggFuncType::MAX)
         .value("SUM", agg::AggFuncType::SUM)
         .value("AVG", agg::AggFuncType::AVG)
+        .value("APPROX_COUNT_DISTINCT", agg::AggFuncType::APPROX_COUNT_DISTINCT)
+        .value("APPROX_PERCENTILE", agg::AggFuncType::APPROX_PERCENTILE)
         .export_values();
 
     py::enum_<sort::SortOrder>(m, "SortOrder")
@@ -36,20 +172,77 @@ PYBIND11_MODULE(vinum_lib, m) {
         .value("DESC", sort::SortOrder::DESC)
         .export_values();
 
+    py::enum_<join::JoinType>(m, "JoinType")
+        .value("INNER", join::JoinType::INNER)
+        .value("LEFT", join::JoinType::LEFT)
+        .export_values();
+
+    py::register_exception<vinum::common::MemoryLimitError>(m, "MemoryLimitError", PyExc_MemoryError);
+
+    // A single pool is shared by all the operators of a query.
+    py::class_<vinum::common::QueryMemoryPool, std::shared_ptr<vinum::common::QueryMemoryPool>>(m, "QueryMemoryPool")
+        .def(py::init<int64_t, const std::string&>(),
+             py::arg("limit") = 0, py::arg("backend") = "default")
+        .def_property_readonly("bytes_allocated", &vinum::common::QueryMemoryPool::bytes_allocated)
+        .def_property_readonly("max_memory", &vinum::common::QueryMemoryPool::max_memory)
+        .def_property_readonly("reserved_bytes", &vinum::common::QueryMemoryPool::ReservedBytes)
+        .def_property_readonly("limit", &vinum::common::QueryMemoryPool::Limit)
+        .def_property_readonly("backend_name", &vinum::common::QueryMemoryPool::backend_name)
+        .def("__repr__", [](const vinum::common::QueryMemoryPool& obj) {
+            return "<QueryMemoryPool bytes_allocated: " + std::to_string(obj.bytes_allocated())
+                    + ", max_memory: " + std::to_string(obj.max_memory())
+                    + ", limit: " + std::to_string(obj.Limit()) + ">";
+         });
+
     py::class_<agg::AggFuncDef>(m, "AggFuncDef")
         .def(py::init<
                     agg::AggFuncType,
                     const std::string&,
                     const std::string&>())
+        .def(py::init<
+                    agg::AggFuncType,
+                    const std::string&,
+                    const std::string&,
+                    double>())
         .def_readonly("column_name",
                       &agg::AggFuncDef::column_name)
         .def_readonly("out_col_name",
                       &agg::AggFuncDef::out_col_name)
+        .def_readonly("param",
+                      &agg::AggFuncDef::param)
         .def("__repr__", [](const agg::AggFuncDef& obj) {
             return "<AggFuncDef col_name: " + obj.column_name
                     + ", out_col_name: " + obj.out_col_name + ">";
          });
 
+    py::class_<agg::AggregateStats>(m, "AggregateStats")
+        .def_readonly("num_batches", &agg::AggregateStats::num_batches)
+        .def_readonly("num_rows", &agg::AggregateStats::num_rows)
+        .def_readonly("num_groups", &agg::AggregateStats::num_groups)
+        .def_readonly("table_capacity", &agg::AggregateStats::table_capacity)
+        .def_readonly("num_resizes", &agg::AggregateStats::num_resizes)
+        .def_readonly("memory_bytes", &agg::AggregateStats::memory_bytes)
+        .def_readonly("estimated_groups", &agg::AggregateStats::estimated_groups)
+        .def_readonly("update_nanos", &agg::AggregateStats::update_nanos)
+        .def_readonly("result_nanos", &agg::AggregateStats::result_nanos)
+        .def_property_readonly("load_factor", &agg::AggregateStats::LoadFactor)
+        .def("__repr__", [](const agg::AggregateStats& obj) {
+            return "<AggregateStats num_rows: " + std::to_string(obj.num_rows)
+                    + ", num_groups: " + std::to_string(obj.num_groups)
+                    + ", table_capacity: " + std::to_string(obj.table_capacity)
+                    + ", num_resizes: " + std::to_string(obj.num_resizes) + ">";
+         });
+
+    py::class_<agg::SpillStats>(m, "SpillStats")
+        .def_readonly("bytes_spilled", &agg::SpillStats::bytes_spilled)
+        .def_readonly("num_spills", &agg::SpillStats::num_spills)
+        .def_readonly("num_partitions", &agg::SpillStats::num_partitions)
+        .def("__repr__", [](const agg::SpillStats& obj) {
+            return "<SpillStats bytes_spilled: " + std::to_string(obj.bytes_spilled)
+                    + ", num_spills: " + std::to_string(obj.num_spills)
+                    + ", num_partitions: " + std::to_string(obj.num_partitions) + ">";
+         });
+
 
     py::class_<agg::SingleNumericalHashAggregate>(m, "SingleNumericalHashAggregate")
         .def(py::init<
@@ -58,16 +251,31 @@ PYBIND11_MODULE(vinum_lib, m) {
                     const std::vector<agg::AggFuncDef>&
                     >())
         .def("next", [](agg::SingleNumericalHashAggregate &self,
-                        py::handle py_batch) {
+                        py::handle py_batch,
+                        py::handle py_selection) {
                 auto batch = arrow::py::unwrap_batch(
                     py_batch.ptr()).ValueOrDie();
-                return self.Next(batch);
-            }
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
         )
         .def("result", [](agg::SingleNumericalHashAggregate &self) {
                 return py::handle(arrow::py::wrap_batch(self.Result()));
             }
         )
+        .def("next_result", [](agg::SingleNumericalHashAggregate &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &agg::SingleNumericalHashAggregate::AggStats)
+        .def("set_memory_pool", &agg::SingleNumericalHashAggregate::SetMemoryPool)
+        .def("set_expected_rows", &agg::SingleNumericalHashAggregate::SetExpectedRows)
         ;
 
     py::class_<agg::MultiNumericalHashAggregate>(m, "MultiNumericalHashAggregate")
@@ -77,16 +285,31 @@ PYBIND11_MODULE(vinum_lib, m) {
                     const std::vector<agg::AggFuncDef>&
                     >())
         .def("next", [](agg::MultiNumericalHashAggregate &self,
-                        py::handle py_batch) {
+                        py::handle py_batch,
+                        py::handle py_selection) {
                 auto batch = arrow::py::unwrap_batch(
                     py_batch.ptr()).ValueOrDie();
-                return self.Next(batch);
-            }
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
         )
         .def("result", [](agg::MultiNumericalHashAggregate &self) {
                 return py::handle(arrow::py::wrap_batch(self.Result()));
             }
         )
+        .def("next_result", [](agg::MultiNumericalHashAggregate &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &agg::MultiNumericalHashAggregate::AggStats)
+        .def("set_memory_pool", &agg::MultiNumericalHashAggregate::SetMemoryPool)
+        .def("set_expected_rows", &agg::MultiNumericalHashAggregate::SetExpectedRows)
         ;
 
     py::class_<agg::GenericHashAggregate>(m, "GenericHashAggregate")
@@ -96,31 +319,150 @@ PYBIND11_MODULE(vinum_lib, m) {
                     const std::vector<agg::AggFuncDef>&
                     >())
         .def("next", [](agg::GenericHashAggregate &self,
-                        py::handle py_batch) {
+                        py::handle py_batch,
+                        py::handle py_selection) {
                 auto batch = arrow::py::unwrap_batch(
                     py_batch.ptr()).ValueOrDie();
-                return self.Next(batch);
-            }
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
         )
         .def("result", [](agg::GenericHashAggregate &self) {
                 return py::handle(arrow::py::wrap_batch(self.Result()));
             }
         )
+        .def("next_result", [](agg::GenericHashAggregate &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &agg::GenericHashAggregate::AggStats)
+        .def("set_memory_pool", &agg::GenericHashAggregate::SetMemoryPool)
+        .def("set_expected_rows", &agg::GenericHashAggregate::SetExpectedRows)
+        ;
+
+    py::class_<agg::CompositeKeyHashAggregate>(m, "CompositeKeyHashAggregate")
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<std::string>&,
+                    const std::vector<agg::AggFuncDef>&
+                    >())
+        .def("next", [](agg::CompositeKeyHashAggregate &self,
+                        py::handle py_batch,
+                        py::handle py_selection) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
+        )
+        .def("result", [](agg::CompositeKeyHashAggregate &self) {
+                return py::handle(arrow::py::wrap_batch(self.Result()));
+            }
+        )
+        .def("next_result", [](agg::CompositeKeyHashAggregate &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &agg::CompositeKeyHashAggregate::AggStats)
+        .def("set_memory_pool", &agg::CompositeKeyHashAggregate::SetMemoryPool)
+        .def("set_expected_rows", &agg::CompositeKeyHashAggregate::SetExpectedRows)
+        ;
+
+    py::class_<agg::DictionaryHashAggregate>(m, "DictionaryHashAggregate")
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<std::string>&,
+                    const std::vector<agg::AggFuncDef>&
+                    >())
+        .def("next", [](agg::DictionaryHashAggregate &self,
+                        py::handle py_batch,
+                        py::handle py_selection) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
+        )
+        .def("result", [](agg::DictionaryHashAggregate &self) {
+                return py::handle(arrow::py::wrap_batch(self.Result()));
+            }
+        )
+        .def("next_result", [](agg::DictionaryHashAggregate &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &agg::DictionaryHashAggregate::AggStats)
+        .def("set_memory_pool", &agg::DictionaryHashAggregate::SetMemoryPool)
+        .def("set_expected_rows", &agg::DictionaryHashAggregate::SetExpectedRows)
         ;
 
+    bind_parallel_aggregate<agg::SingleNumericalHashAggregate>(
+            m, "ParallelSingleNumericalHashAggregate");
+    bind_parallel_aggregate<agg::MultiNumericalHashAggregate>(
+            m, "ParallelMultiNumericalHashAggregate");
+    bind_parallel_aggregate<agg::GenericHashAggregate>(
+            m, "ParallelGenericHashAggregate");
+    bind_parallel_aggregate<agg::CompositeKeyHashAggregate>(
+            m, "ParallelCompositeKeyHashAggregate");
+    bind_parallel_aggregate<agg::DictionaryHashAggregate>(
+            m, "ParallelDictionaryHashAggregate");
+
+    bind_spilling_aggregate<agg::SingleNumericalHashAggregate>(
+            m, "SpillingSingleNumericalHashAggregate");
+    bind_spilling_aggregate<agg::MultiNumericalHashAggregate>(
+            m, "SpillingMultiNumericalHashAggregate");
+    bind_spilling_aggregate<agg::GenericHashAggregate>(
+            m, "SpillingGenericHashAggregate");
+    bind_spilling_aggregate<agg::CompositeKeyHashAggregate>(
+            m, "SpillingCompositeKeyHashAggregate");
+    bind_spilling_aggregate<agg::DictionaryHashAggregate>(
+            m, "SpillingDictionaryHashAggregate");
+
     py::class_<agg::OneGroupAggregate>(m, "OneGroupAggregate")
         .def(py::init<const std::vector<agg::AggFuncDef>&>())
         .def("next", [](agg::OneGroupAggregate &self,
-                        py::handle py_batch) {
+                        py::handle py_batch,
+                        py::handle py_selection) {
                 auto batch = arrow::py::unwrap_batch(
                     py_batch.ptr()).ValueOrDie();
-                return self.Next(batch);
-            }
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
         )
         .def("result", [](agg::OneGroupAggregate &self) {
                 return py::handle(arrow::py::wrap_batch(self.Result()));
             }
         )
+        .def("next_result", [](agg::OneGroupAggregate &self, int64_t batch_size) {
+                auto result = self.NextResult(batch_size);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("agg_stats", &agg::OneGroupAggregate::AggStats)
+        .def("set_memory_pool", &agg::OneGroupAggregate::SetMemoryPool)
         ;
 
     py::class_<sort::Sort>(m, "Sort")
@@ -128,17 +470,231 @@ PYBIND11_MODULE(vinum_lib, m) {
                     const std::vector<std::string>&,
                     const std::vector<sort::SortOrder>&
                     >())
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<sort::SortOrder>&,
+                    size_t,
+                    const std::string&,
+                    int64_t
+                    >())
         .def("next", [](sort::Sort &self,
-                        py::handle py_batch) {
+                        py::handle py_batch,
+                        py::handle py_selection) {
                 auto batch = arrow::py::unwrap_batch(
                     py_batch.ptr()).ValueOrDie();
-                return self.Next(batch);
-            }
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
         )
         .def("sorted", [](sort::Sort &self) {
                 return py::handle(arrow::py::wrap_batch(self.Sorted()));
             }
         )
+        .def("next_sorted", [](sort::Sort &self) {
+                auto next_batch = self.NextSorted();
+                if (next_batch != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(next_batch));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("sort_stats", &sort::Sort::Stats)
+        .def("set_memory_pool", &sort::Sort::SetMemoryPool)
+        ;
+
+    py::class_<sort::ParallelSort>(m, "ParallelSort")
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<sort::SortOrder>&,
+                    size_t,
+                    int64_t
+                    >())
+        .def("next", [](sort::ParallelSort &self,
+                        py::handle py_batch,
+                        py::handle py_selection) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
+        )
+        .def("sorted", [](sort::ParallelSort &self) {
+                return py::handle(arrow::py::wrap_batch(self.Sorted()));
+            }
+        )
+        .def("set_memory_pool", &sort::ParallelSort::SetMemoryPool)
+        ;
+
+    py::class_<sort::TopN>(m, "TopN")
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<sort::SortOrder>&,
+                    int64_t,
+                    int64_t
+                    >())
+        .def("next", [](sort::TopN &self,
+                        py::handle py_batch,
+                        py::handle py_selection) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto selection = unwrap_selection(py_selection);
+                self.Next(batch, selection);
+            },
+            py::arg("batch"), py::arg("selection") = py::none()
+        )
+        .def("result", [](sort::TopN &self) {
+                return py::handle(arrow::py::wrap_batch(self.Result()));
+            }
+        )
+        .def("set_memory_pool", &sort::TopN::SetMemoryPool)
+        ;
+
+    py::class_<sort::SortStats>(m, "SortStats")
+        .def_readonly("bytes_spilled", &sort::SortStats::bytes_spilled)
+        .def_readonly("num_spilled_runs", &sort::SortStats::num_spilled_runs)
+        .def_readonly("num_batches", &sort::SortStats::num_batches)
+        .def_readonly("num_rows", &sort::SortStats::num_rows)
+        .def_readonly("sort_nanos", &sort::SortStats::sort_nanos)
+        .def("__repr__", [](const sort::SortStats& obj) {
+            return "<SortStats bytes_spilled: " + std::to_string(obj.bytes_spilled)
+                    + ", num_spilled_runs: " + std::to_string(obj.num_spilled_runs) + ">";
+         });
+
+    py::class_<join::HashJoin>(m, "HashJoin")
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<std::string>&,
+                    join::JoinType
+                    >())
+        .def("build", [](join::HashJoin &self,
+                         py::handle py_table) {
+                auto table = arrow::py::unwrap_table(
+                    py_table.ptr()).ValueOrDie();
+                self.Build(table);
+            }
+        )
+        .def("next", [](join::HashJoin &self,
+                        py::handle py_batch) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                return py::handle(arrow::py::wrap_batch(self.Next(batch)));
+            }
+        )
+        .def("set_memory_pool", &join::HashJoin::SetMemoryPool)
+        ;
+
+    py::enum_<window::WindowFuncType>(m, "WindowFuncType")
+        .value("ROW_NUMBER", window::WindowFuncType::ROW_NUMBER)
+        .value("RANK", window::WindowFuncType::RANK)
+        .value("DENSE_RANK", window::WindowFuncType::DENSE_RANK)
+        .value("COUNT", window::WindowFuncType::COUNT)
+        .value("COUNT_STAR", window::WindowFuncType::COUNT_STAR)
+        .value("MIN", window::WindowFuncType::MIN)
+        .value("MAX", window::WindowFuncType::MAX)
+        .value("SUM", window::WindowFuncType::SUM)
+        .value("AVG", window::WindowFuncType::AVG)
+        .value("LAG", window::WindowFuncType::LAG)
+        .value("LEAD", window::WindowFuncType::LEAD)
+        .export_values();
+
+    py::class_<window::WindowFuncDef>(m, "WindowFuncDef")
+        .def(py::init<
+                    window::WindowFuncType,
+                    const std::string&,
+                    const std::string&,
+                    int64_t>())
+        .def_readonly("column_name",
+                      &window::WindowFuncDef::column_name)
+        .def_readonly("out_col_name",
+                      &window::WindowFuncDef::out_col_name)
+        .def_readonly("offset",
+                      &window::WindowFuncDef::offset)
+        ;
+
+    py::class_<window::Window>(m, "Window")
+        .def(py::init<
+                    const std::vector<std::string>&,
+                    const std::vector<std::string>&,
+                    const std::vector<window::WindowFuncDef>&
+                    >())
+        .def("next", [](window::Window &self,
+                        py::handle py_batch) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                auto result = self.Next(batch);
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("finish", [](window::Window &self) {
+                auto result = self.Finish();
+                if (result != nullptr) {
+                    return py::handle(arrow::py::wrap_batch(result));
+                } else {
+                    return py::handle(py::cast<py::none>(Py_None));
+                }
+            }
+        )
+        .def("set_memory_pool", &window::Window::SetMemoryPool)
+        ;
+
+    py::enum_<filter::CompareOp>(m, "CompareOp")
+        .value("EQUALS", filter::CompareOp::EQUALS)
+        .value("NOT_EQUALS", filter::CompareOp::NOT_EQUALS)
+        .value("LESS", filter::CompareOp::LESS)
+        .value("LESS_EQUAL", filter::CompareOp::LESS_EQUAL)
+        .value("GREATER", filter::CompareOp::GREATER)
+        .value("GREATER_EQUAL", filter::CompareOp::GREATER_EQUAL)
+        .export_values();
+
+    py::class_<filter::Predicate>(m, "Predicate")
+        .def(py::init<>())
+        .def("column", &filter::Predicate::Column)
+        .def("int_literal", &filter::Predicate::IntLiteral)
+        .def("double_literal", &filter::Predicate::DoubleLiteral)
+        .def("string_literal", &filter::Predicate::StringLiteral)
+        .def("compare", &filter::Predicate::Compare)
+        .def("is_null", &filter::Predicate::IsNull)
+        .def("and_", &filter::Predicate::And)
+        .def("or_", &filter::Predicate::Or)
+        .def("not_", &filter::Predicate::Not)
+        .def("bind", [](filter::Predicate &self,
+                        py::handle py_schema) {
+                auto schema = arrow::py::unwrap_schema(
+                    py_schema.ptr()).ValueOrDie();
+                return self.Bind(*schema);
+            }
+        )
+        .def("select", [](filter::Predicate &self,
+                          py::handle py_batch) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                std::shared_ptr<arrow::Array> selection;
+                {
+                    py::gil_scoped_release release;
+                    selection = filter::SelectionToArray(self.Select(*batch));
+                }
+                return py::handle(arrow::py::wrap_array(selection));
+            }
+        )
+        .def("filter", [](filter::Predicate &self,
+                          py::handle py_batch) {
+                auto batch = arrow::py::unwrap_batch(
+                    py_batch.ptr()).ValueOrDie();
+                std::shared_ptr<arrow::RecordBatch> result;
+                {
+                    py::gil_scoped_release release;
+                    result = self.Filter(batch);
+                }
+                return py::handle(arrow::py::wrap_batch(result));
+            }
+        )
         ;
 
     py::class_<vinum::operators::TableBatchReader>(m, "TableBatchReader")
@@ -164,5 +720,142 @@ PYBIND11_MODULE(vinum_lib, m) {
         )
         ;
 
+    m.def("average_row_width", [](py::handle table_handle,
+                                  const std::vector<std::string>& column_names) {
+            auto table = arrow::py::unwrap_table(
+                table_handle.ptr()).ValueOrDie();
+            return vinum::operators::AverageRowWidth(table, column_names);
+        }
+    );
+    m.def("adaptive_batch_size", &vinum::operators::AdaptiveBatchSize);
+
+    py::class_<vinum::operators::BatchSource>(m, "BatchSource")
+        .def_property_readonly("schema", [](vinum::operators::BatchSource &self) {
+                return py::handle(arrow::py::wrap_schema(self.Schema()));
+            }
+        )
+        .def("read_next_batch", [](vinum::operators::BatchSource &self) {
+                std::shared_ptr<arrow::RecordBatch> batch;
+                {
+                    py::gil_scoped_release release;
+                    batch = self.Next(0);
+                }
+                if (batch == nullptr) {
+                    throw py::stop_iteration();
+                }
+                return py::handle(arrow::py::wrap_batch(batch));
+            }
+        )
+        ;
+
+    py::class_<vinum::operators::ParallelTableBatchReader,
+               vinum::operators::BatchSource>(m, "ParallelTableBatchReader")
+        .def(py::init([](py::handle table_handle,
+                         int64_t morsel_size,
+                         size_t num_workers) {
+                auto table = arrow::py::unwrap_table(
+                    table_handle.ptr()).ValueOrDie();
+                return new vinum::operators::ParallelTableBatchReader(table, morsel_size, num_workers);
+            }
+        ))
+        .def("num_morsels", &vinum::operators::ParallelTableBatchReader::NumMorsels)
+        ;
+
+    py::class_<vinum::operators::CsvStreamReader,
+               vinum::operators::BatchSource>(m, "CsvStreamReader")
+        .def(py::init([](const std::string& path,
+                         int32_t block_size,
+                         int32_t skip_rows,
+                         const std::vector<std::string>& column_names,
+                         bool autogenerate_column_names,
+                         char delimiter,
+                         bool quoting,
+                         char quote_char,
+                         size_t num_threads,
+                         size_t read_ahead) {
+                auto read_options = arrow::csv::ReadOptions::Defaults();
+                read_options.block_size = block_size;
+                read_options.skip_rows = skip_rows;
+                read_options.column_names = column_names;
+                read_options.autogenerate_column_names = autogenerate_column_names;
+                auto parse_options = arrow::csv::ParseOptions::Defaults();
+                parse_options.delimiter = delimiter;
+                parse_options.quoting = quoting;
+                parse_options.quote_char = quote_char;
+                py::gil_scoped_release release;
+                return new vinum::operators::CsvStreamReader(
+                    path, read_options, parse_options, num_threads, read_ahead);
+            }
+        ))
+        ;
+
+    py::class_<vinum::operators::IpcFileReader,
+               vinum::operators::BatchSource>(m, "IpcFileReader")
+        .def(py::init<const std::string&, int64_t, size_t>())
+        .def("num_record_batches", &vinum::operators::IpcFileReader::NumRecordBatches)
+        ;
+
+    py::class_<vinum::operators::ParquetFileReader,
+               vinum::operators::BatchSource>(m, "ParquetFileReader")
+        .def(py::init<
+                    const std::string&,
+                    const std::vector<std::string>&,
+                    const std::vector<int>&,
+                    int64_t,
+                    size_t
+                    >())
+        .def("num_row_groups", &vinum::operators::ParquetFileReader::NumRowGroups)
+        ;
+
+    py::class_<Pipeline> pipeline(m, "Pipeline");
+    pipeline
+        .def(py::init<
+                    vinum::operators::BatchSource&,
+                    const std::vector<std::string>&,
+                    filter::Predicate*
+                    >(),
+             py::keep_alive<1, 2>(), py::keep_alive<1, 4>())
+        .def("next", [](Pipeline &self) {
+                std::shared_ptr<arrow::RecordBatch> batch;
+                std::shared_ptr<arrow::Array> selection;
+                bool has_next;
+                {
+                    py::gil_scoped_release release;
+                    has_next = self.Next(batch, selection);
+                }
+                if (!has_next) {
+                    return py::object(py::none());
+                }
+                py::object py_selection = py::none();
+                if (selection != nullptr) {
+                    py_selection = py::reinterpret_steal<py::object>(arrow::py::wrap_array(selection));
+                }
+                return py::object(py::make_tuple(
+                    py::reinterpret_steal<py::object>(arrow::py::wrap_batch(batch)),
+                    py_selection));
+            }
+        )
+        ;
+
+    bind_pipeline_sink<agg::SingleNumericalHashAggregate>(pipeline);
+    bind_pipeline_sink<agg::MultiNumericalHashAggregate>(pipeline);
+    bind_pipeline_sink<agg::GenericHashAggregate>(pipeline);
+    bind_pipeline_sink<agg::CompositeKeyHashAggregate>(pipeline);
+    bind_pipeline_sink<agg::DictionaryHashAggregate>(pipeline);
+    bind_pipeline_sink<agg::OneGroupAggregate>(pipeline);
+    bind_pipeline_sink<agg::ParallelHashAggregate<agg::SingleNumericalHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::ParallelHashAggregate<agg::MultiNumericalHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::ParallelHashAggregate<agg::GenericHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::ParallelHashAggregate<agg::CompositeKeyHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::ParallelHashAggregate<agg::DictionaryHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::SpillingHashAggregate<agg::SingleNumericalHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::SpillingHashAggregate<agg::MultiNumericalHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::SpillingHashAggregate<agg::GenericHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::SpillingHashAggregate<agg::CompositeKeyHashAggregate>>(pipeline);
+    bind_pipeline_sink<agg::SpillingHashAggregate<agg::DictionaryHashAggregate>>(pipeline);
+    bind_pipeline_sink<sort::Sort>(pipeline);
+    bind_pipeline_sink<sort::ParallelSort>(pipeline);
+    bind_pipeline_sink<sort::TopN>(pipeline);
+
 }
 
@@ -0,0 +1,137 @@
+from typing import Iterable, Tuple
+
+import vinum_lib
+
+from vinum._typing import OperatorArgument
+from vinum.arrow.record_batch import RecordBatch
+from vinum.core.base import Operator
+from vinum.errors import FunctionError
+from vinum.parser.query import Column
+from vinum.util.util import is_column, is_literal
+
+
+class WindowFunction:
+    """
+    Window function, evaluated by the WindowOperator.
+
+    Parameters
+    ----------
+    func : str
+        Window function name.
+    arguments : Tuple[OperatorArgument, ...]
+        Function arguments: a column, and the literal offset of lag/lead.
+    out_col_name : str
+        Name of the column holding the result of the function.
+    """
+    FUNCS = {
+        'ROW_NUMBER': vinum_lib.WindowFuncType.ROW_NUMBER,
+        'RANK': vinum_lib.WindowFuncType.RANK,
+        'DENSE_RANK': vinum_lib.WindowFuncType.DENSE_RANK,
+        'COUNT': vinum_lib.WindowFuncType.COUNT,
+        'COUNT_STAR': vinum_lib.WindowFuncType.COUNT_STAR,
+        'MIN': vinum_lib.WindowFuncType.MIN,
+        'MAX': vinum_lib.WindowFuncType.MAX,
+        'SUM': vinum_lib.WindowFuncType.SUM,
+        'AVG': vinum_lib.WindowFuncType.AVG,
+        'LAG': vinum_lib.WindowFuncType.LAG,
+        'LEAD': vinum_lib.WindowFuncType.LEAD,
+    }
+
+    RANKING_FUNCS = ('ROW_NUMBER', 'RANK', 'DENSE_RANK', 'COUNT_STAR')
+    OFFSET_FUNCS = ('LAG', 'LEAD')
+
+    def __init__(self,
+                 func: str,
+                 arguments: Tuple[OperatorArgument, ...],
+                 out_col_name: str) -> None:
+        self._func = func.upper()
+        if self._func not in self.FUNCS:
+            raise FunctionError(
+                f'Window function is not supported: {func}.')
+        self._out_col_name = out_col_name
+        self._input_column_name = ''
+        self._offset = 1
+
+        if self._func in self.RANKING_FUNCS:
+            if arguments:
+                raise FunctionError(f'{func}() takes no arguments.')
+            return
+
+        if not arguments or not is_column(arguments[0]):
+            raise FunctionError(f'{func}() expects a column argument.')
+        self._input_column_name = arguments[0].get_column_name()
+
+        if self._func in self.OFFSET_FUNCS and len(arguments) == 2:
+            offset = arguments[1]
+            if (
+                    not is_literal(offset)
+                    or isinstance(offset.value, bool)
+                    or not isinstance(offset.value, int)
+            ):
+                raise FunctionError(
+                    f'{func}() expects an integer literal offset.')
+            self._offset = offset.value
+        elif len(arguments) != 1:
+            raise FunctionError(f'Too many arguments of {func}().')
+
+    def get_func_def(self) -> 'vinum_lib.WindowFuncDef':
+        return vinum_lib.WindowFuncDef(
+            self.FUNCS[self._func],
+            self._input_column_name,
+            self._out_col_name,
+            self._offset
+        )
+
+    def __str__(self) -> str:
+        return f'{self._func}({self._input_column_name})'
+
+
+class WindowOperator(Operator):
+    """
+    Window Operator.
+
+    Class is thin proxy which delegates all the work to C++ based
+    physical operator.
+
+    Input batches must be sorted by the partition columns,
+    then by the order columns. The window functions are appended
+    as new columns to the rows, partition by partition.
+
+    Parameters
+    ----------
+    partition_by : Tuple[Column, ...]
+        PARTITION BY columns.
+    order_by : Tuple[Column, ...]
+        ORDER BY columns of the window.
+    funcs : Iterable[WindowFunction]
+        Window functions sharing the window.
+    parent_operator : Operator
+        Parent operator.
+    """
+    def __init__(self,
+                 partition_by: Tuple[Column, ...],
+                 order_by: Tuple[Column, ...],
+                 funcs: Iterable[WindowFunction],
+                 parent_operator: Operator) -> None:
+        super().__init__(parent_operator, partition_by + order_by)
+        self._window = vinum_lib.Window(
+            [c.get_column_name() for c in partition_by],
+            [c.get_column_name() for c in order_by],
+            [func.get_func_def() for func in funcs]
+        )
+
+    def set_memory_pool(self, memory_pool: vinum_lib.QueryMemoryPool) -> None:
+        super().set_memory_pool(memory_pool)
+        self._window.set_memory_pool(memory_pool)
+
+    def next(self) -> Iterable[RecordBatch]:
+        for batch in self._parent_operator.next():
+            result = self._window.next(batch.get_batch())
+            if result is not None:
+                yield RecordBatch(result)
+
+        result = self._window.finish()
+        if result is not None:
+            yield RecordBatch(result)
+
+        del self._window
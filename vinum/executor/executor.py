@@ -1,5 +1,14 @@
+import time
+from typing import Any, Callable, Iterable, List, Optional
+
+import pyarrow as pa
+
+import vinum_lib
+
 from vinum.arrow.arrow_table import ArrowTable
+from vinum.core.algebra import NativeScanOperator
 from vinum.core.base import Operator
+from vinum.executor.profile import OperatorProfile, QueryProfile
 
 
 class Executor:
@@ -7,7 +16,12 @@ class Executor:
     Abstract Executor.
 
     Responsible for execution of a query plan.
+
+    Every execution gets its own memory pool, available as `memory_pool`
+    once the execution started.
     """
+    def __init__(self) -> None:
+        self.memory_pool: Optional[vinum_lib.QueryMemoryPool] = None
 
     def execute(self, operator: Operator) -> ArrowTable:
         """
@@ -20,6 +34,20 @@ class Executor:
         """
         pass
 
+    def _set_memory_pool(self, operator: Operator) -> None:
+        """
+        Create the memory pool of the query and set it on all the operators.
+        """
+        from vinum import get_query_memory_limit, get_memory_pool_backend
+        self.memory_pool = vinum_lib.QueryMemoryPool(
+            get_query_memory_limit() or 0,
+            get_memory_pool_backend()
+        )
+        op = operator
+        while op is not None:
+            op.set_memory_pool(self.memory_pool)
+            op = op._parent_operator
+
 
 class RecursiveExecutor(Executor):
     """
@@ -28,4 +56,134 @@ class RecursiveExecutor(Executor):
     Execute the query plan recursively.
     """
     def execute(self, operator: Operator) -> ArrowTable:
+        self._set_memory_pool(operator)
         return next(operator.next())
+
+
+class ProfilingExecutor(Executor):
+    """
+    Executor of EXPLAIN ANALYZE.
+
+    Executes the query plan recursively, same as RecursiveExecutor,
+    with the batches of every operator timed and counted at the Python
+    operator boundaries. A scan drained by the native pipeline of its
+    parent is fused with it, its time is accounted for by the parent.
+
+    The profile of the last execution is available as `profile`.
+    """
+    def __init__(self) -> None:
+        super().__init__()
+        self.profile: Optional[QueryProfile] = None
+
+    def execute(self, operator: Operator) -> ArrowTable:
+        self._set_memory_pool(operator)
+        operators = []
+        profiles: List[OperatorProfile] = []
+        op = operator
+        while op is not None:
+            profile = OperatorProfile(op.__class__.__name__)
+            if profiles:
+                profiles[-1].children.append(profile)
+            self._instrument(op, profile, self.memory_pool)
+            operators.append(op)
+            profiles.append(profile)
+            op = op._parent_operator
+
+        start_wall = time.perf_counter()
+        start_cpu = time.process_time()
+        result = next(operator.next())
+        wall_time = time.perf_counter() - start_wall
+        cpu_time = time.process_time() - start_cpu
+
+        for idx, (op, profile) in enumerate(zip(operators, profiles)):
+            child = profiles[idx + 1] if idx + 1 < len(profiles) else None
+            self._finish_profile(op, profile, child)
+
+        self.profile = QueryProfile(
+            profiles[0],
+            wall_time,
+            cpu_time,
+            max(self.memory_pool.max_memory,
+                max(profile.peak_bytes for profile in profiles)),
+            result.num_rows
+        )
+        return result
+
+    @staticmethod
+    def _instrument(op: Operator,
+                    profile: OperatorProfile,
+                    memory_pool: vinum_lib.QueryMemoryPool) -> None:
+        """
+        Shadow the next() and run() methods of the operator instance
+        with the timed ones.
+        """
+        next_func = op.next
+
+        default_backend = pa.default_memory_pool().backend_name
+
+        def allocated_bytes() -> int:
+            # Arrow buffers of the query pool are counted by the default
+            # pool as well, unless the query pool has another backend.
+            reserved = memory_pool.reserved_bytes
+            allocated = pa.total_allocated_bytes() + reserved
+            if memory_pool.backend_name != default_backend:
+                allocated += memory_pool.bytes_allocated - reserved
+            return allocated
+
+        def profiled_next() -> Iterable[Any]:
+            batches = next_func()
+            while True:
+                start_wall = time.perf_counter()
+                start_cpu = time.process_time()
+                try:
+                    batch = next(batches)
+                except StopIteration:
+                    return
+                finally:
+                    profile.wall_time += time.perf_counter() - start_wall
+                    profile.cpu_time += time.process_time() - start_cpu
+                profile.batches_out += 1
+                profile.rows_out += batch.num_rows
+                profile.peak_bytes = max(profile.peak_bytes,
+                                         allocated_bytes())
+                yield batch
+
+        op.next = profiled_next
+
+        if isinstance(op, NativeScanOperator):
+            run_func: Callable[..., int] = op.run
+
+            def profiled_run(sink: Any, num_threads: int = 1) -> int:
+                profile.fused = True
+                num_batches = run_func(sink, num_threads)
+                profile.batches_out += num_batches
+                profile.peak_bytes = max(profile.peak_bytes,
+                                         allocated_bytes())
+                return num_batches
+
+            op.run = profiled_run
+
+    @staticmethod
+    def _finish_profile(op: Operator,
+                        profile: OperatorProfile,
+                        child: Optional[OperatorProfile]) -> None:
+        details = op.get_profile_details()
+        # Input counted by the native operator, the only count there is
+        # once the input never crossed into Python.
+        native_rows_in = details.pop('rows_in', None)
+        native_batches_in = details.pop('batches_in', None)
+        profile.details = details
+
+        profile.self_wall_time = profile.wall_time
+        profile.self_cpu_time = profile.cpu_time
+        if child is None:
+            return
+
+        profile.self_wall_time -= child.wall_time
+        profile.self_cpu_time -= child.cpu_time
+        if child.fused and native_rows_in is not None:
+            child.rows_out = native_rows_in
+        profile.rows_in = child.rows_out
+        profile.batches_in = child.batches_out
+        if child.fused and native_batches_in is not None:
+            profile.batches_in = native_batches_in
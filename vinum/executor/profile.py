@@ -0,0 +1,154 @@
+from typing import Any, Dict, List, Optional, Tuple
+
+from vinum.util.tree_print import RecursiveTreePrint
+
+
+class OperatorProfile(RecursiveTreePrint):
+    """
+    Execution profile of a single Operator.
+
+    Times are in seconds. `wall_time` and `cpu_time` are inclusive,
+    ie include the time spent in the operators feeding this one,
+    `self_wall_time` and `self_cpu_time` exclude it.
+    CPU time is the time of the whole process, so that the work of the
+    native threads is accounted for.
+
+    Parameters
+    ----------
+    name : str
+        Operator class name.
+    """
+    def __init__(self, name: str) -> None:
+        self.name: str = name
+        self.wall_time: float = 0.
+        self.cpu_time: float = 0.
+        self.self_wall_time: float = 0.
+        self.self_cpu_time: float = 0.
+        self.rows_in: int = 0
+        self.rows_out: int = 0
+        self.batches_in: int = 0
+        self.batches_out: int = 0
+        # Bytes allocated from the Arrow memory pools and reserved in
+        # the query memory pool, sampled at every batch returned by
+        # the operator.
+        self.peak_bytes: int = 0
+        # Scan fused with its parent into a native pipeline,
+        # its time is accounted for by the parent.
+        self.fused: bool = False
+        self.details: Dict[str, Any] = {}
+        self.children: List['OperatorProfile'] = []
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            'name': self.name,
+            'wall_time': self.wall_time,
+            'cpu_time': self.cpu_time,
+            'self_wall_time': self.self_wall_time,
+            'self_cpu_time': self.self_cpu_time,
+            'rows_in': self.rows_in,
+            'rows_out': self.rows_out,
+            'batches_in': self.batches_in,
+            'batches_out': self.batches_out,
+            'peak_bytes': self.peak_bytes,
+            'fused': self.fused,
+            'details': dict(self.details),
+            'children': [child.to_dict() for child in self.children],
+        }
+
+    @staticmethod
+    def _format_value(value: Any) -> str:
+        if isinstance(value, float):
+            return f'{value:.4g}'
+        return str(value)
+
+    def str_lines_repr(self, indent_level: int) -> Tuple[str, ...]:
+        lines = []
+
+        op_line = (f'{self._level_indent_string(indent_level)}'
+                   f'Operator: {self.name}')
+        if self.fused:
+            op_line += ' (fused)'
+        lines.append(op_line)
+
+        stat_indent = self._level_indent_string(indent_level + 1)
+        lines.append(f'{stat_indent}time: {self.wall_time * 1e3:.3f} ms, '
+                     f'self: {self.self_wall_time * 1e3:.3f} ms, '
+                     f'cpu: {self.self_cpu_time * 1e3:.3f} ms')
+        lines.append(f'{stat_indent}rows: {self.rows_in} -> {self.rows_out}, '
+                     f'batches: {self.batches_in} -> {self.batches_out}')
+        lines.append(f'{stat_indent}peak bytes: {self.peak_bytes}')
+        for key, value in self.details.items():
+            lines.append(f'{stat_indent}{key}: {self._format_value(value)}')
+        lines.append('')
+
+        for child in self.children:
+            for line in child.str_lines_repr(indent_level + 1):
+                lines.append(line)
+
+        return tuple(lines)
+
+
+class QueryProfile(RecursiveTreePrint):
+    """
+    Result of EXPLAIN ANALYZE: the profile of every operator of the plan
+    and the totals of the query.
+
+    Parameters
+    ----------
+    root : OperatorProfile
+        Profile of the root operator of the plan.
+    wall_time : float
+        Wall time of the query, in seconds.
+    cpu_time : float
+        CPU time of the process during the query, in seconds.
+    peak_bytes : int
+        Peak memory of the query pool, or the maximum of the bytes sampled
+        at the batch boundaries of the operators if that is larger.
+    num_rows : int
+        Number of rows of the result.
+    """
+    def __init__(self,
+                 root: Optional[OperatorProfile],
+                 wall_time: float,
+                 cpu_time: float,
+                 peak_bytes: int,
+                 num_rows: int) -> None:
+        self.root = root
+        self.wall_time = wall_time
+        self.cpu_time = cpu_time
+        self.peak_bytes = peak_bytes
+        self.num_rows = num_rows
+
+    def operators(self) -> List[OperatorProfile]:
+        """
+        Profiles of all the operators, from the root down.
+        """
+        profiles = []
+        pending = [self.root] if self.root else []
+        while pending:
+            profile = pending.pop(0)
+            profiles.append(profile)
+            pending.extend(profile.children)
+        return profiles
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            'wall_time': self.wall_time,
+            'cpu_time': self.cpu_time,
+            'peak_bytes': self.peak_bytes,
+            'num_rows': self.num_rows,
+            'plan': self.root.to_dict() if self.root else None,
+        }
+
+    def str_lines_repr(self, indent_level: int) -> Tuple[str, ...]:
+        lines = [
+            f'{self._level_indent_string(indent_level)}'
+            f'Query: {self.wall_time * 1e3:.3f} ms, '
+            f'cpu: {self.cpu_time * 1e3:.3f} ms, '
+            f'rows: {self.num_rows}, '
+            f'peak bytes: {self.peak_bytes}',
+            '',
+        ]
+        if self.root:
+            lines.extend(self.root.str_lines_repr(indent_level))
+        return tuple(lines)
@@ -1,9 +1,17 @@
+import os
+
 import pyarrow.csv
 import pyarrow.json
 import pyarrow.parquet
 
+import vinum_lib
+
 from vinum.api.stream_reader import StreamReader
 from vinum.api.table import Table
+from vinum.io.parquet import ParquetSource
+
+# Extensions of the files decompressed by pyarrow.csv.open_csv.
+COMPRESSED_EXTENSIONS = ('.gz', '.bz2', '.lz4', '.zst', '.br')
 
 
 def stream_csv(input_file, read_options=None, parse_options=None,
@@ -13,10 +21,15 @@ def stream_csv(input_file, read_options=None, parse_options=None,
 
         Open a streaming reader of CSV data.
 
-        Reading using this function is always single-threaded.
+        Uncompressed files are parsed by the native reader, block by block
+        on all the cores if read_options.use_threads, ahead of the query
+        execution, and the batches are fed directly to the C++ operators.
+        The column types are inferred from the first block.
 
-        This function is a thin convenience wrapper around
-        ``pyarrow.csv.open_csv``, which returns ``StreamReader``.
+        Options the native reader does not support, such as convert_options,
+        newlines in values or escaping, as well as compressed files and
+        file-like objects, are read by ``pyarrow.csv.open_csv``,
+        single-threaded.
 
 
         Parameters
@@ -55,12 +68,109 @@ def stream_csv(input_file, read_options=None, parse_options=None,
         5   3   2183
         6   4   1016
     """
+    native_reader = _open_native_csv(input_file, read_options,
+                                     parse_options, convert_options)
+    if native_reader is not None:
+        return StreamReader(native_reader)
     return StreamReader(
         pyarrow.csv.open_csv(input_file, read_options,
                              parse_options, convert_options)
     )
 
 
+def _open_native_csv(input_file, read_options, parse_options,
+                     convert_options):
+    """
+    Open the native parallel CSV reader,
+    None if the input or the options are not supported by it.
+    """
+    if not isinstance(input_file, (str, os.PathLike)):
+        return None
+    path = os.fspath(input_file)
+    if path.lower().endswith(COMPRESSED_EXTENSIONS):
+        return None
+    if convert_options is not None:
+        return None
+
+    if read_options is None:
+        read_options = pyarrow.csv.ReadOptions()
+    if parse_options is None:
+        parse_options = pyarrow.csv.ParseOptions()
+    if (
+            parse_options.newlines_in_values
+            or parse_options.escape_char
+            or not parse_options.double_quote
+            or not parse_options.ignore_empty_lines
+    ):
+        return None
+
+    num_threads = (os.cpu_count() or 1) if read_options.use_threads else 1
+    quote_char = parse_options.quote_char
+    return vinum_lib.CsvStreamReader(
+        path,
+        read_options.block_size,
+        read_options.skip_rows,
+        list(read_options.column_names),
+        read_options.autogenerate_column_names,
+        parse_options.delimiter,
+        bool(quote_char),
+        quote_char if quote_char else '"',
+        num_threads,
+        2 * num_threads
+    )
+
+
+def stream_ipc(source):
+    """
+    stream_ipc(source)
+
+        Open a streaming reader of an Arrow IPC file (Feather v2).
+
+        The file is memory-mapped and its record batches are fed to the
+        C++ operators without copying, directly from the page cache:
+        opening the file is immediate, and the processes querying the same
+        file share its memory. Large record batches are split into
+        zero-copy morsels of ``get_batch_size()`` rows, processed on all
+        the cores.
+
+        Files written by ``pyarrow.feather.write_feather`` with the default
+        version 2 or by ``pyarrow.ipc.new_file`` are supported, Feather v1
+        files are not.
+
+
+        Parameters
+        ----------
+        source: string or path
+            The location of the Arrow IPC file.
+
+        Returns
+        -------
+        :class:`StreamReader`
+
+        Examples
+        --------
+        Run aggregation query on a Feather file:
+
+        >>> import vinum as vn
+        >>> query = 'select passenger_count pc, count(*) from t group by pc'
+        >>> vn.stream_ipc('taxi.feather').sql(query).to_pandas()
+           pc  count
+        0   0    165
+        1   5   3453
+        2   6    989
+        3   1  34808
+        4   2   7386
+        5   3   2183
+        6   4   1016
+    """
+    from vinum import get_batch_size
+    return StreamReader(
+        vinum_lib.IpcFileReader(os.fspath(source),
+                                get_batch_size(),
+                                os.cpu_count() or 1)
+    )
+
+
 def read_csv(input_file, read_options=None, parse_options=None,
              convert_options=None, memory_pool=None) -> Table:
     """
@@ -148,6 +258,47 @@ def read_json(input_file, read_options=None, parse_options=None,
     return Table(table)
 
 
+def stream_parquet(source, use_threads=True):
+    """
+    stream_parquet(source, use_threads=True)
+
+        Open a streaming reader of a Parquet file.
+
+        The columns used by the query and the comparisons of the WHERE
+        condition are pushed down to the reader: only the used columns
+        are read, and the row groups which cannot match the condition,
+        according to the min/max statistics of the file, are skipped.
+        The row groups are decoded lazily and the batches are fed
+        directly to the C++ operators.
+
+
+        Parameters
+        ----------
+        source: string or path
+            The location of the Parquet file.
+        use_threads : bool, default True
+            Decode the columns of a row group in parallel.
+
+        Returns
+        -------
+        :class:`StreamReader`
+
+        Examples
+        --------
+        Run aggregation query on a Parquet file:
+
+        >>> import vinum as vn
+        >>> query = ('select passenger_count pc, count(*) from t '
+        ...          'where passenger_count > 3 group by pc')
+        >>> vn.stream_parquet('taxi.parquet').sql(query).to_pandas()
+           pc  count
+        0   5   3453
+        1   6    989
+        2   4   1016
+    """
+    return StreamReader(ParquetSource(os.fspath(source), use_threads))
+
+
 def read_parquet(source, columns=None, use_threads=True, metadata=None,
                  use_pandas_metadata=False, memory_map=False,
                  read_dictionary=None, filesystem=None, filters=None,
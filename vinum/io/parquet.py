@@ -0,0 +1,179 @@
+import os
+from typing import Any, Iterable, List, Optional, Tuple
+
+import pyarrow as pa
+import pyarrow.parquet
+
+import vinum_lib
+
+from vinum.parser.query import Expression, SQLExpression
+from vinum.util.util import is_column, is_expression, is_literal
+
+
+# Comparison operators, and their mirrors for the literal on the left.
+COMPARE_OPS = {
+    SQLExpression.EQUALS: SQLExpression.EQUALS,
+    SQLExpression.NOT_EQUALS: SQLExpression.NOT_EQUALS,
+    SQLExpression.LESS_THAN: SQLExpression.GREATER_THAN,
+    SQLExpression.LESS_THAN_OR_EQUAL: SQLExpression.GREATER_THAN_OR_EQUAL,
+    SQLExpression.GREATER_THAN: SQLExpression.LESS_THAN,
+    SQLExpression.GREATER_THAN_OR_EQUAL: SQLExpression.LESS_THAN_OR_EQUAL,
+}
+
+
+class ParquetSource:
+    """
+    Parquet file, opened by the query planner with the projection and
+    the predicate of the query pushed down.
+
+    Only the columns used by the query are read, and the row groups
+    which cannot match the WHERE condition, according to the min/max
+    statistics of the columns, are skipped.
+
+    Parameters
+    ----------
+    path : str
+        Location of the Parquet file.
+    use_threads : bool
+        Decode the columns of a row group in parallel.
+    """
+    def __init__(self, path: str, use_threads: bool = True) -> None:
+        self._path = path
+        self._use_threads = use_threads
+        self._file = pyarrow.parquet.ParquetFile(path)
+
+    @property
+    def schema(self) -> pa.Schema:
+        return self._file.schema_arrow
+
+    def open(self,
+             column_names: Iterable[str],
+             where_condition: Optional[Expression]
+             ) -> 'vinum_lib.ParquetFileReader':
+        """
+        Open the native reader of the columns and the row groups
+        needed by the query.
+
+        Parameters
+        ----------
+        column_names : Iterable[str]
+            Columns used by the query.
+        where_condition : Optional[Expression]
+            WHERE condition of the query.
+
+        Returns
+        -------
+        vinum_lib.ParquetFileReader
+            Native stream of the batches.
+        """
+        from vinum import get_batch_size
+        num_threads = (os.cpu_count() or 1) if self._use_threads else 1
+        return vinum_lib.ParquetFileReader(
+            self._path,
+            list(column_names),
+            self.select_row_groups(where_condition),
+            get_batch_size(),
+            num_threads
+        )
+
+    def select_row_groups(self,
+                          where_condition: Optional[Expression]
+                          ) -> List[int]:
+        """
+        Return the indices of the row groups that may have rows matching
+        the WHERE condition.
+        """
+        metadata = self._file.metadata
+        conjuncts = (_comparison_conjuncts(where_condition)
+                     if where_condition else [])
+        if not conjuncts:
+            return list(range(metadata.num_row_groups))
+
+        row_groups = []
+        for row_group_idx in range(metadata.num_row_groups):
+            row_group = metadata.row_group(row_group_idx)
+            statistics = {}
+            for col_idx in range(row_group.num_columns):
+                column = row_group.column(col_idx)
+                statistics[column.path_in_schema] = column.statistics
+            if all(_may_match(statistics.get(name), op, value)
+                   for name, op, value in conjuncts):
+                row_groups.append(row_group_idx)
+        return row_groups
+
+
+def _comparison_conjuncts(
+        expr: Any
+) -> List[Tuple[str, SQLExpression, Any]]:
+    """
+    Return the comparisons of a column with a literal, (column, op, value),
+    which are the conjuncts of the expression.
+    Other conjuncts are not used to skip the row groups.
+    """
+    if not is_expression(expr) or expr.is_shared():
+        return []
+
+    sql_operator = expr.sql_operator
+    args = expr.arguments
+    if sql_operator == SQLExpression.AND:
+        return [conjunct
+                for arg in args
+                for conjunct in _comparison_conjuncts(arg)]
+    elif sql_operator in COMPARE_OPS:
+        if is_column(args[0]) and is_literal(args[1]):
+            return [(args[0].get_column_name(), sql_operator, args[1].value)]
+        elif is_literal(args[0]) and is_column(args[1]):
+            return [(args[1].get_column_name(),
+                     COMPARE_OPS[sql_operator],
+                     args[0].value)]
+    elif sql_operator == SQLExpression.BETWEEN:
+        if (
+                is_column(args[0])
+                and is_literal(args[1])
+                and is_literal(args[2])
+        ):
+            name = args[0].get_column_name()
+            return [(name, SQLExpression.GREATER_THAN_OR_EQUAL, args[1].value),
+                    (name, SQLExpression.LESS_THAN_OR_EQUAL, args[2].value)]
+    return []
+
+
+def _is_comparable(value: Any, stats_value: Any) -> bool:
+    if isinstance(value, bool) or isinstance(stats_value, bool):
+        return False
+    if isinstance(value, (int, float)):
+        return isinstance(stats_value, (int, float))
+    if isinstance(value, str):
+        return isinstance(stats_value, str)
+    return False
+
+
+def _may_match(statistics: Any, sql_operator: SQLExpression,
+               value: Any) -> bool:
+    """
+    Check if any value within the min/max statistics of a column chunk
+    may satisfy the comparison with the literal.
+    """
+    if statistics is None or not statistics.has_min_max:
+        return True
+    min_value = statistics.min
+    max_value = statistics.max
+    if (
+            not _is_comparable(value, min_value)
+            or not _is_comparable(value, max_value)
+    ):
+        return True
+
+    if sql_operator == SQLExpression.EQUALS:
+        return min_value <= value <= max_value
+    elif sql_operator == SQLExpression.NOT_EQUALS:
+        return not min_value == max_value == value
+    elif sql_operator == SQLExpression.LESS_THAN:
+        return min_value < value
+    elif sql_operator == SQLExpression.LESS_THAN_OR_EQUAL:
+        return min_value <= value
+    elif sql_operator == SQLExpression.GREATER_THAN:
+        return max_value > value
+    elif sql_operator == SQLExpression.GREATER_THAN_OR_EQUAL:
+        return max_value >= value
+    return True
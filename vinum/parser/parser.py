@@ -13,6 +13,7 @@ from vinum.parser.query import (
     SQLExpression,
     Expression,
     SortOrder,
+    WindowSpec,
 )
 from vinum.util.util import (
     append_flat,
@@ -20,6 +21,10 @@ from vinum.util.util import (
 )
 
 
+# Bit of WindowDef.frameOptions set by an explicit frame clause.
+FRAMEOPTION_NONDEFAULT = 0x00001
+
+
 class AbstractSqlParser:
     """
     Abstract SQL Parser.
@@ -210,8 +215,20 @@ class PglastParser(AbstractSqlParser):
                 if 'agg_star' in expr and name and name.lower() == 'count':
                     name = 'count_star'
                 elif 'args' in expr:
+                    if expr.get('agg_distinct'):
+                        if not name or name.lower() != 'count':
+                            raise ParserError(
+                                'DISTINCT is only supported by count().'
+                            )
+                        name = 'count_distinct'
                     for arg in expr['args']:
                         args.append(self._parse_node(arg))
+                if 'over' in expr:
+                    if name == 'count_distinct':
+                        raise ParserError(
+                            'DISTINCT is not supported by window functions.'
+                        )
+                    return self._parse_window(name, args, expr['over'])
                 return Expression(
                     SQLExpression.FUNCTION,
                     tuple(args),
@@ -221,6 +238,43 @@ class PglastParser(AbstractSqlParser):
         except (KeyError, IndexError):
             raise ParserError('Failed to parse the query.')
 
+    def _parse_sort_clause(self, sort_clause):
+        order_by = []
+        sort_order = []
+        for sort_expr in sort_clause:
+            sort_by = sort_expr['SortBy']
+            order_by.append(self._parse_node(sort_by['node']))
+            sortby_dir = SortOrder.ASC if sort_by['sortby_dir'] <= 1 else SortOrder.DESC
+            sort_order.append(sortby_dir)
+        return tuple(order_by), tuple(sort_order)
+
+    def _parse_window(self, name, args, over):
+        window_def = over['WindowDef']
+        if 'refname' in window_def or 'name' in window_def:
+            raise ParserError('Named windows are not supported.')
+        if window_def.get('frameOptions', 0) & FRAMEOPTION_NONDEFAULT:
+            raise ParserError(
+                'Window frame clauses are not supported, '
+                'only the default frame is.'
+            )
+
+        partition_by = tuple(
+            self._parse_node(expr)
+            for expr in window_def.get('partitionClause', [])
+        )
+        order_by, sort_order = self._parse_sort_clause(
+            window_def.get('orderClause', [])
+        )
+        window = WindowSpec(name.lower(),
+                            len(args),
+                            len(partition_by),
+                            sort_order)
+        return Expression(
+            SQLExpression.WINDOW,
+            tuple(args) + partition_by + order_by,
+            window=window
+        )
+
     def _create_ast(self):
         ast = self._parse()
 
@@ -256,16 +310,9 @@ class PglastParser(AbstractSqlParser):
         if 'havingClause' in ast:
             having = self._parse_node(ast['havingClause'])
 
-        order_by = []
-        sort_order = []
-        if 'sortClause' in ast:
-            for sort_expr in ast['sortClause']:
-                sort_by = sort_expr['SortBy']
-                order_by.append(self._parse_node(sort_by['node']))
-                sortby_dir = SortOrder.ASC if sort_by['sortby_dir'] <= 1 else SortOrder.DESC
-                sort_order.append(sortby_dir)
-        order_by = tuple(order_by)
-        sort_order = tuple(sort_order)
+        order_by, sort_order = self._parse_sort_clause(
+            ast.get('sortClause', [])
+        )
 
         limit = None
         offset = 0
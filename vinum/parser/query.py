@@ -6,6 +6,7 @@ from vinum.util.util import (
     find_all_columns_recursively,
     append_flat,
     is_expression,
+    traverse_exprs,
 )
 from vinum.util.tree_print import RecursiveTreePrint
 
@@ -56,6 +57,7 @@ class SQLExpression(Enum):
 
     # Functions
     FUNCTION = auto()
+    WINDOW = auto()
 
 
 class SortOrder(Enum):
@@ -228,6 +230,62 @@ class Column(HasAlias, HasColumnName, RecursiveTreePrint):
         return hash(self._name)
 
 
+class WindowSpec:
+    """
+    Window of a window function: func(args) OVER (PARTITION BY .. ORDER BY ..).
+
+    The function arguments, the PARTITION BY and the ORDER BY expressions
+    are the arguments of the WINDOW Expression, in this order, so that they
+    are bound and traversed as the arguments of any other expression.
+
+    Parameters
+    ----------
+    function_name : str
+        Name of the window function.
+    num_args : int
+        Number of the function arguments.
+    num_partition_by : int
+        Number of the PARTITION BY expressions.
+    sort_order : Tuple[SortOrder, ...]
+        Sort order of the ORDER BY expressions, ASC / DESC.
+    """
+    def __init__(self,
+                 function_name: str,
+                 num_args: int,
+                 num_partition_by: int,
+                 sort_order: Tuple['SortOrder', ...]) -> None:
+        self.function_name: str = function_name
+        self.num_args: int = num_args
+        self.num_partition_by: int = num_partition_by
+        self.sort_order: Tuple['SortOrder', ...] = sort_order
+
+    def function_args(
+            self, arguments: Tuple['QueryBaseType', ...]
+    ) -> Tuple['QueryBaseType', ...]:
+        return arguments[:self.num_args]
+
+    def partition_by(
+            self, arguments: Tuple['QueryBaseType', ...]
+    ) -> Tuple['QueryBaseType', ...]:
+        return arguments[self.num_args:self.num_args + self.num_partition_by]
+
+    def order_by(
+            self, arguments: Tuple['QueryBaseType', ...]
+    ) -> Tuple['QueryBaseType', ...]:
+        return arguments[self.num_args + self.num_partition_by:]
+
+    def __eq__(self, o: object) -> bool:
+        return (isinstance(o, WindowSpec)
+                and self.function_name == o.function_name
+                and self.num_args == o.num_args
+                and self.num_partition_by == o.num_partition_by
+                and self.sort_order == o.sort_order)
+
+    def __hash__(self):
+        return hash((self.function_name, self.num_args,
+                     self.num_partition_by, self.sort_order))
+
+
 class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
     """
     SQL Expression.
@@ -245,18 +303,22 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
         Function name, if expression is a function.
     alias : Optional[str]
         Optional alias.
+    window : Optional[WindowSpec]
+        Window, if expression is a window function.
     """
     def __init__(self,
                  sql_operator: SQLExpression,
                  arguments: Tuple['QueryBaseType', ...],
                  function_name: str = None,
                  alias: Optional[str] = None,
-                 shared_id: Optional[str] = None):
+                 shared_id: Optional[str] = None,
+                 window: Optional[WindowSpec] = None):
         self._sql_operator: SQLExpression = sql_operator
         self._arguments: Tuple['QueryBaseType', ...] = arguments
         self._function_name: Optional[str] = function_name
         self._alias: Optional[str] = alias
         self._shared_id: Optional[str] = shared_id
+        self._window: Optional[WindowSpec] = window
 
     @property
     def sql_operator(self) -> SQLExpression:
@@ -273,6 +335,10 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
     def function_name(self) -> Optional[str]:
         return self._function_name
 
+    @property
+    def window(self) -> Optional[WindowSpec]:
+        return self._window
+
     def has_alias(self) -> bool:
         return self._alias is not None
 
@@ -281,6 +347,8 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
             return self._alias
         elif self._sql_operator == SQLExpression.FUNCTION:
             return str(self._function_name)
+        elif self._sql_operator == SQLExpression.WINDOW:
+            return self._window.function_name   # type: ignore
         else:
             return None
 
@@ -332,6 +400,9 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
                          f'Expression: {self._sql_operator}')
         if self._sql_operator == SQLExpression.FUNCTION:
             operator_line = f'{operator_line}: {self.function_name}'
+        elif self._sql_operator == SQLExpression.WINDOW:
+            operator_line = (f'{operator_line}: '
+                             f'{self._window.function_name}')  # type: ignore
         if self.is_shared():
             operator_line = f'{operator_line}, IS_SHARED'
 
@@ -349,7 +420,8 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
             self._arguments,
             self._function_name,
             self._alias,
-            self._shared_id
+            self._shared_id,
+            self._window
         )
 
     def __eq__(self, o: object) -> bool:
@@ -357,7 +429,8 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
             return False
 
         if (self._sql_operator != o.sql_operator
-                or self._function_name != o.function_name):
+                or self._function_name != o.function_name
+                or self._window != o.window):
             return False
 
         for arg_one, arg_two in zip(self._arguments, o.arguments):
@@ -370,6 +443,7 @@ class Expression(HasAlias, HasColumnName, RecursiveTreePrint):
         return hash(
             (self._sql_operator,
              self._function_name,
+             self._window,
              tuple(hash(arg) for arg in self._arguments))
         )
 
@@ -523,6 +597,10 @@ class Query:
                     and expr.function_name.lower() == 'count_star'):
                 return True
 
+    def has_window_funcs(self) -> bool:
+        return any(expr.sql_operator == SQLExpression.WINDOW
+                   for expr in traverse_exprs(self.select_expressions))
+
     def __str__(self):
         str_repr = 'Query syntax tree: \n'
 
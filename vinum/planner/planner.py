@@ -1,6 +1,9 @@
 import pyarrow as pa
 
+import vinum_lib
+
 from vinum.arrow.arrow_table import ArrowTable
+from vinum.io.parquet import ParquetSource
 from vinum.parser.query import Query
 
 from typing import (
@@ -19,14 +22,17 @@ from typing import (
 )
 
 from vinum.core.aggregate import AggregateOperator, AggregateFunction
+from vinum.core.window import WindowFunction, WindowOperator
 from vinum.core.udf import (
     lookup_udf,
 )
 from vinum.core.algebra import (
     SortOperator,
     SliceOperator,
+    TopNOperator,
     ProjectOperator,
     TableReaderOperator,
+    NativeScanOperator,
     FilterOperator,
     MaterializeTableOperator,
     EmptyTableReaderOperator,
@@ -41,6 +47,7 @@ from vinum.core.functions import (
 from vinum.core.expressions import (
     EXPRESSION_FUNCTIONS,
     BINARY_EXPRESSIONS, )
+from vinum.core.predicate import compile_predicate
 from vinum.errors import PlannerError
 from vinum.core.base import (
     Operator,
@@ -51,9 +58,11 @@ from vinum.parser.query import (
     Expression,
     Column,
     HasAlias,
+    SortOrder,
 )
 from vinum.planner.binder import Binder
 from vinum.util.util import (
+    is_column,
     is_expression,
     traverse_exprs_tree,
     is_vect_expression,
@@ -246,12 +255,57 @@ class QueryPlanner:
         if not processed_shared_ids:
             processed_shared_ids = set()
 
+        # Compiled before the expressions tree is processed, as processing
+        # marks the shared expressions of the predicate as computed.
+        native_predicate = compile_predicate(
+            filter_expression,
+            processed_shared_ids
+        )
         predicate = self._process_expressions_tree(
             filter_expression,
             processed_shared_ids
         )  # type: ignore
 
-        return FilterOperator(predicate, parent_operator)
+        return FilterOperator(predicate, parent_operator, native_predicate)
+
+    def _new_native_scan_operator(
+            self,
+            source: Union[ArrowTable, 'vinum_lib.BatchSource'],
+            columns: Iterable[Column]
+    ) -> Optional[NativeScanOperator]:
+        """
+        Create the scan of the table or stream fused with the WHERE filter.
+
+        Parameters
+        ----------
+        source : Union[ArrowTable, vinum_lib.BatchSource]
+            Table or native stream to scan.
+        columns : Iterable[Column]
+            Columns of the scan, all the columns of the source if empty.
+
+        Returns
+        -------
+        Optional[NativeScanOperator]
+            Scan operator, or None if the WHERE condition
+            cannot be evaluated natively.
+        """
+        native_predicate = None
+        if self._query.where_condition:
+            native_predicate = compile_predicate(
+                self._query.where_condition,
+                set()
+            )
+            if (
+                    native_predicate is None
+                    or not native_predicate.bind(self._schema)
+            ):
+                return None
+
+        return NativeScanOperator(
+            source,
+            [c.get_column_name() for c in columns],
+            native_predicate
+        )
 
     def _process_expressions(
             self,
@@ -327,6 +381,117 @@ class QueryPlanner:
 
         return tuple(column_names)
 
+    def _new_window_operators(
+            self,
+            parent_operator: Operator,
+            processed_shared_ids: Set[str]
+    ) -> Operator:
+        """
+        Create the operators evaluating the window functions of the query.
+
+        Window functions over the same window are evaluated by a single
+        WindowOperator, on top of a SortOperator by the partition
+        and the order keys of the window. The results are columns named
+        by the shared IDs of the window expressions.
+
+        Parameters
+        ----------
+        parent_operator : Operator
+            Operator returning the rows of the query.
+        processed_shared_ids : Set[str]
+            Set of shared expression IDs, that are already processed.
+
+        Returns
+        -------
+        Operator
+            The last window operator, or the parent operator
+            if the query has no window functions.
+        """
+        def is_window(expr):
+            return expr.sql_operator == SQLExpression.WINDOW
+
+        if any(is_window(expr) for expr in traverse_exprs(
+                (self._query.where_condition, self._query.having)
+                + tuple(self._query.group_by))):
+            raise PlannerError(
+                'Window functions are not allowed in WHERE, '
+                'GROUP BY and HAVING.'
+            )
+
+        window_exprs: Dict[str, Expression] = {}
+        for expr in traverse_exprs(self._query.select_expressions
+                                   + tuple(self._query.order_by)):
+            if not is_window(expr):
+                continue
+            if not expr.is_shared():
+                expr.set_shared_id(f'{expr.window.function_name}_{id(expr)}')
+            window_exprs.setdefault(expr.get_shared_id(), expr)
+
+        if not window_exprs:
+            return parent_operator
+        if self._query.is_aggregate():
+            raise PlannerError(
+                'Window functions are not supported in aggregate queries.'
+            )
+
+        # Expression arguments and keys are projected as columns
+        # before the windows are evaluated.
+        inner_exprs: Dict[str, Expression] = {}
+        for expr in window_exprs.values():
+            args = []
+            for arg in expr.arguments:
+                if is_expression(arg):
+                    if any(is_window(inner) for inner in traverse_exprs(arg)):
+                        raise PlannerError(
+                            'Window functions can not be nested.'
+                        )
+                    if not arg.is_shared():
+                        arg.set_shared_id(str(id(arg)))
+                    inner_exprs.setdefault(arg.get_shared_id(), arg)
+                    arg = Column(arg.get_shared_id())
+                args.append(arg)
+            expr.set_arguments(tuple(args))
+
+        current_op = parent_operator
+        if inner_exprs:
+            current_op = ProjectOperator(
+                arguments=self._process_expressions(
+                    tuple(inner_exprs.values()), processed_shared_ids),
+                parent_operator=current_op,
+                keep_input_table=True
+            )
+
+        windows: Dict[Tuple, List[WindowFunction]] = {}
+        for shared_id, expr in window_exprs.items():
+            window = expr.window
+            partition_by = window.partition_by(expr.arguments)
+            order_by = window.order_by(expr.arguments)
+            if not all(is_column(key) for key in partition_by + order_by):
+                raise PlannerError(
+                    'Window PARTITION BY and ORDER BY do not support literals.'
+                )
+            func = WindowFunction(window.function_name,
+                                  window.function_args(expr.arguments),
+                                  shared_id)
+            windows.setdefault(
+                (partition_by, order_by, window.sort_order), []
+            ).append(func)
+
+        for (partition_by, order_by, sort_order), funcs in windows.items():
+            if partition_by or order_by:
+                current_op = SortOperator(
+                    partition_by + order_by,
+                    (SortOrder.ASC,) * len(partition_by) + sort_order,
+                    current_op
+                )
+            current_op = WindowOperator(partition_by,
+                                        order_by,
+                                        funcs,
+                                        current_op)
+
+        processed_shared_ids.update(window_exprs.keys())
+        return current_op
+
     def plan_query(self) -> Operator:
         """
         Create a query execution plan.
@@ -352,25 +517,49 @@ class QueryPlanner:
         if unused_columns:
             if len(unused_columns) < len(self._schema.names):
                 project_args = self._query.get_all_used_columns()
-            elif self._query.has_count_star():
+            elif (self._query.has_count_star()
+                  or self._query.has_window_funcs()):
                 project_args = [Column(self._schema.names[0])]
             else:
                 skip_table = True
 
-        if self._reader:
+        if isinstance(self._reader, ParquetSource):
+            self._reader = self._reader.open(
+                ([c.get_column_name() for c in project_args]
+                 if unused_columns and not skip_table
+                 else self._schema.names),
+                self._query.where_condition
+            )
+
+        native_scan = None
+        if self._reader is None:
+            scan_source = self._table
+        elif isinstance(self._reader, vinum_lib.BatchSource):
+            scan_source = self._reader
+        else:
+            scan_source = None
+        if scan_source is not None and not skip_table:
+            native_scan = self._new_native_scan_operator(
+                scan_source,
+                project_args if unused_columns else ()
+            )
+
+        if native_scan:
+            current_op = native_scan
+        elif self._reader:
           current_op = FileReaderOperator(self._reader)
         elif skip_table:
             current_op = EmptyTableReaderOperator()
         else:
             current_op = TableReaderOperator(self._table)
 
-        if unused_columns and not skip_table:
+        if unused_columns and not skip_table and not native_scan:
             current_op = ProjectOperator(
                 arguments=project_args,
                 parent_operator=current_op
             )
 
-        if self._query.where_condition:
+        if self._query.where_condition and not native_scan:
             current_op = self._new_filter_operator(
                 filter_expression=self._query.where_condition,
                 parent_operator=current_op,
@@ -468,6 +657,9 @@ class QueryPlanner:
                 agg_cols=agg_cols
             )
 
+        current_op = self._new_window_operators(current_op,
+                                                processed_shared_ids)
+
         if self._query.having:
             current_op = self._new_filter_operator(
                 filter_expression=self._query.having,
@@ -475,7 +667,19 @@ class QueryPlanner:
                 processed_shared_ids=processed_shared_ids
             )
 
-        if self._query.order_by:
+        # Sort followed by a limit is fused into a TopN,
+        # which keeps only offset + limit rows in memory.
+        is_top_n = bool(self._query.order_by) and self._query.has_limit()
+        if is_top_n:
+            current_op = TopNOperator(
+                self._process_expressions(self._query.order_by,
+                                          processed_shared_ids),
+                self._query.sort_order,
+                self._query.limit,  # type: ignore
+                self._query.offset,
+                current_op
+            )
+        elif self._query.order_by:
             current_op = SortOperator(
                 self._process_expressions(self._query.order_by,
                                           processed_shared_ids),
@@ -493,7 +697,7 @@ class QueryPlanner:
             col_names=self._column_names(self._query.select_expressions)
         )
 
-        if self._query.has_limit():
+        if self._query.has_limit() and not is_top_n:
             current_op = SliceOperator(
                 self._query.limit,  # type: ignore
                 self._query.offset,
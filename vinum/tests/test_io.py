@@ -1,6 +1,14 @@
 import pytest
 
-from vinum import read_csv, stream_csv, read_parquet
+import pyarrow.csv
+import pyarrow.feather
+import pyarrow.parquet
+
+from vinum import (
+    read_csv, stream_csv, stream_ipc, stream_parquet, read_parquet
+)
+from vinum.io.parquet import ParquetSource
+from vinum.parser.query import Column, Expression, Literal, SQLExpression
 from vinum.tests.conftest import csv_datafile, _assert_tables_equal
 
 QUERIES = [
@@ -81,8 +89,106 @@ class TestQueryResults:
         actual_tbl = stream_csv(csv_datafile).sql(query)
         _assert_tables_equal(actual_tbl, expected_result)
 
+    def test_open_csv_blocks(self, tmp_path):
+        # Small blocks, cut inside of the lines and parsed in parallel.
+        csv_file = tmp_path / 'blocks.csv'
+        lines = ['key,value,name']
+        lines += [f'{idx % 7},{idx * 0.5},name_{idx}' for idx in range(3000)]
+        csv_file.write_text('\n'.join(lines))
+
+        read_options = pyarrow.csv.ReadOptions(block_size=1 << 10)
+        actual_tbl = stream_csv(str(csv_file), read_options=read_options).sql(
+            'select key, count(*), sum(value), max(name) '
+            'from t where value > 10 group by key order by key'
+        )
+        expected_result = {
+            'key': tuple(range(7)),
+            'count_star': tuple(
+                sum(1 for idx in range(21, 3000) if idx % 7 == key)
+                for key in range(7)
+            ),
+            'sum': tuple(
+                sum(idx * 0.5 for idx in range(21, 3000) if idx % 7 == key)
+                for key in range(7)
+            ),
+            'max': tuple(
+                max(f'name_{idx}' for idx in range(21, 3000) if idx % 7 == key)
+                for key in range(7)
+            ),
+        }
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    def test_open_csv_header_block(self, tmp_path):
+        # The first block holds the header only, the column types
+        # are inferred from the next one.
+        value_col = 'v' * 59
+        csv_file = tmp_path / 'header_block.csv'
+        lines = [f'key,{value_col}']
+        lines += [f'{idx % 3},{idx}' for idx in range(100)]
+        csv_file.write_text('\n'.join(lines))
+        assert len(lines[0]) + 1 == 64
+
+        read_options = pyarrow.csv.ReadOptions(block_size=64)
+        actual_tbl = stream_csv(str(csv_file), read_options=read_options).sql(
+            f'select key, sum({value_col}) as total from t '
+            'group by key order by key'
+        )
+        _assert_tables_equal(actual_tbl, {
+            'key': (0, 1, 2),
+            'total': tuple(sum(range(key, 100, 3)) for key in range(3)),
+        })
+
     @pytest.mark.parametrize("query, expected_result", QUERIES)
     def test_read_parquet(self, query, expected_result, parquet_datafile):
         actual_tbl = read_parquet(parquet_datafile).sql(query)
         _assert_tables_equal(actual_tbl, expected_result)
 
+    @pytest.mark.parametrize("query, expected_result", QUERIES)
+    def test_stream_parquet(self, query, expected_result, parquet_datafile):
+        actual_tbl = stream_parquet(parquet_datafile).sql(query)
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    def test_stream_parquet_row_groups(self, tmp_path):
+        parquet_file = str(tmp_path / 'row_groups.parquet')
+        pyarrow.parquet.write_table(
+            pyarrow.table({'key': list(range(3000)),
+                           'name': [f'name_{idx}' for idx in range(3000)]}),
+            parquet_file,
+            row_group_size=500
+        )
+
+        where_condition = Expression(SQLExpression.AND, (
+            Expression(SQLExpression.LESS_THAN,
+                       (Literal(1200), Column('key'))),
+            Expression(SQLExpression.BETWEEN,
+                       (Column('key'), Literal(0), Literal(2100))),
+        ))
+        row_groups = ParquetSource(parquet_file).select_row_groups(
+            where_condition
+        )
+        assert row_groups == [2, 3, 4]
+
+        actual_tbl = stream_parquet(parquet_file).sql(
+            'select count(*), min(name), max(key) from t '
+            'where 1200 < key and key between 0 and 2100'
+        )
+        expected_result = {
+            'count_star': (900,),
+            'min': ('name_1201',),
+            'max': (2100,),
+        }
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    @pytest.mark.parametrize("query, expected_result", QUERIES)
+    def test_stream_ipc(self, query, expected_result,
+                        parquet_datafile, tmp_path):
+        # Small record batches, mapped from the file and read in parallel.
+        ipc_file = tmp_path / 'taxi.feather'
+        pyarrow.feather.write_feather(
+            pyarrow.parquet.read_table(parquet_datafile),
+            str(ipc_file),
+            compression='uncompressed',
+            chunksize=1000
+        )
+        actual_tbl = stream_ipc(ipc_file).sql(query)
+        _assert_tables_equal(actual_tbl, expected_result)
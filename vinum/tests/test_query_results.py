@@ -4,7 +4,10 @@ import pytest
 
 import numpy as np
 
+import vinum
+from vinum.core.algebra import SortOperator
 from vinum.core.udf import register_python, register_numpy
+from vinum.errors import FunctionError
 from vinum.tests.conftest import (
     create_test_data,
     create_null_test_data,
@@ -621,6 +624,25 @@ groupby_queries = (
          'sum': (40.03, 13.68),
      }),
 
+    (test_groupby_table,
+     ('select city_from, count(distinct city_to) as cities, '
+      'count(distinct total) as totals, count(distinct name) as names, '
+      'count(*) from t group by city_from order by city_from'),
+     {
+         'city_from': ('Berlin', 'Munich', 'Riva', 'San Francisco'),
+         'cities': (2, 1, 1, 1),
+         'totals': (2, 2, 1, 1),
+         'names': (2, 1, 1, 1),
+         'count_star': (4, 2, 1, 1),
+     }),
+
+    (test_groupby_table,
+     'select count(distinct vendor_id), count(vendor_id) from t',
+     {
+         'count_distinct': (3,),
+         'count': (8,),
+     }),
+
 )
 
 
@@ -1384,6 +1406,92 @@ null_data = (
 
 )
 
+topn_queries = (
+    (test_groupby_table,
+     'select id, total from t order by total desc limit 3',
+     {
+         'id': (2, 4, 3),
+         'total': (143.15, 53.1, 33.40),
+     }),
+
+    (test_groupby_table,
+     'select id from t order by total limit 4 offset 1',
+     {
+         'id': (8, 6, 3, 5),
+     }),
+
+    (test_groupby_table,
+     'select id from t order by total, id desc limit 3',
+     {
+         'id': (8, 1, 6),
+     }),
+
+    (test_groupby_table,
+     'select id from t order by total desc limit 20 offset 6',
+     {
+         'id': (1, 8),
+     }),
+
+    (test_table_null,
+     "select id from t order by name desc, to_float(is_vendor) desc, np.log(lng) desc limit 3",
+     {
+         'id': (3, 4, 7)
+     }),
+
+)
+
+
+window_queries = (
+    (test_groupby_table,
+     'select id, row_number() over (partition by vendor_id order by id) as rn, '
+     'sum(total) over (partition by vendor_id order by id) as running '
+     'from t order by id',
+     {
+         'id': (1, 2, 3, 4, 5, 6, 7, 8),
+         'rn': (1, 1, 2, 1, 3, 2, 4, 5),
+         'running': (2.43, 143.15, 35.83, 53.1, 69.23, 156.3, 102.63, 105.06),
+     }),
+
+    (test_groupby_table,
+     'select id, '
+     'rank() over (partition by city_from order by total desc) as rnk, '
+     'dense_rank() over (partition by city_from order by total desc) as drnk, '
+     'lag(total) over (partition by city_from order by id) as prev '
+     'from t order by id',
+     {
+         'id': (1, 2, 3, 4, 5, 6, 7, 8),
+         'rnk': (3, 1, 1, 1, 1, 2, 1, 3),
+         'drnk': (2, 1, 1, 1, 1, 2, 1, 2),
+         'prev': (np.nan, np.nan, np.nan, np.nan, 2.43, 143.15, 33.4, 33.4),
+     }),
+
+    (test_groupby_table,
+     'select id, lead(total, 2) over (order by id) as next_total, '
+     'count(*) over (partition by vendor_id) as cnt from t order by id',
+     {
+         'id': (1, 2, 3, 4, 5, 6, 7, 8),
+         'next_total': (33.4, 53.1, 33.4, 13.15, 33.4, 2.43, np.nan, np.nan),
+         'cnt': (5, 2, 5, 1, 5, 2, 5, 5),
+     }),
+
+    (test_groupby_table,
+     'select id, sum(tip) over (partition by vendor_id % 2) as tips '
+     'from t order by id',
+     {
+         'id': (1, 2, 3, 4, 5, 6, 7, 8),
+         'tips': (39.7, 9.68, 39.7, 39.7, 39.7, 9.68, 39.7, 39.7),
+     }),
+
+    (test_groupby_table,
+     'select id, avg(total) over () as avg_total from t '
+     'where vendor_id = 2 order by id',
+     {
+         'id': (2, 6),
+         'avg_total': (78.15, 78.15),
+     }),
+
+)
+
 
 class TestQueryResults:
 
@@ -1391,17 +1499,207 @@ class TestQueryResults:
                              (queries
                               + groupby_queries
                               + orderby_queries
+                              + topn_queries
                               + datetime_queries_scalar
                               + datetime_queries_column
                               + built_in_functions
                               + math_functions
                               + null_data
+                              + window_queries
                               )
                              )
     def test_queries(self, source_tbl, query, expected_result):
         actual_tbl = source_tbl.sql(query)
         _assert_tables_equal(actual_tbl, expected_result)
 
+    @pytest.mark.parametrize("source_tbl, query, expected_result",
+                             tuple(q for q in groupby_queries
+                                   if 'order by' in q[1].lower())
+                             )
+    def test_parallel_groupby(self, source_tbl, query, expected_result):
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        vinum.set_num_threads(4)
+        try:
+            actual_tbl = source_tbl.sql(query)
+        finally:
+            vinum.set_num_threads(1)
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    @pytest.mark.parametrize("source_tbl, query, expected_result",
+                             tuple(q for q in groupby_queries
+                                   if 'order by' in q[1].lower())
+                             )
+    def test_spilling_groupby(self, source_tbl, query, expected_result,
+                              tmp_path):
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        vinum.set_memory_limit(1)
+        vinum.set_spill_dir(str(tmp_path))
+        try:
+            actual_tbl = source_tbl.sql(query)
+        finally:
+            vinum.set_memory_limit(None)
+            vinum.set_spill_dir(None)
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, expected_result)
+        assert not list(tmp_path.iterdir())
+
+    @pytest.mark.parametrize("source_tbl, query, expected_result",
+                             orderby_queries)
+    def test_parallel_sort(self, source_tbl, query, expected_result,
+                           monkeypatch):
+        monkeypatch.setattr(SortOperator, 'PARALLEL_MIN_RUN_ROWS', 1)
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        vinum.set_num_threads(4)
+        try:
+            actual_tbl = source_tbl.sql(query)
+        finally:
+            vinum.set_num_threads(1)
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    @pytest.mark.parametrize("source_tbl, query, expected_result",
+                             topn_queries)
+    def test_top_n_batches(self, source_tbl, query, expected_result):
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        try:
+            actual_tbl = source_tbl.sql(query)
+        finally:
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    @pytest.mark.parametrize("source_tbl, query, expected_result",
+                             orderby_queries)
+    def test_external_sort(self, source_tbl, query, expected_result,
+                           tmp_path):
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(3)
+        vinum.set_memory_limit(1)
+        vinum.set_spill_dir(str(tmp_path))
+        try:
+            actual_tbl = source_tbl.sql(query)
+        finally:
+            vinum.set_memory_limit(None)
+            vinum.set_spill_dir(None)
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, expected_result)
+        assert not list(tmp_path.iterdir())
+
+    @pytest.mark.parametrize("num_threads", (1, 4))
+    def test_dictionary_groupby(self, num_threads):
+        arrow_tbl = test_groupby_table.to_arrow()
+        col_idx = arrow_tbl.schema.get_field_index('city_from')
+        dict_tbl = vinum.Table.from_arrow(arrow_tbl.set_column(
+            col_idx,
+            'city_from',
+            arrow_tbl.column(col_idx).dictionary_encode()
+        ))
+        query = ('select city_from, count(*), sum(tax) from t '
+                 'group by city_from order by city_from')
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(3)
+        vinum.set_num_threads(num_threads)
+        try:
+            actual_tbl = dict_tbl.sql(query)
+        finally:
+            vinum.set_num_threads(1)
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, {
+            'city_from': ('Berlin', 'Munich', 'Riva', 'San Francisco'),
+            'count_star': (4, 2, 1, 1),
+            'sum': (4.04, 4.0, 1.59, 1.69),
+        })
+
+    @pytest.mark.parametrize("num_threads", (1, 4))
+    def test_approx_aggregates(self, num_threads):
+        query = ('select city_from, approx_count_distinct(city_to) as dist, '
+                 'approx_percentile(total, 0) as p0, '
+                 'approx_percentile(total, 0.5) as p50, '
+                 'approx_percentile(total, 1) as p100 from t '
+                 'group by city_from order by city_from')
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        vinum.set_num_threads(num_threads)
+        try:
+            actual_tbl = test_groupby_table.sql(query)
+        finally:
+            vinum.set_num_threads(1)
+            vinum.set_batch_size(batch_size)
+        # Digests of a few values keep every value as a centroid,
+        # the median is interpolated between them.
+        _assert_tables_equal(actual_tbl, {
+            'city_from': ('Berlin', 'Munich', 'Riva', 'San Francisco'),
+            'dist': (2, 1, 1, 1),
+            'p0': (2.43, 13.15, 33.4, 53.1),
+            'p50': (17.915, 78.15, 33.4, 53.1),
+            'p100': (33.4, 143.15, 33.4, 53.1),
+        })
+
+    def test_approx_aggregates_nan(self):
+        tbl = vinum.Table.from_pydict({
+            'key': [0, 0, 0, 0, 0, 1, 1],
+            'val': [1.0, np.nan, 3.0, 0.0, -0.0, np.nan, np.nan],
+        })
+        query = ('select key, approx_count_distinct(val) as dist, '
+                 'approx_percentile(val, 0) as p0, '
+                 'approx_percentile(val, 1) as p100 from t '
+                 'group by key order by key')
+        # NaNs are a single distinct value and are skipped by the
+        # percentiles, a group of NaNs only has no percentile.
+        _assert_tables_equal(tbl.sql(query), {
+            'key': (0, 1),
+            'dist': (4, 1),
+            'p0': (0.0, np.nan),
+            'p100': (3.0, np.nan),
+        })
+
+    @pytest.mark.parametrize("query", (
+            "select approx_percentile(total) from t",
+            "select approx_percentile(total, 1.5) from t",
+            "select approx_percentile(total, 'a') from t",
+    ))
+    def test_approx_percentile_bad_param(self, query):
+        with pytest.raises(Exception):
+            test_groupby_table.sql(query)
+
+    @pytest.mark.parametrize("query", (
+            "select sum(total, total) from t",
+            "select min(total, 1) from t group by city_from",
+    ))
+    def test_agg_func_extra_args(self, query):
+        with pytest.raises(FunctionError):
+            test_groupby_table.sql(query)
+
+    @pytest.mark.parametrize("source_tbl, query, expected_result",
+                             window_queries)
+    @pytest.mark.parametrize("num_threads", (1, 4))
+    def test_window_batches(self, source_tbl, query, expected_result,
+                            num_threads):
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        vinum.set_num_threads(num_threads)
+        try:
+            actual_tbl = source_tbl.sql(query)
+        finally:
+            vinum.set_num_threads(1)
+            vinum.set_batch_size(batch_size)
+        _assert_tables_equal(actual_tbl, expected_result)
+
+    @pytest.mark.parametrize("query", (
+            "select sum(total) over (order by id rows between 1 preceding "
+            "and current row) from t",
+            "select id from t where row_number() over (order by id) > 1",
+            "select vendor_id, row_number() over () from t group by vendor_id",
+            "select ntile(2) over (order by id) from t",
+    ))
+    def test_unsupported_windows(self, query):
+        with pytest.raises(Exception):
+            test_groupby_table.sql(query)
+
     @pytest.mark.parametrize(
         "source_tbl, udf_name, udf, is_python_udf, query, expected_result",
         (
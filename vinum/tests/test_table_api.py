@@ -1,8 +1,12 @@
+import random
+
 import pytest
 
 import pyarrow as pa
 import pandas as pd
 
+import vinum
+
 from vinum import Table
 from vinum.tests.conftest import _assert_tables_equal
 
@@ -54,6 +58,137 @@ class TestTableAPI:
             print_query_tree=True)
         assert query_plan
 
+    def test_explain_analyze(self):
+        tbl = Table.from_pydict({'key': [i % 5 for i in range(100)],
+                                 'val': list(range(100))})
+        profile = tbl.explain_analyze('select key, sum(val) from t '
+                                      'group by key order by key')
+        assert profile.num_rows == 5
+        assert profile.root.rows_out == 5
+
+        operators = {op.name: op for op in profile.operators()}
+        agg = operators['AggregateOperator']
+        assert agg.rows_in == 100
+        assert agg.rows_out == 5
+        assert agg.details['groups'] == 5
+        assert agg.details['hash_table_capacity'] >= 5
+        assert 0 < agg.details['load_factor'] <= 1
+        assert operators['SortOperator'].rows_in == 5
+        assert all(op.wall_time >= op.self_wall_time >= 0
+                   for op in profile.operators())
+
+        profile_str = str(profile)
+        assert 'Operator: AggregateOperator' in profile_str
+        assert 'load_factor' in profile_str
+        plan = profile.to_dict()['plan']
+        assert plan['name'] == 'MaterializeTableOperator'
+        assert plan['children']
+
+    def test_query_memory_limit(self):
+        tbl = Table.from_pydict({'key': [f'key_{i}' for i in range(1000)],
+                                 'val': list(range(1000))})
+        query = 'select key, sum(val) from t group by key'
+        vinum.set_query_memory_limit(1)
+        try:
+            with pytest.raises(MemoryError):
+                tbl.sql_pd(query)
+        finally:
+            vinum.set_query_memory_limit(None)
+
+        assert len(tbl.sql_pd(query)) == 1000
+        assert tbl.explain_analyze(query).peak_bytes > 0
+
+    def test_sort_sliced_table_memory_limit(self):
+        num_rows = 1 << 17
+        tbl = Table.from_pydict({'key': list(range(num_rows, 0, -1)),
+                                 'val': [float(i) for i in range(num_rows)]})
+        table_bytes = tbl.to_arrow().nbytes
+        # The scan feeds the sort zero-copy slices of the single chunk,
+        # they are accounted with their rows, not with the whole chunk.
+        vinum.set_query_memory_limit(8 * table_bytes)
+        try:
+            result = tbl.sql_pd('select key, val from t order by key')
+        finally:
+            vinum.set_query_memory_limit(None)
+        assert len(result) == num_rows
+        assert result['key'].is_monotonic_increasing
+
+    def test_adaptive_batch_size(self):
+        num_rows = 1 << 15
+        tbl = Table.from_pydict({'key': [i % 1000 for i in range(num_rows)],
+                                 'val': ['x' * 200] * num_rows})
+        profile = tbl.explain_analyze('select key, count(val) from t '
+                                      'group by key')
+        assert profile.num_rows == 1000
+        operators = {op.name: op for op in profile.operators()}
+        scan = operators['NativeScanOperator']
+        assert scan.details['row_width'] > 200
+        assert scan.details['batch_size'] < vinum.get_batch_size()
+        agg = operators['AggregateOperator']
+        assert agg.details['estimated_groups'] >= 1000
+
+        vinum.set_adaptive_batch_size(False)
+        try:
+            scan = tbl.explain_analyze('select key from t').operators()[-1]
+            assert scan.details['batch_size'] == vinum.get_batch_size()
+            assert 'row_width' not in scan.details
+        finally:
+            vinum.set_adaptive_batch_size(True)
+
+    def test_filtered_estimated_groups(self):
+        ids = list(range(1 << 17))
+        random.Random(42).shuffle(ids)
+        tbl = Table.from_pydict({'id': ids})
+        profile = tbl.explain_analyze('select id, count(*) from t '
+                                      'where id < 40000 group by id')
+        assert profile.num_rows == 40000
+        agg = {op.name: op for op in profile.operators()}['AggregateOperator']
+        assert abs(agg.details['estimated_groups'] - 40000) < 4000
+
+    def test_query_cache(self):
+        tbl = Table.from_pydict({'key': [i % 5 for i in range(100)],
+                                 'val': list(range(100))})
+        query = 'select key, sum(val) from t group by key order by key'
+        vinum.set_query_cache_size(1 << 20)
+        try:
+            expected = tbl.sql(query).to_arrow().to_pydict()
+            result = tbl.sql('select key,  sum(val)\n from t '
+                             'group by key order by key;')
+            _assert_tables_equal(result, expected)
+            info = vinum.query_cache_info()
+            assert (info.hits, info.misses, info.entries) == (1, 1, 1)
+            assert 0 < info.bytes <= info.max_bytes
+
+            other_tbl = Table.from_pydict({'key': [1], 'val': [1]})
+            assert len(other_tbl.sql_pd(query)) == 1
+            assert vinum.query_cache_info().misses == 2
+
+            del other_tbl
+            assert vinum.query_cache_info().entries == 1
+
+            vinum.set_query_cache_size(1)
+            assert vinum.query_cache_info().entries == 0
+        finally:
+            vinum.set_query_cache_size(None)
+
+    @pytest.mark.parametrize("query", (
+            "select now() as ts from t",
+            "select key, datetime('now') as ts from t",
+            "select key, np.random.rand() from t",
+            "select udf_cache_square(val) from t",
+    ))
+    def test_query_cache_non_deterministic(self, query):
+        tbl = Table.from_pydict({'key': [1, 2, 3], 'val': [1, 2, 3]})
+        vinum.register_python('udf_cache_square', lambda x: x * x)
+        vinum.set_query_cache_size(1 << 20)
+        try:
+            for _ in range(2):
+                assert len(tbl.sql_pd(query)) == 3
+            info = vinum.query_cache_info()
+            assert (info.hits, info.entries) == (0, 0)
+        finally:
+            vinum.set_query_cache_size(None)
+
     @pytest.mark.parametrize("input, query, expected_result", TEST_DATA_1)
     def test_head(self, input, query, expected_result):
         query_plan = Table.from_pydict(input).head(1)
@@ -63,3 +198,53 @@ class TestTableAPI:
     def test_schema(self, input, query, expected_result):
         schema = Table.from_pydict(input).schema
         assert isinstance(schema, pa.Schema)
+
+    @pytest.mark.parametrize("how, expected_result", (
+        ('inner', {
+            'id': [1, 1, 3],
+            'amount': [10, 20, 30],
+            'name': ['a', 'a', 'c'],
+        }),
+        ('left', {
+            'id': [1, 1, 3, 4, None],
+            'amount': [10, 20, 30, 40, 50],
+            'name': ['a', 'a', 'c', None, None],
+        }),
+    ))
+    def test_join(self, how, expected_result):
+        batch_size = vinum.get_batch_size()
+        vinum.set_batch_size(2)
+        try:
+            orders = Table.from_pydict({'id': [1, 1, 3, 4, None],
+                                        'amount': [10, 20, 30, 40, 50]})
+            users = Table.from_pydict({'id': [1, 2, 3, None],
+                                       'name': ['a', 'b', 'c', 'd']})
+            result = orders.join(users, on='id', how=how)
+            assert result.to_arrow().to_pydict() == expected_result
+        finally:
+            vinum.set_batch_size(batch_size)
+
+    def test_join_multiple_keys(self):
+        left = Table.from_pydict({'k1': ['x', 'x', 'y'],
+                                  'k2': [1, 2, 1],
+                                  'val': [1.5, 2.5, 3.5]})
+        right = Table.from_pydict({'key1': ['x', 'y', 'y'],
+                                   'key2': [2, 1, 1],
+                                   'val': [10, 20, 30]})
+        result = left.join(right, on=['k1', 'k2'], right_on=['key1', 'key2'])
+        assert result.to_arrow().to_pydict() == {
+            'k1': ['x', 'y', 'y'],
+            'k2': [2, 1, 1],
+            'val': [2.5, 3.5, 3.5],
+            'key1': ['x', 'y', 'y'],
+            'key2': [2, 1, 1],
+            'val_right': [10, 20, 30],
+        }
+
+    def test_join_invalid(self):
+        left = Table.from_pydict({'id': [1, 2]})
+        right = Table.from_pydict({'id': ['1', '2']})
+        with pytest.raises(Exception):
+            left.join(right, on='id')
+        with pytest.raises(Exception):
+            left.join(right, on='id', how='outer')
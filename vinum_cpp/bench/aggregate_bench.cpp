@@ -0,0 +1,119 @@
+#include "bench_data.h"
+
+#include "operators/aggregate/generic_hash_aggregate.h"
+#include "operators/aggregate/multi_numerical_hash_aggregate.h"
+#include "operators/aggregate/one_group_aggregate.h"
+#include "operators/aggregate/single_numerical_hash_aggregate.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using vinum::operators::aggregate::AggFuncDef;
+using vinum::operators::aggregate::AggFuncType;
+using vinum::operators::aggregate::GenericHashAggregate;
+using vinum::operators::aggregate::MultiNumericalHashAggregate;
+using vinum::operators::aggregate::OneGroupAggregate;
+using vinum::operators::aggregate::SingleNumericalHashAggregate;
+using vinum::bench::Batches;
+
+constexpr int64_t NUM_ROWS = 1 << 20;
+
+std::vector<AggFuncDef> bench_agg_funcs() {
+    return {
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+            AggFuncDef{AggFuncType::MIN, "int_val", "min_int"},
+            AggFuncDef{AggFuncType::MAX, "double_val", "max_double"},
+            AggFuncDef{AggFuncType::AVG, "double_val", "avg_double"},
+    };
+}
+
+// Arguments of the hash aggregates: number of distinct keys, percentage of NULL values.
+void hash_agg_args(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"keys", "null_pct"});
+    for (int64_t num_keys : {16, 1 << 10, 1 << 16, 1 << 20}) {
+        for (int64_t null_pct : {0, 10}) {
+            bench->Args({num_keys, null_pct});
+        }
+    }
+}
+
+template<typename MAKE_AGG>
+void run_aggregate(benchmark::State& state, const Batches& batches, MAKE_AGG make_agg) {
+    int64_t num_groups = 0;
+    for (auto _ : state) {
+        auto agg = make_agg();
+        for (const auto& batch : batches) {
+            agg->Next(batch);
+        }
+        auto result = agg->Result();
+        num_groups = result->num_rows();
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * vinum::bench::num_rows_of(batches));
+    state.counters["groups"] = static_cast<double>(num_groups);
+}
+
+void BM_OneGroupAggregate(benchmark::State& state) {
+    const auto& batches = vinum::bench::bench_batches(
+            NUM_ROWS, 1, state.range(0) / 100.0, arrow::Type::INT64);
+    run_aggregate(state, batches, []() {
+        return std::make_unique<OneGroupAggregate>(bench_agg_funcs());
+    });
+}
+BENCHMARK(BM_OneGroupAggregate)->ArgName("null_pct")->Arg(0)->Arg(10)->Arg(50)
+        ->Unit(benchmark::kMillisecond);
+
+template<arrow::Type::type KEY_TYPE>
+void BM_SingleNumericalHashAggregate(benchmark::State& state) {
+    const auto& batches = vinum::bench::bench_batches(
+            NUM_ROWS, state.range(0), state.range(1) / 100.0, KEY_TYPE);
+    run_aggregate(state, batches, []() {
+        return std::make_unique<SingleNumericalHashAggregate>(
+                std::vector<std::string>{"key"}, std::vector<std::string>{"key"}, bench_agg_funcs());
+    });
+}
+BENCHMARK_TEMPLATE(BM_SingleNumericalHashAggregate, arrow::Type::INT64)->Apply(hash_agg_args)
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_SingleNumericalHashAggregate, arrow::Type::DOUBLE)->Apply(hash_agg_args)
+        ->Unit(benchmark::kMillisecond);
+
+template<arrow::Type::type KEY_TYPE>
+void BM_MultiNumericalHashAggregate(benchmark::State& state) {
+    const auto& batches = vinum::bench::bench_batches(
+            NUM_ROWS, state.range(0), state.range(1) / 100.0, KEY_TYPE);
+    run_aggregate(state, batches, []() {
+        return std::make_unique<MultiNumericalHashAggregate>(
+                std::vector<std::string>{"key", "second_key"},
+                std::vector<std::string>{"key", "second_key"},
+                bench_agg_funcs());
+    });
+}
+BENCHMARK_TEMPLATE(BM_MultiNumericalHashAggregate, arrow::Type::INT64)->Apply(hash_agg_args)
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiNumericalHashAggregate, arrow::Type::DOUBLE)->Apply(hash_agg_args)
+        ->Unit(benchmark::kMillisecond);
+
+template<arrow::Type::type KEY_TYPE>
+void BM_GenericHashAggregate(benchmark::State& state) {
+    const auto& batches = vinum::bench::bench_batches(
+            NUM_ROWS, state.range(0), state.range(1) / 100.0, KEY_TYPE);
+    run_aggregate(state, batches, []() {
+        return std::make_unique<GenericHashAggregate>(
+                std::vector<std::string>{"key", "second_key"},
+                std::vector<std::string>{"key", "second_key"},
+                bench_agg_funcs());
+    });
+}
+BENCHMARK_TEMPLATE(BM_GenericHashAggregate, arrow::Type::INT64)->Apply(hash_agg_args)
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GenericHashAggregate, arrow::Type::STRING)->Apply(hash_agg_args)
+        ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/util.h"
+
+#include <arrow/api.h>
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+namespace vinum::bench {
+
+// Same as the default batch size of vinum.
+constexpr int64_t BATCH_SIZE = 10000;
+
+using Batches = std::vector<std::shared_ptr<arrow::RecordBatch>>;
+
+/**
+ * Synthetic table of num_rows rows, the keys are drawn uniformly from num_keys distinct values.
+ *
+ * Columns:
+ *  key:        the key, of key_type: INT64, DOUBLE or STRING
+ *  second_key: int64, key % 13, the second key of the multi column aggregates
+ *  int_val:    int32 in [-1000, 1000]
+ *  double_val: double in [0, 100)
+ * Every value of key, int_val and double_val is NULL with the probability null_fraction.
+ * The generator is seeded, the same arguments always produce the same table.
+ */
+inline std::shared_ptr<arrow::Table> create_bench_table(int64_t num_rows,
+                                                        int64_t num_keys,
+                                                        double null_fraction,
+                                                        arrow::Type::type key_type) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> key_dist(0, num_keys - 1);
+    std::uniform_int_distribution<int32_t> int_dist(-1000, 1000);
+    std::uniform_real_distribution<double> double_dist(0, 100);
+    std::bernoulli_distribution null_dist(null_fraction);
+
+    arrow::Int64Builder int_key_builder;
+    arrow::DoubleBuilder double_key_builder;
+    arrow::StringBuilder str_key_builder;
+    arrow::Int64Builder second_key_builder;
+    arrow::Int32Builder int_builder;
+    arrow::DoubleBuilder double_builder;
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        const auto key = key_dist(gen);
+        const bool is_null_key = null_dist(gen);
+        switch (key_type) {
+            case arrow::Type::INT64:
+                RAISE_ON_ARROW_FAILURE(is_null_key ? int_key_builder.AppendNull() : int_key_builder.Append(key));
+                break;
+            case arrow::Type::DOUBLE:
+                RAISE_ON_ARROW_FAILURE(
+                        is_null_key ? double_key_builder.AppendNull() : double_key_builder.Append(key * 0.5));
+                break;
+            case arrow::Type::STRING:
+                RAISE_ON_ARROW_FAILURE(
+                        is_null_key ? str_key_builder.AppendNull()
+                                    : str_key_builder.Append("key_" + std::to_string(key)));
+                break;
+            default:
+                throw std::runtime_error("Unsupported key type of the bench table.");
+        }
+        RAISE_ON_ARROW_FAILURE(second_key_builder.Append(key % 13));
+
+        if (null_dist(gen)) {
+            RAISE_ON_ARROW_FAILURE(int_builder.AppendNull());
+            RAISE_ON_ARROW_FAILURE(double_builder.AppendNull());
+        } else {
+            RAISE_ON_ARROW_FAILURE(int_builder.Append(int_dist(gen)));
+            RAISE_ON_ARROW_FAILURE(double_builder.Append(double_dist(gen)));
+        }
+    }
+
+    std::shared_ptr<arrow::Array> keys, second_keys, ints, doubles;
+    switch (key_type) {
+        case arrow::Type::INT64:
+            RAISE_ON_ARROW_FAILURE(int_key_builder.Finish(&keys));
+            break;
+        case arrow::Type::DOUBLE:
+            RAISE_ON_ARROW_FAILURE(double_key_builder.Finish(&keys));
+            break;
+        default:
+            RAISE_ON_ARROW_FAILURE(str_key_builder.Finish(&keys));
+    }
+    RAISE_ON_ARROW_FAILURE(second_key_builder.Finish(&second_keys));
+    RAISE_ON_ARROW_FAILURE(int_builder.Finish(&ints));
+    RAISE_ON_ARROW_FAILURE(double_builder.Finish(&doubles));
+
+    auto schema = arrow::schema({
+            arrow::field("key", keys->type()),
+            arrow::field("second_key", arrow::int64()),
+            arrow::field("int_val", arrow::int32()),
+            arrow::field("double_val", arrow::float64()),
+    });
+    return arrow::Table::Make(schema, {keys, second_keys, ints, doubles});
+}
+
+// Batches of BATCH_SIZE rows of the bench table, generated once per set of arguments.
+inline const Batches& bench_batches(int64_t num_rows,
+                                    int64_t num_keys,
+                                    double null_fraction,
+                                    arrow::Type::type key_type) {
+    static std::map<std::tuple<int64_t, int64_t, double, arrow::Type::type>, Batches> cache;
+    const auto cache_key = std::make_tuple(num_rows, num_keys, null_fraction, key_type);
+    auto it = cache.find(cache_key);
+    if (it == cache.end()) {
+        auto table = create_bench_table(num_rows, num_keys, null_fraction, key_type);
+        Batches batches;
+        arrow::TableBatchReader reader(*table);
+        reader.set_chunksize(BATCH_SIZE);
+        RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+        it = cache.emplace(cache_key, std::move(batches)).first;
+    }
+    return it->second;
+}
+
+inline int64_t num_rows_of(const Batches& batches) {
+    int64_t num_rows = 0;
+    for (const auto& batch : batches) {
+        num_rows += batch->num_rows();
+    }
+    return num_rows;
+}
+
+}  // namespace vinum::bench
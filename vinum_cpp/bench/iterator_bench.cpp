@@ -0,0 +1,99 @@
+#include "bench_data.h"
+
+#include "common/array_iterators.h"
+
+#include <arrow/api.h>
+#include <arrow/util/string_view.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+
+namespace {
+
+using vinum::common::ArrayIter;
+using vinum::common::TypedValueArrayIter;
+using vinum::common::array_iter_factory;
+
+constexpr int64_t NUM_ROWS = 1 << 20;
+
+// Arguments of the iterators: percentage of NULL values.
+void iter_args(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("null_pct")->Arg(0)->Arg(10)->Arg(50);
+}
+
+std::shared_ptr<arrow::Array> bench_column(benchmark::State& state, arrow::Type::type key_type) {
+    const auto& batches = vinum::bench::bench_batches(
+            NUM_ROWS, NUM_ROWS, state.range(0) / 100.0, key_type);
+    auto table_res = arrow::Table::FromRecordBatches(batches);
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    auto combined_res = table_res.ValueOrDie()->CombineChunks();
+    RAISE_ON_ARROW_FAILURE(combined_res.status());
+    return combined_res.ValueOrDie()->GetColumnByName("key")->chunk(0);
+}
+
+// Values as uint64, the way the keys of the hash aggregates are read.
+template<arrow::Type::type TYPE>
+void BM_ArrayIterAsUInt64(benchmark::State& state) {
+    const auto array = bench_column(state, TYPE);
+    auto iter = array_iter_factory(TYPE);
+    for (auto _ : state) {
+        iter->SetArray(array);
+        uint64_t sum = 0;
+        while (iter->HasMore()) {
+            if (iter->NextIfNull()) {
+                continue;
+            }
+            sum += iter->NextAsUInt64();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * array->length());
+}
+BENCHMARK_TEMPLATE(BM_ArrayIterAsUInt64, arrow::Type::INT64)->Apply(iter_args);
+BENCHMARK_TEMPLATE(BM_ArrayIterAsUInt64, arrow::Type::DOUBLE)->Apply(iter_args);
+
+// Typed values, the way the inputs of the aggregate functions are read.
+template<typename ARROW_TYPE>
+void BM_TypedArrayIter(benchmark::State& state) {
+    using CType = typename ARROW_TYPE::c_type;
+    const auto array = bench_column(state, ARROW_TYPE::type_id);
+    auto iter = array_iter_factory(ARROW_TYPE::type_id);
+    auto* typed_iter = static_cast<TypedValueArrayIter<CType>*>(iter.get());
+    for (auto _ : state) {
+        typed_iter->SetArray(array);
+        CType sum = 0;
+        while (typed_iter->HasMore()) {
+            if (typed_iter->NextIfNull()) {
+                continue;
+            }
+            sum += typed_iter->Next();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * array->length());
+}
+BENCHMARK_TEMPLATE(BM_TypedArrayIter, arrow::Int64Type)->Apply(iter_args);
+BENCHMARK_TEMPLATE(BM_TypedArrayIter, arrow::DoubleType)->Apply(iter_args);
+
+void BM_StringArrayIter(benchmark::State& state) {
+    const auto array = bench_column(state, arrow::Type::STRING);
+    auto iter = array_iter_factory(arrow::Type::STRING);
+    auto* typed_iter = static_cast<TypedValueArrayIter<arrow::util::string_view>*>(iter.get());
+    for (auto _ : state) {
+        typed_iter->SetArray(array);
+        size_t total_length = 0;
+        while (typed_iter->HasMore()) {
+            if (typed_iter->NextIfNull()) {
+                continue;
+            }
+            total_length += typed_iter->Next().size();
+        }
+        benchmark::DoNotOptimize(total_length);
+    }
+    state.SetItemsProcessed(state.iterations() * array->length());
+}
+BENCHMARK(BM_StringArrayIter)->Apply(iter_args);
+
+}  // namespace
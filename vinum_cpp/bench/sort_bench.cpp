@@ -0,0 +1,57 @@
+#include "bench_data.h"
+
+#include "operators/sort/sort.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using vinum::operators::sort::Sort;
+using vinum::operators::sort::SortOrder;
+
+// Arguments of the sorts: number of rows, percentage of NULL values.
+void sort_args(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"rows", "null_pct"});
+    for (int64_t num_rows : {1 << 16, 1 << 20}) {
+        for (int64_t null_pct : {0, 10}) {
+            bench->Args({num_rows, null_pct});
+        }
+    }
+}
+
+void run_sort(benchmark::State& state,
+              arrow::Type::type key_type,
+              const std::vector<std::string>& sort_cols,
+              const std::vector<SortOrder>& sort_order) {
+    const int64_t num_rows = state.range(0);
+    const auto& batches = vinum::bench::bench_batches(
+            num_rows, num_rows, state.range(1) / 100.0, key_type);
+    for (auto _ : state) {
+        Sort sort(sort_cols, sort_order);
+        for (const auto& batch : batches) {
+            sort.Next(batch);
+        }
+        benchmark::DoNotOptimize(sort.Sorted());
+    }
+    state.SetItemsProcessed(state.iterations() * num_rows);
+}
+
+template<arrow::Type::type KEY_TYPE>
+void BM_Sort(benchmark::State& state) {
+    run_sort(state, KEY_TYPE, {"key"}, {SortOrder::ASC});
+}
+BENCHMARK_TEMPLATE(BM_Sort, arrow::Type::INT64)->Apply(sort_args)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Sort, arrow::Type::DOUBLE)->Apply(sort_args)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Sort, arrow::Type::STRING)->Apply(sort_args)->Unit(benchmark::kMillisecond);
+
+// Few distinct values of the first column, the ties are broken by the second one.
+void BM_SortMultiColumn(benchmark::State& state) {
+    run_sort(state, arrow::Type::INT64, {"second_key", "double_val"}, {SortOrder::ASC, SortOrder::DESC});
+}
+BENCHMARK(BM_SortMultiColumn)->Apply(sort_args)->Unit(benchmark::kMillisecond);
+
+}  // namespace
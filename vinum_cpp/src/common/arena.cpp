@@ -0,0 +1,28 @@
+#include "arena.h"
+
+
+namespace vinum::common {
+
+Arena::Arena(size_t block_size) : block_size(block_size) {}
+
+size_t Arena::BytesReserved() const {
+    return this->bytes_reserved;
+}
+
+void Arena::Release() {
+    std::vector<std::unique_ptr<uint8_t[]>>().swap(this->blocks);
+    this->current = nullptr;
+    this->remaining = 0;
+    this->bytes_reserved = 0;
+}
+
+void Arena::AllocateBlock(size_t min_size) {
+    // Allocations larger than the block size get a block of their own.
+    const size_t size = min_size > this->block_size ? min_size : this->block_size;
+    this->blocks.emplace_back(new uint8_t[size]);
+    this->current = this->blocks.back().get();
+    this->remaining = size;
+    this->bytes_reserved += size;
+}
+
+}  // namespace vinum::common
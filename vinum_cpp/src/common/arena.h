@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+
+namespace vinum::common {
+
+/**
+ * Bump allocator of raw bytes, memory is allocated in blocks and released all at once
+ * when the arena is destroyed or released. Pointers returned by Allocate() stay valid for the
+ * lifetime of the arena, which makes it suitable for the keys of the hash tables.
+ */
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    inline uint8_t* Allocate(size_t size) {
+        if (size > this->remaining) {
+            this->AllocateBlock(size);
+        }
+        uint8_t* ptr = this->current;
+        this->current += size;
+        this->remaining -= size;
+        return ptr;
+    }
+
+    inline uint8_t* Copy(const void* data, size_t size) {
+        uint8_t* ptr = this->Allocate(size);
+        std::memcpy(ptr, data, size);
+        return ptr;
+    }
+
+    // Free all the blocks, the pointers returned so far become invalid.
+    void Release();
+
+    // Total size of the blocks allocated so far.
+    [[nodiscard]] size_t BytesReserved() const;
+
+private:
+    const size_t block_size;
+    std::vector<std::unique_ptr<uint8_t[]>> blocks;
+    uint8_t* current = nullptr;
+    size_t remaining = 0;
+    size_t bytes_reserved = 0;
+
+    void AllocateBlock(size_t min_size);
+};
+
+}  // namespace vinum::common
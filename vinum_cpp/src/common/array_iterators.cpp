@@ -63,6 +63,8 @@ std::unique_ptr<ArrayIter> array_iter_factory(arrow::Type::type type) {
             return std::make_unique<StringArrayIter<arrow::LargeBinaryArray>>();
         case arrow::Type::FIXED_SIZE_BINARY:
             return std::make_unique<StringArrayIter<arrow::FixedSizeBinaryArray>>();
+        case arrow::Type::DICTIONARY:
+            return std::make_unique<DictionaryArrayIter>();
         // -- Generic types - types, where only IsNull() is supported by generic arrow::Array
         case arrow::Type::STRUCT:
         case arrow::Type::LIST:
@@ -71,7 +73,6 @@ std::unique_ptr<ArrayIter> array_iter_factory(arrow::Type::type type) {
         case arrow::Type::MAP:
         case arrow::Type::DENSE_UNION:
         case arrow::Type::SPARSE_UNION:
-        case arrow::Type::DICTIONARY:
         case arrow::Type::EXTENSION:
         case arrow::Type::NA:
             return std::make_unique<GenericArrayIter>();
@@ -45,6 +45,16 @@ public:
 
     virtual uint64_t NextAsUInt64() = 0;
 
+    // Null bitmap of the array, or nullptr if the array has no nulls.
+    [[nodiscard]] inline const uint8_t* ValidityBitmap() const {
+        return this->NonNullCount() == this->Length() ? nullptr : this->nulls_ptr;
+    }
+
+    // Bit index of the first element of the array in the ValidityBitmap().
+    [[nodiscard]] inline int64_t Offset() const {
+        return this->nulls_idx - this->current_idx;
+    }
+
 protected:
     const uint8_t *nulls_ptr = nullptr;
     int64_t nulls_idx = 0;
@@ -105,6 +115,11 @@ public:
     virtual T Next() = 0;
 
     virtual T GetValue(int64_t idx) = 0;
+
+    // Pointer to the first value of the array, nullptr if the values are not stored as a plain C array.
+    [[nodiscard]] virtual const T* RawValues() const {
+        return nullptr;
+    }
 };
 
 
@@ -177,7 +192,7 @@ public:
 
     using TypedValueArrayIter<typename T::c_type>::TypedValueArrayIter;
 
-    void SetArray(const std::shared_ptr<void>& arr) override {
+    void SetArray(const std::shared_ptr<void>& arr) final {
         this->array = std::static_pointer_cast<arrow::NumericArray<T>>(arr);
         native_arr_ptr = (DType *) this->array->raw_values();
         this->nulls_ptr = this->array->null_bitmap_data();
@@ -186,32 +201,36 @@ public:
         this->length = this->array->length();
     }
 
-    [[nodiscard]] bool HasMore() const override {
+    [[nodiscard]] bool HasMore() const final {
         return this->current_idx < this->length;
     }
 
-    [[nodiscard]] int64_t Length() const override {
+    [[nodiscard]] int64_t Length() const final {
         return this->length;
     }
 
-    [[nodiscard]] int64_t NonNullCount() const override {
+    [[nodiscard]] int64_t NonNullCount() const final {
         return this->length - this->array->null_count();
     }
 
-    [[nodiscard]] inline bool IsNull(int64_t idx) const override {
+    [[nodiscard]] inline bool IsNull(int64_t idx) const final {
         return this->array->IsNull(idx);
     }
 
-    DType Next() override {
+    DType Next() final {
         auto val = *native_arr_ptr;
         this->MoveNext();
         return val;
     }
 
-    DType GetValue(int64_t idx) override {
+    DType GetValue(int64_t idx) final {
         return this->array->GetView(idx);
     }
 
+    [[nodiscard]] const DType* RawValues() const final {
+        return this->array->raw_values();
+    }
+
     uint64_t NextAsUInt64() override {
         return static_cast<uint64_t>(this->Next());
     }
@@ -220,7 +239,7 @@ protected:
     std::shared_ptr<arrow::NumericArray<T>> array = nullptr;
     const DType *native_arr_ptr = nullptr;
 
-    inline void MoveNext() override {
+    inline void MoveNext() final {
         this->current_idx++;
         this->nulls_idx++;
         native_arr_ptr++;
@@ -248,6 +267,64 @@ private:
     }
 };
 
+/**
+ * Dictionary encoded array, values of the iterator are the dictionary indices.
+ */
+class DictionaryArrayIter : public TypedValueArrayIter<int64_t> {
+public:
+
+    void SetArray(const std::shared_ptr<void>& arr) override {
+        this->array = std::static_pointer_cast<arrow::DictionaryArray>(arr);
+        this->nulls_ptr = this->array->null_bitmap_data();
+        this->nulls_idx = this->array->offset();
+        this->current_idx = 0;
+        this->length = this->array->length();
+    }
+
+    [[nodiscard]] bool HasMore() const override {
+        return this->current_idx < this->length;
+    }
+
+    [[nodiscard]] int64_t Length() const override {
+        return this->length;
+    }
+
+    [[nodiscard]] int64_t NonNullCount() const override {
+        return this->length - this->array->null_count();
+    }
+
+    [[nodiscard]] inline bool IsNull(int64_t idx) const override {
+        return this->array->IsNull(idx);
+    }
+
+    int64_t Next() override {
+        auto idx = this->current_idx;
+        this->MoveNext();
+        return this->array->GetValueIndex(idx);
+    }
+
+    int64_t GetValue(int64_t idx) override {
+        return this->array->GetValueIndex(idx);
+    }
+
+    // Dictionary indices are only meaningful within the array's dictionary.
+    uint64_t NextAsUInt64() override {
+        return static_cast<uint64_t>(this->Next());
+    }
+
+    [[nodiscard]] const std::shared_ptr<arrow::Array>& Dictionary() const {
+        return this->array->dictionary();
+    }
+
+protected:
+    std::shared_ptr<arrow::DictionaryArray> array = nullptr;
+
+    inline void MoveNext() override {
+        this->current_idx++;
+        this->nulls_idx++;
+    }
+};
+
 
 std::unique_ptr<ArrayIter> array_iter_factory(arrow::Type::type type);
 
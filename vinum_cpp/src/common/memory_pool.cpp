@@ -0,0 +1,211 @@
+#include "memory_pool.h"
+
+#include "util.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+
+namespace vinum::common {
+
+namespace {
+
+arrow::MemoryPool* backend_pool(const std::string& backend) {
+    if (backend == "default") {
+        return arrow::default_memory_pool();
+    }
+    if (backend == "system") {
+        return arrow::system_memory_pool();
+    }
+
+    arrow::MemoryPool* pool = nullptr;
+    arrow::Status status;
+    if (backend == "jemalloc") {
+        status = arrow::jemalloc_memory_pool(&pool);
+    } else if (backend == "mimalloc") {
+        status = arrow::mimalloc_memory_pool(&pool);
+    } else {
+        throw std::runtime_error("Unknown memory pool backend: '" + backend
+                                 + "', expected one of: default, system, jemalloc, mimalloc.");
+    }
+    if (!status.ok()) {
+        throw std::runtime_error("Memory pool backend '" + backend
+                                 + "' is not available: " + status.message());
+    }
+    return pool;
+}
+
+}  // namespace
+
+
+QueryMemoryPool::QueryMemoryPool(int64_t limit, const std::string& backend)
+        : limit(limit), backend(backend_pool(backend)) {}
+
+arrow::Status QueryMemoryPool::Allocate(int64_t size, uint8_t** out) {
+    if (!this->Grow(size)) {
+        return arrow::Status::OutOfMemory("Query memory limit of ", this->limit,
+                                          " bytes exceeded, failed to allocate ", size, " bytes.");
+    }
+    auto status = this->backend->Allocate(size, out);
+    if (!status.ok()) {
+        this->allocated -= size;
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->num_buffers++ == 0) {
+        this->keep_alive = this->weak_from_this().lock();
+    }
+    return status;
+}
+
+arrow::Status QueryMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+    const int64_t diff = new_size - old_size;
+    if (diff > 0 && !this->Grow(diff)) {
+        return arrow::Status::OutOfMemory("Query memory limit of ", this->limit,
+                                          " bytes exceeded, failed to reallocate ", new_size, " bytes.");
+    }
+    auto status = this->backend->Reallocate(old_size, new_size, ptr);
+    if (!status.ok()) {
+        if (diff > 0) {
+            this->allocated -= diff;
+        }
+        return status;
+    }
+    if (diff < 0) {
+        this->allocated += diff;
+    }
+    return status;
+}
+
+void QueryMemoryPool::Free(uint8_t* buffer, int64_t size) {
+    this->backend->Free(buffer, size);
+    this->allocated -= size;
+
+    // The last buffer may be the last reference to the pool, it's destroyed once the lock is released.
+    std::shared_ptr<QueryMemoryPool> self;
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (--this->num_buffers == 0) {
+        self = std::move(this->keep_alive);
+    }
+}
+
+void QueryMemoryPool::ReleaseUnused() {
+    this->backend->ReleaseUnused();
+}
+
+int64_t QueryMemoryPool::bytes_allocated() const {
+    return this->allocated;
+}
+
+int64_t QueryMemoryPool::max_memory() const {
+    return this->peak;
+}
+
+std::string QueryMemoryPool::backend_name() const {
+    return this->backend->backend_name();
+}
+
+void QueryMemoryPool::Reserve(int64_t bytes) {
+    if (!this->TryReserve(bytes)) {
+        throw MemoryLimitError("Query memory limit of " + std::to_string(this->limit)
+                               + " bytes exceeded, failed to reserve " + std::to_string(bytes)
+                               + " bytes, " + std::to_string(this->bytes_allocated()) + " bytes in use.");
+    }
+}
+
+bool QueryMemoryPool::TryReserve(int64_t bytes) {
+    if (!this->Grow(bytes)) {
+        return false;
+    }
+    this->reserved += bytes;
+    return true;
+}
+
+void QueryMemoryPool::Release(int64_t bytes) {
+    this->allocated -= bytes;
+    this->reserved -= bytes;
+}
+
+int64_t QueryMemoryPool::ReservedBytes() const {
+    return this->reserved;
+}
+
+int64_t QueryMemoryPool::Limit() const {
+    return this->limit;
+}
+
+bool QueryMemoryPool::Grow(int64_t bytes) {
+    const int64_t total = this->allocated.fetch_add(bytes) + bytes;
+    if (this->limit > 0 && total > this->limit) {
+        this->allocated -= bytes;
+        return false;
+    }
+    this->UpdatePeak(total);
+    return true;
+}
+
+void QueryMemoryPool::UpdatePeak(int64_t bytes) {
+    int64_t current_peak = this->peak;
+    while (bytes > current_peak && !this->peak.compare_exchange_weak(current_peak, bytes)) {}
+}
+
+
+MemoryReservation::~MemoryReservation() {
+    this->SetPool(nullptr);
+}
+
+void MemoryReservation::SetPool(std::shared_ptr<QueryMemoryPool> new_pool) {
+    if (this->pool) {
+        this->pool->Release(this->size);
+    }
+    this->pool = std::move(new_pool);
+    // Nothing stays reserved if the new pool has no room for the bytes, the next Resize() retries.
+    if (this->pool && !this->pool->TryReserve(this->size)) {
+        this->size = 0;
+    }
+}
+
+void MemoryReservation::Resize(int64_t bytes) {
+    if (!this->TryResize(bytes)) {
+        // Throws MemoryLimitError, unless the memory was freed since TryResize().
+        this->pool->Reserve(bytes - this->size);
+        this->size = bytes;
+    }
+}
+
+bool MemoryReservation::TryResize(int64_t bytes) {
+    if (this->pool) {
+        if (bytes > this->size) {
+            if (!this->pool->TryReserve(bytes - this->size)) {
+                return false;
+            }
+        } else {
+            this->pool->Release(this->size - bytes);
+        }
+    }
+    this->size = bytes;
+    return true;
+}
+
+int64_t MemoryReservation::Size() const {
+    return this->size;
+}
+
+int64_t MemoryReservation::Available() const {
+    if (!this->pool || this->pool->Limit() <= 0) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return std::max<int64_t>(this->pool->Limit() - this->pool->bytes_allocated(), 0);
+}
+
+arrow::MemoryPool* MemoryReservation::ArrowPool() const {
+    return this->pool ? static_cast<arrow::MemoryPool*>(this->pool.get()) : arrow::default_memory_pool();
+}
+
+const std::shared_ptr<QueryMemoryPool>& MemoryReservation::Pool() const {
+    return this->pool;
+}
+
+}  // namespace vinum::common
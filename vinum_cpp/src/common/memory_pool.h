@@ -0,0 +1,110 @@
+#pragma once
+
+#include <arrow/api.h>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+
+
+namespace vinum::common {
+
+/**
+ * Memory pool of a single query.
+ *
+ * Arrow allocations of the operators are forwarded to the backend pool: "default", "system",
+ * "jemalloc" or "mimalloc". The state the operators keep outside of Arrow buffers, ie hash tables
+ * and buffered batches, is accounted with Reserve() and Release().
+ * Both count against the limit, an allocation exceeding it fails with arrow::Status::OutOfMemory,
+ * a reservation throws MemoryLimitError. Limit of 0 means unlimited.
+ *
+ * Arrow buffers keep a raw pointer to their pool, so the pool keeps itself alive while any buffer
+ * allocated by it is alive, ie the batches of the result may outlive the query.
+ * Must be owned by a std::shared_ptr.
+ */
+class QueryMemoryPool : public arrow::MemoryPool, public std::enable_shared_from_this<QueryMemoryPool> {
+public:
+    explicit QueryMemoryPool(int64_t limit = 0, const std::string& backend = "default");
+
+    QueryMemoryPool(const QueryMemoryPool&) = delete;
+    QueryMemoryPool& operator=(const QueryMemoryPool&) = delete;
+
+    arrow::Status Allocate(int64_t size, uint8_t** out) override;
+    arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+    void Free(uint8_t* buffer, int64_t size) override;
+    void ReleaseUnused() override;
+
+    // Bytes of the Arrow buffers and of the reservations.
+    [[nodiscard]] int64_t bytes_allocated() const override;
+    [[nodiscard]] int64_t max_memory() const override;
+    [[nodiscard]] std::string backend_name() const override;
+
+    // Account bytes of memory not allocated by the pool, throws MemoryLimitError over the limit.
+    void Reserve(int64_t bytes);
+    // Same as Reserve(), returns false instead of throwing, nothing is reserved then.
+    bool TryReserve(int64_t bytes);
+    void Release(int64_t bytes);
+
+    [[nodiscard]] int64_t ReservedBytes() const;
+    [[nodiscard]] int64_t Limit() const;
+
+private:
+    const int64_t limit;
+    arrow::MemoryPool* backend;
+
+    std::atomic<int64_t> allocated{0};
+    std::atomic<int64_t> reserved{0};
+    std::atomic<int64_t> peak{0};
+
+    // Number of the live Arrow buffers, the pool is kept alive by keep_alive while it's not 0.
+    int64_t num_buffers = 0;
+    std::shared_ptr<QueryMemoryPool> keep_alive;
+    std::mutex mutex;
+
+    // Add bytes to allocated, false if that would exceed the limit.
+    bool Grow(int64_t bytes);
+    void UpdatePeak(int64_t bytes);
+};
+
+
+/**
+ * Bytes reserved by an operator in a QueryMemoryPool, released on destruction.
+ * Without a pool nothing is accounted and Resize() always succeeds.
+ */
+class MemoryReservation {
+public:
+    MemoryReservation() = default;
+
+    ~MemoryReservation();
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    // Move the reservation to another pool, nullptr to stop accounting.
+    void SetPool(std::shared_ptr<QueryMemoryPool> new_pool);
+
+    // Grow or shrink the reservation to bytes, throws MemoryLimitError if the pool would exceed its limit.
+    void Resize(int64_t bytes);
+    // Same as Resize(), returns false instead of throwing, the reservation is left unchanged then.
+    bool TryResize(int64_t bytes);
+
+    [[nodiscard]] int64_t Size() const;
+
+    // Bytes the reservation may still grow by within the limit of the pool,
+    // std::numeric_limits<int64_t>::max() without a pool or a limit.
+    [[nodiscard]] int64_t Available() const;
+
+    // Pool for the Arrow allocations of the operator, the default pool without a query pool.
+    [[nodiscard]] arrow::MemoryPool* ArrowPool() const;
+
+    [[nodiscard]] const std::shared_ptr<QueryMemoryPool>& Pool() const;
+
+private:
+    std::shared_ptr<QueryMemoryPool> pool;
+    int64_t size = 0;
+};
+
+}  // namespace vinum::common
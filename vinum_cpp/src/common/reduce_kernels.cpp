@@ -0,0 +1,147 @@
+#include "reduce_kernels.h"
+#include "reduce_kernels_internal.h"
+
+
+namespace vinum::common::kernels {
+
+namespace {
+
+enum class SimdLevel {
+    NONE, AVX2, AVX512
+};
+
+SimdLevel DetectSimdLevel() {
+#if defined(VINUM_HAVE_AVX512)
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+#endif
+#if defined(VINUM_HAVE_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::NONE;
+}
+
+const SimdLevel simd_level = DetectSimdLevel();
+
+}  // namespace
+
+#if defined(VINUM_HAVE_AVX512)
+#define VINUM_DISPATCH_AVX512(FUNC, ...) \
+    if (simd_level == SimdLevel::AVX512) { return avx512::FUNC(__VA_ARGS__); }
+#else
+#define VINUM_DISPATCH_AVX512(FUNC, ...)
+#endif
+
+#if defined(VINUM_HAVE_AVX2)
+#define VINUM_DISPATCH_AVX2(FUNC, ...) \
+    if (simd_level == SimdLevel::AVX2) { return avx2::FUNC(__VA_ARGS__); }
+#else
+#define VINUM_DISPATCH_AVX2(FUNC, ...)
+#endif
+
+#define VINUM_DISPATCH(FUNC, ...) \
+    VINUM_DISPATCH_AVX512(FUNC, __VA_ARGS__) \
+    VINUM_DISPATCH_AVX2(FUNC, __VA_ARGS__)
+
+
+template<>
+double Sum<double, double>(const double* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    VINUM_DISPATCH(SumDouble, values, validity, offset, length)
+
+    double sum = 0;
+    for (int64_t i = 0; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+template<>
+double Sum<float, double>(const float* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    VINUM_DISPATCH(SumFloat, values, validity, offset, length)
+
+    double sum = 0;
+    for (int64_t i = 0; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+template<>
+int64_t Sum<int32_t, int64_t>(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    VINUM_DISPATCH(SumInt32, values, validity, offset, length)
+
+    int64_t sum = 0;
+    for (int64_t i = 0; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+template<>
+hugeint_t Sum<int64_t, hugeint_t>(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    VINUM_DISPATCH(SumInt64, values, validity, offset, length)
+
+    hugeint_t sum = 0;
+    for (int64_t i = 0; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += Hugeint::Convert<int64_t>(values[i]);
+        }
+    }
+    return sum;
+}
+
+template<>
+hugeint_t Sum<uint64_t, hugeint_t>(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    VINUM_DISPATCH(SumUInt64, values, validity, offset, length)
+
+    hugeint_t sum = 0;
+    for (int64_t i = 0; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += Hugeint::Convert<uint64_t>(values[i]);
+        }
+    }
+    return sum;
+}
+
+template<typename T>
+inline bool ScalarMinMax(const T* values, const uint8_t* validity, int64_t offset, int64_t length,
+                         bool is_max, T& result) {
+    bool has_value = false;
+    for (int64_t i = 0; i < length; i++) {
+        if (!IsValidBit(validity, offset + i)) {
+            continue;
+        }
+        if (!has_value || ((values[i] < result) ^ is_max)) {
+            result = values[i];
+            has_value = true;
+        }
+    }
+    return has_value;
+}
+
+template<>
+bool MinMax<int32_t>(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                     bool is_max, int32_t& result) {
+    VINUM_DISPATCH(MinMaxInt32, values, validity, offset, length, is_max, result)
+
+    return ScalarMinMax(values, validity, offset, length, is_max, result);
+}
+
+template<>
+bool MinMax<int64_t>(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                     bool is_max, int64_t& result) {
+    VINUM_DISPATCH(MinMaxInt64, values, validity, offset, length, is_max, result)
+
+    return ScalarMinMax(values, validity, offset, length, is_max, result);
+}
+
+}  // namespace vinum::common::kernels
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "common/huge_int.h"
+
+#include <arrow/util/bit_util.h>
+
+#include <cstdint>
+
+
+namespace vinum::common::kernels {
+
+/**
+ * Reduction kernels over the raw values buffer of a primitive Arrow array.
+ *
+ * `values` points to the first value of the array (ie array offset already applied),
+ * `validity` is the null bitmap of the array with `offset` being the bit index of the first value,
+ * `validity` may be nullptr if the array has no nulls.
+ *
+ * Generic versions below are scalar, hot types have explicit specializations, defined in
+ * reduce_kernels.cpp, which dispatch at runtime to AVX-512 / AVX2 implementations,
+ * if those are supported by both the compiler and the CPU.
+ */
+
+template<typename T_ACC, typename T>
+inline void AddTo(T_ACC& acc, T val) {
+    acc += val;
+}
+
+template<typename T>
+inline void AddTo(hugeint_t& acc, T val) {
+    acc += Hugeint::Convert<T>(val);
+}
+
+/**
+ * Sum of all the non-null values.
+ */
+template<typename T, typename T_ACC>
+T_ACC Sum(const T* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    T_ACC sum = T_ACC(0);
+    if (validity == nullptr) {
+        for (int64_t i = 0; i < length; i++) {
+            AddTo(sum, values[i]);
+        }
+    } else {
+        for (int64_t i = 0; i < length; i++) {
+            if (arrow::BitUtil::GetBit(validity, offset + i)) {
+                AddTo(sum, values[i]);
+            }
+        }
+    }
+    return sum;
+}
+
+/**
+ * Min or max of all the non-null values, the same comparison as the one used by MinMaxFunc::Update().
+ * Returns false if there are no non-null values.
+ */
+template<typename T>
+bool MinMax(const T* values, const uint8_t* validity, int64_t offset, int64_t length,
+            bool is_max, T& result) {
+    bool has_value = false;
+    for (int64_t i = 0; i < length; i++) {
+        if (validity != nullptr && !arrow::BitUtil::GetBit(validity, offset + i)) {
+            continue;
+        }
+        if (!has_value) {
+            result = values[i];
+            has_value = true;
+        } else if ((values[i] < result) ^ is_max) {
+            result = values[i];
+        }
+    }
+    return has_value;
+}
+
+template<>
+double Sum<double, double>(const double* values, const uint8_t* validity, int64_t offset, int64_t length);
+
+template<>
+double Sum<float, double>(const float* values, const uint8_t* validity, int64_t offset, int64_t length);
+
+template<>
+int64_t Sum<int32_t, int64_t>(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length);
+
+template<>
+hugeint_t Sum<int64_t, hugeint_t>(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length);
+
+template<>
+hugeint_t Sum<uint64_t, hugeint_t>(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length);
+
+template<>
+bool MinMax<int32_t>(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                     bool is_max, int32_t& result);
+
+template<>
+bool MinMax<int64_t>(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                     bool is_max, int64_t& result);
+
+}  // namespace vinum::common::kernels
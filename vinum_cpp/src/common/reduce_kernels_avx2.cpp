@@ -0,0 +1,275 @@
+// AVX2 reduction kernels, this unit is compiled with -mavx2.
+
+#include "reduce_kernels_internal.h"
+
+#include <immintrin.h>
+
+
+namespace vinum::common::kernels::avx2 {
+
+namespace {
+
+// One 64-bit lane per each of the 4 lowest bits: all ones if the bit is set, zero otherwise.
+inline __m256i ExpandMask4(uint64_t bits) {
+    const __m256i bit_select = _mm256_setr_epi64x(1, 2, 4, 8);
+    const __m256i broadcast = _mm256_set1_epi64x(static_cast<int64_t>(bits & 0xF));
+    return _mm256_cmpeq_epi64(_mm256_and_si256(broadcast, bit_select), bit_select);
+}
+
+// One 32-bit lane per each of the 8 lowest bits.
+inline __m256i ExpandMask8(uint64_t bits) {
+    const __m256i bit_select = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i broadcast = _mm256_set1_epi32(static_cast<int32_t>(bits & 0xFF));
+    return _mm256_cmpeq_epi32(_mm256_and_si256(broadcast, bit_select), bit_select);
+}
+
+inline double HorizontalSum(__m256d vec) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, vec);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+inline uint64_t HorizontalSum(__m256i vec) {
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), vec);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Sums 4 doubles per step, LOAD converts 4 input values starting at the pointer into doubles.
+template<typename T, typename LOAD>
+inline double SumAsDouble(const T* values, const uint8_t* validity, int64_t offset, int64_t length, LOAD load) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == ALL_VALID) {
+            for (int j = 0; j < 64; j += 8) {
+                acc0 = _mm256_add_pd(acc0, load(values + i + j));
+                acc1 = _mm256_add_pd(acc1, load(values + i + j + 4));
+            }
+        } else if (bits != 0) {
+            for (int j = 0; j < 64; j += 4, bits >>= 4) {
+                const __m256d mask = _mm256_castsi256_pd(ExpandMask4(bits));
+                acc0 = _mm256_add_pd(acc0, _mm256_and_pd(load(values + i + j), mask));
+            }
+        }
+    }
+
+    double sum = HorizontalSum(_mm256_add_pd(acc0, acc1));
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += static_cast<double>(values[i]);
+        }
+    }
+    return sum;
+}
+
+// Sum of 64-bit integers, each value is split into 32-bit halves accumulated in 64-bit lanes,
+// lanes are spilled into hugeint_t once per HUGEINT_SPILL_BLOCK values.
+// Signed values are biased by 2^63 to make them unsigned, the bias is subtracted in the end.
+template<bool IS_SIGNED>
+inline hugeint_t SumInt64Halves(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    const __m256i sign_bit = _mm256_set1_epi64x(static_cast<int64_t>(1ULL << 63));
+
+    hugeint_t sum = HugeintFromParts(0, 0);
+    uint64_t num_valid = 0;
+    int64_t i = 0;
+    while (i + 64 <= length) {
+        __m256i lo_acc = _mm256_setzero_si256();
+        __m256i hi_acc = _mm256_setzero_si256();
+        for (int64_t block_end = i + HUGEINT_SPILL_BLOCK; i + 64 <= length && i < block_end; i += 64) {
+            uint64_t bits = LoadValidityWord(validity, offset + i);
+            if (bits == 0) {
+                continue;
+            }
+            num_valid += __builtin_popcountll(bits);
+            for (int j = 0; j < 64; j += 4, bits >>= 4) {
+                __m256i vals = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + j));
+                if (IS_SIGNED) {
+                    vals = _mm256_xor_si256(vals, sign_bit);
+                }
+                vals = _mm256_and_si256(vals, ExpandMask4(bits));
+                lo_acc = _mm256_add_epi64(lo_acc, _mm256_and_si256(vals, low_mask));
+                hi_acc = _mm256_add_epi64(hi_acc, _mm256_srli_epi64(vals, 32));
+            }
+        }
+        SpillHalves(sum, HorizontalSum(lo_acc), HorizontalSum(hi_acc));
+    }
+
+    uint64_t lo_tail = 0, hi_tail = 0;
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            uint64_t val = IS_SIGNED ? (values[i] ^ (1ULL << 63)) : values[i];
+            lo_tail += val & 0xFFFFFFFFULL;
+            hi_tail += val >> 32;
+            num_valid++;
+        }
+    }
+    SpillHalves(sum, lo_tail, hi_tail);
+
+    if (IS_SIGNED) {
+        // Subtract num_valid * 2^63
+        sum -= HugeintFromParts((num_valid & 1) << 63, static_cast<int64_t>(num_valid >> 1));
+    }
+    return sum;
+}
+
+template<bool IS_MAX>
+inline __m256i SelectInt32(__m256i acc, __m256i vals) {
+    return IS_MAX ? _mm256_max_epi32(acc, vals) : _mm256_min_epi32(acc, vals);
+}
+
+template<bool IS_MAX>
+inline __m256i SelectInt64(__m256i acc, __m256i vals) {
+    // Lanes where vals should replace acc
+    const __m256i replace = IS_MAX ? _mm256_cmpgt_epi64(vals, acc) : _mm256_cmpgt_epi64(acc, vals);
+    return _mm256_blendv_epi8(acc, vals, replace);
+}
+
+template<bool IS_MAX>
+inline bool MinMaxInt32Impl(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                            int32_t& result) {
+    const int32_t identity = IS_MAX ? INT32_MIN : INT32_MAX;
+    const __m256i identity_vec = _mm256_set1_epi32(identity);
+    __m256i acc = identity_vec;
+    bool has_value = false;
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == ALL_VALID) {
+            for (int j = 0; j < 64; j += 8) {
+                acc = SelectInt32<IS_MAX>(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + j)));
+            }
+        } else if (bits != 0) {
+            for (int j = 0; j < 64; j += 8, bits >>= 8) {
+                __m256i vals = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + j));
+                vals = _mm256_blendv_epi8(identity_vec, vals, ExpandMask8(bits));
+                acc = SelectInt32<IS_MAX>(acc, vals);
+            }
+        } else {
+            continue;
+        }
+        has_value = true;
+    }
+
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int32_t res = identity;
+    for (int32_t lane : lanes) {
+        res = IS_MAX ? (lane > res ? lane : res) : (lane < res ? lane : res);
+    }
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            res = IS_MAX ? (values[i] > res ? values[i] : res) : (values[i] < res ? values[i] : res);
+            has_value = true;
+        }
+    }
+    result = res;
+    return has_value;
+}
+
+template<bool IS_MAX>
+inline bool MinMaxInt64Impl(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                            int64_t& result) {
+    const int64_t identity = IS_MAX ? INT64_MIN : INT64_MAX;
+    const __m256i identity_vec = _mm256_set1_epi64x(identity);
+    __m256i acc = identity_vec;
+    bool has_value = false;
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == ALL_VALID) {
+            for (int j = 0; j < 64; j += 4) {
+                acc = SelectInt64<IS_MAX>(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + j)));
+            }
+        } else if (bits != 0) {
+            for (int j = 0; j < 64; j += 4, bits >>= 4) {
+                __m256i vals = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + j));
+                vals = _mm256_blendv_epi8(identity_vec, vals, ExpandMask4(bits));
+                acc = SelectInt64<IS_MAX>(acc, vals);
+            }
+        } else {
+            continue;
+        }
+        has_value = true;
+    }
+
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int64_t res = identity;
+    for (int64_t lane : lanes) {
+        res = IS_MAX ? (lane > res ? lane : res) : (lane < res ? lane : res);
+    }
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            res = IS_MAX ? (values[i] > res ? values[i] : res) : (values[i] < res ? values[i] : res);
+            has_value = true;
+        }
+    }
+    result = res;
+    return has_value;
+}
+
+}  // namespace
+
+
+double SumDouble(const double* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumAsDouble(values, validity, offset, length, [](const double* ptr) {
+        return _mm256_loadu_pd(ptr);
+    });
+}
+
+double SumFloat(const float* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumAsDouble(values, validity, offset, length, [](const float* ptr) {
+        return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+    });
+}
+
+int64_t SumInt32(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    __m256i acc = _mm256_setzero_si256();
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == 0) {
+            continue;
+        }
+        for (int j = 0; j < 64; j += 4, bits >>= 4) {
+            __m256i vals = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + j)));
+            acc = _mm256_add_epi64(acc, _mm256_and_si256(vals, ExpandMask4(bits)));
+        }
+    }
+
+    auto sum = static_cast<int64_t>(HorizontalSum(acc));
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+hugeint_t SumInt64(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumInt64Halves<true>(reinterpret_cast<const uint64_t*>(values), validity, offset, length);
+}
+
+hugeint_t SumUInt64(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumInt64Halves<false>(values, validity, offset, length);
+}
+
+bool MinMaxInt32(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                 bool is_max, int32_t& result) {
+    return is_max
+           ? MinMaxInt32Impl<true>(values, validity, offset, length, result)
+           : MinMaxInt32Impl<false>(values, validity, offset, length, result);
+}
+
+bool MinMaxInt64(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                 bool is_max, int64_t& result) {
+    return is_max
+           ? MinMaxInt64Impl<true>(values, validity, offset, length, result)
+           : MinMaxInt64Impl<false>(values, validity, offset, length, result);
+}
+
+}  // namespace vinum::common::kernels::avx2
@@ -0,0 +1,219 @@
+// AVX-512 reduction kernels, this unit is compiled with -mavx512f.
+
+#include "reduce_kernels_internal.h"
+
+#include <immintrin.h>
+
+
+namespace vinum::common::kernels::avx512 {
+
+namespace {
+
+// Sums 8 doubles per step, LOAD converts 8 input values starting at the pointer into doubles.
+template<typename T, typename LOAD>
+inline double SumAsDouble(const T* values, const uint8_t* validity, int64_t offset, int64_t length, LOAD load) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == ALL_VALID) {
+            for (int j = 0; j < 64; j += 16) {
+                acc0 = _mm512_add_pd(acc0, load(values + i + j));
+                acc1 = _mm512_add_pd(acc1, load(values + i + j + 8));
+            }
+        } else if (bits != 0) {
+            for (int j = 0; j < 64; j += 8, bits >>= 8) {
+                acc0 = _mm512_mask_add_pd(acc0, static_cast<__mmask8>(bits), acc0, load(values + i + j));
+            }
+        }
+    }
+
+    double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += static_cast<double>(values[i]);
+        }
+    }
+    return sum;
+}
+
+// See avx2::SumInt64Halves()
+template<bool IS_SIGNED>
+inline hugeint_t SumInt64Halves(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    const __m512i low_mask = _mm512_set1_epi64(0xFFFFFFFFLL);
+    const __m512i sign_bit = _mm512_set1_epi64(static_cast<int64_t>(1ULL << 63));
+
+    hugeint_t sum = HugeintFromParts(0, 0);
+    uint64_t num_valid = 0;
+    int64_t i = 0;
+    while (i + 64 <= length) {
+        __m512i lo_acc = _mm512_setzero_si512();
+        __m512i hi_acc = _mm512_setzero_si512();
+        for (int64_t block_end = i + HUGEINT_SPILL_BLOCK; i + 64 <= length && i < block_end; i += 64) {
+            uint64_t bits = LoadValidityWord(validity, offset + i);
+            if (bits == 0) {
+                continue;
+            }
+            num_valid += __builtin_popcountll(bits);
+            for (int j = 0; j < 64; j += 8, bits >>= 8) {
+                const auto mask = static_cast<__mmask8>(bits);
+                __m512i vals = _mm512_loadu_si512(values + i + j);
+                if (IS_SIGNED) {
+                    vals = _mm512_xor_si512(vals, sign_bit);
+                }
+                lo_acc = _mm512_mask_add_epi64(lo_acc, mask, lo_acc, _mm512_and_si512(vals, low_mask));
+                hi_acc = _mm512_mask_add_epi64(hi_acc, mask, hi_acc, _mm512_srli_epi64(vals, 32));
+            }
+        }
+        SpillHalves(sum,
+                    static_cast<uint64_t>(_mm512_reduce_add_epi64(lo_acc)),
+                    static_cast<uint64_t>(_mm512_reduce_add_epi64(hi_acc)));
+    }
+
+    uint64_t lo_tail = 0, hi_tail = 0;
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            uint64_t val = IS_SIGNED ? (values[i] ^ (1ULL << 63)) : values[i];
+            lo_tail += val & 0xFFFFFFFFULL;
+            hi_tail += val >> 32;
+            num_valid++;
+        }
+    }
+    SpillHalves(sum, lo_tail, hi_tail);
+
+    if (IS_SIGNED) {
+        // Subtract num_valid * 2^63
+        sum -= HugeintFromParts((num_valid & 1) << 63, static_cast<int64_t>(num_valid >> 1));
+    }
+    return sum;
+}
+
+template<bool IS_MAX>
+inline bool MinMaxInt32Impl(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                            int32_t& result) {
+    const int32_t identity = IS_MAX ? INT32_MIN : INT32_MAX;
+    __m512i acc = _mm512_set1_epi32(identity);
+    bool has_value = false;
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == 0) {
+            continue;
+        }
+        for (int j = 0; j < 64; j += 16, bits >>= 16) {
+            const auto mask = static_cast<__mmask16>(bits);
+            const __m512i vals = _mm512_loadu_si512(values + i + j);
+            acc = IS_MAX
+                  ? _mm512_mask_max_epi32(acc, mask, acc, vals)
+                  : _mm512_mask_min_epi32(acc, mask, acc, vals);
+        }
+        has_value = true;
+    }
+
+    int32_t res = IS_MAX ? _mm512_reduce_max_epi32(acc) : _mm512_reduce_min_epi32(acc);
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            res = IS_MAX ? (values[i] > res ? values[i] : res) : (values[i] < res ? values[i] : res);
+            has_value = true;
+        }
+    }
+    result = res;
+    return has_value;
+}
+
+template<bool IS_MAX>
+inline bool MinMaxInt64Impl(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                            int64_t& result) {
+    const int64_t identity = IS_MAX ? INT64_MIN : INT64_MAX;
+    __m512i acc = _mm512_set1_epi64(identity);
+    bool has_value = false;
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == 0) {
+            continue;
+        }
+        for (int j = 0; j < 64; j += 8, bits >>= 8) {
+            const auto mask = static_cast<__mmask8>(bits);
+            const __m512i vals = _mm512_loadu_si512(values + i + j);
+            acc = IS_MAX
+                  ? _mm512_mask_max_epi64(acc, mask, acc, vals)
+                  : _mm512_mask_min_epi64(acc, mask, acc, vals);
+        }
+        has_value = true;
+    }
+
+    int64_t res = IS_MAX ? _mm512_reduce_max_epi64(acc) : _mm512_reduce_min_epi64(acc);
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            res = IS_MAX ? (values[i] > res ? values[i] : res) : (values[i] < res ? values[i] : res);
+            has_value = true;
+        }
+    }
+    result = res;
+    return has_value;
+}
+
+}  // namespace
+
+
+double SumDouble(const double* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumAsDouble(values, validity, offset, length, [](const double* ptr) {
+        return _mm512_loadu_pd(ptr);
+    });
+}
+
+double SumFloat(const float* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumAsDouble(values, validity, offset, length, [](const float* ptr) {
+        return _mm512_cvtps_pd(_mm256_loadu_ps(ptr));
+    });
+}
+
+int64_t SumInt32(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    __m512i acc = _mm512_setzero_si512();
+    int64_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t bits = LoadValidityWord(validity, offset + i);
+        if (bits == 0) {
+            continue;
+        }
+        for (int j = 0; j < 64; j += 8, bits >>= 8) {
+            const __m512i vals = _mm512_cvtepi32_epi64(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + j)));
+            acc = _mm512_mask_add_epi64(acc, static_cast<__mmask8>(bits), acc, vals);
+        }
+    }
+
+    int64_t sum = _mm512_reduce_add_epi64(acc);
+    for (; i < length; i++) {
+        if (IsValidBit(validity, offset + i)) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+hugeint_t SumInt64(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumInt64Halves<true>(reinterpret_cast<const uint64_t*>(values), validity, offset, length);
+}
+
+hugeint_t SumUInt64(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length) {
+    return SumInt64Halves<false>(values, validity, offset, length);
+}
+
+bool MinMaxInt32(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                 bool is_max, int32_t& result) {
+    return is_max
+           ? MinMaxInt32Impl<true>(values, validity, offset, length, result)
+           : MinMaxInt32Impl<false>(values, validity, offset, length, result);
+}
+
+bool MinMaxInt64(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length,
+                 bool is_max, int64_t& result) {
+    return is_max
+           ? MinMaxInt64Impl<true>(values, validity, offset, length, result)
+           : MinMaxInt64Impl<false>(values, validity, offset, length, result);
+}
+
+}  // namespace vinum::common::kernels::avx512
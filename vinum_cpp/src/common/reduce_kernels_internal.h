@@ -0,0 +1,73 @@
+#pragma once
+
+// Declarations shared between reduce_kernels.cpp and the ISA specific translation units.
+// The ISA specific units are compiled with -mavx2 / -mavx512f, so they must not instantiate
+// any inline function shared with the rest of the library - all the helpers here have internal linkage.
+
+#include "common/data_types.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+
+namespace vinum::common::kernels {
+
+// Number of values reduced between two spills of SIMD accumulators into hugeint_t.
+static constexpr int64_t HUGEINT_SPILL_BLOCK = 1 << 16;
+
+static constexpr uint64_t ALL_VALID = ~0ULL;
+
+static inline bool IsValidBit(const uint8_t* validity, int64_t bit_idx) {
+    return validity == nullptr || ((validity[bit_idx >> 3] >> (bit_idx & 7)) & 1);
+}
+
+// Validity bits of the 64 values starting at bit_offset, only the bytes covering those bits are read.
+static inline uint64_t LoadValidityWord(const uint8_t* validity, int64_t bit_offset) {
+    if (validity == nullptr) {
+        return ALL_VALID;
+    }
+    const uint8_t* bytes = validity + (bit_offset >> 3);
+    const int shift = static_cast<int>(bit_offset & 7);
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    if (shift != 0) {
+        word = (word >> shift) | (static_cast<uint64_t>(bytes[8]) << (64 - shift));
+    }
+    return word;
+}
+
+static inline hugeint_t HugeintFromParts(uint64_t lower, int64_t upper) {
+    hugeint_t result;
+    result.lower = lower;
+    result.upper = upper;
+    return result;
+}
+
+// Adds lo_sum + hi_sum * 2^32 to acc.
+static inline void SpillHalves(hugeint_t& acc, uint64_t lo_sum, uint64_t hi_sum) {
+    acc += HugeintFromParts(lo_sum, 0);
+    acc += HugeintFromParts(hi_sum << 32, static_cast<int64_t>(hi_sum >> 32));
+}
+
+#define VINUM_DECLARE_REDUCE_KERNELS \
+    double SumDouble(const double* values, const uint8_t* validity, int64_t offset, int64_t length); \
+    double SumFloat(const float* values, const uint8_t* validity, int64_t offset, int64_t length); \
+    int64_t SumInt32(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length); \
+    hugeint_t SumInt64(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length); \
+    hugeint_t SumUInt64(const uint64_t* values, const uint8_t* validity, int64_t offset, int64_t length); \
+    bool MinMaxInt32(const int32_t* values, const uint8_t* validity, int64_t offset, int64_t length, \
+                     bool is_max, int32_t& result); \
+    bool MinMaxInt64(const int64_t* values, const uint8_t* validity, int64_t offset, int64_t length, \
+                     bool is_max, int64_t& result);
+
+namespace avx2 {
+VINUM_DECLARE_REDUCE_KERNELS
+}  // namespace avx2
+
+namespace avx512 {
+VINUM_DECLARE_REDUCE_KERNELS
+}  // namespace avx512
+
+#undef VINUM_DECLARE_REDUCE_KERNELS
+
+}  // namespace vinum::common::kernels
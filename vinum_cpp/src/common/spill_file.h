@@ -0,0 +1,16 @@
+#pragma once
+
+#include <random>
+#include <string>
+
+
+namespace vinum::common {
+
+// Path of a new spill file in spill_dir: spill_dir/<prefix>_<random token>_<suffix>.arrow
+// Random token, so that several operators (or processes) may share the spill directory.
+inline std::string MakeSpillFilePath(const std::string& spill_dir, const std::string& prefix, size_t suffix) {
+    static thread_local std::mt19937_64 gen(std::random_device{}());
+    return spill_dir + "/" + prefix + "_" + std::to_string(gen()) + "_" + std::to_string(suffix) + ".arrow";
+}
+
+}  // namespace vinum::common
@@ -0,0 +1,79 @@
+#include "thread_pool.h"
+
+
+namespace vinum::common {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    this->workers.reserve(num_threads);
+    for (size_t idx = 0; idx < num_threads; idx++) {
+        this->workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->is_stopping = true;
+    }
+    this->cond.notify_all();
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task) {
+    std::packaged_task<void()> packaged(std::move(task));
+    auto future = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push(std::move(packaged));
+    }
+    this->cond.notify_one();
+    return future;
+}
+
+void ThreadPool::ParallelFor(size_t num_tasks, const std::function<void(size_t)>& func) {
+    if (num_tasks == 1) {
+        func(0);
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_tasks);
+    for (size_t idx = 0; idx < num_tasks; idx++) {
+        futures.push_back(this->Submit([&func, idx]() { func(idx); }));
+    }
+
+    // Wait for all the tasks before rethrowing, as they reference func.
+    for (auto& future : futures) {
+        future.wait();
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+size_t ThreadPool::Size() const {
+    return this->workers.size();
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->cond.wait(lock, [this]() { return this->is_stopping || !this->tasks.empty(); });
+            if (this->tasks.empty()) {
+                return;
+            }
+            task = std::move(this->tasks.front());
+            this->tasks.pop();
+        }
+        task();
+    }
+}
+
+}  // namespace vinum::common
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+namespace vinum::common {
+
+/**
+ * Fixed size pool of worker threads executing tasks in FIFO order.
+ *
+ * Tasks must not wait for other tasks of the same pool, ie ParallelFor() must not be called
+ * from within a task, otherwise the pool may deadlock.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::future<void> Submit(std::function<void()> task);
+
+    // Run func(idx) for every idx in [0, num_tasks) and wait until all of them finish.
+    // The first exception thrown by a task is rethrown to the caller.
+    void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& func);
+
+    [[nodiscard]] size_t Size() const;
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::packaged_task<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool is_stopping = false;
+
+    void WorkerLoop();
+};
+
+}  // namespace vinum::common
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace vinum::common {
+
+// Adds the wall time elapsed during its lifetime to the counter, in nanoseconds.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(int64_t& nanos) : nanos(nanos), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        this->nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - this->start).count();
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    int64_t& nanos;
+    const std::chrono::steady_clock::time_point start;
+};
+
+}  // namespace vinum::common
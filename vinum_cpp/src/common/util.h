@@ -1,11 +1,28 @@
 #pragma once
 
+#include <stdexcept>
+#include <string>
 
-#define RAISE_ON_ARROW_FAILURE(expr)               \
-  do {                                             \
-    arrow::Status status_ = (expr);                \
-    if (!status_.ok()) {                           \
-      std::cerr << status_.message() << std::endl; \
-      throw std::runtime_error(status_.message()); \
-    }                                              \
+
+namespace vinum::common {
+
+// The memory limit of the query was exceeded, see QueryMemoryPool.
+class MemoryLimitError : public std::runtime_error {
+public:
+    explicit MemoryLimitError(const std::string& message) : std::runtime_error(message) {}
+};
+
+}  // namespace vinum::common
+
+
+#define RAISE_ON_ARROW_FAILURE(expr)                              \
+  do {                                                            \
+    arrow::Status status_ = (expr);                               \
+    if (!status_.ok()) {                                          \
+      std::cerr << status_.message() << std::endl;                \
+      if (status_.IsOutOfMemory()) {                              \
+        throw vinum::common::MemoryLimitError(status_.message()); \
+      }                                                           \
+      throw std::runtime_error(status_.message());                \
+    }                                                             \
   } while (0);
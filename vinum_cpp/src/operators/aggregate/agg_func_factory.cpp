@@ -32,6 +32,62 @@ std::shared_ptr<AbstractAggFunc> agg_func_factory(const AggFuncDef &func,
             return make_shared<CountFunc>();
         case AggFuncType::COUNT_STAR:
             return make_shared<CountStarFunc>();
+        case AggFuncType::COUNT_DISTINCT: {
+            switch (array_type) {
+                case arrow::Type::BOOL:
+                    return make_shared<CountDistinctFunc<bool>>();
+                case arrow::Type::INT8:
+                    return make_shared<CountDistinctFunc<int8_t>>();
+                case arrow::Type::INT16:
+                    return make_shared<CountDistinctFunc<int16_t>>();
+                case arrow::Type::INT32:
+                case arrow::Type::DATE32:
+                case arrow::Type::TIME32:
+                case arrow::Type::INTERVAL_MONTHS:
+                    return make_shared<CountDistinctFunc<int32_t>>();
+                case arrow::Type::INT64:
+                case arrow::Type::DATE64:
+                case arrow::Type::TIME64:
+                case arrow::Type::TIMESTAMP:
+                case arrow::Type::DURATION:
+                    return make_shared<CountDistinctFunc<int64_t>>();
+                case arrow::Type::UINT8:
+                    return make_shared<CountDistinctFunc<uint8_t>>();
+                case arrow::Type::UINT16:
+                case arrow::Type::HALF_FLOAT:
+                    return make_shared<CountDistinctFunc<uint16_t>>();
+                case arrow::Type::UINT32:
+                    return make_shared<CountDistinctFunc<uint32_t>>();
+                case arrow::Type::UINT64:
+                    return make_shared<CountDistinctFunc<uint64_t>>();
+                case arrow::Type::FLOAT:
+                    return make_shared<CountDistinctFunc<float_t>>();
+                case arrow::Type::DOUBLE:
+                    return make_shared<CountDistinctFunc<double_t>>();
+                case arrow::Type::INTERVAL_DAY_TIME:
+                    return make_shared<CountDistinctFunc<arrow::DayTimeIntervalType::DayMilliseconds>>();
+                case arrow::Type::DECIMAL128:
+                case arrow::Type::DECIMAL256:
+                case arrow::Type::STRING:
+                case arrow::Type::BINARY:
+                case arrow::Type::LARGE_STRING:
+                case arrow::Type::LARGE_BINARY:
+                case arrow::Type::FIXED_SIZE_BINARY:
+                    return make_shared<CountDistinctFunc<arrow::util::string_view>>();
+                case arrow::Type::STRUCT:
+                case arrow::Type::LIST:
+                case arrow::Type::LARGE_LIST:
+                case arrow::Type::FIXED_SIZE_LIST:
+                case arrow::Type::MAP:
+                case arrow::Type::DENSE_UNION:
+                case arrow::Type::SPARSE_UNION:
+                case arrow::Type::DICTIONARY:
+                case arrow::Type::EXTENSION:
+                case arrow::Type::NA:
+                default:
+                    throw std::runtime_error("Column data type is not supported by count(distinct).");
+            }
+        }
         case AggFuncType::MIN:
         case AggFuncType::MAX: {
             bool is_max = (func.func == AggFuncType::MAX);
@@ -202,7 +258,7 @@ std::shared_ptr<AbstractAggFunc> agg_func_factory(const AggFuncDef &func,
                             arrow::DoubleBuilder>>(arrow::float64());
                 case arrow::Type::HALF_FLOAT:
                     return make_shared<AvgFunc<arrow::HalfFloatType, double_t, double_t,
-                            arrow::HalfFloatBuilder>>(arrow::float64());
+                            arrow::DoubleBuilder>>(arrow::float64());
                 case arrow::Type::FLOAT:
                     return make_shared<AvgFunc<arrow::FloatType, double_t, double_t,
                             arrow::DoubleBuilder>>(arrow::float64());
@@ -245,6 +301,88 @@ std::shared_ptr<AbstractAggFunc> agg_func_factory(const AggFuncDef &func,
                     throw std::runtime_error("Column data type is not supported by avg().");
             }
         }
+        case AggFuncType::APPROX_COUNT_DISTINCT: {
+            switch (array_type) {
+                case arrow::Type::BOOL:
+                    return make_shared<ApproxCountDistinctFunc<bool>>();
+                case arrow::Type::INT8:
+                    return make_shared<ApproxCountDistinctFunc<int8_t>>();
+                case arrow::Type::INT16:
+                    return make_shared<ApproxCountDistinctFunc<int16_t>>();
+                case arrow::Type::INT32:
+                case arrow::Type::DATE32:
+                case arrow::Type::TIME32:
+                case arrow::Type::INTERVAL_MONTHS:
+                    return make_shared<ApproxCountDistinctFunc<int32_t>>();
+                case arrow::Type::INT64:
+                case arrow::Type::DATE64:
+                case arrow::Type::TIME64:
+                case arrow::Type::TIMESTAMP:
+                case arrow::Type::DURATION:
+                    return make_shared<ApproxCountDistinctFunc<int64_t>>();
+                case arrow::Type::UINT8:
+                    return make_shared<ApproxCountDistinctFunc<uint8_t>>();
+                case arrow::Type::UINT16:
+                case arrow::Type::HALF_FLOAT:
+                    return make_shared<ApproxCountDistinctFunc<uint16_t>>();
+                case arrow::Type::UINT32:
+                    return make_shared<ApproxCountDistinctFunc<uint32_t>>();
+                case arrow::Type::UINT64:
+                    return make_shared<ApproxCountDistinctFunc<uint64_t>>();
+                case arrow::Type::FLOAT:
+                    return make_shared<ApproxCountDistinctFunc<float_t>>();
+                case arrow::Type::DOUBLE:
+                    return make_shared<ApproxCountDistinctFunc<double_t>>();
+                case arrow::Type::INTERVAL_DAY_TIME:
+                    return make_shared<ApproxCountDistinctFunc<arrow::DayTimeIntervalType::DayMilliseconds>>();
+                case arrow::Type::DECIMAL128:
+                case arrow::Type::DECIMAL256:
+                case arrow::Type::STRING:
+                case arrow::Type::BINARY:
+                case arrow::Type::LARGE_STRING:
+                case arrow::Type::LARGE_BINARY:
+                case arrow::Type::FIXED_SIZE_BINARY:
+                    return make_shared<ApproxCountDistinctFunc<arrow::util::string_view>>();
+                case arrow::Type::STRUCT:
+                case arrow::Type::LIST:
+                case arrow::Type::LARGE_LIST:
+                case arrow::Type::FIXED_SIZE_LIST:
+                case arrow::Type::MAP:
+                case arrow::Type::DENSE_UNION:
+                case arrow::Type::SPARSE_UNION:
+                case arrow::Type::DICTIONARY:
+                case arrow::Type::EXTENSION:
+                case arrow::Type::NA:
+                default:
+                    throw std::runtime_error("Column data type is not supported by approx_count_distinct().");
+            }
+        }
+        case AggFuncType::APPROX_PERCENTILE: {
+            switch (array_type) {
+                case arrow::Type::INT8:
+                    return make_shared<ApproxPercentileFunc<arrow::Int8Type>>(func.param);
+                case arrow::Type::INT16:
+                    return make_shared<ApproxPercentileFunc<arrow::Int16Type>>(func.param);
+                case arrow::Type::INT32:
+                    return make_shared<ApproxPercentileFunc<arrow::Int32Type>>(func.param);
+                case arrow::Type::INT64:
+                    return make_shared<ApproxPercentileFunc<arrow::Int64Type>>(func.param);
+                case arrow::Type::UINT8:
+                    return make_shared<ApproxPercentileFunc<arrow::UInt8Type>>(func.param);
+                case arrow::Type::UINT16:
+                    return make_shared<ApproxPercentileFunc<arrow::UInt16Type>>(func.param);
+                case arrow::Type::UINT32:
+                    return make_shared<ApproxPercentileFunc<arrow::UInt32Type>>(func.param);
+                case arrow::Type::UINT64:
+                    return make_shared<ApproxPercentileFunc<arrow::UInt64Type>>(func.param);
+                case arrow::Type::FLOAT:
+                    return make_shared<ApproxPercentileFunc<arrow::FloatType>>(func.param);
+                case arrow::Type::DOUBLE:
+                    return make_shared<ApproxPercentileFunc<arrow::DoubleType>>(func.param);
+                default:
+                    throw std::runtime_error("Column data type is not supported by approx_percentile().");
+            }
+        }
         case AggFuncType::GROUP_BUILDER: {
             switch (array_type) {
                 case arrow::Type::BOOL:
@@ -309,6 +447,9 @@ std::shared_ptr<AbstractAggFunc> agg_func_factory(const AggFuncDef &func,
                 case arrow::Type::FIXED_SIZE_BINARY:
                     return make_shared<StringGroupBuilder<arrow::FixedSizeBinaryArray,
                             arrow::FixedSizeBinaryBuilder>>(field_type);
+                case arrow::Type::DICTIONARY:
+                    return make_shared<DictionaryGroupBuilder>(
+                            static_cast<const arrow::DictionaryType&>(*field_type).value_type());
                 case arrow::Type::STRUCT:
                 case arrow::Type::LIST:
                 case arrow::Type::LARGE_LIST:
@@ -316,7 +457,6 @@ std::shared_ptr<AbstractAggFunc> agg_func_factory(const AggFuncDef &func,
                 case arrow::Type::MAP:
                 case arrow::Type::DENSE_UNION:
                 case arrow::Type::SPARSE_UNION:
-                case arrow::Type::DICTIONARY:
                 case arrow::Type::EXTENSION:
                 case arrow::Type::NA:
                 default:
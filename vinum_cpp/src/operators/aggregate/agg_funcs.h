@@ -2,11 +2,19 @@
 
 #include "common/util.h"
 #include "common/array_iterators.h"
+#include "common/reduce_kernels.h"
+#include "agg_state.h"
+#include "sketches.h"
 
 #include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include <arrow/type_traits.h>
+#include <arrow/util/bit_util.h>
 
+#include <cstring>
 #include <iostream>
 #include <limits>
+#include <type_traits>
 #include <common/huge_int.h>
 #include <unordered_set>
 
@@ -14,49 +22,270 @@
 namespace vinum::operators::aggregate {
 
 enum class AggFuncType {
-    COUNT, COUNT_STAR, MIN, MAX, SUM, AVG, GROUP_BUILDER
+    COUNT, COUNT_STAR, COUNT_DISTINCT, MIN, MAX, SUM, AVG, APPROX_COUNT_DISTINCT, APPROX_PERCENTILE, GROUP_BUILDER
 };
 
 struct AggFuncDef {
     AggFuncType func;
     std::string column_name;
     std::string out_col_name;
+    double param = 0;   // Quantile of APPROX_PERCENTILE
 };
 
 
+// Append the states of the groups [begin, end) to the builder.
 template <typename BUILDER, typename T>
-inline void AppendToBuilder(std::unique_ptr<BUILDER>& builder, const std::shared_ptr<T>& val);
+inline void AppendStates(std::unique_ptr<BUILDER>& builder, const StateColumn<T>& states,
+                         uint32_t begin, uint32_t end) {
+    RAISE_ON_ARROW_FAILURE(builder->AppendValues(states.data() + begin, end - begin, states.valid_data() + begin));
+}
 
-template <typename BUILDER, typename T = std::string>
-inline void AppendToBuilder(std::unique_ptr<BUILDER>& builder, const std::shared_ptr<std::string>& val) {
-    RAISE_ON_ARROW_FAILURE(builder->Append(arrow::util::string_view(val->data(), val->length())));
+template <typename BUILDER>
+constexpr bool IsVarBinaryBuilder = std::is_base_of_v<arrow::BinaryBuilder, BUILDER>
+                                    || std::is_base_of_v<arrow::LargeBinaryBuilder, BUILDER>;
+
+// Variable length values are copied from the contiguous buffer of the states
+// into the data buffer of the builder, which is reserved upfront.
+template <typename BUILDER>
+inline void AppendStates(std::unique_ptr<BUILDER>& builder, const StringStateColumn& states,
+                         uint32_t begin, uint32_t end) {
+    RAISE_ON_ARROW_FAILURE(builder->Resize(end - begin));
+    if constexpr (IsVarBinaryBuilder<BUILDER>) {
+        RAISE_ON_ARROW_FAILURE(builder->ReserveData(states.DataLength(begin, end)));
+    }
+    for (uint32_t group_id = begin; group_id < end; group_id++) {
+        if (!states.IsValid(group_id)) {
+            builder->UnsafeAppendNull();
+        } else if constexpr (IsVarBinaryBuilder<BUILDER>) {
+            builder->UnsafeAppend(states[group_id]);
+        } else {
+            RAISE_ON_ARROW_FAILURE(builder->Append(states[group_id]));
+        }
+    }
 }
 
-template <typename BUILDER, typename T>
-inline void AppendToBuilder(std::unique_ptr<BUILDER>& builder, const std::shared_ptr<T>& val) {
-    builder->UnsafeAppend(*val);
+
+/**
+ * Serialization of the states, ie for spilling the partial aggregates to disk.
+ *
+ * Fixed width states are stored as FixedSizeBinary values of sizeof(T) bytes,
+ * string states as Binary values. valid may be nullptr if all the states are valid,
+ * group_ids may be nullptr to serialize the first num_groups values.
+ */
+template<typename T>
+inline std::shared_ptr<arrow::Array> SerializeValues(const T* values,
+                                                     const uint8_t* valid,
+                                                     const uint32_t* group_ids,
+                                                     size_t num_groups) {
+    arrow::FixedSizeBinaryBuilder builder(arrow::fixed_size_binary(sizeof(T)), arrow::default_memory_pool());
+    RAISE_ON_ARROW_FAILURE(builder.Resize(num_groups));
+    for (size_t idx = 0; idx < num_groups; idx++) {
+        const auto group_id = group_ids != nullptr ? group_ids[idx] : idx;
+        if (valid == nullptr || valid[group_id]) {
+            builder.UnsafeAppend(reinterpret_cast<const uint8_t*>(values + group_id));
+        } else {
+            builder.UnsafeAppendNull();
+        }
+    }
+    std::shared_ptr<arrow::Array> array;
+    RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+    return array;
+}
+
+template<typename T>
+inline std::shared_ptr<arrow::Array> SerializeStates(const StateColumn<T>& states,
+                                                     const uint32_t* group_ids,
+                                                     size_t num_groups) {
+    return SerializeValues(states.data(), states.valid_data(), group_ids, num_groups);
+}
+
+inline std::shared_ptr<arrow::Array> SerializeStates(const StringStateColumn& states,
+                                                     const uint32_t* group_ids,
+                                                     size_t num_groups) {
+    arrow::BinaryBuilder builder(arrow::default_memory_pool());
+    RAISE_ON_ARROW_FAILURE(builder.Resize(num_groups));
+    for (size_t idx = 0; idx < num_groups; idx++) {
+        const auto group_id = group_ids[idx];
+        if (states.IsValid(group_id)) {
+            RAISE_ON_ARROW_FAILURE(builder.Append(states[group_id]));
+        } else {
+            builder.UnsafeAppendNull();
+        }
+    }
+    std::shared_ptr<arrow::Array> array;
+    RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+    return array;
+}
+
+// Inverse of SerializeValues(), null values are zero initialized.
+template<typename T>
+inline void DeserializeValues(const arrow::Array& array, std::vector<T>& values, std::vector<uint8_t>* valid) {
+    const auto& binary_array = static_cast<const arrow::FixedSizeBinaryArray&>(array);
+    values.assign(array.length(), T());
+    if (valid != nullptr) {
+        valid->assign(array.length(), 0);
+    }
+    for (int64_t idx = 0; idx < array.length(); idx++) {
+        if (binary_array.IsValid(idx)) {
+            std::memcpy(&values[idx], binary_array.GetValue(idx), sizeof(T));
+            if (valid != nullptr) {
+                (*valid)[idx] = 1;
+            }
+        }
+    }
+}
+
+template<typename T>
+inline void DeserializeStates(const arrow::Array& array, StateColumn<T>& states) {
+    states = StateColumn<T>();
+    const auto& binary_array = static_cast<const arrow::FixedSizeBinaryArray&>(array);
+    for (int64_t idx = 0; idx < array.length(); idx++) {
+        if (binary_array.IsValid(idx)) {
+            T val;
+            std::memcpy(&val, binary_array.GetValue(idx), sizeof(T));
+            states.Append(val);
+        } else {
+            states.AppendNull();
+        }
+    }
+}
+
+inline void DeserializeStates(const arrow::Array& array, StringStateColumn& states) {
+    states = StringStateColumn();
+    const auto& binary_array = static_cast<const arrow::BinaryArray&>(array);
+    for (int64_t idx = 0; idx < array.length(); idx++) {
+        if (binary_array.IsValid(idx)) {
+            states.Append(binary_array.GetView(idx));
+        } else {
+            states.AppendNull();
+        }
+    }
+}
+
+
+/**
+ * Raw buffer access for the batch UpdateBatch() path.
+ *
+ * Values and validity bits are read directly from the ArrayData buffers,
+ * so that the per-row loops are inlined into each aggregate function and are free of virtual calls.
+ */
+template<typename T>
+inline T ReadValue(const uint8_t* values, int64_t idx) {
+    return reinterpret_cast<const T*>(values)[idx];
+}
+
+template<>
+inline bool ReadValue<bool>(const uint8_t* values, int64_t idx) {
+    return arrow::BitUtil::GetBit(values, idx);
+}
+
+// Call func(group_id, row_idx) for every non-null row of data.
+template<typename FUNC>
+inline void ForEachValid(const uint32_t* group_ids, const arrow::ArrayData& data, FUNC&& func) {
+    const auto null_count = data.GetNullCount();
+    if (null_count == data.length) {
+        return;
+    }
+
+    if (null_count == 0) {
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            func(group_ids[row_idx], row_idx);
+        }
+    } else {
+        const uint8_t* validity = data.buffers[0]->data();
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            if (arrow::BitUtil::GetBit(validity, data.offset + row_idx)) {
+                func(group_ids[row_idx], row_idx);
+            }
+        }
+    }
+}
+
+// Call func(group_id, value) for every non-null value of data.
+template<typename T, typename FUNC>
+inline void ForEachValue(const uint32_t* group_ids, const arrow::ArrayData& data, FUNC&& func) {
+    const uint8_t* values = data.buffers[1] ? data.buffers[1]->data() : nullptr;
+    const auto offset = data.offset;
+    ForEachValid(group_ids, data, [&](uint32_t group_id, int64_t row_idx) {
+        func(group_id, ReadValue<T>(values, offset + row_idx));
+    });
 }
 
 
+/**
+ * Aggregate function.
+ *
+ * Each function owns the state of all the groups, stored column-wise and
+ * addressed by the dense group id assigned by the aggregate operator.
+ * New groups are always appended, ie the group id of a new group is equal to the number of
+ * groups the function holds at the moment of the Init() call.
+ */
 class AbstractAggFunc {
 public:
+    virtual ~AbstractAggFunc() = default;
+
     virtual void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) = 0;
 
-    virtual std::shared_ptr<void> Init(int row_idx) = 0;
+    // Append the state of a new group, initialized with the current row.
+    virtual void Init(int row_idx) = 0;
+
+    // Update the state of an existing group with the current row.
+    virtual void Update(uint32_t group_id) = 0;
+
+    virtual void InitBatch() = 0;
+
+    virtual void UpdateBatch(uint32_t group_id) = 0;
+
+    // Grow the states to num_groups, new groups start empty (NULL or zero).
+    virtual void Resize(uint32_t num_groups) = 0;
+
+    // Update the states with the whole batch, group_ids holds the group id of every row of data.
+    virtual void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) = 0;
+
+    // Merge the states of other_group_ids of another instance of the same function
+    // (ie the same function of another partial aggregate) into the existing groups group_ids.
+    virtual void Merge(const AbstractAggFunc& other,
+                       const uint32_t* other_group_ids,
+                       const uint32_t* group_ids,
+                       size_t num_groups) = 0;
+
+    // Copy the states of the groups [begin, end) into the output builder,
+    // Result() returns them and resets the builder, so the groups may be summarized chunk by chunk.
+    virtual void Summarize(uint32_t begin, uint32_t end) = 0;
 
-    virtual void Update(std::shared_ptr<void> &current_val) = 0;
+    // True if the states do not fit the default output type, see SumOverflowFunc.
+    virtual bool IsOverflow() {
+        return false;
+    }
 
-    virtual std::shared_ptr<void> InitBatch() = 0;
+    // Emit the widened output type, so that several instances of a function produce the same type.
+    virtual void SetOverflowMode() {}
 
-    virtual void UpdateBatch(std::shared_ptr<void> &group) = 0;
+    // Append the states of group_ids to columns, see SerializeValues().
+    // Spilled states are written out right away, they are allocated from the default pool.
+    virtual void SerializeStates(const uint32_t* group_ids,
+                                 size_t num_groups,
+                                 std::vector<std::shared_ptr<arrow::Array>>& columns) const = 0;
 
-    virtual void Reserve(int64_t capacity) = 0;
+    // Replace the states with the ones serialized into columns[col_idx...],
+    // returns the index of the column following the states of this function.
+    virtual size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) = 0;
 
-    virtual void Summarize(const std::shared_ptr<void> &current_val) = 0;
+    // Approximate size of the states in bytes.
+    [[nodiscard]] virtual size_t MemoryUsage() const = 0;
 
     virtual std::shared_ptr<arrow::Array> Result() = 0;
 
     virtual std::shared_ptr<arrow::DataType> DataType() = 0;
+
+    // Pool of the output builders and of the other Arrow allocations of the function,
+    // must be set before the first group is created.
+    virtual void SetMemoryPool(arrow::MemoryPool* memory_pool) {
+        this->pool = memory_pool;
+    }
+
+protected:
+    arrow::MemoryPool* pool = arrow::default_memory_pool();
 };
 
 template<typename T_OUT, typename BUILDER>
@@ -67,19 +296,6 @@ public:
         this->builder = std::make_unique<BUILDER>(builder_type, arrow::default_memory_pool());
     }
 
-    void Reserve(int64_t capacity) override {
-        RAISE_ON_ARROW_FAILURE(this->builder->Resize(capacity));
-    }
-
-    void Summarize(const std::shared_ptr<void> &current_val) override {
-        if (current_val != nullptr) {
-            auto val = std::static_pointer_cast<T_OUT>(current_val);
-            ::vinum::operators::aggregate::AppendToBuilder<BUILDER, T_OUT>(this->builder, val);
-        } else {
-            this->builder->UnsafeAppendNull();
-        }
-    }
-
     std::shared_ptr<arrow::Array> Result() override {
         std::shared_ptr<arrow::Array> array;
         RAISE_ON_ARROW_FAILURE(this->builder->Finish(&array));
@@ -90,6 +306,11 @@ public:
         return builder->type();
     }
 
+    void SetMemoryPool(arrow::MemoryPool* memory_pool) override {
+        AbstractAggFunc::SetMemoryPool(memory_pool);
+        this->builder = std::make_unique<BUILDER>(this->builder->type(), memory_pool);
+    }
+
 protected:
     std::unique_ptr<BUILDER> builder;
 };
@@ -103,26 +324,64 @@ public:
         this->array_iter = std::move(iter);
     }
 
-    std::shared_ptr<void> Init(int row_idx) override {
-        return std::make_shared<uint64_t>(1);
+    void Init(int row_idx) override {
+        this->counts.push_back(1);
+    }
+
+    void Update(uint32_t group_id) override {
+        this->counts[group_id] += 1;
+    }
+
+    void InitBatch() override {
+        this->counts.push_back(0);
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        this->counts[group_id] += this->array_iter->Length();
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->counts.resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            this->counts[group_ids[row_idx]] += 1;
+        }
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_counts = static_cast<const CountStarFunc&>(other).counts;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->counts[group_ids[idx]] += other_counts[other_group_ids[idx]];
+        }
+    }
+
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(SerializeValues(this->counts.data(), nullptr, group_ids, num_groups));
     }
 
-    void Update(std::shared_ptr<void> &current_val) override {
-        auto count = std::static_pointer_cast<uint64_t>(current_val);
-        *count += 1;
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        DeserializeValues(*columns[col_idx], this->counts, nullptr);
+        return col_idx + 1;
     }
 
-    shared_ptr<void> InitBatch() override {
-        return std::make_shared<uint64_t>(0);
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->counts.capacity() * sizeof(uint64_t);
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
-        auto count = std::static_pointer_cast<uint64_t>(group);
-        *count += this->array_iter->Length();
+    void Summarize(uint32_t begin, uint32_t end) override {
+        RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(this->counts.data() + begin, end - begin));
     }
 
 protected:
     std::unique_ptr<common::ArrayIter> array_iter = nullptr;
+    std::vector<uint64_t> counts;
 
 };
 
@@ -136,28 +395,64 @@ public:
         this->array_iter = std::move(iter);
     }
 
-    std::shared_ptr<void> Init(int row_idx) override {
-        auto initial = this->array_iter->NextNull() ? 0 : 1;
-        return std::make_shared<uint64_t>(initial);
+    void Init(int row_idx) override {
+        this->counts.push_back(this->array_iter->NextNull() ? 0 : 1);
+    }
+
+    void Update(uint32_t group_id) override {
+        this->counts[group_id] += this->array_iter->NextNull() ? 0 : 1;
+    }
+
+    void InitBatch() override {
+        this->counts.push_back(0);
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        this->counts[group_id] += this->array_iter->NonNullCount();
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->counts.resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValid(group_ids, data, [this](uint32_t group_id, int64_t) {
+            this->counts[group_id] += 1;
+        });
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_counts = static_cast<const CountFunc&>(other).counts;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->counts[group_ids[idx]] += other_counts[other_group_ids[idx]];
+        }
+    }
+
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(SerializeValues(this->counts.data(), nullptr, group_ids, num_groups));
     }
 
-    void Update(std::shared_ptr<void> &current_val) override {
-        auto incr = this->array_iter->NextNull() ? 0 : 1;
-        auto count = std::static_pointer_cast<uint64_t>(current_val);
-        *count += incr;
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        DeserializeValues(*columns[col_idx], this->counts, nullptr);
+        return col_idx + 1;
     }
 
-    shared_ptr<void> InitBatch() override {
-        return std::make_shared<uint64_t>(0);
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->counts.capacity() * sizeof(uint64_t);
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
-        auto count = std::static_pointer_cast<uint64_t>(group);
-        *count += this->array_iter->NonNullCount();
+    void Summarize(uint32_t begin, uint32_t end) override {
+        RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(this->counts.data() + begin, end - begin));
     }
 
 private:
     std::unique_ptr<common::ArrayIter> array_iter = nullptr;
+    std::vector<uint64_t> counts;
 };
 
 
@@ -177,50 +472,124 @@ public:
         };
     }
 
-    std::shared_ptr<void> Init(int row_idx) override {
+    void Init(int row_idx) override {
         if (this->array_iter->NextIfNull()) {
-            return std::shared_ptr<T_IN>(nullptr);
+            this->states.AppendNull();
         } else {
-            return std::make_shared<T_IN>(this->array_iter->Next());
+            this->states.Append(this->array_iter->Next());
         }
     }
 
-    inline void Update(std::shared_ptr<void> &current_val) override {
+    inline void Update(uint32_t group_id) override {
         if (this->array_iter->NextIfNull()) {
             return;
-        } else if (current_val == nullptr) {
-            current_val = std::make_shared<T_IN>(this->array_iter->Next());
-            return;
         }
 
         auto row_val = this->array_iter->Next();
-        auto last = std::static_pointer_cast<T_IN>(current_val);
-        if ((row_val < *last) ^ this->is_max) {
-            *last = row_val;
+        if (!this->states.IsValid(group_id)) {
+            this->states.Set(group_id, row_val);
+        } else if ((row_val < this->states[group_id]) ^ this->is_max) {
+            this->states[group_id] = row_val;
         }
     }
 
-    shared_ptr<void> InitBatch() override {
-        return this->Init(0);
+    void InitBatch() override {
+        this->states.AppendNull();
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
-        while (this->array_iter->HasMore()) {
-            this->Update(group);
+    // Reduces the whole array with the SIMD kernel, if the values are stored in a plain array.
+    void UpdateBatch(uint32_t group_id) override {
+        const T_IN* values = this->array_iter->RawValues();
+        if (values == nullptr) {
+            while (this->array_iter->HasMore()) {
+                this->Update(group_id);
+            }
+            return;
+        }
+
+        T_IN batch_val;
+        bool has_value = common::kernels::MinMax<T_IN>(values,
+                                                       this->array_iter->ValidityBitmap(),
+                                                       this->array_iter->Offset(),
+                                                       this->array_iter->Length(),
+                                                       this->is_max,
+                                                       batch_val);
+        if (!has_value) {
+            return;
+        }
+        if (!this->states.IsValid(group_id)) {
+            this->states.Set(group_id, batch_val);
+        } else if ((batch_val < this->states[group_id]) ^ this->is_max) {
+            this->states[group_id] = batch_val;
+        }
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValue<T_IN>(group_ids, data, [this](uint32_t group_id, T_IN row_val) {
+            if (!this->states.IsValid(group_id)) {
+                this->states.Set(group_id, row_val);
+            } else if ((row_val < this->states[group_id]) ^ this->is_max) {
+                this->states[group_id] = row_val;
+            }
+        });
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const MinMaxFunc<T_IN, BUILDER>&>(other).states;
+        const bool max = this->is_max;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->states.Merge(other_states, other_group_ids[idx], group_ids[idx],
+                               [max](auto& val, const auto& other_val) {
+                if ((other_val < val) ^ max) {
+                    val = other_val;
+                }
+            });
         }
     }
 
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(aggregate::SerializeStates(this->states, group_ids, num_groups));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        aggregate::DeserializeStates(*columns[col_idx], this->states);
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage();
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        AppendStates<BUILDER>(this->builder, this->states, begin, end);
+    }
+
 protected:
     std::unique_ptr<common::TypedValueArrayIter<T_IN>> array_iter = nullptr;
+    StateColumn<typename StateType<T_IN>::type> states;
     bool is_max;
 };
 
 
+/**
+ * MIN/MAX of the string-like types, values are kept in a StringStateColumn.
+ */
 template<typename BUILDER>
-class StringMinMaxFunc : public MinMaxFunc<std::string, BUILDER> {
+class StringMinMaxFunc : public AggFuncTemplate<std::string, BUILDER> {
 
 public:
-    using MinMaxFunc<std::string, BUILDER>::MinMaxFunc;
+    explicit StringMinMaxFunc(bool is_max,
+                              const std::shared_ptr<arrow::DataType>& builder_type = nullptr
+    ) : AggFuncTemplate<std::string, BUILDER>(builder_type), is_max(is_max) {}
 
     void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) override {
         this->str_iter = std::unique_ptr<common::TypedValueArrayIter<arrow::util::string_view>>{
@@ -228,35 +597,81 @@ public:
         };
     }
 
-    std::shared_ptr<void> Init(int row_idx) override {
+    void Init(int row_idx) override {
         if (this->str_iter->NextIfNull()) {
-            return std::shared_ptr<std::string>(nullptr);
+            this->states.AppendNull();
         } else {
-            return this->create_shared_entry(this->str_iter->Next());
+            this->states.Append(this->str_iter->Next());
         }
     }
 
-    inline void Update(std::shared_ptr<void>& current_val) override {
+    inline void Update(uint32_t group_id) override {
         if (this->str_iter->NextIfNull()) {
             return;
-        } else if (current_val == nullptr) {
-            current_val = this->create_shared_entry(this->str_iter->Next());
-            return;
         }
+        this->UpdateState(group_id, this->str_iter->Next());
+    }
+
+    void InitBatch() override {
+        this->states.AppendNull();
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        while (this->str_iter->HasMore()) {
+            this->Update(group_id);
+        }
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            this->Update(group_ids[row_idx]);
+        }
+    }
 
-        auto row_val = this->str_iter->Next();
-        auto last = std::static_pointer_cast<std::string>(current_val);
-        auto last_view = arrow::util::string_view(last->data(), last->length());
-        if ((row_val < last_view) ^ this->is_max) {
-            *last = std::string(row_val.data(), row_val.length());
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const StringMinMaxFunc<BUILDER>&>(other).states;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            if (other_states.IsValid(other_group_ids[idx])) {
+                this->UpdateState(group_ids[idx], other_states[other_group_ids[idx]]);
+            }
         }
     }
 
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(aggregate::SerializeStates(this->states, group_ids, num_groups));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        aggregate::DeserializeStates(*columns[col_idx], this->states);
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage();
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        AppendStates<BUILDER>(this->builder, this->states, begin, end);
+    }
+
 protected:
     std::unique_ptr<common::TypedValueArrayIter<arrow::util::string_view>> str_iter = nullptr;
+    StringStateColumn states;
+    bool is_max;
 
-    inline std::shared_ptr<std::string> create_shared_entry(const arrow::util::string_view& view) {
-        return std::make_shared<std::string>(view.data(), view.length());
+    inline void UpdateState(uint32_t group_id, arrow::util::string_view val) {
+        if (!this->states.IsValid(group_id) || ((val < this->states[group_id]) ^ this->is_max)) {
+            this->states.Set(group_id, val);
+        }
     }
 };
 
@@ -274,6 +689,15 @@ public:
 
 protected:
     std::unique_ptr<common::NumericArrayIter<T_IN>> array_iter = nullptr;
+
+    // Sum of all the non-null values of the current array, computed by the SIMD kernel.
+    template<typename T_ACC>
+    inline T_ACC SumArray() const {
+        return common::kernels::Sum<typename T_IN::c_type, T_ACC>(this->array_iter->RawValues(),
+                                                                  this->array_iter->ValidityBitmap(),
+                                                                  this->array_iter->Offset(),
+                                                                  this->array_iter->Length());
+    }
 };
 
 
@@ -283,37 +707,92 @@ class SumFunc : public NumericAggFunc<T_IN, T_OUT, BUILDER> {
 public:
     using NumericAggFunc<T_IN, T_OUT, BUILDER>::NumericAggFunc;
 
-    std::shared_ptr<void> Init(int row_idx) override {
+    void Init(int row_idx) override {
         if (this->array_iter->NextIfNull()) {
-            return std::shared_ptr<T_OUT>(nullptr);
+            this->states.AppendNull();
         } else {
-            return std::make_shared<T_OUT>(this->array_iter->Next());
+            this->states.Append(this->array_iter->Next());
         }
     }
 
-    inline void Update(std::shared_ptr<void> &current_val) override {
+    inline void Update(uint32_t group_id) override {
         if (this->array_iter->NextIfNull()) {
             return;
-        } else if (current_val == nullptr) {
-            current_val = std::make_shared<T_OUT>(this->array_iter->Next());
-            return;
         }
 
         auto row_val = this->array_iter->Next();
-        auto last = std::static_pointer_cast<T_OUT>(current_val);
-        *last += row_val;
+        if (this->states.IsValid(group_id)) {
+            this->states[group_id] += row_val;
+        } else {
+            this->states.Set(group_id, row_val);
+        }
     }
 
-    shared_ptr<void> InitBatch() override {
-        return this->Init(0);
+    void InitBatch() override {
+        this->states.AppendNull();
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
-        while (this->array_iter->HasMore()) {
-            this->Update(group);
+    void UpdateBatch(uint32_t group_id) override {
+        if (this->array_iter->NonNullCount() == 0) {
+            return;
+        }
+
+        auto batch_sum = this->template SumArray<T_OUT>();
+        if (this->states.IsValid(group_id)) {
+            this->states[group_id] += batch_sum;
+        } else {
+            this->states.Set(group_id, batch_sum);
+        }
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValue<typename T_IN::c_type>(group_ids, data, [this](uint32_t group_id, T_OUT row_val) {
+            if (this->states.IsValid(group_id)) {
+                this->states[group_id] += row_val;
+            } else {
+                this->states.Set(group_id, row_val);
+            }
+        });
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const SumFunc<T_IN, T_OUT, BUILDER>&>(other).states;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->states.Merge(other_states, other_group_ids[idx], group_ids[idx],
+                               [](T_OUT& sum, const T_OUT& other_sum) {
+                sum += other_sum;
+            });
         }
     }
 
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(aggregate::SerializeStates(this->states, group_ids, num_groups));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        aggregate::DeserializeStates(*columns[col_idx], this->states);
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage();
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        AppendStates<BUILDER>(this->builder, this->states, begin, end);
+    }
+
+protected:
+    StateColumn<T_OUT> states;
 };
 
 template<typename T_IN, typename T_OUT, typename BUILDER>
@@ -324,74 +803,132 @@ public:
 
     using NumericAggFunc<T_IN, T_OUT, BUILDER>::NumericAggFunc;
 
-    std::shared_ptr<void> Init(int row_idx) override {
+    void Init(int row_idx) override {
         if (this->array_iter->NextIfNull()) {
-            return std::shared_ptr<common::hugeint_t>(nullptr);
+            this->states.AppendNull();
         } else {
-            return std::make_shared<common::hugeint_t>(common::Hugeint::Convert<DType>(this->array_iter->Next()));
+            this->states.Append(common::Hugeint::Convert<DType>(this->array_iter->Next()));
         }
     }
 
-    inline void Update(std::shared_ptr<void> &current_val) override {
+    inline void Update(uint32_t group_id) override {
         if (this->array_iter->NextIfNull()) {
             return;
-        } else if (current_val == nullptr) {
-            current_val = std::make_shared<common::hugeint_t>(common::Hugeint::Convert<DType>(this->array_iter->Next()));
-            return;
         }
 
         auto row_val = common::Hugeint::Convert<DType>(this->array_iter->Next());
-        auto last = std::static_pointer_cast<common::hugeint_t>(current_val);
-        *last += row_val;
+        if (this->states.IsValid(group_id)) {
+            this->states[group_id] += row_val;
+        } else {
+            this->states.Set(group_id, row_val);
+        }
     }
 
-    shared_ptr<void> InitBatch() override {
-        return this->Init(0);
+    void InitBatch() override {
+        this->states.AppendNull();
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
-        while (this->array_iter->HasMore()) {
-            this->Update(group);
+    void UpdateBatch(uint32_t group_id) override {
+        if (this->array_iter->NonNullCount() == 0) {
+            return;
+        }
+
+        auto batch_sum = this->template SumArray<common::hugeint_t>();
+        if (this->states.IsValid(group_id)) {
+            this->states[group_id] += batch_sum;
+        } else {
+            this->states.Set(group_id, batch_sum);
         }
     }
 
-    void Summarize(const shared_ptr<void> &current_val) override {
-        if (current_val != nullptr) {
-            auto hugeint_val = std::static_pointer_cast<common::hugeint_t>(current_val);
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
 
-            if (this->is_overflow_mode) {
-                this->overflow_builder_->UnsafeAppend(
-                        this->HugeintToDecimal(*hugeint_val));
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValue<DType>(group_ids, data, [this](uint32_t group_id, DType val) {
+            auto row_val = common::Hugeint::Convert<DType>(val);
+            if (this->states.IsValid(group_id)) {
+                this->states[group_id] += row_val;
             } else {
-                T_OUT int_res;
-                bool cast_ok = common::Hugeint::TryCast<T_OUT>(*hugeint_val, int_res);
+                this->states.Set(group_id, row_val);
+            }
+        });
+    }
 
-                if (cast_ok) {
-                    // Value can be cast to the output type, appending casted value.
-                    this->builder->UnsafeAppend(int_res);
-                } else {
-                    // Sum would overflow on 64 bit types, we need to resort Decimal128.
-                    this->is_overflow_mode = true;
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const SumOverflowFunc<T_IN, T_OUT, BUILDER>&>(other).states;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->states.Merge(other_states, other_group_ids[idx], group_ids[idx],
+                               [](common::hugeint_t& sum, const common::hugeint_t& other_sum) {
+                sum += other_sum;
+            });
+        }
+    }
+
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(aggregate::SerializeStates(this->states, group_ids, num_groups));
+    }
 
-                    // Instantiate new Decimal128Builder
-                    this->overflow_builder_ = std::make_unique<arrow::Decimal128Builder>(
-                            arrow::decimal128(arrow::Decimal128Type::kMaxPrecision, 0)
-                            );
-                    RAISE_ON_ARROW_FAILURE(this->overflow_builder_->Resize(this->builder->capacity()));
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        aggregate::DeserializeStates(*columns[col_idx], this->states);
+        return col_idx + 1;
+    }
 
-                    // Copy values from the current builder
-                    this->CopyBuilder();
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage();
+    }
 
-                    // Append Decimal Value
-                    this->overflow_builder_->UnsafeAppend(
-                            this->HugeintToDecimal(*hugeint_val));
-                }
+    bool IsOverflow() override {
+        T_OUT sum;
+        for (uint32_t group_id = 0, num_groups = this->states.size(); group_id < num_groups; group_id++) {
+            if (this->states.IsValid(group_id) && !common::Hugeint::TryCast<T_OUT>(this->states[group_id], sum)) {
+                return true;
             }
-        } else {
-            if (this->is_overflow_mode) {
-                this->overflow_builder_->UnsafeAppendNull();
+        }
+        return false;
+    }
+
+    void SetOverflowMode() override {
+        this->is_overflow_mode = true;
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        const auto num_groups = end - begin;
+
+        // Sums are cast to the output type, unless at least one of them would overflow,
+        // in which case the entire column is emitted as Decimal128.
+        // When summarized chunk by chunk, the overflow mode must be set upfront, see IsOverflow().
+        std::vector<T_OUT> sums(num_groups);
+        for (uint32_t group_id = begin; group_id < end && !this->is_overflow_mode; group_id++) {
+            if (this->states.IsValid(group_id)
+                    && !common::Hugeint::TryCast<T_OUT>(this->states[group_id], sums[group_id - begin])) {
+                this->is_overflow_mode = true;
+            }
+        }
+
+        if (!this->is_overflow_mode) {
+            RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(
+                    sums.data(), num_groups, this->states.valid_data() + begin));
+            return;
+        }
+
+        if (this->overflow_builder_ == nullptr) {
+            this->overflow_builder_ = std::make_unique<arrow::Decimal128Builder>(
+                    arrow::decimal128(arrow::Decimal128Type::kMaxPrecision, 0), this->pool
+                    );
+        }
+        RAISE_ON_ARROW_FAILURE(this->overflow_builder_->Resize(num_groups));
+        for (uint32_t group_id = begin; group_id < end; group_id++) {
+            if (this->states.IsValid(group_id)) {
+                this->overflow_builder_->UnsafeAppend(this->HugeintToDecimal(this->states[group_id]));
             } else {
-                this->builder->UnsafeAppendNull();
+                this->overflow_builder_->UnsafeAppendNull();
             }
         }
     }
@@ -414,24 +951,16 @@ public:
         return array;
     }
 
+protected:
+    StateColumn<common::hugeint_t> states;
+
 private:
     bool is_overflow_mode = false;
     std::unique_ptr<arrow::Decimal128Builder> overflow_builder_ = nullptr;
 
-    inline arrow::Decimal128 HugeintToDecimal(common::hugeint_t& hugeint) const {
+    inline arrow::Decimal128 HugeintToDecimal(const common::hugeint_t& hugeint) const {
         return arrow::Decimal128{hugeint.upper, hugeint.lower};
     }
-
-    void CopyBuilder() {
-        for (int64_t i = 0, sz = this->builder->length(); i < sz; i++) {
-            if (!this->array_iter->IsNull(i)) {
-                this->overflow_builder_->UnsafeAppend(
-                        arrow::Decimal128{(*this->builder)[i]});
-            } else {
-                this->overflow_builder_->UnsafeAppendNull();
-            }
-        }
-    }
 };
 
 
@@ -444,64 +973,124 @@ public:
 
     using NumericAggFunc<T_IN, T_OUT, BUILDER>::NumericAggFunc;
 
-    std::shared_ptr<void> Init(int row_idx) override {
+    void Init(int row_idx) override {
         if (this->array_iter->NextIfNull()) {
-            return std::shared_ptr<std::shared_ptr<std::pair<T_SUM, uint64_t>>>(nullptr);
+            this->states.emplace_back(T_SUM(0), 0);
         } else {
-            return this->InitPair<DType>(this->array_iter->Next());
+            this->states.push_back(this->InitPair<DType>(this->array_iter->Next()));
         }
     }
 
-    void Update(std::shared_ptr<void> &current_val) override {
+    void Update(uint32_t group_id) override {
         if (this->array_iter->NextIfNull()) {
             return;
-        } else if (current_val == nullptr) {
-            current_val = this->InitPair<DType>(this->array_iter->Next());
-            return;
         }
 
         auto row_val = this->array_iter->Next();
-        auto pair = std::static_pointer_cast<std::pair<T_SUM, uint64_t>>(current_val);
-        this->Add<T_SUM>(pair->first, row_val);
-        pair->second += 1;
+        auto& pair = this->states[group_id];
+        this->Add<T_SUM>(pair.first, row_val);
+        pair.second += 1;
     }
 
-    shared_ptr<void> InitBatch() override {
-        return this->Init(0);
+    void InitBatch() override {
+        this->states.emplace_back(T_SUM(0), 0);
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
-        while (this->array_iter->HasMore()) {
-            this->Update(group);
+    void UpdateBatch(uint32_t group_id) override {
+        auto count = this->array_iter->NonNullCount();
+        if (count == 0) {
+            return;
         }
+
+        auto& pair = this->states[group_id];
+        pair.first += this->template SumArray<T_SUM>();
+        pair.second += count;
     }
 
+    void Resize(uint32_t num_groups) override {
+        this->states.resize(num_groups);
+    }
 
-    void Summarize(const std::shared_ptr<void> &current_val) override {
-        if (current_val != nullptr) {
-            auto pair = std::static_pointer_cast<std::pair<T_SUM, uint64_t>>(current_val);
-            T_OUT val = this->ComputeAvg<T_SUM>(pair->first, pair->second);
-            this->builder->UnsafeAppend(val);
-        } else {
-            this->builder->UnsafeAppendNull();
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValue<DType>(group_ids, data, [this](uint32_t group_id, DType row_val) {
+            auto& pair = this->states[group_id];
+            this->Add<T_SUM>(pair.first, row_val);
+            pair.second += 1;
+        });
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const AvgFunc<T_IN, T_SUM, T_OUT, BUILDER>&>(other).states;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            auto& pair = this->states[group_ids[idx]];
+            const auto& other_pair = other_states[other_group_ids[idx]];
+            pair.first += other_pair.first;
+            pair.second += other_pair.second;
+        }
+    }
+
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        std::vector<T_SUM> sums(num_groups);
+        std::vector<uint64_t> counts(num_groups);
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            const auto& pair = this->states[group_ids[idx]];
+            sums[idx] = pair.first;
+            counts[idx] = pair.second;
+        }
+        columns.push_back(SerializeValues(sums.data(), nullptr, nullptr, num_groups));
+        columns.push_back(SerializeValues(counts.data(), nullptr, nullptr, num_groups));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        std::vector<T_SUM> sums;
+        std::vector<uint64_t> counts;
+        DeserializeValues(*columns[col_idx], sums, nullptr);
+        DeserializeValues(*columns[col_idx + 1], counts, nullptr);
+        this->states.resize(sums.size());
+        for (size_t group_id = 0; group_id < sums.size(); group_id++) {
+            this->states[group_id] = std::make_pair(sums[group_id], counts[group_id]);
         }
+        return col_idx + 2;
     }
 
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.capacity() * sizeof(std::pair<T_SUM, uint64_t>);
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        const auto num_groups = end - begin;
+        std::vector<T_OUT> avgs(num_groups);
+        std::vector<uint8_t> valid(num_groups);
+        for (uint32_t group_id = begin; group_id < end; group_id++) {
+            const auto& pair = this->states[group_id];
+            // Groups that had only NULL values have zero count.
+            if (pair.second > 0) {
+                avgs[group_id - begin] = this->ComputeAvg<T_SUM>(pair.first, pair.second);
+                valid[group_id - begin] = 1;
+            }
+        }
+        RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(avgs.data(), num_groups, valid.data()));
+    }
+
+protected:
+    // (sum, count) pair per group, the group is NULL if count is zero.
+    std::vector<std::pair<T_SUM, uint64_t>> states;
+
 private:
 
     template<typename T>
-    inline std::shared_ptr<std::pair<T_SUM, uint64_t>> InitPair(const T &val) {
-        return std::make_shared<std::pair<T_SUM, uint64_t>>(
-                std::make_pair(val, 1)
-        );
+    inline std::pair<T_SUM, uint64_t> InitPair(const T &val) {
+        return std::make_pair(val, 1);
     }
 
     template<typename T=common::hugeint_t>
-    inline std::shared_ptr<std::pair<common::hugeint_t, uint64_t>> InitPair(const uint64_t &val) {
-        auto sum = common::Hugeint::Convert(val);
-        return std::make_shared<std::pair<common::hugeint_t, uint64_t>>(
-                std::make_pair(sum, 1)
-        );
+    inline std::pair<common::hugeint_t, uint64_t> InitPair(const uint64_t &val) {
+        return std::make_pair(common::Hugeint::Convert(val), 1);
     }
 
     template<typename T>
@@ -541,46 +1130,490 @@ private:
 
 };
 
-template<typename T_IN, typename BUILDER>
-class GroupBuilder : public AggFuncTemplate<T_IN, BUILDER> {
+/**
+ * Exact number of distinct non-null values, with a DistinctSet per group.
+ * T is the value type of the array iterator.
+ */
+template<typename T>
+class CountDistinctFunc : public AggFuncTemplate<uint64_t, arrow::UInt64Builder> {
 
 public:
-    using AggFuncTemplate<T_IN, BUILDER>::AggFuncTemplate;
+    using Key = typename DistinctKey<T>::type;
+
+    CountDistinctFunc() : AggFuncTemplate<uint64_t, arrow::UInt64Builder>::AggFuncTemplate(arrow::uint64()) {}
 
     void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) override {
-        this->array_iter = std::unique_ptr<common::TypedValueArrayIter<T_IN>>{
-                static_cast<common::TypedValueArrayIter<T_IN>*>(iter.release())
+        this->array_iter = std::unique_ptr<common::TypedValueArrayIter<T>>{
+                dynamic_cast<common::TypedValueArrayIter<T>*>(iter.release())
         };
     }
 
-    std::shared_ptr<void> Init(int row_idx) override {
-        if (this->array_iter->IsNull(row_idx)) {
-            return std::shared_ptr<T_IN>(nullptr);
-        } else {
-            return std::make_shared<T_IN>(this->array_iter->GetValue(row_idx));
+    void Init(int row_idx) override {
+        this->sets.emplace_back();
+        this->Update(this->sets.size() - 1);
+    }
+
+    inline void Update(uint32_t group_id) override {
+        if (this->array_iter->NextIfNull()) {
+            return;
         }
+        this->sets_usage += this->sets[group_id].Insert(DistinctKey<T>::Of(this->array_iter->Next()));
     }
 
-    void Update(std::shared_ptr<void> &current_val) override {
-        throw std::runtime_error("Calling Update method of GroupBuilder - assertion error.");
+    void InitBatch() override {
+        this->sets.emplace_back();
     }
 
-    shared_ptr<void> InitBatch() override {
-        throw std::runtime_error("Calling InitBatch method of GroupBuilder - assertion error.");
+    void UpdateBatch(uint32_t group_id) override {
+        while (this->array_iter->HasMore()) {
+            this->Update(group_id);
+        }
     }
 
-    void UpdateBatch(shared_ptr<void> &group) override {
+    void Resize(uint32_t num_groups) override {
+        this->sets.resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        if constexpr (std::is_same_v<T, arrow::util::string_view>) {
+            for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+                this->Update(group_ids[row_idx]);
+            }
+        } else {
+            ForEachValue<T>(group_ids, data, [this](uint32_t group_id, T row_val) {
+                this->sets_usage += this->sets[group_id].Insert(DistinctKey<T>::Of(row_val));
+            });
+        }
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_sets = static_cast<const CountDistinctFunc<T>&>(other).sets;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            auto& set = this->sets[group_ids[idx]];
+            other_sets[other_group_ids[idx]].ForEach([&](const Key& key) {
+                this->sets_usage += set.Insert(key);
+            });
+        }
+    }
+
+    // Keys of a group are serialized as a single Binary value: the raw keys,
+    // or the length-prefixed bytes of the string keys.
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        arrow::BinaryBuilder builder(arrow::default_memory_pool());
+        RAISE_ON_ARROW_FAILURE(builder.Resize(num_groups));
+        std::string bytes;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            bytes.clear();
+            this->sets[group_ids[idx]].ForEach([&](const Key& key) {
+                if constexpr (std::is_same_v<Key, std::string>) {
+                    const auto length = static_cast<uint32_t>(key.size());
+                    bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                    bytes.append(key);
+                } else {
+                    bytes.append(reinterpret_cast<const char*>(&key), sizeof(Key));
+                }
+            });
+            RAISE_ON_ARROW_FAILURE(builder.Append(bytes));
+        }
+        std::shared_ptr<arrow::Array> array;
+        RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+        columns.push_back(array);
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        const auto& binary_array = static_cast<const arrow::BinaryArray&>(*columns[col_idx]);
+        this->sets.clear();
+        this->sets.resize(binary_array.length());
+        this->sets_usage = 0;
+        for (int64_t idx = 0; idx < binary_array.length(); idx++) {
+            const auto view = binary_array.GetView(idx);
+            size_t pos = 0;
+            while (pos < view.size()) {
+                if constexpr (std::is_same_v<Key, std::string>) {
+                    uint32_t length;
+                    std::memcpy(&length, view.data() + pos, sizeof(length));
+                    pos += sizeof(length);
+                    this->sets_usage += this->sets[idx].Insert(view.substr(pos, length));
+                    pos += length;
+                } else {
+                    Key key;
+                    std::memcpy(&key, view.data() + pos, sizeof(Key));
+                    pos += sizeof(Key);
+                    this->sets_usage += this->sets[idx].Insert(key);
+                }
+            }
+        }
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->sets.capacity() * sizeof(DistinctSet<Key>) + this->sets_usage;
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        std::vector<uint64_t> counts(end - begin);
+        for (uint32_t group_id = begin; group_id < end; group_id++) {
+            counts[group_id - begin] = this->sets[group_id].size();
+        }
+        RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(counts.data(), counts.size()));
+    }
+
+private:
+    std::unique_ptr<common::TypedValueArrayIter<T>> array_iter = nullptr;
+    std::vector<DistinctSet<Key>> sets;
+    size_t sets_usage = 0;   // Bytes allocated by the promoted sets and the string keys
+};
+
+
+/**
+ * Approximate number of distinct non-null values, estimated with a HyperLogLog sketch per group.
+ * T is the value type of the array iterator, string-like values are hashed by their bytes.
+ */
+template<typename T>
+class ApproxCountDistinctFunc : public AggFuncTemplate<uint64_t, arrow::UInt64Builder> {
+
+public:
+    ApproxCountDistinctFunc() : AggFuncTemplate<uint64_t, arrow::UInt64Builder>::AggFuncTemplate(arrow::uint64()) {}
+
+    void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) override {
+        this->array_iter = std::unique_ptr<common::TypedValueArrayIter<T>>{
+                dynamic_cast<common::TypedValueArrayIter<T>*>(iter.release())
+        };
+    }
+
+    void Init(int row_idx) override {
+        this->sketches.AppendEmpty();
+        this->Update(this->sketches.size() - 1);
+    }
+
+    inline void Update(uint32_t group_id) override {
+        if (this->array_iter->NextIfNull()) {
+            return;
+        }
+        this->sketches.Add(group_id, SketchHash(this->array_iter->Next()));
+    }
+
+    void InitBatch() override {
+        this->sketches.AppendEmpty();
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        while (this->array_iter->HasMore()) {
+            this->Update(group_id);
+        }
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->sketches.Resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        if constexpr (std::is_same_v<T, arrow::util::string_view>) {
+            for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+                this->Update(group_ids[row_idx]);
+            }
+        } else {
+            ForEachValue<T>(group_ids, data, [this](uint32_t group_id, T row_val) {
+                this->sketches.Add(group_id, SketchHash(row_val));
+            });
+        }
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_sketches = static_cast<const ApproxCountDistinctFunc<T>&>(other).sketches;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->sketches.Merge(other_sketches, other_group_ids[idx], group_ids[idx]);
+        }
+    }
+
+    // Registers of a group are serialized as a single FixedSizeBinary value.
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        arrow::FixedSizeBinaryBuilder builder(arrow::fixed_size_binary(HyperLogLogColumn::NUM_REGISTERS),
+                                              arrow::default_memory_pool());
+        RAISE_ON_ARROW_FAILURE(builder.Resize(num_groups));
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            builder.UnsafeAppend(this->sketches.Registers(group_ids[idx]));
+        }
+        std::shared_ptr<arrow::Array> array;
+        RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+        columns.push_back(array);
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        const auto& binary_array = static_cast<const arrow::FixedSizeBinaryArray&>(*columns[col_idx]);
+        this->sketches = HyperLogLogColumn();
+        this->sketches.Resize(binary_array.length());
+        for (int64_t idx = 0; idx < binary_array.length(); idx++) {
+            std::memcpy(this->sketches.Registers(idx), binary_array.GetValue(idx), HyperLogLogColumn::NUM_REGISTERS);
+        }
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->sketches.MemoryUsage();
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        std::vector<uint64_t> estimates(end - begin);
+        for (uint32_t group_id = begin; group_id < end; group_id++) {
+            estimates[group_id - begin] = this->sketches.Estimate(group_id);
+        }
+        RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(estimates.data(), estimates.size()));
+    }
+
+private:
+    std::unique_ptr<common::TypedValueArrayIter<T>> array_iter = nullptr;
+    HyperLogLogColumn sketches;
+};
+
+
+/**
+ * Approximate percentile of the numeric values, estimated with a t-digest per group.
+ * Groups without non-null values are NULL.
+ */
+template<typename T_IN>
+class ApproxPercentileFunc : public NumericAggFunc<T_IN, double_t, arrow::DoubleBuilder> {
+
+public:
+    using DType = typename T_IN::c_type;
+
+    explicit ApproxPercentileFunc(double quantile)
+            : NumericAggFunc<T_IN, double_t, arrow::DoubleBuilder>(arrow::float64()), quantile(quantile) {
+        if (!(quantile >= 0 && quantile <= 1)) {
+            throw std::runtime_error("Percentile must be between 0 and 1: " + std::to_string(quantile));
+        }
+    }
+
+    void Init(int row_idx) override {
+        this->digests.emplace_back();
+        this->Update(this->digests.size() - 1);
+    }
+
+    inline void Update(uint32_t group_id) override {
+        if (this->array_iter->NextIfNull()) {
+            return;
+        }
+        this->AddValue(group_id, this->array_iter->Next());
+    }
+
+    void InitBatch() override {
+        this->digests.emplace_back();
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        while (this->array_iter->HasMore()) {
+            this->Update(group_id);
+        }
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->digests.resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValue<DType>(group_ids, data, [this](uint32_t group_id, DType row_val) {
+            this->AddValue(group_id, row_val);
+        });
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_digests = static_cast<const ApproxPercentileFunc<T_IN>&>(other).digests;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            auto& digest = this->digests[group_ids[idx]];
+            const size_t digest_usage = digest.MemoryUsage();
+            digest.Merge(other_digests[other_group_ids[idx]]);
+            this->digests_usage += digest.MemoryUsage() - digest_usage;
+        }
+    }
+
+    // A digest is serialized as a Binary value of doubles: min, max, then mean and weight of
+    // every centroid. Empty digests are NULL.
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        arrow::BinaryBuilder builder(arrow::default_memory_pool());
+        RAISE_ON_ARROW_FAILURE(builder.Resize(num_groups));
+        std::vector<double> values;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            // Compressing does not change the quantiles, the serialized digest has no buffer.
+            auto digest = this->digests[group_ids[idx]];
+            if (digest.IsEmpty()) {
+                builder.UnsafeAppendNull();
+                continue;
+            }
+            digest.Compress();
+            values.assign({digest.Min(), digest.Max()});
+            for (const auto& centroid : digest.Centroids()) {
+                values.push_back(centroid.mean);
+                values.push_back(centroid.weight);
+            }
+            RAISE_ON_ARROW_FAILURE(builder.Append(reinterpret_cast<const uint8_t*>(values.data()),
+                                                  values.size() * sizeof(double)));
+        }
+        std::shared_ptr<arrow::Array> array;
+        RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+        columns.push_back(array);
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        const auto& binary_array = static_cast<const arrow::BinaryArray&>(*columns[col_idx]);
+        this->digests.assign(binary_array.length(), TDigest());
+        this->digests_usage = 0;
+        std::vector<double> values;
+        for (int64_t idx = 0; idx < binary_array.length(); idx++) {
+            if (binary_array.IsNull(idx)) {
+                continue;
+            }
+            const auto view = binary_array.GetView(idx);
+            values.resize(view.size() / sizeof(double));
+            std::memcpy(values.data(), view.data(), values.size() * sizeof(double));
+            this->digests[idx].Assign(reinterpret_cast<const TDigest::Centroid*>(values.data() + 2),
+                                      (values.size() - 2) / 2, values[0], values[1]);
+            this->digests_usage += this->digests[idx].MemoryUsage();
+        }
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->digests.capacity() * sizeof(TDigest) + this->digests_usage;
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        const auto num_groups = end - begin;
+        std::vector<double> percentiles(num_groups);
+        std::vector<uint8_t> valid(num_groups);
+        for (uint32_t group_id = begin; group_id < end; group_id++) {
+            auto& digest = this->digests[group_id];
+            if (!digest.IsEmpty()) {
+                percentiles[group_id - begin] = digest.Quantile(this->quantile);
+                valid[group_id - begin] = 1;
+            }
+        }
+        RAISE_ON_ARROW_FAILURE(this->builder->AppendValues(percentiles.data(), num_groups, valid.data()));
+    }
+
+private:
+    const double quantile;
+    std::vector<TDigest> digests;
+    size_t digests_usage = 0;   // Bytes allocated by the digests, maintained on every update
+
+    // NaNs have no order, they are skipped so that the digest stays sorted by the means.
+    inline void AddValue(uint32_t group_id, DType val) {
+        if constexpr (std::is_floating_point_v<DType>) {
+            if (std::isnan(val)) {
+                return;
+            }
+        }
+        auto& digest = this->digests[group_id];
+        const size_t digest_usage = digest.MemoryUsage();
+        digest.Add(static_cast<double>(val));
+        this->digests_usage += digest.MemoryUsage() - digest_usage;
+    }
+};
+
+template<typename T_IN, typename BUILDER, typename T_STATE = typename StateType<T_IN>::type>
+class GroupBuilder : public AggFuncTemplate<T_IN, BUILDER> {
+
+public:
+    using AggFuncTemplate<T_IN, BUILDER>::AggFuncTemplate;
+
+    void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) override {
+        this->array_iter = std::unique_ptr<common::TypedValueArrayIter<T_IN>>{
+                static_cast<common::TypedValueArrayIter<T_IN>*>(iter.release())
+        };
+    }
+
+    void Init(int row_idx) override {
+        if (this->array_iter->IsNull(row_idx)) {
+            this->states.AppendNull();
+        } else {
+            this->states.Append(T_STATE(this->array_iter->GetValue(row_idx)));
+        }
+    }
+
+    void Update(uint32_t group_id) override {
+        throw std::runtime_error("Calling Update method of GroupBuilder - assertion error.");
+    }
+
+    void InitBatch() override {
+        throw std::runtime_error("Calling InitBatch method of GroupBuilder - assertion error.");
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
         throw std::runtime_error("Calling UpdateBatch method of GroupBuilder - assertion error.");
     }
 
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
+
+    // Key of the group is the same for all its rows, so it is enough to take the first non-null value.
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        ForEachValue<T_IN>(group_ids, data, [this](uint32_t group_id, T_IN row_val) {
+            if (!this->states.IsValid(group_id)) {
+                this->states.Set(group_id, T_STATE(row_val));
+            }
+        });
+    }
+
+    // Merged groups have equal keys, so the key is taken from whichever state is non-null.
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const GroupBuilder<T_IN, BUILDER, T_STATE>&>(other).states;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            this->states.Merge(other_states, other_group_ids[idx], group_ids[idx],
+                               [](T_STATE&, const T_STATE&) {});
+        }
+    }
+
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(aggregate::SerializeStates(this->states, group_ids, num_groups));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        aggregate::DeserializeStates(*columns[col_idx], this->states);
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage();
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        AppendStates<BUILDER>(this->builder, this->states, begin, end);
+    }
+
+protected:
+    StateColumn<T_STATE> states;
+
 private:
     std::unique_ptr<common::TypedValueArrayIter<T_IN>> array_iter = nullptr;
 };
 
+/**
+ * Group builder of the string-like types, keys are kept in a StringStateColumn.
+ */
 template<typename ARRAY, typename BUILDER>
-class StringGroupBuilder : public GroupBuilder<arrow::util::string_view, BUILDER> {
+class StringGroupBuilder : public AggFuncTemplate<std::string, BUILDER> {
 public:
-    using GroupBuilder<arrow::util::string_view, BUILDER>::GroupBuilder;
+    using AggFuncTemplate<std::string, BUILDER>::AggFuncTemplate;
 
     void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) override {
         this->array_iter = std::unique_ptr<common::StringArrayIter<ARRAY>>{
@@ -588,26 +1621,341 @@ public:
         };
     }
 
-
-    std::shared_ptr<void> Init(int row_idx) override {
+    void Init(int row_idx) override {
         if (this->array_iter->IsNull(row_idx)) {
-            return std::shared_ptr<std::string>(nullptr);
+            this->states.AppendNull();
         } else {
-            return std::make_shared<std::string>(this->array_iter->GetString(row_idx));
+            this->states.Append(this->array_iter->GetValue(row_idx));
         }
     }
 
-    void Summarize(const std::shared_ptr<void>& current_val) override {
-        if (current_val != nullptr) {
-            auto val = std::static_pointer_cast<std::string>(current_val);
-            ::vinum::operators::aggregate::AppendToBuilder<BUILDER, std::string>(this->builder, val);
-        } else {
-            this->builder->UnsafeAppendNull();
+    void Update(uint32_t group_id) override {
+        throw std::runtime_error("Calling Update method of GroupBuilder - assertion error.");
+    }
+
+    void InitBatch() override {
+        throw std::runtime_error("Calling InitBatch method of GroupBuilder - assertion error.");
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        throw std::runtime_error("Calling UpdateBatch method of GroupBuilder - assertion error.");
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            auto group_id = group_ids[row_idx];
+            if (!this->states.IsValid(group_id) && !this->array_iter->IsNull(row_idx)) {
+                this->states.Set(group_id, this->array_iter->GetValue(row_idx));
+            }
         }
     }
 
+    // Merged groups have equal keys, so the key is taken from whichever state is non-null.
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_states = static_cast<const StringGroupBuilder<ARRAY, BUILDER>&>(other).states;
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            if (!this->states.IsValid(group_ids[idx]) && other_states.IsValid(other_group_ids[idx])) {
+                this->states.Set(group_ids[idx], other_states[other_group_ids[idx]]);
+            }
+        }
+    }
+
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(aggregate::SerializeStates(this->states, group_ids, num_groups));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        aggregate::DeserializeStates(*columns[col_idx], this->states);
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage();
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        AppendStates<BUILDER>(this->builder, this->states, begin, end);
+    }
+
 private:
     std::unique_ptr<common::StringArrayIter<ARRAY>> array_iter = nullptr;
+    StringStateColumn states;
+};
+
+/**
+ * Group builder of a dictionary encoded column.
+ * Groups keep the dictionary index of their key, the keys are decoded
+ * into the dictionary value type with a single Take() in Summarize().
+ */
+class DictionaryGroupBuilder : public AbstractAggFunc {
+
+public:
+    explicit DictionaryGroupBuilder(const std::shared_ptr<arrow::DataType>& value_type)
+            : value_type(value_type) {}
+
+    void SetArrayIter(std::unique_ptr<common::ArrayIter> iter) override {
+        this->array_iter = std::unique_ptr<common::DictionaryArrayIter>{
+                static_cast<common::DictionaryArrayIter*>(iter.release())
+        };
+        this->current_dict_id = this->AddDictionary(this->array_iter->Dictionary());
+    }
+
+    void Init(int row_idx) override {
+        if (this->array_iter->IsNull(row_idx)) {
+            this->states.AppendNull();
+        } else {
+            this->states.Append(DictValueRef{this->current_dict_id, this->array_iter->GetValue(row_idx)});
+        }
+    }
+
+    void Update(uint32_t group_id) override {
+        throw std::runtime_error("Calling Update method of DictionaryGroupBuilder - assertion error.");
+    }
+
+    void InitBatch() override {
+        throw std::runtime_error("Calling InitBatch method of DictionaryGroupBuilder - assertion error.");
+    }
+
+    void UpdateBatch(uint32_t group_id) override {
+        throw std::runtime_error("Calling UpdateBatch method of DictionaryGroupBuilder - assertion error.");
+    }
+
+    void Resize(uint32_t num_groups) override {
+        this->states.Resize(num_groups);
+    }
+
+    void UpdateBatch(const uint32_t* group_ids, const arrow::ArrayData& data) override {
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            auto group_id = group_ids[row_idx];
+            if (!this->states.IsValid(group_id) && !this->array_iter->IsNull(row_idx)) {
+                this->states.Set(group_id, DictValueRef{this->current_dict_id, this->array_iter->GetValue(row_idx)});
+            }
+        }
+    }
+
+    void Merge(const AbstractAggFunc& other,
+               const uint32_t* other_group_ids,
+               const uint32_t* group_ids,
+               size_t num_groups) override {
+        const auto& other_builder = static_cast<const DictionaryGroupBuilder&>(other);
+        std::vector<uint32_t> dict_ids;
+        for (const auto& dictionary : other_builder.dictionaries) {
+            dict_ids.push_back(this->AddDictionary(dictionary));
+        }
+
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            auto other_group_id = other_group_ids[idx];
+            if (!this->states.IsValid(group_ids[idx]) && other_builder.states.IsValid(other_group_id)) {
+                const auto& ref = other_builder.states[other_group_id];
+                this->states.Set(group_ids[idx], DictValueRef{dict_ids[ref.dict_id], ref.index});
+            }
+        }
+    }
+
+    // Keys are serialized decoded, so that the spilled states do not depend on the dictionaries.
+    void SerializeStates(const uint32_t* group_ids,
+                         size_t num_groups,
+                         std::vector<std::shared_ptr<arrow::Array>>& columns) const override {
+        columns.push_back(this->Decode(group_ids, num_groups, arrow::default_memory_pool()));
+    }
+
+    size_t DeserializeStates(const std::vector<std::shared_ptr<arrow::Array>>& columns, size_t col_idx) override {
+        const auto& values = columns[col_idx];
+        this->ClearDictionaries();
+        this->AddDictionary(values);
+        this->states = StateColumn<DictValueRef>();
+        for (int64_t idx = 0; idx < values->length(); idx++) {
+            if (values->IsValid(idx)) {
+                this->states.Append(DictValueRef{0, idx});
+            } else {
+                this->states.AppendNull();
+            }
+        }
+        return col_idx + 1;
+    }
+
+    [[nodiscard]] size_t MemoryUsage() const override {
+        return this->states.MemoryUsage() + this->dictionaries_usage
+               + (this->concatenated != nullptr ? ArrayBytes(*this->concatenated) : 0);
+    }
+
+    void Summarize(uint32_t begin, uint32_t end) override {
+        std::vector<uint32_t> group_ids(end - begin);
+        for (uint32_t idx = 0; idx < group_ids.size(); idx++) {
+            group_ids[idx] = begin + idx;
+        }
+        this->result = this->Decode(group_ids.data(), group_ids.size(), this->pool);
+    }
+
+    std::shared_ptr<arrow::Array> Result() override {
+        return this->result;
+    }
+
+    std::shared_ptr<arrow::DataType> DataType() override {
+        return this->value_type;
+    }
+
+private:
+    struct DictValueRef {
+        uint32_t dict_id;   // Index in dictionaries
+        int64_t index;      // Index in the dictionary
+    };
+
+    const std::shared_ptr<arrow::DataType> value_type;
+    std::unique_ptr<common::DictionaryArrayIter> array_iter = nullptr;
+
+    // Distinct dictionaries seen so far, batches usually share the same dictionary.
+    std::vector<std::shared_ptr<arrow::Array>> dictionaries;
+    robin_hood::unordered_map<uint64_t, std::vector<uint32_t>> dict_ids_by_hash;
+    size_t dictionaries_usage = 0;
+    uint32_t current_dict_id = 0;
+
+    // Concatenation of the dictionaries and the offset of every dictionary in it, only the dictionaries
+    // added since the previous Decode() are appended.
+    mutable std::shared_ptr<arrow::Array> concatenated = nullptr;
+    mutable std::vector<int64_t> dict_offsets;
+
+    StateColumn<DictValueRef> states;
+    std::shared_ptr<arrow::Array> result = nullptr;
+
+    // Keys of group_ids decoded into the value type.
+    std::shared_ptr<arrow::Array> Decode(const uint32_t* group_ids, size_t num_groups, arrow::MemoryPool* pool) const {
+        if (this->dictionaries.empty()) {
+            auto nulls_res = arrow::MakeArrayOfNull(this->value_type, num_groups, pool);
+            RAISE_ON_ARROW_FAILURE(nulls_res.status());
+            return nulls_res.ValueOrDie();
+        }
+
+        // All the dictionaries are concatenated, so that the keys are decoded with a single Take().
+        std::shared_ptr<arrow::Array> values = this->dictionaries[0];
+        if (this->dict_offsets.empty()) {
+            this->dict_offsets.push_back(0);
+        }
+        if (this->dictionaries.size() > 1) {
+            const size_t num_concatenated = this->dict_offsets.size() - 1;
+            if (num_concatenated < this->dictionaries.size()) {
+                arrow::ArrayVector to_concat;
+                if (this->concatenated != nullptr) {
+                    to_concat.push_back(this->concatenated);
+                }
+                for (size_t dict_id = num_concatenated; dict_id < this->dictionaries.size(); dict_id++) {
+                    to_concat.push_back(this->dictionaries[dict_id]);
+                    this->dict_offsets.push_back(this->dict_offsets.back() + this->dictionaries[dict_id]->length());
+                }
+                auto concat_res = arrow::Concatenate(to_concat, pool);
+                RAISE_ON_ARROW_FAILURE(concat_res.status());
+                this->concatenated = concat_res.ValueOrDie();
+            }
+            values = this->concatenated;
+        }
+
+        arrow::Int64Builder indices_builder(pool);
+        RAISE_ON_ARROW_FAILURE(indices_builder.Resize(num_groups));
+        for (size_t idx = 0; idx < num_groups; idx++) {
+            const auto group_id = group_ids[idx];
+            if (this->states.IsValid(group_id)) {
+                const auto& ref = this->states[group_id];
+                indices_builder.UnsafeAppend(this->dict_offsets[ref.dict_id] + ref.index);
+            } else {
+                indices_builder.UnsafeAppendNull();
+            }
+        }
+        std::shared_ptr<arrow::Array> indices;
+        RAISE_ON_ARROW_FAILURE(indices_builder.Finish(&indices));
+
+        arrow::compute::ExecContext ctx(pool);
+        auto take_res = arrow::compute::Take(*values, *indices, arrow::compute::TakeOptions::Defaults(), &ctx);
+        RAISE_ON_ARROW_FAILURE(take_res.status());
+        return take_res.ValueOrDie();
+    }
+
+    // Id of the dictionary, the dictionary of the previous batch is checked first, then only
+    // the known dictionaries with the same hash are compared.
+    uint32_t AddDictionary(const std::shared_ptr<arrow::Array>& dictionary) {
+        if (this->current_dict_id < this->dictionaries.size()
+                && this->dictionaries[this->current_dict_id] == dictionary) {
+            return this->current_dict_id;
+        }
+        auto& dict_ids = this->dict_ids_by_hash[DictionaryHash(*dictionary)];
+        for (const auto dict_id : dict_ids) {
+            const auto& known = this->dictionaries[dict_id];
+            if (known == dictionary || known->Equals(*dictionary)) {
+                return dict_id;
+            }
+        }
+        const auto dict_id = static_cast<uint32_t>(this->dictionaries.size());
+        dict_ids.push_back(dict_id);
+        this->dictionaries.push_back(dictionary);
+        this->dictionaries_usage += ArrayBytes(*dictionary);
+        return dict_id;
+    }
+
+    void ClearDictionaries() {
+        this->dictionaries.clear();
+        this->dict_ids_by_hash.clear();
+        this->dictionaries_usage = 0;
+        this->current_dict_id = 0;
+        this->concatenated = nullptr;
+        this->dict_offsets.clear();
+    }
+
+    // Hash of the values of a dictionary. Equal dictionaries of the fixed width and the binary types hash
+    // the same, the dictionaries of the other types are only told apart by their length.
+    static uint64_t DictionaryHash(const arrow::Array& dictionary) {
+        const auto& data = *dictionary.data();
+        const uint64_t length_hash = robin_hood::hash<int64_t>{}(data.length);
+        const uint8_t* values = nullptr;
+        size_t values_size = 0;
+        switch (data.type->id()) {
+            case arrow::Type::STRING:
+            case arrow::Type::BINARY: {
+                const auto* offsets = data.GetValues<int32_t>(1);
+                values = data.buffers[2] != nullptr ? data.buffers[2]->data() + offsets[0] : nullptr;
+                values_size = offsets[data.length] - offsets[0];
+                break;
+            }
+            case arrow::Type::LARGE_STRING:
+            case arrow::Type::LARGE_BINARY: {
+                const auto* offsets = data.GetValues<int64_t>(1);
+                values = data.buffers[2] != nullptr ? data.buffers[2]->data() + offsets[0] : nullptr;
+                values_size = offsets[data.length] - offsets[0];
+                break;
+            }
+            default:
+                if (arrow::is_fixed_width(data.type->id()) && data.buffers[1] != nullptr) {
+                    const auto bit_width = static_cast<const arrow::FixedWidthType&>(*data.type).bit_width();
+                    if (bit_width % 8 == 0) {
+                        values = data.buffers[1]->data() + data.offset * (bit_width / 8);
+                        values_size = data.length * (bit_width / 8);
+                    }
+                }
+                break;
+        }
+        if (values == nullptr || values_size == 0) {
+            return length_hash;
+        }
+        return length_hash ^ robin_hood::hash_bytes(values, values_size);
+    }
+
+    // Bytes of the buffers of an array, dictionaries are kept whole.
+    static size_t ArrayBytes(const arrow::Array& array) {
+        size_t bytes = 0;
+        for (const auto& buffer : array.data()->buffers) {
+            if (buffer != nullptr) {
+                bytes += buffer->size();
+            }
+        }
+        return bytes;
+    }
 };
 
 }  // namespace vinum::operators::aggregate
@@ -0,0 +1,405 @@
+#pragma once
+
+#include "common/robin_hood.h"
+
+#include <arrow/api.h>
+#include <arrow/util/string_view.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace vinum::operators::aggregate {
+
+/**
+ * Columnar storage of a per-group aggregate state.
+ *
+ * Values of all groups are kept in a single contiguous vector, indexed by the dense group id
+ * assigned by the aggregate operator. `valid` holds one validity flag per group, which
+ * allows the whole column to be copied into an Arrow builder with a single AppendValues() call.
+ */
+template<typename T>
+class StateColumn {
+public:
+    inline void Append(const T& val) {
+        values.push_back(val);
+        valid.push_back(1);
+    }
+
+    inline void AppendNull() {
+        values.emplace_back();
+        valid.push_back(0);
+    }
+
+    // Grow the column to num_groups, new groups are NULL.
+    inline void Resize(uint32_t num_groups) {
+        values.resize(num_groups);
+        valid.resize(num_groups, 0);
+    }
+
+    inline void Set(uint32_t group_id, const T& val) {
+        values[group_id] = val;
+        valid[group_id] = 1;
+    }
+
+    // Merge the state of other_group_id of another column into group_id,
+    // combine(state, other_state) is called only if both states are non-null.
+    template<typename COMBINE>
+    inline void Merge(const StateColumn<T>& other, uint32_t other_group_id, uint32_t group_id, COMBINE combine) {
+        if (!other.IsValid(other_group_id)) {
+            return;
+        }
+        if (IsValid(group_id)) {
+            combine(values[group_id], other[other_group_id]);
+        } else {
+            Set(group_id, other[other_group_id]);
+        }
+    }
+
+    [[nodiscard]] inline bool IsValid(uint32_t group_id) const {
+        return valid[group_id];
+    }
+
+    inline T& operator[](uint32_t group_id) {
+        return values[group_id];
+    }
+
+    inline const T& operator[](uint32_t group_id) const {
+        return values[group_id];
+    }
+
+    [[nodiscard]] inline size_t size() const {
+        return values.size();
+    }
+
+    [[nodiscard]] inline const T* data() const {
+        return values.data();
+    }
+
+    [[nodiscard]] inline const uint8_t* valid_data() const {
+        return valid.data();
+    }
+
+    [[nodiscard]] inline size_t MemoryUsage() const {
+        return values.capacity() * sizeof(T) + valid.capacity();
+    }
+
+private:
+    std::vector<T> values;
+    std::vector<uint8_t> valid;
+};
+
+/**
+ * Columnar storage of a per-group string state.
+ *
+ * Bytes of all the values are kept in a single contiguous buffer, groups hold the offset
+ * and the length of their value, so that new groups do not allocate a string each.
+ * A value which does not fit the space of the previous value of the group is appended
+ * to the end of the buffer, the buffer is compacted once most of it is no longer referenced.
+ * Views returned by operator[] are invalidated by Append() and Set().
+ */
+class StringStateColumn {
+public:
+    inline void Append(arrow::util::string_view val) {
+        slots.push_back(Slot{this->CopyBytes(val), static_cast<uint32_t>(val.size())});
+        valid.push_back(1);
+    }
+
+    inline void AppendNull() {
+        slots.push_back(Slot{0, 0});
+        valid.push_back(0);
+    }
+
+    // Grow the column to num_groups, new groups are NULL.
+    inline void Resize(uint32_t num_groups) {
+        slots.resize(num_groups, Slot{0, 0});
+        valid.resize(num_groups, 0);
+    }
+
+    inline void Set(uint32_t group_id, arrow::util::string_view val) {
+        auto& slot = slots[group_id];
+        if (valid[group_id] && val.size() <= slot.length) {
+            std::memcpy(bytes.data() + slot.offset, val.data(), val.size());
+            unused_bytes += slot.length - val.size();
+        } else {
+            if (valid[group_id]) {
+                unused_bytes += slot.length;
+            }
+            slot.offset = this->CopyBytes(val);
+        }
+        slot.length = static_cast<uint32_t>(val.size());
+        valid[group_id] = 1;
+
+        if (unused_bytes > COMPACT_MIN_BYTES && unused_bytes > bytes.size() / 2) {
+            this->Compact();
+        }
+    }
+
+    [[nodiscard]] inline bool IsValid(uint32_t group_id) const {
+        return valid[group_id];
+    }
+
+    inline arrow::util::string_view operator[](uint32_t group_id) const {
+        const auto& slot = slots[group_id];
+        return arrow::util::string_view(bytes.data() + slot.offset, slot.length);
+    }
+
+    [[nodiscard]] inline size_t size() const {
+        return slots.size();
+    }
+
+    // Total length of the valid values of the groups [begin, end).
+    [[nodiscard]] inline size_t DataLength(uint32_t begin, uint32_t end) const {
+        size_t length = 0;
+        for (uint32_t group_id = begin; group_id < end; group_id++) {
+            length += valid[group_id] ? slots[group_id].length : 0;
+        }
+        return length;
+    }
+
+    [[nodiscard]] inline size_t MemoryUsage() const {
+        return slots.capacity() * sizeof(Slot) + valid.capacity() + bytes.capacity();
+    }
+
+private:
+    static constexpr size_t COMPACT_MIN_BYTES = 1 << 20;
+
+    struct Slot {
+        uint64_t offset;
+        uint32_t length;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint8_t> valid;
+    std::vector<char> bytes;
+    size_t unused_bytes = 0;    // Bytes of the buffer no longer referenced by any group
+
+    inline uint64_t CopyBytes(arrow::util::string_view val) {
+        const uint64_t offset = bytes.size();
+        bytes.insert(bytes.end(), val.data(), val.data() + val.size());
+        return offset;
+    }
+
+    // Copy the values of all the groups into a new buffer, dropping the unreferenced bytes.
+    void Compact() {
+        std::vector<char> compacted;
+        compacted.reserve(bytes.size() - unused_bytes);
+        for (uint32_t group_id = 0; group_id < slots.size(); group_id++) {
+            if (valid[group_id]) {
+                auto& slot = slots[group_id];
+                const uint64_t offset = compacted.size();
+                compacted.insert(compacted.end(), bytes.data() + slot.offset, bytes.data() + slot.offset + slot.length);
+                slot.offset = offset;
+            }
+        }
+        bytes = std::move(compacted);
+        unused_bytes = 0;
+    }
+};
+
+/**
+ * Type of the state value for the input c_type T.
+ * Booleans are stored as bytes, so that the state column is addressable and
+ * can be passed to BooleanBuilder::AppendValues() as is.
+ */
+template<typename T>
+struct StateType {
+    using type = T;
+};
+
+template<>
+struct StateType<bool> {
+    using type = uint8_t;
+};
+
+/**
+ * Key of the input c_type T in a DistinctSet, and the conversion of a value to its key.
+ * Floats are keyed by their bit pattern, with the signed zeros and all the NaNs normalized,
+ * so that the keys are equal exactly when the values are the same SQL value.
+ * String-like values are looked up by their view and copied only when inserted.
+ */
+template<typename T>
+struct DistinctKey {
+    using type = T;
+
+    static inline T Of(T val) {
+        return val;
+    }
+};
+
+template<typename T, typename T_BITS>
+struct FloatDistinctKey {
+    using type = T_BITS;
+
+    static inline T_BITS Of(T val) {
+        if (std::isnan(val)) {
+            val = std::numeric_limits<T>::quiet_NaN();
+        } else if (val == 0) {
+            val = 0;
+        }
+        T_BITS bits;
+        std::memcpy(&bits, &val, sizeof(T));
+        return bits;
+    }
+};
+
+template<>
+struct DistinctKey<float> : FloatDistinctKey<float, uint32_t> {};
+
+template<>
+struct DistinctKey<double> : FloatDistinctKey<double, uint64_t> {};
+
+template<>
+struct DistinctKey<arrow::DayTimeIntervalType::DayMilliseconds> {
+    using type = uint64_t;
+
+    static inline uint64_t Of(arrow::DayTimeIntervalType::DayMilliseconds val) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(val.days)) << 32)
+                | static_cast<uint32_t>(val.milliseconds);
+    }
+};
+
+template<>
+struct DistinctKey<arrow::util::string_view> {
+    using type = std::string;
+
+    static inline arrow::util::string_view Of(arrow::util::string_view val) {
+        return val;
+    }
+};
+
+// Hash and equality of the string keys of a DistinctSet, also of their views, so that a duplicate
+// is found without copying it into a key.
+struct StringKeyHash {
+    using is_transparent = void;
+
+    template<typename V>
+    size_t operator()(const V& val) const noexcept {
+        return robin_hood::hash_bytes(val.data(), val.size());
+    }
+};
+
+struct StringKeyEqual {
+    using is_transparent = void;
+
+    template<typename A, typename B>
+    bool operator()(const A& lhs, const B& rhs) const noexcept {
+        return arrow::util::string_view(lhs.data(), lhs.size()) == arrow::util::string_view(rhs.data(), rhs.size());
+    }
+};
+
+/**
+ * Set of the distinct values of a group.
+ *
+ * The first INLINE_SIZE values are kept in an inline array and compared linearly,
+ * the set is promoted to a robin_hood::unordered_flat_set once it grows beyond,
+ * so that the groups with only a few distinct values do not allocate a hash table.
+ */
+template<typename T>
+class DistinctSet {
+public:
+    static constexpr uint32_t INLINE_SIZE = 4;
+
+    // Insert the key, or the view of a string key, returns the number of bytes allocated.
+    template<typename V>
+    size_t Insert(const V& val) {
+        size_t set_usage = 0;
+        if (!this->set) {
+            for (uint32_t idx = 0; idx < this->num_inline; idx++) {
+                if (KeyEquals(this->inline_values[idx], val)) {
+                    return 0;
+                }
+            }
+            if (this->num_inline < INLINE_SIZE) {
+                this->inline_values[this->num_inline++] = ToKey(val);
+                return KeyBytes(val);
+            }
+            // The value is not among the promoted ones, the whole table is allocated by this insert.
+            this->Promote();
+        } else {
+            // String keys are copied only on insert, duplicates are found by their view.
+            if (this->set->contains(val)) {
+                return 0;
+            }
+            set_usage = this->SetMemoryUsage();
+        }
+
+        this->set->emplace(ToKey(val));
+        return this->SetMemoryUsage() - set_usage + KeyBytes(val);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return this->set ? this->set->size() : this->num_inline;
+    }
+
+    template<typename FUNC>
+    void ForEach(FUNC&& func) const {
+        if (this->set) {
+            for (const auto& key : *this->set) {
+                func(key);
+            }
+        } else {
+            for (uint32_t idx = 0; idx < this->num_inline; idx++) {
+                func(this->inline_values[idx]);
+            }
+        }
+    }
+
+private:
+    using Set = std::conditional_t<std::is_same_v<T, std::string>,
+                                   robin_hood::unordered_flat_set<T, StringKeyHash, StringKeyEqual>,
+                                   robin_hood::unordered_flat_set<T>>;
+
+    std::array<T, INLINE_SIZE> inline_values {};
+    uint32_t num_inline = 0;
+    std::unique_ptr<Set> set = nullptr;
+
+    void Promote() {
+        this->set = std::make_unique<Set>();
+        for (uint32_t idx = 0; idx < this->num_inline; idx++) {
+            this->set->emplace(std::move(this->inline_values[idx]));
+        }
+        this->inline_values = {};
+        this->num_inline = 0;
+    }
+
+    [[nodiscard]] size_t SetMemoryUsage() const {
+        return (this->set->mask() + 1) * (sizeof(T) + 1);
+    }
+
+    static inline bool KeyEquals(const T& key, const T& val) {
+        return key == val;
+    }
+
+    static inline bool KeyEquals(const std::string& key, arrow::util::string_view val) {
+        return arrow::util::string_view(key.data(), key.size()) == val;
+    }
+
+    static inline const T& ToKey(const T& val) {
+        return val;
+    }
+
+    static inline std::string ToKey(arrow::util::string_view val) {
+        return std::string(val.data(), val.size());
+    }
+
+    // Bytes of a string key, beyond the set itself.
+    template<typename V>
+    static inline size_t KeyBytes(const V& val) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return val.size();
+        } else {
+            return 0;
+        }
+    }
+};
+
+}  // namespace vinum::operators::aggregate
@@ -1,9 +1,13 @@
 #include "base_aggregate.h"
 #include "agg_func_factory.h"
 #include "agg_funcs.h"
+#include "operators/filter/selection.h"
+#include "common/timer.h"
 
 #include <arrow/api.h>
 
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,31 +25,203 @@ BaseAggregate::BaseAggregate(const std::vector<std::string>& groupby_cols,
 BaseAggregate::~BaseAggregate() = default;
 
 void BaseAggregate::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
-    this->EnsureInitAggFuncs(batch->schema());
-    this->SetBatchArrays(batch);
+    {
+        common::ScopedTimer timer(this->stats.update_nanos);
+        this->EnsureInitAggFuncs(batch->schema());
+        this->SetBatchArrays(batch);
 
+        if (this->is_vectorized) {
+            this->UpdateGroupsVectorized(batch);
+        } else {
+            this->UpdateGroups(batch);
+        }
+    }
+    this->TrackBatch(*batch);
+}
+
+void BaseAggregate::TrackBatch(const arrow::RecordBatch& batch) {
+    this->stats.num_batches++;
+    this->stats.num_rows += batch.num_rows();
+
+    // Hash tables grow by doubling.
+    const auto capacity = static_cast<int64_t>(this->GroupTableCapacity());
+    if (capacity > this->stats.table_capacity) {
+        if (this->stats.table_capacity > 0) {
+            for (auto size = this->stats.table_capacity; size < capacity; size *= 2) {
+                this->stats.num_resizes++;
+            }
+        }
+        this->stats.table_capacity = capacity;
+    }
+    if (!this->is_groups_estimated && this->expected_rows > GROUP_SAMPLE_ROWS
+            && this->stats.num_rows >= GROUP_SAMPLE_ROWS) {
+        this->ReserveEstimatedGroups();
+    }
+    this->ReserveMemory();
+}
+
+void BaseAggregate::ReserveEstimatedGroups() {
+    this->is_groups_estimated = true;
+    // Expected rows are counted before the selection, the rest of them is selected as the rows so far.
+    const auto scanned_rows = std::max(this->num_scanned_rows, this->stats.num_rows);
+    const auto selected_rows = static_cast<int64_t>(
+            static_cast<double>(this->expected_rows) * this->stats.num_rows / scanned_rows);
+    auto estimate = estimate_num_groups(this->num_groups, this->stats.num_rows, selected_rows);
+
+    // Groups to come take as many bytes as the groups so far, they must fit in the pool.
+    const auto used_bytes = static_cast<double>(this->TotalMemoryUsage());
+    const auto group_bytes = std::max(used_bytes / std::max<uint32_t>(this->num_groups, 1), 1.0);
+    const auto available_groups = static_cast<double>(this->memory.Available()) / group_bytes;
+    if (this->num_groups + available_groups < static_cast<double>(estimate)) {
+        estimate = this->num_groups + static_cast<int64_t>(available_groups);
+    }
+
+    this->stats.estimated_groups = estimate;
+    if (this->stats.estimated_groups <= this->num_groups) {
+        return;
+    }
+    this->ReserveGroups(this->stats.estimated_groups);
+
+    // Single rehash to the reserved capacity.
+    const auto capacity = static_cast<int64_t>(this->GroupTableCapacity());
+    if (capacity > this->stats.table_capacity) {
+        if (this->stats.table_capacity > 0) {
+            this->stats.num_resizes++;
+        }
+        this->stats.table_capacity = capacity;
+    }
+}
+
+void BaseAggregate::SetExpectedRows(int64_t num_rows) {
+    this->expected_rows = num_rows;
+}
+
+void BaseAggregate::ReserveMemory() {
+    const auto bytes = static_cast<int64_t>(this->TotalMemoryUsage());
+    this->stats.memory_bytes = std::max(this->stats.memory_bytes, bytes);
+    if (this->is_spillable) {
+        this->is_over_memory_limit = !this->memory.TryResize(bytes);
+    } else {
+        this->memory.Resize(bytes);
+    }
+}
+
+size_t BaseAggregate::TotalMemoryUsage() const {
+    return this->MemoryUsage() + this->GroupTableMemoryUsage();
+}
+
+void BaseAggregate::SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool) {
+    this->memory.SetPool(pool);
+}
+
+AggregateStats BaseAggregate::AggStats() const {
+    AggregateStats result = this->stats;
+    result.num_groups = this->num_groups;
+    return result;
+}
+
+void BaseAggregate::Next(const std::shared_ptr<arrow::RecordBatch>& batch,
+                         const std::shared_ptr<arrow::Array>& selection) {
+    this->num_scanned_rows += batch->num_rows();
+    this->Next(filter::TakeSelectedColumns(batch, selection, this->InputColumnNames()));
+}
+
+std::vector<std::string> BaseAggregate::InputColumnNames() const {
+    std::vector<std::string> col_names(this->groupby_col_names);
+    for (const auto& func_def : this->input_agg_specs) {
+        if (!func_def.column_name.empty()) {
+            col_names.push_back(func_def.column_name);
+        }
+    }
+    return col_names;
+}
+
+void BaseAggregate::SetVectorized(bool vectorized) {
+    this->is_vectorized = vectorized;
+}
+
+size_t BaseAggregate::MemoryUsage() const {
+    size_t usage = 0;
+    for (const auto &agg_func : this->agg_funcs) {
+        usage += agg_func->MemoryUsage();
+    }
+    return usage;
+}
+
+void BaseAggregate::UpdateGroups(const std::shared_ptr<arrow::RecordBatch>& batch) {
     auto num_rows = batch->column(0)->length();
     for (size_t row_idx = 0; row_idx < num_rows; row_idx++) {
         bool is_new_entry;
-        auto& entry = this->GetOrCreateEntry(batch, row_idx, is_new_entry);
+        auto group_id = this->GetOrCreateEntry(batch, row_idx, is_new_entry);
         if (is_new_entry) {
             for (const auto &agg_func : this->agg_funcs) {
-                entry.push_back(
-                    agg_func->Init(row_idx)
-                );
+                agg_func->Init(row_idx);
             }
         } else {
             for (auto agg_idx = this->agg_col_indices.size(), size = this->agg_funcs.size();
                         agg_idx < size; agg_idx++) {
                 const auto &agg_func = this->agg_funcs[agg_idx];
-                agg_func->Update(entry[agg_idx]);
+                agg_func->Update(group_id);
             }
         }
     }
 }
 
+void BaseAggregate::UpdateGroupsVectorized(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    auto num_rows = batch->column(0)->length();
+
+    // Assign the group ids to all the rows first, then update each agg function with the whole batch.
+    this->group_ids.resize(num_rows);
+    this->AssignGroupIds(batch, this->group_ids.data());
+
+    for (size_t agg_idx = 0, size = this->agg_funcs.size(); agg_idx < size; agg_idx++) {
+        const auto &agg_func = this->agg_funcs[agg_idx];
+        agg_func->Resize(this->num_groups);
+        agg_func->UpdateBatch(this->group_ids.data(), *this->batch_arrays[agg_idx]);
+    }
+}
+
+void BaseAggregate::AssignGroupIds(const std::shared_ptr<arrow::RecordBatch>& batch, uint32_t* group_ids) {
+    for (int64_t row_idx = 0, num_rows = batch->num_rows(); row_idx < num_rows; row_idx++) {
+        bool is_new_entry;
+        group_ids[row_idx] = this->GetOrCreateEntry(batch, row_idx, is_new_entry);
+    }
+}
+
 std::shared_ptr<arrow::RecordBatch> BaseAggregate::Result() {
-    this->SummarizeGroups();
+    return this->ResultBatch(0, this->num_groups);
+}
+
+std::shared_ptr<arrow::RecordBatch> BaseAggregate::NextResult(int64_t batch_size) {
+    if (!this->is_result_started) {
+        this->is_result_started = true;
+        this->ReleaseGroups();
+        this->ReserveMemory();
+        // Output types must be the same for all the chunks.
+        for (const auto &agg_func : this->agg_funcs) {
+            if (agg_func->IsOverflow()) {
+                agg_func->SetOverflowMode();
+            }
+        }
+        if (this->num_groups == 0) {
+            return this->ResultBatch(0, 0);
+        }
+    }
+    if (this->next_result_group >= this->num_groups) {
+        return nullptr;
+    }
+
+    const uint32_t begin = this->next_result_group;
+    const auto end = static_cast<uint32_t>(std::min<int64_t>(this->num_groups, begin + batch_size));
+    this->next_result_group = end;
+    return this->ResultBatch(begin, end);
+}
+
+std::shared_ptr<arrow::RecordBatch> BaseAggregate::ResultBatch(uint32_t begin, uint32_t end) {
+    common::ScopedTimer timer(this->stats.result_nanos);
+    for (const auto &agg_func : this->agg_funcs) {
+        agg_func->Summarize(begin, end);
+    }
 
     std::vector<std::shared_ptr<arrow::Field>> schema_vector;
     std::vector<std::shared_ptr<arrow::Array>> table_cols;
@@ -68,6 +244,7 @@ std::shared_ptr<arrow::RecordBatch> BaseAggregate::Result() {
 }
 
 void BaseAggregate::SetBatchArrays(const std::shared_ptr<arrow::RecordBatch> &batch) {
+    this->batch_arrays.resize(this->agg_func_specs.size());
     for (size_t agg_idx = 0, size = this->agg_func_specs.size(); agg_idx < size; agg_idx++) {
         const AggFuncDef &func_def = this->agg_func_specs[agg_idx];
         const auto &agg_func = this->agg_funcs[agg_idx];
@@ -85,6 +262,7 @@ void BaseAggregate::SetBatchArrays(const std::shared_ptr<arrow::RecordBatch> &ba
 
         array_iter->SetArray(array);
         agg_func->SetArrayIter(std::move(array_iter));
+        this->batch_arrays[agg_idx] = array->data();
     }
 }
 
@@ -116,6 +294,70 @@ void BaseAggregate::EnsureInitAggFuncs(const std::shared_ptr<arrow::Schema>& sch
                           this->input_agg_specs.begin(),
                           this->input_agg_specs.end());
     this->agg_func_specs = all_func_specs;
+
+    for (const auto& agg_func : this->agg_funcs) {
+        agg_func->SetMemoryPool(this->memory.ArrowPool());
+    }
+}
+
+void BaseAggregate::UnifyOutputTypes(const std::vector<BaseAggregate*>& aggregates) {
+    const BaseAggregate& first = *aggregates[0];
+    for (size_t agg_idx = 0, num_funcs = first.agg_funcs.size(); agg_idx < num_funcs; agg_idx++) {
+        bool is_overflow = false;
+        for (const auto& aggregate : aggregates) {
+            if (aggregate->agg_funcs[agg_idx]->IsOverflow()) {
+                is_overflow = true;
+                break;
+            }
+        }
+        if (!is_overflow) {
+            continue;
+        }
+        for (const auto& aggregate : aggregates) {
+            aggregate->agg_funcs[agg_idx]->SetOverflowMode();
+        }
+    }
+}
+
+int64_t estimate_num_groups(int64_t sample_groups, int64_t sample_rows, int64_t total_rows) {
+    if (sample_groups <= 0 || sample_rows <= 0) {
+        return 0;
+    }
+    if (sample_rows >= total_rows) {
+        return sample_groups;
+    }
+    // Every row of the sample is a distinct key, so are all the rows.
+    if (sample_groups >= sample_rows) {
+        return total_rows;
+    }
+
+    const auto sample_n = static_cast<double>(sample_rows);
+    const auto groups = static_cast<double>(sample_groups);
+    auto expected_distinct = [](double num_keys, double num_rows) {
+        return -num_keys * std::expm1(-num_rows / num_keys);
+    };
+
+    // Expected distinct keys of the sample grow with K, from below sample_groups at K = sample_groups
+    // to sample_rows as K goes to infinity.
+    double low = groups;
+    double high = groups * 2;
+    while (expected_distinct(high, sample_n) < groups) {
+        high *= 2;
+        if (high > static_cast<double>(total_rows) * 64) {
+            return total_rows;
+        }
+    }
+    for (int iter = 0; iter < 64 && high - low > 1; iter++) {
+        const double mid = (low + high) / 2;
+        if (expected_distinct(mid, sample_n) < groups) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    const auto estimate = static_cast<int64_t>(expected_distinct(high, static_cast<double>(total_rows)));
+    return std::clamp(estimate, sample_groups, total_rows);
 }
 
 void lookup_col_indices(const std::vector<std::string>& col_names,
@@ -130,5 +372,48 @@ void lookup_col_indices(const std::vector<std::string>& col_names,
     }
 }
 
+std::shared_ptr<arrow::RecordBatch> ResultStream::Next(int64_t batch_size) {
+    while (this->aggregate_idx < this->aggregates.size()) {
+        auto batch = this->aggregates[this->aggregate_idx]->NextResult(batch_size);
+        if (batch == nullptr) {
+            this->aggregate_idx++;
+            continue;
+        }
+        const bool is_last = this->aggregate_idx + 1 == this->aggregates.size();
+        if (batch->num_rows() == 0 && (this->has_returned || !is_last)) {
+            continue;
+        }
+        this->has_returned = true;
+        return batch;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<arrow::RecordBatch>
+concatenate_batches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+                    arrow::MemoryPool* pool) {
+    const auto& schema = batches[0]->schema();
+
+    int64_t num_rows = 0;
+    for (const auto& batch : batches) {
+        num_rows += batch->num_rows();
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (int col_idx = 0; col_idx < schema->num_fields(); col_idx++) {
+        std::vector<std::shared_ptr<arrow::Array>> chunks;
+        chunks.reserve(batches.size());
+        for (const auto& batch : batches) {
+            chunks.push_back(batch->column(col_idx));
+        }
+        auto concat_res = arrow::Concatenate(chunks, pool);
+        if (!concat_res.ok()) {
+            throw std::runtime_error(concat_res.status().message());
+        }
+        columns.push_back(concat_res.ValueOrDie());
+    }
+    return arrow::RecordBatch::Make(schema, num_rows, columns);
+}
+
 
 }  // namespace vinum::operators::aggregate
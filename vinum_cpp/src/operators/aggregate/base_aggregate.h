@@ -1,6 +1,7 @@
 #pragma once
 
 #include "agg_funcs.h"
+#include "common/memory_pool.h"
 
 #include <arrow/api.h>
 
@@ -11,6 +12,50 @@
 
 namespace vinum::operators::aggregate {
 
+template<typename AGG>
+class ParallelHashAggregate;
+
+template<typename AGG>
+class SpillingHashAggregate;
+
+// Activity of an aggregate, reported by EXPLAIN ANALYZE.
+struct AggregateStats {
+    int64_t num_batches = 0;        // Batches received by Next()
+    int64_t num_rows = 0;           // Rows received by Next()
+    int64_t num_groups = 0;
+    int64_t table_capacity = 0;     // Slots of the hash table, at its largest
+    int64_t num_resizes = 0;        // Number of times the hash table doubled
+    int64_t memory_bytes = 0;       // Bytes of the states and of the hash table, at their largest
+    int64_t estimated_groups = 0;   // Groups estimated from the first rows to reserve the hash table, 0 if not estimated
+    int64_t update_nanos = 0;       // Time spent updating the groups in Next()
+    int64_t result_nanos = 0;       // Time spent summarizing the groups into the result
+
+    // Fraction of the slots of the hash table taken by the groups, 0 without a hash table.
+    [[nodiscard]] double LoadFactor() const {
+        return this->table_capacity > 0 ? static_cast<double>(this->num_groups) / this->table_capacity : 0;
+    }
+
+    // Accumulate the activity of another aggregate, ie of a partial aggregate.
+    void Add(const AggregateStats& other) {
+        this->num_batches += other.num_batches;
+        this->num_rows += other.num_rows;
+        this->num_groups += other.num_groups;
+        this->table_capacity += other.table_capacity;
+        this->num_resizes += other.num_resizes;
+        this->memory_bytes += other.memory_bytes;
+        this->estimated_groups += other.estimated_groups;
+        this->update_nanos += other.update_nanos;
+        this->result_nanos += other.result_nanos;
+    }
+};
+
+// Group of a hash aggregate: pointer to the key stored in the hash table and the group id.
+template<typename KEY>
+struct GroupRef {
+    const KEY* key;
+    uint32_t group_id;
+};
+
 
 class BaseAggregate {
 public:
@@ -22,9 +67,47 @@ public:
 
     virtual void Next(const std::shared_ptr<arrow::RecordBatch>& batch);
 
+    // Aggregate the rows of the batch at the selection, all the rows if the selection is nullptr.
+    // Only the columns read by the aggregate are gathered.
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch, const std::shared_ptr<arrow::Array>& selection);
+
     std::shared_ptr<arrow::RecordBatch> Result();
 
+    // Next batch of at most batch_size groups of the result, nullptr once all the groups were returned.
+    // If there are no groups, the first call returns an empty batch.
+    // The first call releases the hash table, Next() must not be called afterwards.
+    std::shared_ptr<arrow::RecordBatch> NextResult(int64_t batch_size);
+
+    // Switch between the vectorized (batch-at-a-time) and row-at-a-time update paths.
+    void SetVectorized(bool vectorized);
+
+    // Approximate size of the states of all the groups in bytes, the hash table itself is not included.
+    [[nodiscard]] size_t MemoryUsage() const;
+
+    // Approximate size of the states and of the hash table in bytes.
+    [[nodiscard]] size_t TotalMemoryUsage() const;
+
+    // Account the states and the hash table in the pool of the query, the Arrow buffers
+    // of the functions are allocated from it. Must be called before the first batch.
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool);
+
+    // Number of rows the aggregate is expected to receive, at most. Once the first GROUP_SAMPLE_ROWS rows
+    // are aggregated, the hash table is reserved for the number of groups estimated from them,
+    // instead of doubling as the groups grow. The rows are of the batches before the selection,
+    // the estimate scales them by the fraction of the rows selected so far.
+    // The reserved table is capped to the room left in the pool. Must be called before the first batch.
+    void SetExpectedRows(int64_t num_rows);
+
+    [[nodiscard]] AggregateStats AggStats() const;
+
+    static constexpr int64_t GROUP_SAMPLE_ROWS = 1 << 14;
+
 protected:
+    template<typename AGG>
+    friend class ParallelHashAggregate;
+    template<typename AGG>
+    friend class SpillingHashAggregate;
+
     const std::vector<AggFuncDef> input_agg_specs;
     const std::vector<std::string> groupby_col_names; // Names of groupby columns
     const std::vector<std::string> agg_col_names;   // Names of aggregate columns (subset of groupby columns)
@@ -35,20 +118,125 @@ protected:
 
     std::vector<std::shared_ptr<AbstractAggFunc>> agg_funcs;
 
+    // Number of groups created so far, new group gets the next dense id.
+    uint32_t num_groups = 0;
+
+    bool is_vectorized = true;
+    std::vector<uint32_t> group_ids;    // Group id of every row of the current batch
+    std::vector<std::shared_ptr<arrow::ArrayData>> batch_arrays;  // Input array of every agg function
+
+    AggregateStats stats;
+
+    common::MemoryReservation memory;
+    // Exceeding the limit of the pool sets is_over_memory_limit instead of throwing,
+    // the owner is expected to free the groups, see SpillingHashAggregate.
+    bool is_spillable = false;
+    bool is_over_memory_limit = false;
+
+    int64_t expected_rows = 0;
+    int64_t num_scanned_rows = 0;   // Rows of the batches received with a selection, before the selection
+    bool is_groups_estimated = false;
+
+    // Names of the groupby columns and of the inputs of the aggregate functions.
+    [[nodiscard]] std::vector<std::string> InputColumnNames() const;
+
     virtual void SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch);
     virtual void EnsureInitAggFuncs(const std::shared_ptr<arrow::Schema>& schema);
 
+    // Assign the group id of every row of the batch to group_ids, creating the new groups.
+    // Calls GetOrCreateEntry() for every row, aggregates override it with a loop specialized
+    // for the key type, free of the virtual calls per row.
+    virtual void AssignGroupIds(const std::shared_ptr<arrow::RecordBatch>& batch, uint32_t* group_ids);
+
+    // Free the hash table, the keys of the groups are kept by the group builders.
+    virtual void ReleaseGroups() {}
+
+    // Number of slots of the hash table, 0 if the aggregate has no hash table.
+    [[nodiscard]] virtual size_t GroupTableCapacity() const {
+        return 0;
+    }
+
+    // Approximate size of the hash table and of the keys it owns in bytes.
+    [[nodiscard]] virtual size_t GroupTableMemoryUsage() const {
+        return 0;
+    }
+
+    // Grow the hash table to hold num_groups groups without rehashing.
+    virtual void ReserveGroups(size_t num_groups) {}
+
+    // Count the batch received by Next(), the growth of the hash table and of the memory.
+    void TrackBatch(const arrow::RecordBatch& batch);
+
+    // Reserve the hash table for the groups estimated from the rows received so far, see SetExpectedRows().
+    void ReserveEstimatedGroups();
+
+    // Resize the reservation to TotalMemoryUsage(), throws MemoryLimitError over the limit of the pool
+    // unless the aggregate is spillable.
+    void ReserveMemory();
+
+    // All the aggregates must produce the same output types, ie if SUM of any of them overflows
+    // the default output type, all of them emit the widened type. Used when the results of
+    // several aggregates of disjoint groups are concatenated.
+    static void UnifyOutputTypes(const std::vector<BaseAggregate*>& aggregates);
+
 private:
 
-    virtual std::vector<std::shared_ptr<void>>& GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
-                                                                 const int& row_idx,
-                                                                 bool& is_new_entry) = 0;
-    virtual void SummarizeGroups() = 0;
+    // Returns id of the group the row belongs to.
+    virtual uint32_t GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                      const int& row_idx,
+                                      bool& is_new_entry) = 0;
+    // Id of the first group not returned by NextResult() yet.
+    uint32_t next_result_group = 0;
+    bool is_result_started = false;
+
+    std::shared_ptr<arrow::RecordBatch> ResultBatch(uint32_t begin, uint32_t end);
+
+    void UpdateGroups(const std::shared_ptr<arrow::RecordBatch>& batch);
+    void UpdateGroupsVectorized(const std::shared_ptr<arrow::RecordBatch>& batch);
 };
 
 void lookup_col_indices(const std::vector<std::string>& col_names,
                         std::vector<int>& col_indices,
                         const std::shared_ptr<arrow::Schema>& table_schema);
 
+/**
+ * Number of groups of total_rows rows, estimated from the sample_groups groups of the first sample_rows rows.
+ *
+ * The keys are assumed to be drawn uniformly from K distinct values, so that n rows are expected to have
+ * K * (1 - exp(-n / K)) distinct keys. K is solved from the groups of the sample, the estimate is
+ * the number of distinct keys expected in all the rows. Clustered keys underestimate the groups,
+ * the hash table then grows as usual.
+ */
+int64_t estimate_num_groups(int64_t sample_groups, int64_t sample_rows, int64_t total_rows);
+
+// Approximate size of a robin_hood map in bytes: the slots and the info byte of every slot.
+template<typename MAP>
+inline size_t hash_map_memory_usage(const MAP& map) {
+    return map.mask() > 0 ? (map.mask() + 1) * (sizeof(typename MAP::value_type) + 1) : 0;
+}
+
+/**
+ * Streams the results of several aggregates of disjoint groups batch by batch, see BaseAggregate::NextResult().
+ * Empty batches are skipped, unless all the aggregates are empty, then a single empty batch is returned.
+ */
+class ResultStream {
+public:
+    ResultStream() = default;
+
+    explicit ResultStream(const std::vector<BaseAggregate*>& aggregates) : aggregates(aggregates) {}
+
+    std::shared_ptr<arrow::RecordBatch> Next(int64_t batch_size);
+
+private:
+    std::vector<BaseAggregate*> aggregates;
+    size_t aggregate_idx = 0;
+    bool has_returned = false;
+};
+
+// Concatenate batches of the same schema into a single batch.
+std::shared_ptr<arrow::RecordBatch>
+concatenate_batches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+                    arrow::MemoryPool* pool = arrow::default_memory_pool());
+
 
 }  // namespace vinum::operators::aggregate
@@ -0,0 +1,49 @@
+#include "composite_key_hash_aggregate.h"
+
+
+namespace vinum::operators::aggregate {
+
+void CompositeKeyHashAggregate::SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    BaseAggregate::SetBatchArrays(batch);
+
+    this->key_encoder.Encode(*batch);
+}
+
+uint32_t
+CompositeKeyHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                            const int& row_idx,
+                                            bool& is_new_entry) {
+    const EncodedKey key = this->key_encoder.Key(row_idx);
+    return this->FindOrCreateGroup(&key, is_new_entry);
+}
+
+uint32_t CompositeKeyHashAggregate::FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry) {
+    const auto &entry_pair = this->groups.find(*key);
+
+    if (entry_pair == this->groups.end()) {
+        is_new_entry = true;
+        // Key of the batch is only valid until the next batch, so the key bytes are copied into the arena.
+        const EncodedKey stored_key {this->arena.Copy(key->data, key->size), key->size, key->hash};
+        this->groups.emplace(stored_key, this->num_groups);
+        return this->num_groups++;
+    } else {
+        is_new_entry = false;
+        return entry_pair->second;
+    }
+}
+
+void CompositeKeyHashAggregate::EnsureInitAggFuncs(const shared_ptr<arrow::Schema>& table_schema) {
+    BaseAggregate::EnsureInitAggFuncs(table_schema);
+
+    if (!this->key_encoder.IsInitialized()) {
+        this->key_encoder = BatchKeyEncoder(*table_schema, this->groupby_col_indices);
+    }
+}
+
+void CompositeKeyHashAggregate::ReleaseGroups() {
+    this->groups = decltype(this->groups)();
+    this->arena.Release();
+}
+
+
+}  // namespace vinum::operators::aggregate
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "base_aggregate.h"
+#include "key_encoding.h"
+#include "common/arena.h"
+
+#include "common/robin_hood.h"
+
+
+namespace vinum::operators::aggregate {
+
+/**
+ * Hash aggregate on any combination of numeric, boolean, temporal, string and binary columns.
+ *
+ * Keys of the whole batch are encoded and hashed column by column before the lookup,
+ * the keys of the groups are stored in an arena. This avoids creating arrow::Scalar objects
+ * per row and column, as GenericHashAggregate does.
+ */
+class CompositeKeyHashAggregate : public BaseAggregate {
+public:
+    typedef EncodedKey KEY_TYPE;
+
+    using BaseAggregate::BaseAggregate;
+
+    uint32_t FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry);
+
+    // Calls func(const KEY_TYPE* key, uint32_t group_id) for every group.
+    template<typename FUNC>
+    void ForEachGroup(FUNC&& func) const {
+        for (const auto& group : this->groups) {
+            func(&group.first, group.second);
+        }
+    }
+
+    static inline size_t HashKey(const KEY_TYPE* key) {
+        return key->hash;
+    }
+
+protected:
+    void SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch) override;
+
+    void EnsureInitAggFuncs(const shared_ptr<arrow::Schema>& table_schema) override;
+
+    void ReleaseGroups() override;
+
+    [[nodiscard]] size_t GroupTableCapacity() const override {
+        return this->groups.mask() > 0 ? this->groups.mask() + 1 : 0;
+    }
+
+    [[nodiscard]] size_t GroupTableMemoryUsage() const override {
+        return hash_map_memory_usage(this->groups) + this->arena.BytesReserved();
+    }
+
+    void ReserveGroups(size_t num_groups) override {
+        this->groups.reserve(num_groups);
+    }
+
+private:
+    robin_hood::unordered_map<KEY_TYPE, uint32_t, EncodedKeyHasher> groups;
+    common::Arena arena;    // Bytes of the keys of the groups
+
+    BatchKeyEncoder key_encoder;    // Keys of the current batch
+
+    uint32_t GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                              const int& row_idx,
+                              bool& is_new_entry) override;
+};
+
+}  // namespace vinum::operators::aggregate
@@ -0,0 +1,124 @@
+#include "dictionary_hash_aggregate.h"
+
+#include <arrow/util/bit_util.h>
+
+
+namespace vinum::operators::aggregate {
+
+
+void DictionaryHashAggregate::SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    BaseAggregate::SetBatchArrays(batch);
+
+    this->indices = batch->column(this->groupby_col_indices[0])->data();
+    this->SetDictionary(this->indices->dictionary);
+}
+
+void DictionaryHashAggregate::SetDictionary(const std::shared_ptr<arrow::ArrayData>& batch_dictionary) {
+    // Batches of the same column chunk usually share the dictionary, then the resolved groups are kept.
+    if (this->dictionary != nullptr
+            && (this->dictionary == batch_dictionary
+                || arrow::MakeArray(this->dictionary)->Equals(arrow::MakeArray(batch_dictionary)))) {
+        return;
+    }
+
+    this->dictionary = batch_dictionary;
+    const auto dict_size = batch_dictionary->length;
+    this->dict_groups.assign(dict_size, NO_GROUP);
+    this->dict_keys.resize(dict_size);
+    this->dict_valid.resize(dict_size);
+    VisitKeyColumn(this->value_spec, *batch_dictionary,
+                   [this](int64_t dict_idx, bool is_valid, const uint8_t* value, uint32_t value_size) {
+        this->dict_valid[dict_idx] = is_valid;
+        if (is_valid) {
+            this->dict_keys[dict_idx].assign(reinterpret_cast<const char*>(value), value_size);
+        }
+    });
+}
+
+int64_t DictionaryHashAggregate::GetIndex(int64_t row_idx) const {
+    const auto& data = *this->indices;
+    switch (data.type->id()) {
+        case arrow::Type::INT8:
+            return data.GetValues<int8_t>(1)[row_idx];
+        case arrow::Type::UINT8:
+            return data.GetValues<uint8_t>(1)[row_idx];
+        case arrow::Type::INT16:
+            return data.GetValues<int16_t>(1)[row_idx];
+        case arrow::Type::UINT16:
+            return data.GetValues<uint16_t>(1)[row_idx];
+        case arrow::Type::INT32:
+            return data.GetValues<int32_t>(1)[row_idx];
+        case arrow::Type::UINT32:
+            return data.GetValues<uint32_t>(1)[row_idx];
+        case arrow::Type::INT64:
+            return data.GetValues<int64_t>(1)[row_idx];
+        case arrow::Type::UINT64:
+            return static_cast<int64_t>(data.GetValues<uint64_t>(1)[row_idx]);
+        default:
+            throw std::runtime_error("Unsupported dictionary index type: " + data.type->ToString());
+    }
+}
+
+uint32_t
+DictionaryHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                          const int& row_idx,
+                                          bool& is_new_entry) {
+    const auto& validity = this->indices->buffers[0];
+    if (validity != nullptr && !arrow::BitUtil::GetBit(validity->data(), this->indices->offset + row_idx)) {
+        return this->FindOrCreateGroup(nullptr, is_new_entry);
+    }
+
+    const auto dict_idx = this->GetIndex(row_idx);
+    auto& group_id = this->dict_groups[dict_idx];
+    if (group_id != NO_GROUP) {
+        is_new_entry = false;
+        return group_id;
+    }
+
+    // NULL dictionary values belong to the NULL group as well.
+    group_id = this->FindOrCreateGroup(this->dict_valid[dict_idx] ? &this->dict_keys[dict_idx] : nullptr,
+                                       is_new_entry);
+    return group_id;
+}
+
+uint32_t DictionaryHashAggregate::FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry) {
+    if (key == nullptr) {
+        is_new_entry = false;
+        if (this->null_group_id == NO_GROUP) {
+            this->null_group_id = this->num_groups++;
+            is_new_entry = true;
+        }
+        return this->null_group_id;
+    }
+
+    const auto& entry_pair = this->groups.find(*key);
+
+    if (entry_pair == this->groups.end()) {
+        is_new_entry = true;
+        return this->groups[*key] = this->num_groups++;
+    } else {
+        is_new_entry = false;
+        return entry_pair->second;
+    }
+}
+
+void DictionaryHashAggregate::EnsureInitAggFuncs(const shared_ptr<arrow::Schema>& table_schema) {
+    BaseAggregate::EnsureInitAggFuncs(table_schema);
+
+    const auto& type = table_schema->field(this->groupby_col_indices[0])->type();
+    if (type->id() != arrow::Type::DICTIONARY) {
+        throw std::runtime_error("Group by column is not dictionary encoded: " + type->ToString());
+    }
+    this->value_spec = MakeKeyColumnSpec(*static_cast<const arrow::DictionaryType&>(*type).value_type());
+}
+
+void DictionaryHashAggregate::ReleaseGroups() {
+    this->groups = decltype(this->groups)();
+    this->dictionary = nullptr;
+    this->dict_groups = std::vector<uint32_t>();
+    this->dict_keys = std::vector<KEY_TYPE>();
+    this->dict_valid = std::vector<uint8_t>();
+}
+
+
+}  // namespace vinum::operators::aggregate
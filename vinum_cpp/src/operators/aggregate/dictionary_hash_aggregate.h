@@ -0,0 +1,93 @@
+#pragma once
+
+#include "base_aggregate.h"
+#include "key_encoding.h"
+
+#include "common/robin_hood.h"
+
+
+namespace vinum::operators::aggregate {
+
+/**
+ * Hash aggregate on a single dictionary encoded column.
+ *
+ * Rows are grouped by the dictionary index: every dictionary entry is resolved to a group
+ * only once per dictionary, with a hash lookup of the entry's value, rows then get the group id
+ * directly from the per-dictionary table. Batches with different dictionaries are remapped
+ * by value, so the groups are shared across the dictionaries.
+ * The key column is decoded only once in Result(), see DictionaryGroupBuilder.
+ */
+class DictionaryHashAggregate : public BaseAggregate {
+public:
+    // Bytes of the dictionary value
+    typedef std::string KEY_TYPE;
+
+    using BaseAggregate::BaseAggregate;
+
+    // Returns id of the group with the given key, nullptr key stands for the NULL group.
+    uint32_t FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry);
+
+    // Calls func(const KEY_TYPE* key, uint32_t group_id) for every group, key is nullptr for the NULL group.
+    template<typename FUNC>
+    void ForEachGroup(FUNC&& func) const {
+        for (const auto& group : this->groups) {
+            func(&group.first, group.second);
+        }
+        if (this->null_group_id != NO_GROUP) {
+            func(nullptr, this->null_group_id);
+        }
+    }
+
+    static inline size_t HashKey(const KEY_TYPE* key) {
+        return key != nullptr ? robin_hood::hash<KEY_TYPE>{}(*key) : 0;
+    }
+
+protected:
+    void SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch) override;
+
+    void EnsureInitAggFuncs(const shared_ptr<arrow::Schema>& table_schema) override;
+
+    void ReleaseGroups() override;
+
+    [[nodiscard]] size_t GroupTableCapacity() const override {
+        return this->groups.mask() > 0 ? this->groups.mask() + 1 : 0;
+    }
+
+    [[nodiscard]] size_t GroupTableMemoryUsage() const override {
+        return hash_map_memory_usage(this->groups)
+               + this->dict_groups.capacity() * sizeof(uint32_t)
+               + this->dict_keys.capacity() * sizeof(KEY_TYPE)
+               + this->dict_valid.capacity();
+    }
+
+    void ReserveGroups(size_t num_groups) override {
+        this->groups.reserve(num_groups);
+    }
+
+private:
+    static constexpr uint32_t NO_GROUP = std::numeric_limits<uint32_t>::max();
+
+    robin_hood::unordered_map<KEY_TYPE, uint32_t> groups;
+    uint32_t null_group_id = NO_GROUP;
+
+    KeyColumnSpec value_spec;
+
+    // Dictionary of the current batch and the group id of its entries, NO_GROUP if not resolved yet.
+    std::shared_ptr<arrow::ArrayData> dictionary = nullptr;
+    std::vector<uint32_t> dict_groups;
+    std::vector<KEY_TYPE> dict_keys;
+    std::vector<uint8_t> dict_valid;
+
+    // Indices of the current batch
+    std::shared_ptr<arrow::ArrayData> indices = nullptr;
+
+    uint32_t GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                              const int& row_idx,
+                              bool& is_new_entry) override;
+
+    void SetDictionary(const std::shared_ptr<arrow::ArrayData>& batch_dictionary);
+
+    [[nodiscard]] int64_t GetIndex(int64_t row_idx) const;
+};
+
+}  // namespace vinum::operators::aggregate
@@ -3,14 +3,12 @@
 
 namespace vinum::operators::aggregate {
 
-std::vector<std::shared_ptr<void>> &
+uint32_t
 GenericHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
                                        const int &row_idx,
                                        bool &is_new_entry) {
-    static const auto num_groupby_cols = this->groupby_col_indices.size();
-
     auto key = std::vector<std::shared_ptr<arrow::Scalar>>();
-    key.reserve(num_groupby_cols);
+    key.reserve(this->groupby_col_indices.size());
 
     for (int col_idx : this->groupby_col_indices) {
         arrow::Result<std::shared_ptr<arrow::Scalar>> scalar_res =
@@ -21,33 +19,23 @@ GenericHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>
         key.emplace_back(scalar_res.ValueOrDie());
     }
 
-    const auto &entry_pair = this->groups.find(key);
+    return this->FindOrCreateGroup(&key, is_new_entry);
+}
+
+uint32_t GenericHashAggregate::FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry) {
+    const auto &entry_pair = this->groups.find(*key);
 
     if (entry_pair == this->groups.end()) {
         is_new_entry = true;
-
-        auto entry = std::make_unique<std::vector<std::shared_ptr<void>>>();
-        entry->reserve(num_groupby_cols);
-        return *(this->groups[key] = std::move(entry));
+        return this->groups[*key] = this->num_groups++;
     } else {
         is_new_entry = false;
-        return *entry_pair->second;
+        return entry_pair->second;
     }
 }
 
-void GenericHashAggregate::SummarizeGroups() {
-    const auto num_groups = this->groups.size();
-    for (const auto &agg_func : this->agg_funcs) {
-        agg_func->Reserve(num_groups);
-    }
-
-    for (const auto &group : this->groups) {
-        auto &entry = *group.second;
-        for (int agg_idx = 0, size = this->agg_funcs.size(); agg_idx < size; agg_idx++) {
-            const auto &agg_func = this->agg_funcs[agg_idx];
-            agg_func->Summarize(entry[agg_idx]);
-        }
-    }
+void GenericHashAggregate::ReleaseGroups() {
+    this->groups = decltype(this->groups)();
 }
 
 
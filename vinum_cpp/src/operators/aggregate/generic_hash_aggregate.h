@@ -45,24 +45,52 @@ public:
 
 class GenericHashAggregate : public BaseAggregate {
 public:
+    typedef std::vector<std::shared_ptr<arrow::Scalar>> KEY_TYPE;
+
     using BaseAggregate::BaseAggregate;
 
+    uint32_t FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry);
+
+    // Calls func(const KEY_TYPE* key, uint32_t group_id) for every group.
+    template<typename FUNC>
+    void ForEachGroup(FUNC&& func) const {
+        for (const auto& group : this->groups) {
+            func(&group.first, group.second);
+        }
+    }
+
+    static inline size_t HashKey(const KEY_TYPE* key) {
+        return ScalarsVectorHasher{}(*key);
+    }
+
 protected:
-    typedef std::vector<std::shared_ptr<arrow::Scalar>> KEY_TYPE;
+    void ReleaseGroups() override;
+
+    [[nodiscard]] size_t GroupTableCapacity() const override {
+        return this->groups.mask() > 0 ? this->groups.mask() + 1 : 0;
+    }
 
+    [[nodiscard]] size_t GroupTableMemoryUsage() const override {
+        // Every key holds a scalar per group by column.
+        return hash_map_memory_usage(this->groups)
+               + this->groups.size() * this->groupby_col_names.size()
+                 * (sizeof(std::shared_ptr<arrow::Scalar>) + sizeof(arrow::Int64Scalar));
+    }
+
+    void ReserveGroups(size_t num_groups) override {
+        this->groups.reserve(num_groups);
+    }
 
 private:
     robin_hood::unordered_map<
             KEY_TYPE,
-            std::unique_ptr<std::vector<std::shared_ptr<void>>>,
+            uint32_t,
             ScalarsVectorHasher,
             ScalarsVectorEqualsFn> groups;
 
-    std::vector<std::shared_ptr<void>> &GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
-                                                         const int& row_idx,
-                                                         bool& is_new_entry) override;
-
-    void SummarizeGroups() override;
+    uint32_t GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                              const int& row_idx,
+                              bool& is_new_entry) override;
 
 };
 
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "common/robin_hood.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace vinum::operators::aggregate {
+
+/**
+ * Open addressing hash table from 64-bit integer keys to group ids, with linear probing.
+ *
+ * Unlike a generic hash map, the hash of the key is computed by the caller, so that
+ * the keys of a batch may be hashed and their slots prefetched before any of them is probed,
+ * and FindOrInsert() resolves a key with a single probe whether the key exists or not.
+ * Pointers to the keys are invalidated when the table grows.
+ */
+class IntGroupTable {
+public:
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+    static inline size_t Hash(uint64_t key) {
+        return robin_hood::hash<uint64_t>{}(key);
+    }
+
+    inline void Prefetch(size_t hash) const {
+        if (!this->slots.empty()) {
+            __builtin_prefetch(&this->slots[hash & this->mask]);
+        }
+    }
+
+    // Returns the group id of the key, inserting the key with new_group_id if it is not in the table.
+    inline uint32_t FindOrInsert(uint64_t key, size_t hash, uint32_t new_group_id, bool& is_inserted) {
+        if (this->slots.empty()) {
+            this->Rehash(INITIAL_CAPACITY);
+        }
+        size_t slot_idx = hash & this->mask;
+        while (true) {
+            auto& slot = this->slots[slot_idx];
+            if (slot.group_id == EMPTY) {
+                slot.key = key;
+                slot.group_id = new_group_id;
+                is_inserted = true;
+                if (++this->num_keys > this->max_keys) {
+                    this->Rehash(this->slots.size() * 2);
+                }
+                return new_group_id;
+            }
+            if (slot.key == key) {
+                is_inserted = false;
+                return slot.group_id;
+            }
+            slot_idx = (slot_idx + 1) & this->mask;
+        }
+    }
+
+    // Returns the group id of the key, EMPTY if the key is not in the table.
+    inline uint32_t Find(uint64_t key, size_t hash) const {
+        if (this->slots.empty()) {
+            return EMPTY;
+        }
+        size_t slot_idx = hash & this->mask;
+        while (true) {
+            const auto& slot = this->slots[slot_idx];
+            if (slot.group_id == EMPTY || slot.key == key) {
+                return slot.group_id;
+            }
+            slot_idx = (slot_idx + 1) & this->mask;
+        }
+    }
+
+    // Grow the table to hold num_keys keys without rehashing, the table never shrinks.
+    void Reserve(size_t num_keys) {
+        size_t capacity = INITIAL_CAPACITY;
+        while (capacity / 2 < num_keys) {
+            capacity *= 2;
+        }
+        if (capacity > this->slots.size()) {
+            this->Rehash(capacity);
+        }
+    }
+
+    // Calls func(const uint64_t* key, uint32_t group_id) for every key.
+    template<typename FUNC>
+    void ForEach(FUNC&& func) const {
+        for (const auto& slot : this->slots) {
+            if (slot.group_id != EMPTY) {
+                func(&slot.key, slot.group_id);
+            }
+        }
+    }
+
+    [[nodiscard]] inline size_t size() const {
+        return this->num_keys;
+    }
+
+    [[nodiscard]] inline size_t capacity() const {
+        return this->slots.size();
+    }
+
+    [[nodiscard]] inline size_t MemoryUsage() const {
+        return this->slots.capacity() * sizeof(Slot);
+    }
+
+private:
+    static constexpr size_t INITIAL_CAPACITY = 64;
+
+    struct Slot {
+        uint64_t key;
+        uint32_t group_id;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    size_t num_keys = 0;
+    size_t max_keys = 0;    // Number of keys which triggers the growth, at the load factor of 1/2
+
+    void Rehash(size_t capacity) {
+        std::vector<Slot> old_slots(capacity, Slot{0, EMPTY});
+        old_slots.swap(this->slots);
+        this->mask = capacity - 1;
+        this->max_keys = capacity / 2;
+
+        for (const auto& slot : old_slots) {
+            if (slot.group_id != EMPTY) {
+                size_t slot_idx = Hash(slot.key) & this->mask;
+                while (this->slots[slot_idx].group_id != EMPTY) {
+                    slot_idx = (slot_idx + 1) & this->mask;
+                }
+                this->slots[slot_idx] = slot;
+            }
+        }
+    }
+};
+
+}  // namespace vinum::operators::aggregate
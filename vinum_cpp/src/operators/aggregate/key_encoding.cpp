@@ -0,0 +1,110 @@
+#include "key_encoding.h"
+
+#include "common/robin_hood.h"
+
+
+namespace vinum::operators::aggregate {
+
+namespace {
+
+constexpr size_t NULL_HASH = 0x5bd1e995;
+
+inline size_t CombineHash(size_t seed, size_t hash) {
+    return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+}  // namespace
+
+
+BatchKeyEncoder::BatchKeyEncoder(const arrow::Schema& schema, const std::vector<int>& col_indices)
+        : col_indices(col_indices) {
+    for (int col_idx : col_indices) {
+        this->key_columns.push_back(MakeKeyColumnSpec(*schema.field(col_idx)->type()));
+    }
+    this->null_bitmap_size = static_cast<int>((this->key_columns.size() + 7) / 8);
+}
+
+void BatchKeyEncoder::Encode(const arrow::RecordBatch& batch) {
+    this->EncodeKeys(batch);
+    this->HashKeys(batch);
+}
+
+void BatchKeyEncoder::EncodeKeys(const arrow::RecordBatch& batch) {
+    const int64_t num_rows = batch.num_rows();
+
+    // Compute the size of every key first, so that the keys of the batch are stored in a single buffer.
+    this->key_offsets.assign(num_rows + 1, this->null_bitmap_size);
+    for (size_t col_idx = 0, size = this->key_columns.size(); col_idx < size; col_idx++) {
+        const auto& column = this->key_columns[col_idx];
+        const bool is_binary = column.kind == KeyColumnKind::BINARY || column.kind == KeyColumnKind::LARGE_BINARY;
+        VisitKeyColumn(column, *batch.column(this->col_indices[col_idx])->data(),
+                       [this, is_binary](int64_t row_idx, bool is_valid, const uint8_t*, uint32_t value_size) {
+            if (is_valid) {
+                this->key_offsets[row_idx] += value_size + (is_binary ? sizeof(uint32_t) : 0);
+            }
+        });
+    }
+
+    uint32_t total_size = 0;
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        uint32_t key_size = this->key_offsets[row_idx];
+        this->key_offsets[row_idx] = total_size;
+        total_size += key_size;
+    }
+    this->key_offsets[num_rows] = total_size;
+
+    // Null bitmaps are zero initialized.
+    this->batch_keys.assign(total_size, 0);
+    this->write_offsets.resize(num_rows);
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        this->write_offsets[row_idx] = this->key_offsets[row_idx] + this->null_bitmap_size;
+    }
+
+    uint8_t* keys = this->batch_keys.data();
+    for (size_t col_idx = 0, size = this->key_columns.size(); col_idx < size; col_idx++) {
+        const auto& column = this->key_columns[col_idx];
+        const bool is_binary = column.kind == KeyColumnKind::BINARY || column.kind == KeyColumnKind::LARGE_BINARY;
+        VisitKeyColumn(column, *batch.column(this->col_indices[col_idx])->data(),
+                       [this, keys, col_idx, is_binary](int64_t row_idx, bool is_valid,
+                                                       const uint8_t* value, uint32_t value_size) {
+            if (!is_valid) {
+                arrow::BitUtil::SetBit(keys + this->key_offsets[row_idx], col_idx);
+                return;
+            }
+            auto& write_offset = this->write_offsets[row_idx];
+            if (is_binary) {
+                std::memcpy(keys + write_offset, &value_size, sizeof(uint32_t));
+                write_offset += sizeof(uint32_t);
+            }
+            if (value_size > 0) {
+                std::memcpy(keys + write_offset, value, value_size);
+                write_offset += value_size;
+            }
+        });
+    }
+}
+
+void BatchKeyEncoder::HashKeys(const arrow::RecordBatch& batch) {
+    this->key_hashes.assign(batch.num_rows(), this->key_columns.size());
+    for (size_t col_idx = 0, size = this->key_columns.size(); col_idx < size; col_idx++) {
+        const auto& column = this->key_columns[col_idx];
+        const bool hash_as_int = column.kind == KeyColumnKind::BOOLEAN
+                || (column.kind == KeyColumnKind::FIXED_WIDTH && column.byte_width <= sizeof(uint64_t));
+        VisitKeyColumn(column, *batch.column(this->col_indices[col_idx])->data(),
+                       [this, hash_as_int](int64_t row_idx, bool is_valid, const uint8_t* value, uint32_t value_size) {
+            size_t hash;
+            if (!is_valid) {
+                hash = NULL_HASH;
+            } else if (hash_as_int) {
+                uint64_t int_value = 0;
+                std::memcpy(&int_value, value, value_size);
+                hash = robin_hood::hash_int(int_value);
+            } else {
+                hash = robin_hood::hash_bytes(value, value_size);
+            }
+            this->key_hashes[row_idx] = CombineHash(this->key_hashes[row_idx], hash);
+        });
+    }
+}
+
+}  // namespace vinum::operators::aggregate
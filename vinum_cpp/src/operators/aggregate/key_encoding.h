@@ -0,0 +1,206 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <arrow/util/bit_util.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+
+namespace vinum::operators::aggregate {
+
+/**
+ * Helpers to access the values of group by columns as raw bytes,
+ * shared by the aggregates which encode keys into bytes.
+ */
+
+enum class KeyColumnKind {
+    FIXED_WIDTH, BOOLEAN, BINARY, LARGE_BINARY
+};
+
+struct KeyColumnSpec {
+    KeyColumnKind kind;
+    int byte_width;     // Width of FIXED_WIDTH values
+};
+
+inline constexpr uint8_t BOOL_BYTES[2] = {0, 1};
+
+// True if the values of the given type can be accessed as raw bytes.
+inline bool IsSupportedKeyType(const arrow::DataType& type) {
+    switch (type.id()) {
+        case arrow::Type::BOOL:
+        case arrow::Type::UINT8:
+        case arrow::Type::INT8:
+        case arrow::Type::UINT16:
+        case arrow::Type::INT16:
+        case arrow::Type::UINT32:
+        case arrow::Type::INT32:
+        case arrow::Type::UINT64:
+        case arrow::Type::INT64:
+        case arrow::Type::HALF_FLOAT:
+        case arrow::Type::FLOAT:
+        case arrow::Type::DOUBLE:
+        case arrow::Type::DATE32:
+        case arrow::Type::DATE64:
+        case arrow::Type::TIME32:
+        case arrow::Type::TIME64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::DURATION:
+        case arrow::Type::DECIMAL128:
+        case arrow::Type::DECIMAL256:
+        case arrow::Type::FIXED_SIZE_BINARY:
+        case arrow::Type::STRING:
+        case arrow::Type::BINARY:
+        case arrow::Type::LARGE_STRING:
+        case arrow::Type::LARGE_BINARY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline KeyColumnSpec MakeKeyColumnSpec(const arrow::DataType& type) {
+    if (!IsSupportedKeyType(type)) {
+        throw std::runtime_error("Unsupported type of the group by column: " + type.ToString());
+    }
+
+    switch (type.id()) {
+        case arrow::Type::BOOL:
+            return KeyColumnSpec{KeyColumnKind::BOOLEAN, 1};
+        case arrow::Type::STRING:
+        case arrow::Type::BINARY:
+            return KeyColumnSpec{KeyColumnKind::BINARY, 0};
+        case arrow::Type::LARGE_STRING:
+        case arrow::Type::LARGE_BINARY:
+            return KeyColumnSpec{KeyColumnKind::LARGE_BINARY, 0};
+        default:
+            return KeyColumnSpec{
+                    KeyColumnKind::FIXED_WIDTH,
+                    static_cast<const arrow::FixedWidthType&>(type).bit_width() / 8
+            };
+    }
+}
+
+template<typename OFFSET_T, typename FUNC>
+inline void VisitBinaryValues(const arrow::ArrayData& data, const uint8_t* validity, FUNC&& func) {
+    const auto* offsets = reinterpret_cast<const OFFSET_T*>(data.buffers[1]->data()) + data.offset;
+    const uint8_t* values = data.buffers[2] != nullptr ? data.buffers[2]->data() : nullptr;
+    for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+        bool is_valid = validity == nullptr || arrow::BitUtil::GetBit(validity, data.offset + row_idx);
+        func(row_idx, is_valid, values + offsets[row_idx],
+             static_cast<uint32_t>(offsets[row_idx + 1] - offsets[row_idx]));
+    }
+}
+
+/**
+ * Calls func(row_idx, is_valid, const uint8_t* value, uint32_t value_size) for every row of the column.
+ * Booleans are passed as a single byte.
+ */
+template<typename FUNC>
+inline void VisitKeyColumn(const KeyColumnSpec& column, const arrow::ArrayData& data, FUNC&& func) {
+    const uint8_t* validity =
+            data.buffers[0] != nullptr && data.GetNullCount() != 0 ? data.buffers[0]->data() : nullptr;
+
+    switch (column.kind) {
+        case KeyColumnKind::FIXED_WIDTH: {
+            const uint8_t* values = data.buffers[1]->data() + data.offset * column.byte_width;
+            for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+                bool is_valid = validity == nullptr || arrow::BitUtil::GetBit(validity, data.offset + row_idx);
+                func(row_idx, is_valid, values + row_idx * column.byte_width, column.byte_width);
+            }
+            break;
+        }
+        case KeyColumnKind::BOOLEAN: {
+            const uint8_t* values = data.buffers[1]->data();
+            for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+                bool is_valid = validity == nullptr || arrow::BitUtil::GetBit(validity, data.offset + row_idx);
+                func(row_idx, is_valid, &BOOL_BYTES[arrow::BitUtil::GetBit(values, data.offset + row_idx)], 1);
+            }
+            break;
+        }
+        case KeyColumnKind::BINARY:
+            VisitBinaryValues<int32_t>(data, validity, func);
+            break;
+        case KeyColumnKind::LARGE_BINARY:
+            VisitBinaryValues<int64_t>(data, validity, func);
+            break;
+    }
+}
+
+/**
+ * Group key encoded into bytes: null bitmap of the key columns followed by
+ * the values of non-null columns, fixed width values are stored inline,
+ * strings and binaries are prefixed with their uint32 length.
+ * The hash is computed over the column values, not over the encoded bytes.
+ */
+struct EncodedKey {
+    const uint8_t* data;
+    uint32_t size;
+    size_t hash;
+
+    bool operator==(const EncodedKey& other) const {
+        return size == other.size && std::memcmp(data, other.data, size) == 0;
+    }
+};
+
+class EncodedKeyHasher {
+public:
+    std::size_t operator()(const EncodedKey& key) const {
+        return key.hash;
+    }
+};
+
+/**
+ * Encodes and hashes the keys of all the rows of a batch into a single buffer, see EncodedKey.
+ * Keys are valid until the next batch is encoded.
+ */
+class BatchKeyEncoder {
+public:
+    BatchKeyEncoder() = default;
+
+    // Keys of the columns col_indices of the schema.
+    BatchKeyEncoder(const arrow::Schema& schema, const std::vector<int>& col_indices);
+
+    [[nodiscard]] bool IsInitialized() const {
+        return !this->key_columns.empty();
+    }
+
+    void Encode(const arrow::RecordBatch& batch);
+
+    [[nodiscard]] inline EncodedKey Key(int64_t row_idx) const {
+        return EncodedKey{
+                this->batch_keys.data() + this->key_offsets[row_idx],
+                this->key_offsets[row_idx + 1] - this->key_offsets[row_idx],
+                this->key_hashes[row_idx]
+        };
+    }
+
+    // True if any of the key columns is null in the row.
+    [[nodiscard]] inline bool HasNull(int64_t row_idx) const {
+        const uint8_t* null_bitmap = this->batch_keys.data() + this->key_offsets[row_idx];
+        for (int byte_idx = 0; byte_idx < this->null_bitmap_size; byte_idx++) {
+            if (null_bitmap[byte_idx] != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<int> col_indices;
+    std::vector<KeyColumnSpec> key_columns;
+    int null_bitmap_size = 0;
+
+    // Encoded keys of the current batch
+    std::vector<uint8_t> batch_keys;
+    std::vector<uint32_t> key_offsets;  // Offset of every row's key in batch_keys, num_rows + 1 entries
+    std::vector<uint32_t> write_offsets;  // Scratch space of EncodeKeys()
+    std::vector<size_t> key_hashes;
+
+    void EncodeKeys(const arrow::RecordBatch& batch);
+    void HashKeys(const arrow::RecordBatch& batch);
+};
+
+}  // namespace vinum::operators::aggregate
@@ -14,12 +14,10 @@ void MultiNumericalHashAggregate::SetBatchArrays(const std::shared_ptr<arrow::Re
 }
 
 
-std::vector<std::shared_ptr<void>> &
+uint32_t
 MultiNumericalHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
                                               const int& row_idx,
                                               bool& is_new_entry) {
-    static const auto num_groupby_cols = this->groupby_col_indices.size();
-
     std::vector<IntKeyValue> key;
     key.reserve(this->iters.size());
     for (const auto& iter : this->iters) {
@@ -28,32 +26,18 @@ MultiNumericalHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::Recor
         key.emplace_back(IntKeyValue{iter->NextAsUInt64(), is_null});
     }
 
-    const auto &entry_pair = this->groups.find(key);
+    return this->FindOrCreateGroup(&key, is_new_entry);
+}
+
+uint32_t MultiNumericalHashAggregate::FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry) {
+    const auto &entry_pair = this->groups.find(*key);
 
     if (entry_pair == this->groups.end()) {
         is_new_entry = true;
-
-        auto entry = std::make_unique<std::vector<std::shared_ptr<void>>>();
-        entry->reserve(num_groupby_cols);
-        return *(this->groups[key] = std::move(entry));
+        return this->groups[*key] = this->num_groups++;
     } else {
         is_new_entry = false;
-        return *entry_pair->second;
-    }
-}
-
-void MultiNumericalHashAggregate::SummarizeGroups() {
-    const auto num_groups = this->groups.size();
-    for (const auto &agg_func : this->agg_funcs) {
-        agg_func->Reserve(num_groups);
-    }
-
-    for (const auto &group : this->groups) {
-        auto &entry = *group.second;
-        for (int agg_idx = 0, size = this->agg_funcs.size(); agg_idx < size; agg_idx++) {
-            const auto &agg_func = this->agg_funcs[agg_idx];
-            agg_func->Summarize(entry[agg_idx]);
-        }
+        return entry_pair->second;
     }
 }
 
@@ -71,5 +55,9 @@ void MultiNumericalHashAggregate::EnsureInitAggFuncs(const shared_ptr<arrow::Sch
     }
 }
 
+void MultiNumericalHashAggregate::ReleaseGroups() {
+    this->groups = decltype(this->groups)();
+}
+
 
 }  // namespace vinum::operators::aggregate
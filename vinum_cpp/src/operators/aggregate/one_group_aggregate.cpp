@@ -1,5 +1,7 @@
 #include "one_group_aggregate.h"
 
+#include "common/timer.h"
+
 namespace vinum::operators::aggregate {
 
 OneGroupAggregate::OneGroupAggregate(const std::vector<AggFuncDef>& agg_funcs)
@@ -7,36 +9,30 @@ OneGroupAggregate::OneGroupAggregate(const std::vector<AggFuncDef>& agg_funcs)
 
 
 void OneGroupAggregate::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
-    this->EnsureInitAggFuncs(batch->schema());
-    this->SetBatchArrays(batch);
-
-    if (this->group->empty()) {
-        for (const auto &agg_func : this->agg_funcs) {
-            this->group->push_back(
-                agg_func->InitBatch()
-            );
+    {
+        common::ScopedTimer timer(this->stats.update_nanos);
+        this->EnsureInitAggFuncs(batch->schema());
+        this->SetBatchArrays(batch);
+
+        // The only group always has id 0.
+        if (this->num_groups == 0) {
+            for (const auto &agg_func : this->agg_funcs) {
+                agg_func->InitBatch();
+            }
+            this->num_groups = 1;
         }
-    }
-
-    for (auto agg_idx = this->agg_col_indices.size(), size = this->agg_funcs.size();
-         agg_idx < size; agg_idx++) {
-        const auto &agg_func = this->agg_funcs[agg_idx];
-        agg_func->UpdateBatch((*this->group)[agg_idx]);
-    }
-}
-
-void OneGroupAggregate::SummarizeGroups() {
-    for (const auto &agg_func : this->agg_funcs) {
-        agg_func->Reserve(1);
-    }
 
-    for (int agg_idx = 0, size = this->agg_funcs.size(); agg_idx < size; agg_idx++) {
-        const auto &agg_func = this->agg_funcs[agg_idx];
-        agg_func->Summarize((*this->group)[agg_idx]);
+        for (auto agg_idx = this->agg_col_indices.size(), size = this->agg_funcs.size();
+             agg_idx < size; agg_idx++) {
+            const auto &agg_func = this->agg_funcs[agg_idx];
+            agg_func->UpdateBatch(0);
+        }
     }
+    // The states are accounted once updated, as by the hash aggregates.
+    this->TrackBatch(*batch);
 }
 
-vector<std::shared_ptr<void>> &
+uint32_t
 OneGroupAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
                                     const int& row_idx,
                                     bool& is_new_entry) {
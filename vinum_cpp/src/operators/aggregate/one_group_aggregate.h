@@ -11,16 +11,12 @@ public:
 
     explicit OneGroupAggregate(const std::vector<AggFuncDef>& agg_funcs);
 
-    void Next(const std::shared_ptr<arrow::RecordBatch>& batch) override;
-
-protected:
-    std::unique_ptr<std::vector<std::shared_ptr<void>>> group =
-            std::make_unique<std::vector<std::shared_ptr<void>>>();
+    using BaseAggregate::Next;
 
-    void SummarizeGroups() override;
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch) override;
 
 private:
-    vector<std::shared_ptr<void>> &
+    uint32_t
     GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
                      const int& row_idx,
                      bool& is_new_entry) override;
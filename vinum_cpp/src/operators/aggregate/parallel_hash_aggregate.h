@@ -0,0 +1,277 @@
+#pragma once
+
+#include "base_aggregate.h"
+#include "common/thread_pool.h"
+
+#include <arrow/api.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace vinum::operators::aggregate {
+
+/**
+ * Multi-threaded hash aggregate, AGG is one of the hash aggregates
+ * (Single/Multi numerical or Generic).
+ *
+ * Next() may be called concurrently from several threads, each concurrent call
+ * aggregates its batch into its own partial aggregate, which is not shared with other threads
+ * while the batch is processed. Number of partial aggregates is equal to the max number of
+ * concurrent Next() calls.
+ *
+ * Result() merges the partial aggregates: groups of each partial aggregate are
+ * radix partitioned on the key hash, then each partition is merged by a separate task,
+ * so partitions never share a key and the merged partitions are simply concatenated.
+ * NextResult() streams the merged partitions batch by batch instead.
+ * Result() and NextResult() must not be called concurrently with Next().
+ */
+template<typename AGG>
+class ParallelHashAggregate {
+public:
+    using KEY_TYPE = typename AGG::KEY_TYPE;
+
+    ParallelHashAggregate(const std::vector<std::string>& groupby_cols,
+                          const std::vector<std::string>& agg_cols,
+                          const std::vector<AggFuncDef>& agg_funcs,
+                          size_t num_threads)
+            : groupby_col_names(groupby_cols),
+              agg_col_names(agg_cols),
+              agg_func_specs(agg_funcs),
+              pool(num_threads),
+              num_partitions(NumPartitions(num_threads)) {}
+
+    // Rows of the batch at the selection are aggregated, all the rows if the selection is nullptr.
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch,
+              const std::shared_ptr<arrow::Array>& selection = nullptr) {
+        PartialGuard guard(*this, batch->schema());
+        guard.partial->Next(batch, selection);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> Result() {
+        auto merged = this->MergePartials();
+        if (merged.size() == 1) {
+            auto result = merged[0]->Result();
+            this->result_merged_stats = MergedStats(merged);
+            return result;
+        }
+
+        std::vector<std::shared_ptr<arrow::RecordBatch>> results(merged.size());
+        this->pool.ParallelFor(merged.size(), [&merged, &results](size_t partition_idx) {
+            results[partition_idx] = merged[partition_idx]->Result();
+        });
+        this->result_merged_stats = MergedStats(merged);
+
+        return concatenate_batches(results, this->ArrowPool());
+    }
+
+    // See BaseAggregate::NextResult(), Next() must not be called afterwards.
+    std::shared_ptr<arrow::RecordBatch> NextResult(int64_t batch_size) {
+        if (!this->is_result_started) {
+            this->is_result_started = true;
+            this->merged = this->MergePartials();
+            std::vector<BaseAggregate*> merged_bases;
+            for (const auto& partition : this->merged) {
+                merged_bases.push_back(partition.get());
+            }
+            this->result_stream = ResultStream(merged_bases);
+        }
+        return this->result_stream.Next(batch_size);
+    }
+
+    // Partial and merged aggregates account their memory in the pool, must be called before Next().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& memory_pool) {
+        this->memory_pool = memory_pool;
+    }
+
+    // Rows of all the batches, at most. Every partial aggregate reserves its hash table for the groups
+    // estimated from its share of the rows, see BaseAggregate::SetExpectedRows(). Must be called before Next().
+    void SetExpectedRows(int64_t num_rows) {
+        this->expected_rows = num_rows;
+    }
+
+    // Activity of all the partial aggregates. Once Result() or NextResult() merged them,
+    // the groups and the summarizing time are of the merged aggregates.
+    [[nodiscard]] AggregateStats AggStats() const {
+        AggregateStats result = this->merged_partial_stats;
+        for (const auto& partial : this->partials) {
+            result.Add(partial->AggStats());
+        }
+        const auto merged_stats = this->merged.empty() ? this->result_merged_stats : MergedStats(this->merged);
+        if (merged_stats.has_value()) {
+            result.num_groups = merged_stats->num_groups;
+            result.result_nanos += merged_stats->result_nanos;
+        }
+        return result;
+    }
+
+private:
+    const std::vector<std::string> groupby_col_names;
+    const std::vector<std::string> agg_col_names;
+    const std::vector<AggFuncDef> agg_func_specs;
+
+    common::ThreadPool pool;
+    const size_t num_partitions;
+    std::shared_ptr<common::QueryMemoryPool> memory_pool = nullptr;
+    int64_t expected_rows = 0;
+
+    std::mutex mutex;
+    std::shared_ptr<arrow::Schema> schema = nullptr;
+    std::vector<std::unique_ptr<AGG>> partials;     // All the partial aggregates
+    std::vector<AGG*> idle_partials;                // Partial aggregates not used by any thread at the moment
+
+    // Holds a partial aggregate for the duration of a Next() call.
+    struct PartialGuard {
+        ParallelHashAggregate<AGG>& parent;
+        AGG* partial;
+
+        PartialGuard(ParallelHashAggregate<AGG>& parent, const std::shared_ptr<arrow::Schema>& schema)
+                : parent(parent) {
+            std::lock_guard<std::mutex> lock(parent.mutex);
+            if (parent.schema == nullptr) {
+                parent.schema = schema;
+            }
+            if (parent.idle_partials.empty()) {
+                parent.partials.push_back(parent.MakeAggregate());
+                parent.partials.back()->SetExpectedRows(
+                        parent.expected_rows / static_cast<int64_t>(parent.pool.Size()));
+                this->partial = parent.partials.back().get();
+            } else {
+                this->partial = parent.idle_partials.back();
+                parent.idle_partials.pop_back();
+            }
+        }
+
+        ~PartialGuard() {
+            std::lock_guard<std::mutex> lock(parent.mutex);
+            parent.idle_partials.push_back(this->partial);
+        }
+    };
+
+    // Merged partitions of the groups of all the partial aggregates, set by NextResult()
+    std::vector<std::unique_ptr<AGG>> merged;
+    ResultStream result_stream;
+    bool is_result_started = false;
+    AggregateStats merged_partial_stats;    // Activity of the partial aggregates released by MergePartials()
+    std::optional<AggregateStats> result_merged_stats;     // Activity of the merged aggregates released by Result()
+
+    [[nodiscard]] arrow::MemoryPool* ArrowPool() const {
+        return this->memory_pool ? this->memory_pool.get() : arrow::default_memory_pool();
+    }
+
+    static AggregateStats MergedStats(const std::vector<std::unique_ptr<AGG>>& merged_aggs) {
+        AggregateStats result;
+        for (const auto& partition : merged_aggs) {
+            result.Add(partition->AggStats());
+        }
+        return result;
+    }
+
+    // Merge the partial aggregates into aggregates of disjoint groups, with the same output types.
+    std::vector<std::unique_ptr<AGG>> MergePartials() {
+        std::vector<std::unique_ptr<AGG>> merged;
+        if (this->partials.empty()) {
+            merged.push_back(this->MakeAggregate());
+            return merged;
+        }
+        for (const auto& partial : this->partials) {
+            this->merged_partial_stats.Add(partial->AggStats());
+        }
+        if (this->partials.size() == 1) {
+            merged.push_back(std::move(this->partials[0]));
+            this->partials.clear();
+            this->idle_partials.clear();
+            return merged;
+        }
+
+        // Partition the groups of every partial aggregate: partitioned[partial_idx][partition_idx]
+        std::vector<std::vector<std::vector<GroupRef<KEY_TYPE>>>> partitioned(this->partials.size());
+        this->pool.ParallelFor(this->partials.size(), [this, &partitioned](size_t partial_idx) {
+            auto& partitions = partitioned[partial_idx];
+            partitions.resize(this->num_partitions);
+            this->partials[partial_idx]->ForEachGroup([this, &partitions](const KEY_TYPE* key, uint32_t group_id) {
+                partitions[this->PartitionOf(AGG::HashKey(key))].push_back(GroupRef<KEY_TYPE>{key, group_id});
+            });
+        });
+
+        merged.resize(this->num_partitions);
+        this->pool.ParallelFor(this->num_partitions, [this, &partitioned, &merged](size_t partition_idx) {
+            merged[partition_idx] = this->MergePartition(partitioned, partition_idx);
+        });
+        // Merged aggregates own copies of the keys, the partial aggregates are not needed anymore.
+        partitioned.clear();
+        this->partials.clear();
+        this->idle_partials.clear();
+
+        std::vector<BaseAggregate*> merged_bases;
+        for (const auto& partition : merged) {
+            merged_bases.push_back(partition.get());
+        }
+        BaseAggregate::UnifyOutputTypes(merged_bases);
+        return merged;
+    }
+
+    std::unique_ptr<AGG> MakeAggregate() const {
+        auto aggregate = std::make_unique<AGG>(this->groupby_col_names, this->agg_col_names, this->agg_func_specs);
+        aggregate->SetMemoryPool(this->memory_pool);
+        return aggregate;
+    }
+
+    // A few partitions per thread, so that merge tasks are balanced even if the keys are skewed.
+    static size_t NumPartitions(size_t num_threads) {
+        size_t num_partitions = 1;
+        while (num_partitions < num_threads * 4) {
+            num_partitions <<= 1;
+        }
+        return num_partitions;
+    }
+
+    // Key hashes are not necessarily well mixed (ie std::hash of an integer), so mix them first.
+    inline size_t PartitionOf(size_t hash) const {
+        return ((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 32) & (this->num_partitions - 1);
+    }
+
+    std::unique_ptr<AGG> MergePartition(const std::vector<std::vector<std::vector<GroupRef<KEY_TYPE>>>>& partitioned,
+                                        size_t partition_idx) {
+        auto merged = this->MakeAggregate();
+        BaseAggregate& merged_base = *merged;
+        merged_base.EnsureInitAggFuncs(this->schema);
+
+        // Groups of the partition are at least the groups of any of the partial aggregates.
+        size_t max_partial_groups = 0;
+        for (size_t partial_idx = 0, size = this->partials.size(); partial_idx < size; partial_idx++) {
+            max_partial_groups = std::max(max_partial_groups, partitioned[partial_idx][partition_idx].size());
+        }
+        merged_base.ReserveGroups(max_partial_groups);
+
+        std::vector<uint32_t> partial_group_ids;
+        std::vector<uint32_t> group_ids;
+        for (size_t partial_idx = 0, size = this->partials.size(); partial_idx < size; partial_idx++) {
+            const auto& groups = partitioned[partial_idx][partition_idx];
+            partial_group_ids.resize(groups.size());
+            group_ids.resize(groups.size());
+            for (size_t idx = 0; idx < groups.size(); idx++) {
+                bool is_new_entry;
+                group_ids[idx] = merged->FindOrCreateGroup(groups[idx].key, is_new_entry);
+                partial_group_ids[idx] = groups[idx].group_id;
+            }
+
+            const BaseAggregate& partial_base = *this->partials[partial_idx];
+            for (size_t agg_idx = 0, num_funcs = merged_base.agg_funcs.size(); agg_idx < num_funcs; agg_idx++) {
+                const auto& agg_func = merged_base.agg_funcs[agg_idx];
+                agg_func->Resize(merged_base.num_groups);
+                agg_func->Merge(*partial_base.agg_funcs[agg_idx],
+                                partial_group_ids.data(),
+                                group_ids.data(),
+                                groups.size());
+            }
+            merged_base.ReserveMemory();
+        }
+        return merged;
+    }
+};
+
+}  // namespace vinum::operators::aggregate
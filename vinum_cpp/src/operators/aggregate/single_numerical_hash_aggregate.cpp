@@ -1,79 +1,305 @@
 #include "single_numerical_hash_aggregate.h"
 
+#include <arrow/util/bit_util.h>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
 
 namespace vinum::operators::aggregate {
 
+namespace {
+
+// Min/max biased key of the non-null values, returns false if all the values are null.
+template<typename T>
+bool BiasedKeyRange(const arrow::ArrayData& data, uint64_t key_bias, uint64_t& min_key, uint64_t& max_key) {
+    const T* values = data.GetValues<T>(1);
+    const uint8_t* validity = data.buffers[0] != nullptr ? data.buffers[0]->data() : nullptr;
+    bool has_value = false;
+    for (int64_t i = 0; i < data.length; i++) {
+        if (validity != nullptr && !arrow::BitUtil::GetBit(validity, data.offset + i)) {
+            continue;
+        }
+        const uint64_t key = static_cast<uint64_t>(values[i]) ^ key_bias;
+        if (!has_value) {
+            min_key = max_key = key;
+            has_value = true;
+        } else if (key < min_key) {
+            min_key = key;
+        } else if (key > max_key) {
+            max_key = key;
+        }
+    }
+    return has_value;
+}
+
+// Key of the value, same as ArrayIter::NextAsUInt64(): integers are cast, floats keep their bits.
+template<typename T>
+inline uint64_t KeyOf(T val) {
+    if constexpr (std::is_floating_point_v<T>) {
+        uint64_t key = 0;
+        std::memcpy(&key, &val, sizeof(T));
+        return key;
+    } else {
+        return static_cast<uint64_t>(val);
+    }
+}
+
+bool IsSignedKeyType(arrow::Type::type type_id) {
+    switch (type_id) {
+        case arrow::Type::UINT8:
+        case arrow::Type::UINT16:
+        case arrow::Type::UINT32:
+        case arrow::Type::UINT64:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool IsDirectKeyType(arrow::Type::type type_id) {
+    switch (type_id) {
+        case arrow::Type::INT8:
+        case arrow::Type::INT16:
+        case arrow::Type::INT32:
+        case arrow::Type::INT64:
+        case arrow::Type::UINT8:
+        case arrow::Type::UINT16:
+        case arrow::Type::UINT32:
+        case arrow::Type::UINT64:
+        case arrow::Type::DATE32:
+        case arrow::Type::DATE64:
+        case arrow::Type::TIME32:
+        case arrow::Type::TIME64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::DURATION:
+        case arrow::Type::INTERVAL_MONTHS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
 
 void SingleNumericalHashAggregate::SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch) {
     BaseAggregate::SetBatchArrays(batch);
 
     auto col = batch->column(this->groupby_col_indices[0]);
     this->iter->SetArray(col);
+
+    if (this->is_direct) {
+        this->UpdateDirectWindow(*col->data());
+    }
+}
+
+void SingleNumericalHashAggregate::UpdateDirectWindow(const arrow::ArrayData& data) {
+    uint64_t min_key = 0, max_key = 0;
+    bool has_value;
+    switch (data.type->id()) {
+        case arrow::Type::INT8:
+            has_value = BiasedKeyRange<int8_t>(data, this->key_bias, min_key, max_key);
+            break;
+        case arrow::Type::INT16:
+            has_value = BiasedKeyRange<int16_t>(data, this->key_bias, min_key, max_key);
+            break;
+        case arrow::Type::INT32:
+        case arrow::Type::DATE32:
+        case arrow::Type::TIME32:
+        case arrow::Type::INTERVAL_MONTHS:
+            has_value = BiasedKeyRange<int32_t>(data, this->key_bias, min_key, max_key);
+            break;
+        case arrow::Type::UINT8:
+            has_value = BiasedKeyRange<uint8_t>(data, this->key_bias, min_key, max_key);
+            break;
+        case arrow::Type::UINT16:
+            has_value = BiasedKeyRange<uint16_t>(data, this->key_bias, min_key, max_key);
+            break;
+        case arrow::Type::UINT32:
+            has_value = BiasedKeyRange<uint32_t>(data, this->key_bias, min_key, max_key);
+            break;
+        case arrow::Type::UINT64:
+            has_value = BiasedKeyRange<uint64_t>(data, this->key_bias, min_key, max_key);
+            break;
+        default:
+            has_value = BiasedKeyRange<int64_t>(data, this->key_bias, min_key, max_key);
+            break;
+    }
+    if (!has_value) {
+        return;
+    }
+
+    if (this->direct_groups.empty()) {
+        if (max_key - min_key >= MAX_DIRECT_RANGE) {
+            this->DisableDirectWindow();
+            return;
+        }
+        this->direct_base = min_key;
+        this->direct_groups.assign(max_key - min_key + 1, NO_GROUP);
+        return;
+    }
+
+    const uint64_t window_min = std::min(min_key, this->direct_base);
+    const uint64_t window_max = std::max(max_key, this->direct_base + this->direct_groups.size() - 1);
+    if (window_max - window_min >= MAX_DIRECT_RANGE) {
+        this->DisableDirectWindow();
+        return;
+    }
+    if (window_min < this->direct_base) {
+        this->direct_groups.insert(this->direct_groups.begin(), this->direct_base - window_min, NO_GROUP);
+        this->direct_base = window_min;
+    }
+    this->direct_groups.resize(window_max - window_min + 1, NO_GROUP);
+}
+
+void SingleNumericalHashAggregate::DisableDirectWindow() {
+    this->is_direct = false;
+    this->direct_groups.clear();
+    this->direct_groups.shrink_to_fit();
 }
 
 
-std::vector<std::shared_ptr<void>> &
+uint32_t
 SingleNumericalHashAggregate::GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
                                                const int& row_idx,
                                                bool& is_new_entry) {
-    static const auto num_groupby_cols = this->groupby_col_indices.size();
     bool is_null = this->iter->IsNull();
     auto key = this->iter->NextAsUInt64();
 
-    // Check NULL group first
-    if (is_null) {
-        is_new_entry = false;
-        if (this->null_group == nullptr) {
-            this->null_group = std::move(std::make_unique<std::vector<std::shared_ptr<void>>>());
-            this->null_group->reserve(num_groupby_cols);
-            is_new_entry = true;
+    if (this->is_direct && !is_null) {
+        // The hash map is still updated on the first occurrence of the key, it holds all the groups.
+        auto& group_id = this->direct_groups[(key ^ this->key_bias) - this->direct_base];
+        if (group_id != NO_GROUP) {
+            is_new_entry = false;
+            return group_id;
         }
-        return *this->null_group;
+        return group_id = this->FindOrCreateGroup(&key, is_new_entry);
     }
 
-    const auto& entry_pair = this->groups.find(key);
-
-    if (entry_pair == this->groups.end()) {
-        is_new_entry = true;
+    return this->FindOrCreateGroup(is_null ? nullptr : &key, is_new_entry);
+}
 
-        auto entry = std::make_unique<std::vector<std::shared_ptr<void>>>();
-        entry->reserve(num_groupby_cols);
-        return *(this->groups[key] = std::move(entry));
-    } else {
-        is_new_entry = false;
-        return *entry_pair->second;
+void SingleNumericalHashAggregate::AssignGroupIds(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                  uint32_t* group_ids) {
+    const auto& data = *batch->column(this->groupby_col_indices[0])->data();
+    switch (data.type->id()) {
+        case arrow::Type::INT8:
+            return this->AssignGroupIdsTyped<int8_t>(data, group_ids);
+        case arrow::Type::INT16:
+            return this->AssignGroupIdsTyped<int16_t>(data, group_ids);
+        case arrow::Type::INT32:
+        case arrow::Type::DATE32:
+        case arrow::Type::TIME32:
+        case arrow::Type::INTERVAL_MONTHS:
+            return this->AssignGroupIdsTyped<int32_t>(data, group_ids);
+        case arrow::Type::INT64:
+        case arrow::Type::DATE64:
+        case arrow::Type::TIME64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::DURATION:
+            return this->AssignGroupIdsTyped<int64_t>(data, group_ids);
+        case arrow::Type::UINT8:
+            return this->AssignGroupIdsTyped<uint8_t>(data, group_ids);
+        case arrow::Type::UINT16:
+        case arrow::Type::HALF_FLOAT:
+            return this->AssignGroupIdsTyped<uint16_t>(data, group_ids);
+        case arrow::Type::UINT32:
+            return this->AssignGroupIdsTyped<uint32_t>(data, group_ids);
+        case arrow::Type::UINT64:
+            return this->AssignGroupIdsTyped<uint64_t>(data, group_ids);
+        case arrow::Type::FLOAT:
+            return this->AssignGroupIdsTyped<float>(data, group_ids);
+        case arrow::Type::DOUBLE:
+            return this->AssignGroupIdsTyped<double>(data, group_ids);
+        default:
+            return BaseAggregate::AssignGroupIds(batch, group_ids);
     }
 }
 
-void SingleNumericalHashAggregate::SummarizeGroups() {
-    const auto num_groups = this->groups.size() + ((this->null_group != nullptr) ? 1 : 0);
-    for (const auto &agg_func : this->agg_funcs) {
-        agg_func->Reserve(num_groups);
+template<typename T>
+void SingleNumericalHashAggregate::AssignGroupIdsTyped(const arrow::ArrayData& data, uint32_t* group_ids) {
+    if (this->is_direct) {
+        this->AssignGroupIdsTyped<T, true>(data, group_ids);
+    } else {
+        this->AssignGroupIdsTyped<T, false>(data, group_ids);
     }
+}
 
-    for (const auto &group : this->groups) {
-        SummarizeAggFunc(*group.second);
+template<typename T, bool IS_DIRECT>
+void SingleNumericalHashAggregate::AssignGroupIdsTyped(const arrow::ArrayData& data, uint32_t* group_ids) {
+    const T* values = data.GetValues<T>(1);
+    const uint8_t* validity = data.GetNullCount() > 0 ? data.buffers[0]->data() : nullptr;
+    bool is_new_entry;
+    if constexpr (IS_DIRECT) {
+        for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+            if (validity != nullptr && !arrow::BitUtil::GetBit(validity, data.offset + row_idx)) {
+                group_ids[row_idx] = this->FindOrCreateGroup(nullptr, is_new_entry);
+                continue;
+            }
+            // The hash table is still updated on the first occurrence of the key, it holds all the groups.
+            const KEY_TYPE key = KeyOf(values[row_idx]);
+            auto& group_id = this->direct_groups[(key ^ this->key_bias) - this->direct_base];
+            if (group_id == NO_GROUP) {
+                group_id = this->FindOrCreateGroup(&key, is_new_entry);
+            }
+            group_ids[row_idx] = group_id;
+        }
+        return;
     }
 
-    if (this->null_group != nullptr) {
-        SummarizeAggFunc(*this->null_group);
+    KEY_TYPE keys[PROBE_CHUNK_ROWS];
+    size_t hashes[PROBE_CHUNK_ROWS];
+    for (int64_t chunk_begin = 0; chunk_begin < data.length; chunk_begin += PROBE_CHUNK_ROWS) {
+        const int64_t chunk_rows = std::min(PROBE_CHUNK_ROWS, data.length - chunk_begin);
+        // Slots of the whole chunk are fetched in parallel, before the first probe waits for its slot.
+        for (int64_t idx = 0; idx < chunk_rows; idx++) {
+            keys[idx] = KeyOf(values[chunk_begin + idx]);
+            hashes[idx] = IntGroupTable::Hash(keys[idx]);
+            this->groups.Prefetch(hashes[idx]);
+        }
+        for (int64_t idx = 0; idx < chunk_rows; idx++) {
+            const int64_t row_idx = chunk_begin + idx;
+            if (validity != nullptr && !arrow::BitUtil::GetBit(validity, data.offset + row_idx)) {
+                group_ids[row_idx] = this->FindOrCreateGroup(nullptr, is_new_entry);
+            } else {
+                group_ids[row_idx] = this->FindOrCreateGroup(keys[idx], hashes[idx], is_new_entry);
+            }
+        }
     }
 }
 
-void SingleNumericalHashAggregate::SummarizeAggFunc(const std::vector<std::shared_ptr<void>>& entry) {
-    for (int agg_idx = 0, size = this->agg_funcs.size(); agg_idx < size; agg_idx++) {
-        const auto &agg_func = this->agg_funcs[agg_idx];
-        agg_func->Summarize(entry[agg_idx]);
+uint32_t SingleNumericalHashAggregate::FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry) {
+    // Check NULL group first
+    if (key == nullptr) {
+        is_new_entry = false;
+        if (this->null_group_id == NO_GROUP) {
+            this->null_group_id = this->num_groups++;
+            is_new_entry = true;
+        }
+        return this->null_group_id;
     }
+
+    return this->FindOrCreateGroup(*key, IntGroupTable::Hash(*key), is_new_entry);
 }
 
 void SingleNumericalHashAggregate::EnsureInitAggFuncs(const shared_ptr<arrow::Schema>& table_schema) {
     BaseAggregate::EnsureInitAggFuncs(table_schema);
 
     if (this->iter == nullptr) {
-        this->iter = std::move(common::array_iter_factory(table_schema->field(groupby_col_indices[0])->type()->id()));
+        const auto type_id = table_schema->field(groupby_col_indices[0])->type()->id();
+        this->iter = std::move(common::array_iter_factory(type_id));
+        this->is_direct = IsDirectKeyType(type_id);
+        this->key_bias = IsSignedKeyType(type_id) ? (1ULL << 63) : 0;
     }
 }
 
+void SingleNumericalHashAggregate::ReleaseGroups() {
+    this->groups = decltype(this->groups)();
+    this->direct_groups = std::vector<uint32_t>();
+    this->is_direct = false;
+}
+
 
 }  // namespace vinum::operators::aggregate
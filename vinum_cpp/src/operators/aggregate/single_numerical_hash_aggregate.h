@@ -1,43 +1,108 @@
 #pragma once
 
 #include "base_aggregate.h"
+#include "int_group_table.h"
 #include "common/array_iterators.h"
 
-#include "common/robin_hood.h"
-
 
 namespace vinum::operators::aggregate {
 
+/**
+ * Hash aggregate on a single numerical column.
+ *
+ * If the keys are integers within a range of less than MAX_DIRECT_RANGE values,
+ * rows get the group id from a direct indexed table over the key range, so only the first
+ * occurrence of each key is hashed. The window follows the keys seen so far and is
+ * dropped for good once the range grows too wide.
+ *
+ * The vectorized path reads the keys of the numerical types directly from the values buffer,
+ * with a loop instantiated for the C type of the key column. Outside of the direct window
+ * the keys are probed in chunks of PROBE_CHUNK_ROWS: all the keys of the chunk are hashed
+ * and their slots prefetched first, then each key is found or inserted with a single probe.
+ */
 class SingleNumericalHashAggregate : public BaseAggregate {
 public:
 
+    typedef uint64_t KEY_TYPE;
+
     using BaseAggregate::BaseAggregate;
 
+    // Returns id of the group with the given key, nullptr key stands for the NULL group.
+    uint32_t FindOrCreateGroup(const KEY_TYPE* key, bool& is_new_entry);
+
+    // Calls func(const KEY_TYPE* key, uint32_t group_id) for every group, key is nullptr for the NULL group.
+    template<typename FUNC>
+    void ForEachGroup(FUNC&& func) const {
+        this->groups.ForEach(func);
+        if (this->null_group_id != NO_GROUP) {
+            func(nullptr, this->null_group_id);
+        }
+    }
+
+    static inline size_t HashKey(const KEY_TYPE* key) {
+        return key != nullptr ? IntGroupTable::Hash(*key) : 0;
+    }
 
 protected:
-    typedef uint64_t KEY_TYPE;
 
     void SetBatchArrays(const std::shared_ptr<arrow::RecordBatch>& batch) override;
 
     void EnsureInitAggFuncs(const shared_ptr<arrow::Schema>& table_schema) override;
 
+    void ReleaseGroups() override;
 
-private:
-    robin_hood::unordered_map <
-            KEY_TYPE,
-            std::unique_ptr<std::vector<std::shared_ptr<void>>> > groups;
+    [[nodiscard]] size_t GroupTableCapacity() const override {
+        return this->groups.capacity();
+    }
 
-    std::unique_ptr<std::vector<std::shared_ptr<void>>> null_group = nullptr;
-    std::unique_ptr<common::ArrayIter> iter = nullptr;
+    [[nodiscard]] size_t GroupTableMemoryUsage() const override {
+        return this->groups.MemoryUsage() + this->direct_groups.capacity() * sizeof(uint32_t);
+    }
+
+    void ReserveGroups(size_t num_groups) override {
+        // Keys within the direct window are not hashed.
+        if (!this->is_direct) {
+            this->groups.Reserve(num_groups);
+        }
+    }
 
+    void AssignGroupIds(const std::shared_ptr<arrow::RecordBatch>& batch, uint32_t* group_ids) override;
 
-    std::vector <std::shared_ptr<void>> &GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
-                                                          const int& row_idx,
-                                                          bool& is_new_entry) override;
-    void SummarizeGroups() override;
 
 private:
-    inline void SummarizeAggFunc(const std::vector<std::shared_ptr<void>>& entry);
+    static constexpr uint32_t NO_GROUP = std::numeric_limits<uint32_t>::max();
+    static constexpr uint64_t MAX_DIRECT_RANGE = 1 << 16;
+    static constexpr int64_t PROBE_CHUNK_ROWS = 64;
+
+    IntGroupTable groups;
+
+    uint32_t null_group_id = NO_GROUP;
+    std::unique_ptr<common::ArrayIter> iter = nullptr;
+
+    // Direct indexed groups: direct_groups[biased key - direct_base], NO_GROUP if the key is not seen yet.
+    // Keys are biased so that the order of signed keys is preserved as unsigned.
+    bool is_direct = false;
+    uint64_t key_bias = 0;
+    uint64_t direct_base = 0;
+    std::vector<uint32_t> direct_groups;
+
+    template<typename T>
+    void AssignGroupIdsTyped(const arrow::ArrayData& data, uint32_t* group_ids);
+    template<typename T, bool IS_DIRECT>
+    void AssignGroupIdsTyped(const arrow::ArrayData& data, uint32_t* group_ids);
+
+    void UpdateDirectWindow(const arrow::ArrayData& data);
+    void DisableDirectWindow();
+
+    inline uint32_t FindOrCreateGroup(KEY_TYPE key, size_t hash, bool& is_new_entry) {
+        const uint32_t group_id = this->groups.FindOrInsert(key, hash, this->num_groups, is_new_entry);
+        this->num_groups += is_new_entry;
+        return group_id;
+    }
+
+    uint32_t GetOrCreateEntry(const std::shared_ptr<arrow::RecordBatch>& batch,
+                              const int& row_idx,
+                              bool& is_new_entry) override;
 
 };
 
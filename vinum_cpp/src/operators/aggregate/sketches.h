@@ -0,0 +1,264 @@
+#pragma once
+
+#include "common/robin_hood.h"
+#include "agg_state.h"
+
+#include <arrow/util/bit_util.h>
+#include <arrow/util/string_view.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+
+namespace vinum::operators::aggregate {
+
+// Hash of a value added to a HyperLogLog sketch, of its DistinctKey so that the values
+// counted once by COUNT(DISTINCT) are also hashed the same.
+template<typename T>
+inline uint64_t SketchHash(const T& val) {
+    const auto key = DistinctKey<T>::Of(val);
+    return robin_hood::hash_bytes(&key, sizeof(key));
+}
+
+inline uint64_t SketchHash(arrow::util::string_view val) {
+    return robin_hood::hash_bytes(val.data(), val.size());
+}
+
+/**
+ * HyperLogLog sketches of all the groups, for the approximate number of distinct values.
+ *
+ * Every group has a fixed number of one byte registers, kept in a single contiguous vector
+ * indexed by the dense group id. The registers of a group hold the maximum rank of the hashes
+ * of its values, so that the sketches of the same group of two partial aggregates are merged
+ * by taking the maximum of every register. The standard error of the estimate
+ * is 1.04 / sqrt(NUM_REGISTERS), ie about 1.6%.
+ */
+class HyperLogLogColumn {
+public:
+    static constexpr int PRECISION = 12;
+    static constexpr uint32_t NUM_REGISTERS = 1U << PRECISION;
+
+    // Grow the column to num_groups, new groups are empty.
+    inline void Resize(uint32_t num_groups) {
+        registers.resize(static_cast<size_t>(num_groups) * NUM_REGISTERS, 0);
+    }
+
+    inline void AppendEmpty() {
+        this->Resize(this->size() + 1);
+    }
+
+    // The first PRECISION bits of the hash select the register, the rank is the position
+    // of the first set bit of the remaining ones.
+    inline void Add(uint32_t group_id, uint64_t hash) {
+        const auto register_idx = static_cast<uint32_t>(hash >> (64 - PRECISION));
+        const uint64_t rest = (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+        const auto rank = static_cast<uint8_t>(arrow::BitUtil::CountLeadingZeros(rest) + 1);
+        auto& reg = registers[static_cast<size_t>(group_id) * NUM_REGISTERS + register_idx];
+        reg = std::max(reg, rank);
+    }
+
+    inline void Merge(const HyperLogLogColumn& other, uint32_t other_group_id, uint32_t group_id) {
+        uint8_t* regs = this->Registers(group_id);
+        const uint8_t* other_regs = other.Registers(other_group_id);
+        for (uint32_t idx = 0; idx < NUM_REGISTERS; idx++) {
+            regs[idx] = std::max(regs[idx], other_regs[idx]);
+        }
+    }
+
+    // Estimate of the number of distinct values, corrected with linear counting
+    // while many registers are still empty.
+    [[nodiscard]] uint64_t Estimate(uint32_t group_id) const {
+        const uint8_t* regs = this->Registers(group_id);
+        double sum = 0;
+        uint32_t num_zeros = 0;
+        for (uint32_t idx = 0; idx < NUM_REGISTERS; idx++) {
+            sum += std::ldexp(1.0, -regs[idx]);
+            num_zeros += regs[idx] == 0;
+        }
+        const double m = NUM_REGISTERS;
+        double estimate = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+        if (estimate <= 2.5 * m && num_zeros > 0) {
+            estimate = m * std::log(m / num_zeros);
+        }
+        return static_cast<uint64_t>(std::llround(estimate));
+    }
+
+    [[nodiscard]] inline uint8_t* Registers(uint32_t group_id) {
+        return registers.data() + static_cast<size_t>(group_id) * NUM_REGISTERS;
+    }
+
+    [[nodiscard]] inline const uint8_t* Registers(uint32_t group_id) const {
+        return registers.data() + static_cast<size_t>(group_id) * NUM_REGISTERS;
+    }
+
+    [[nodiscard]] inline uint32_t size() const {
+        return static_cast<uint32_t>(registers.size() / NUM_REGISTERS);
+    }
+
+    [[nodiscard]] inline size_t MemoryUsage() const {
+        return registers.capacity();
+    }
+
+private:
+    std::vector<uint8_t> registers;
+};
+
+
+/**
+ * Merging t-digest, for the approximate quantiles of a group.
+ *
+ * Values are appended to a buffer, which is merged into the sorted centroids once full.
+ * A centroid may only absorb its neighbours while its weight stays below
+ * 4 * n * q * (1 - q) / compression, so that the centroids are small at the tails
+ * and the number of centroids, hence the memory of a digest, is bounded by the compression.
+ * Digests of two partial aggregates are merged by adding the centroids of one to the other.
+ */
+class TDigest {
+public:
+    static constexpr double COMPRESSION = 100;
+    static constexpr size_t BUFFER_SIZE = 256;
+
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    inline void Add(double value) {
+        this->AddCentroid(Centroid{value, 1}, value, value);
+    }
+
+    void Merge(const TDigest& other) {
+        if (other.IsEmpty()) {
+            return;
+        }
+        for (const auto& centroid : other.centroids) {
+            this->AddCentroid(centroid, other.min, other.max);
+        }
+        for (const auto& centroid : other.buffer) {
+            this->AddCentroid(centroid, other.min, other.max);
+        }
+    }
+
+    [[nodiscard]] inline bool IsEmpty() const {
+        return this->total_weight == 0;
+    }
+
+    // Value at the quantile q of [0, 1], interpolated between the centers of the centroids.
+    double Quantile(double q) {
+        this->Compress();
+        if (this->centroids.empty()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (q <= 0) {
+            return this->min;
+        }
+        if (q >= 1) {
+            return this->max;
+        }
+        if (this->centroids.size() == 1) {
+            return this->centroids[0].mean;
+        }
+
+        const double index = q * this->total_weight;
+        const auto& first = this->centroids.front();
+        if (index < first.weight / 2) {
+            return this->min + (first.mean - this->min) * index / (first.weight / 2);
+        }
+        double weight_so_far = first.weight / 2;
+        for (size_t idx = 0; idx + 1 < this->centroids.size(); idx++) {
+            const auto& left = this->centroids[idx];
+            const auto& right = this->centroids[idx + 1];
+            const double delta = (left.weight + right.weight) / 2;
+            if (weight_so_far + delta > index) {
+                return left.mean + (right.mean - left.mean) * (index - weight_so_far) / delta;
+            }
+            weight_so_far += delta;
+        }
+        const auto& last = this->centroids.back();
+        const double fraction = std::min(1.0, (index - weight_so_far) / (last.weight / 2));
+        return last.mean + (this->max - last.mean) * fraction;
+    }
+
+    // Merge the buffer into the centroids.
+    void Compress() {
+        if (this->buffer.empty()) {
+            return;
+        }
+        this->buffer.insert(this->buffer.end(), this->centroids.begin(), this->centroids.end());
+        std::sort(this->buffer.begin(), this->buffer.end(),
+                  [](const Centroid& lhs, const Centroid& rhs) { return lhs.mean < rhs.mean; });
+
+        this->centroids.clear();
+        Centroid current = this->buffer[0];
+        double weight_so_far = 0;
+        for (size_t idx = 1; idx < this->buffer.size(); idx++) {
+            const auto& next = this->buffer[idx];
+            const double proposed = current.weight + next.weight;
+            const double q_left = weight_so_far / this->total_weight;
+            const double q_right = (weight_so_far + proposed) / this->total_weight;
+            const double limit = 4 * this->total_weight
+                    * std::min(q_left * (1 - q_left), q_right * (1 - q_right)) / COMPRESSION;
+            if (proposed <= limit) {
+                current.mean += (next.mean - current.mean) * next.weight / proposed;
+                current.weight = proposed;
+            } else {
+                weight_so_far += current.weight;
+                this->centroids.push_back(current);
+                current = next;
+            }
+        }
+        this->centroids.push_back(current);
+        this->buffer.clear();
+    }
+
+    [[nodiscard]] const std::vector<Centroid>& Centroids() const {
+        return this->centroids;
+    }
+
+    [[nodiscard]] double Min() const {
+        return this->min;
+    }
+
+    [[nodiscard]] double Max() const {
+        return this->max;
+    }
+
+    // Replace the digest with the compressed centroids and the bounds of a serialized digest.
+    void Assign(const Centroid* in_centroids, size_t num_centroids, double in_min, double in_max) {
+        this->centroids.assign(in_centroids, in_centroids + num_centroids);
+        this->buffer.clear();
+        this->total_weight = 0;
+        for (const auto& centroid : this->centroids) {
+            this->total_weight += centroid.weight;
+        }
+        this->min = in_min;
+        this->max = in_max;
+    }
+
+    [[nodiscard]] inline size_t MemoryUsage() const {
+        return (this->centroids.capacity() + this->buffer.capacity()) * sizeof(Centroid);
+    }
+
+private:
+    std::vector<Centroid> centroids;    // Sorted by mean
+    std::vector<Centroid> buffer;
+    double total_weight = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    inline void AddCentroid(const Centroid& centroid, double centroid_min, double centroid_max) {
+        this->buffer.push_back(centroid);
+        this->total_weight += centroid.weight;
+        this->min = std::min(this->min, centroid_min);
+        this->max = std::max(this->max, centroid_max);
+        if (this->buffer.size() >= BUFFER_SIZE) {
+            this->Compress();
+        }
+    }
+};
+
+}  // namespace vinum::operators::aggregate
@@ -0,0 +1,406 @@
+#pragma once
+
+#include "base_aggregate.h"
+#include "key_encoding.h"
+
+#include "common/robin_hood.h"
+#include "common/spill_file.h"
+#include "common/util.h"
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace vinum::operators::aggregate {
+
+// Spilling activity of a SpillingHashAggregate.
+struct SpillStats {
+    uint64_t bytes_spilled = 0;      // Bytes written to the spill files
+    uint32_t num_spills = 0;         // Number of times the in-memory groups were spilled
+    uint32_t num_partitions = 0;     // Number of non-empty spill partitions
+};
+
+/**
+ * Hash aggregate with a memory limit, AGG is one of the hash aggregates
+ * (Single/Multi numerical, Composite key, Dictionary or Generic).
+ *
+ * Groups are aggregated in memory until their states exceed memory_limit bytes,
+ * or the memory pool of the query has no room for them,
+ * then the groups are radix partitioned on the key hash, the partial states of every partition
+ * are appended to the partition's Arrow IPC file in spill_dir and the aggregation continues
+ * with an empty table. Result() spills the remaining groups and re-aggregates the partitions
+ * one at a time, so the memory is bounded by the largest partition.
+ * Partitions are not re-partitioned, ie a partition that does not fit the limit is still
+ * aggregated in memory.
+ *
+ * Spilled states are serialized by AbstractAggFunc::SerializeStates(), the keys are
+ * the serialized states of the group builders, so all the group by columns are aggregated
+ * with a group builder and the columns not in agg_cols are dropped from the result.
+ */
+template<typename AGG>
+class SpillingHashAggregate {
+public:
+    using KEY_TYPE = typename AGG::KEY_TYPE;
+
+    static constexpr size_t DEFAULT_NUM_PARTITIONS = 16;
+
+    SpillingHashAggregate(const std::vector<std::string>& groupby_cols,
+                          const std::vector<std::string>& agg_cols,
+                          const std::vector<AggFuncDef>& agg_funcs,
+                          size_t memory_limit,
+                          const std::string& spill_dir,
+                          size_t num_partitions = DEFAULT_NUM_PARTITIONS)
+            : groupby_col_names(groupby_cols),
+              agg_col_names(agg_cols),
+              agg_func_specs(agg_funcs),
+              memory_limit(memory_limit),
+              spill_dir(spill_dir),
+              num_partitions(NumPartitions(num_partitions)),
+              partitions(this->num_partitions),
+              current(MakeAggregate()) {}
+
+    ~SpillingHashAggregate() {
+        this->RemoveSpillFiles();
+    }
+
+    // Rows of the batch at the selection are aggregated, all the rows if the selection is nullptr.
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch,
+              const std::shared_ptr<arrow::Array>& selection = nullptr) {
+        if (this->schema == nullptr) {
+            this->schema = batch->schema();
+        }
+        this->current->Next(batch, selection);
+
+        if (this->MemoryUsage() > this->memory_limit || this->current->is_over_memory_limit) {
+            this->Spill();
+        }
+    }
+
+    // In-memory aggregates account their memory in the pool, must be called before Next().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& memory_pool) {
+        this->memory_pool = memory_pool;
+        this->current = this->MakeAggregate();
+    }
+
+    std::shared_ptr<arrow::RecordBatch> Result() {
+        if (this->stats.num_spills == 0) {
+            return this->Project(this->current->Result());
+        }
+
+        auto merged = this->MergeSpilled();
+        std::vector<std::shared_ptr<arrow::RecordBatch>> results;
+        for (const auto& partition : merged) {
+            results.push_back(partition->Result());
+        }
+        this->result_merged_stats = MergedStats(merged);
+        return this->Project(concatenate_batches(
+                results, this->memory_pool ? this->memory_pool.get() : arrow::default_memory_pool()));
+    }
+
+    // See BaseAggregate::NextResult(), spilled partitions are re-aggregated by the first call.
+    std::shared_ptr<arrow::RecordBatch> NextResult(int64_t batch_size) {
+        if (!this->is_result_started) {
+            this->is_result_started = true;
+            std::vector<BaseAggregate*> result_bases;
+            if (this->stats.num_spills == 0) {
+                result_bases.push_back(this->current.get());
+            } else {
+                this->merged = this->MergeSpilled();
+                for (const auto& partition : this->merged) {
+                    result_bases.push_back(partition.get());
+                }
+            }
+            this->result_stream = ResultStream(result_bases);
+        }
+        auto batch = this->result_stream.Next(batch_size);
+        return batch != nullptr ? this->Project(batch) : nullptr;
+    }
+
+    [[nodiscard]] const SpillStats& Stats() const {
+        return this->stats;
+    }
+
+    // Activity of all the in-memory aggregates. Once Result() or NextResult() re-aggregated the partitions,
+    // the groups and the summarizing time are of the re-aggregated partitions.
+    [[nodiscard]] AggregateStats AggStats() const {
+        AggregateStats result = this->spilled_agg_stats;
+        result.Add(this->current->AggStats());
+        const auto merged_stats = this->merged.empty() ? this->result_merged_stats : MergedStats(this->merged);
+        if (merged_stats.has_value()) {
+            result.num_groups = merged_stats->num_groups;
+            result.result_nanos += merged_stats->result_nanos;
+        }
+        return result;
+    }
+
+private:
+    struct SpillPartition {
+        std::string path;
+        std::shared_ptr<arrow::Schema> schema = nullptr;
+        std::shared_ptr<arrow::io::FileOutputStream> file = nullptr;
+        std::shared_ptr<arrow::ipc::RecordBatchWriter> writer = nullptr;
+        int64_t bytes_written = 0;
+    };
+
+    const std::vector<std::string> groupby_col_names;
+    const std::vector<std::string> agg_col_names;
+    const std::vector<AggFuncDef> agg_func_specs;
+
+    const size_t memory_limit;
+    const std::string spill_dir;
+    const size_t num_partitions;
+
+    std::shared_ptr<common::QueryMemoryPool> memory_pool = nullptr;
+    std::shared_ptr<arrow::Schema> schema = nullptr;
+    std::vector<SpillPartition> partitions;
+    std::unique_ptr<AGG> current;      // Groups aggregated since the last spill
+    SpillStats stats;
+    AggregateStats spilled_agg_stats;  // Activity of the in-memory aggregates replaced by Spill()
+    std::optional<AggregateStats> result_merged_stats;     // Activity of the partitions released by Result()
+
+    // Re-aggregated partitions, set by NextResult()
+    std::vector<std::unique_ptr<AGG>> merged;
+    ResultStream result_stream;
+    bool is_result_started = false;
+
+    static AggregateStats MergedStats(const std::vector<std::unique_ptr<AGG>>& merged_aggs) {
+        AggregateStats result;
+        for (const auto& partition : merged_aggs) {
+            result.Add(partition->AggStats());
+        }
+        return result;
+    }
+
+    // Spill the remaining groups and re-aggregate every partition, with the same output types.
+    std::vector<std::unique_ptr<AGG>> MergeSpilled() {
+        this->Spill();
+        for (auto& partition : this->partitions) {
+            if (partition.writer != nullptr) {
+                RAISE_ON_ARROW_FAILURE(partition.writer->Close());
+                RAISE_ON_ARROW_FAILURE(partition.file->Close());
+            }
+        }
+
+        std::vector<std::unique_ptr<AGG>> merged;
+        for (const auto& partition : this->partitions) {
+            if (partition.writer != nullptr) {
+                merged.push_back(this->MergePartition(partition));
+            }
+        }
+        this->RemoveSpillFiles();
+
+        std::vector<BaseAggregate*> merged_bases;
+        for (const auto& partition : merged) {
+            merged_bases.push_back(partition.get());
+        }
+        BaseAggregate::UnifyOutputTypes(merged_bases);
+        return merged;
+    }
+
+    // In-memory aggregate of the groups until the next spill, exceeding the pool triggers the spill.
+    std::unique_ptr<AGG> MakeAggregate() const {
+        auto aggregate = std::make_unique<AGG>(this->groupby_col_names, this->groupby_col_names, this->agg_func_specs);
+        aggregate->SetMemoryPool(this->memory_pool);
+        BaseAggregate& base = *aggregate;
+        base.is_spillable = true;
+        return aggregate;
+    }
+
+    static size_t NumPartitions(size_t num_partitions) {
+        size_t power_of_two = 1;
+        while (power_of_two < num_partitions) {
+            power_of_two <<= 1;
+        }
+        return power_of_two;
+    }
+
+    // See ParallelHashAggregate::PartitionOf()
+    inline size_t PartitionOf(size_t hash) const {
+        return ((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 32) & (this->num_partitions - 1);
+    }
+
+    // States of the groups and the hash table entries, the hash table is estimated.
+    [[nodiscard]] size_t MemoryUsage() const {
+        const BaseAggregate& base = *this->current;
+        return base.MemoryUsage() + base.num_groups * 2 * (sizeof(KEY_TYPE) + sizeof(uint32_t));
+    }
+
+    void Spill() {
+        const BaseAggregate& base = *this->current;
+        if (base.num_groups == 0) {
+            return;
+        }
+
+        std::vector<std::vector<uint32_t>> partition_groups(this->num_partitions);
+        this->current->ForEachGroup([this, &partition_groups](const KEY_TYPE* key, uint32_t group_id) {
+            partition_groups[this->PartitionOf(AGG::HashKey(key))].push_back(group_id);
+        });
+
+        for (size_t partition_idx = 0; partition_idx < this->num_partitions; partition_idx++) {
+            const auto& group_ids = partition_groups[partition_idx];
+            if (group_ids.empty()) {
+                continue;
+            }
+            std::vector<std::shared_ptr<arrow::Array>> columns;
+            for (const auto& agg_func : base.agg_funcs) {
+                agg_func->SerializeStates(group_ids.data(), group_ids.size(), columns);
+            }
+            this->WritePartition(partition_idx, columns);
+        }
+
+        this->stats.num_spills++;
+        this->spilled_agg_stats.Add(this->current->AggStats());
+        this->current = this->MakeAggregate();
+    }
+
+    void WritePartition(size_t partition_idx, const std::vector<std::shared_ptr<arrow::Array>>& columns) {
+        auto& partition = this->partitions[partition_idx];
+        if (partition.writer == nullptr) {
+            std::vector<std::shared_ptr<arrow::Field>> fields;
+            for (size_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+                fields.push_back(arrow::field("state_" + std::to_string(col_idx), columns[col_idx]->type()));
+            }
+            partition.schema = arrow::schema(fields);
+            partition.path = common::MakeSpillFilePath(this->spill_dir, "vinum_agg", partition_idx);
+
+            auto file_res = arrow::io::FileOutputStream::Open(partition.path);
+            RAISE_ON_ARROW_FAILURE(file_res.status());
+            partition.file = file_res.ValueOrDie();
+            auto writer_res = arrow::ipc::MakeFileWriter(partition.file, partition.schema);
+            RAISE_ON_ARROW_FAILURE(writer_res.status());
+            partition.writer = writer_res.ValueOrDie();
+            this->stats.num_partitions++;
+        }
+
+        auto batch = arrow::RecordBatch::Make(partition.schema, columns[0]->length(), columns);
+        RAISE_ON_ARROW_FAILURE(partition.writer->WriteRecordBatch(*batch));
+
+        auto position_res = partition.file->Tell();
+        RAISE_ON_ARROW_FAILURE(position_res.status());
+        this->stats.bytes_spilled += position_res.ValueOrDie() - partition.bytes_written;
+        partition.bytes_written = position_res.ValueOrDie();
+    }
+
+    // Re-aggregate the spilled states of a partition, groups are looked up by the encoded keys.
+    std::unique_ptr<AGG> MergePartition(const SpillPartition& partition) const {
+        auto merged = this->MakeAggregate();
+        BaseAggregate& merged_base = *merged;
+        // Partitions are not re-partitioned, a partition not fitting the pool fails the query.
+        merged_base.is_spillable = false;
+        merged_base.EnsureInitAggFuncs(this->schema);
+        auto spilled = this->MakeAggregate();
+        BaseAggregate& spilled_base = *spilled;
+        spilled_base.EnsureInitAggFuncs(this->schema);
+
+        auto file_res = arrow::io::ReadableFile::Open(partition.path);
+        RAISE_ON_ARROW_FAILURE(file_res.status());
+        auto reader_res = arrow::ipc::RecordBatchFileReader::Open(file_res.ValueOrDie());
+        RAISE_ON_ARROW_FAILURE(reader_res.status());
+        const auto reader = reader_res.ValueOrDie();
+
+        std::vector<KeyColumnSpec> key_specs;
+        for (size_t col_idx = 0; col_idx < this->groupby_col_names.size(); col_idx++) {
+            key_specs.push_back(MakeKeyColumnSpec(*partition.schema->field(col_idx)->type()));
+        }
+
+        robin_hood::unordered_map<std::string, uint32_t> groups;
+        std::vector<std::string> keys;
+        std::vector<uint32_t> spilled_group_ids;
+        std::vector<uint32_t> group_ids;
+        for (int batch_idx = 0; batch_idx < reader->num_record_batches(); batch_idx++) {
+            auto batch_res = reader->ReadRecordBatch(batch_idx);
+            RAISE_ON_ARROW_FAILURE(batch_res.status());
+            const auto batch = batch_res.ValueOrDie();
+            const auto num_rows = batch->num_rows();
+
+            size_t col_idx = 0;
+            for (const auto& agg_func : spilled_base.agg_funcs) {
+                col_idx = agg_func->DeserializeStates(batch->columns(), col_idx);
+            }
+
+            EncodeKeys(key_specs, *batch, keys);
+            spilled_group_ids.resize(num_rows);
+            group_ids.resize(num_rows);
+            for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+                const auto& entry = groups.emplace(std::move(keys[row_idx]), merged_base.num_groups);
+                if (entry.second) {
+                    merged_base.num_groups++;
+                }
+                group_ids[row_idx] = entry.first->second;
+                spilled_group_ids[row_idx] = row_idx;
+            }
+
+            for (size_t agg_idx = 0, num_funcs = merged_base.agg_funcs.size(); agg_idx < num_funcs; agg_idx++) {
+                const auto& agg_func = merged_base.agg_funcs[agg_idx];
+                agg_func->Resize(merged_base.num_groups);
+                agg_func->Merge(*spilled_base.agg_funcs[agg_idx],
+                                spilled_group_ids.data(),
+                                group_ids.data(),
+                                num_rows);
+            }
+            merged_base.ReserveMemory();
+        }
+        return merged;
+    }
+
+    // Key of every row: null flag of every key column followed by the length prefixed value bytes.
+    static void EncodeKeys(const std::vector<KeyColumnSpec>& key_specs,
+                           const arrow::RecordBatch& batch,
+                           std::vector<std::string>& keys) {
+        keys.assign(batch.num_rows(), std::string());
+        for (size_t col_idx = 0; col_idx < key_specs.size(); col_idx++) {
+            VisitKeyColumn(key_specs[col_idx], *batch.column_data(col_idx),
+                           [&keys](int64_t row_idx, bool is_valid, const uint8_t* value, uint32_t value_size) {
+                auto& key = keys[row_idx];
+                key.push_back(is_valid ? 1 : 0);
+                if (is_valid) {
+                    key.append(reinterpret_cast<const char*>(&value_size), sizeof(uint32_t));
+                    key.append(reinterpret_cast<const char*>(value), value_size);
+                }
+            });
+        }
+    }
+
+    // Result of the inner aggregates has all the group by columns, keep only agg_cols of them.
+    std::shared_ptr<arrow::RecordBatch> Project(const std::shared_ptr<arrow::RecordBatch>& batch) const {
+        std::vector<int> col_indices;
+        for (const auto& col_name : this->agg_col_names) {
+            for (size_t col_idx = 0; col_idx < this->groupby_col_names.size(); col_idx++) {
+                if (this->groupby_col_names[col_idx] == col_name) {
+                    col_indices.push_back(static_cast<int>(col_idx));
+                    break;
+                }
+            }
+        }
+        for (int col_idx = static_cast<int>(this->groupby_col_names.size()); col_idx < batch->num_columns(); col_idx++) {
+            col_indices.push_back(col_idx);
+        }
+
+        std::vector<std::shared_ptr<arrow::Field>> fields;
+        std::vector<std::shared_ptr<arrow::Array>> columns;
+        for (int col_idx : col_indices) {
+            fields.push_back(batch->schema()->field(col_idx));
+            columns.push_back(batch->column(col_idx));
+        }
+        return arrow::RecordBatch::Make(arrow::schema(fields), batch->num_rows(), columns);
+    }
+
+    void RemoveSpillFiles() {
+        for (auto& partition : this->partitions) {
+            if (!partition.path.empty()) {
+                std::remove(partition.path.c_str());
+                partition.path.clear();
+            }
+        }
+    }
+};
+
+}  // namespace vinum::operators::aggregate
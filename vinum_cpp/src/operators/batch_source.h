@@ -0,0 +1,26 @@
+#pragma once
+
+#include <arrow/api.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace vinum::operators {
+
+/**
+ * Source of the batches of a Pipeline, read by one or several workers.
+ */
+class BatchSource {
+public:
+    virtual ~BatchSource() = default;
+
+    // Next batch of the worker, nullptr once the source is exhausted.
+    // May be called concurrently, with distinct worker indices below NumWorkers().
+    virtual std::shared_ptr<arrow::RecordBatch> Next(size_t worker_idx) = 0;
+
+    [[nodiscard]] virtual std::shared_ptr<arrow::Schema> Schema() const = 0;
+
+    [[nodiscard]] virtual size_t NumWorkers() const = 0;
+};
+
+}  // namespace vinum::operators
@@ -0,0 +1,178 @@
+#include "csv_stream_reader.h"
+
+#include "common/util.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+
+namespace vinum::operators {
+
+namespace {
+
+// Length of the block up to and including its last line end, 0 if the block has no line end.
+int64_t WholeLinesLength(const arrow::Buffer& block) {
+    const auto* data = block.data();
+    for (int64_t pos = block.size(); pos > 0; pos--) {
+        if (data[pos - 1] == '\n' || data[pos - 1] == '\r') {
+            return pos;
+        }
+    }
+    return 0;
+}
+
+std::vector<std::shared_ptr<arrow::RecordBatch>> TableBatches(const std::shared_ptr<arrow::Table>& table) {
+    std::vector<std::shared_ptr<arrow::RecordBatch>> table_batches;
+    arrow::TableBatchReader table_reader(*table);
+    RAISE_ON_ARROW_FAILURE(table_reader.ReadAll(&table_batches));
+    return table_batches;
+}
+
+}  // namespace
+
+
+CsvStreamReader::CsvStreamReader(const std::string& path,
+                                 const arrow::csv::ReadOptions& read_options,
+                                 const arrow::csv::ParseOptions& parse_options,
+                                 size_t num_threads,
+                                 size_t read_ahead)
+        : read_options(read_options),
+          parse_options(parse_options),
+          convert_options(arrow::csv::ConvertOptions::Defaults()),
+          num_threads(std::max<size_t>(num_threads, 1)),
+          read_ahead(std::max<size_t>(read_ahead, 1)),
+          pool(std::max<size_t>(num_threads, 1)) {
+    if (parse_options.newlines_in_values) {
+        throw std::runtime_error("Newlines in CSV values are not supported by the parallel CSV reader.");
+    }
+    if (read_options.block_size <= 0) {
+        throw std::runtime_error("CSV block size must be positive: " + std::to_string(read_options.block_size));
+    }
+    auto file_res = arrow::io::ReadableFile::Open(path);
+    RAISE_ON_ARROW_FAILURE(file_res.status());
+    this->input = file_res.ValueOrDie();
+
+    auto first_block = this->ReadBlock();
+    if (first_block == nullptr) {
+        throw std::runtime_error("Empty CSV file: " + path);
+    }
+    auto first_table = this->ParseBlock(first_block);
+
+    // Header and skipped rows are only at the start of the file.
+    this->read_options.column_names = first_table->schema()->field_names();
+    this->read_options.autogenerate_column_names = false;
+    this->read_options.skip_rows = 0;
+
+    // Types are inferred from the first block with rows, the blocks before it hold only the header.
+    while (first_table->num_rows() == 0) {
+        const auto block = this->ReadBlock();
+        if (block == nullptr) {
+            break;
+        }
+        first_table = this->ParseBlock(block);
+    }
+    const auto first_batches = TableBatches(first_table);
+    this->batches.insert(this->batches.end(), first_batches.begin(), first_batches.end());
+    this->schema = first_table->schema();
+    for (const auto& field : this->schema->fields()) {
+        this->convert_options.column_types[field->name()] = field->type();
+    }
+}
+
+std::shared_ptr<arrow::RecordBatch> CsvStreamReader::Next(size_t) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (this->batches.empty()) {
+        this->ReadAhead();
+        if (this->parsed_blocks.empty()) {
+            return nullptr;
+        }
+        auto block = std::move(this->parsed_blocks.front());
+        this->parsed_blocks.pop_front();
+        // The freed slot is refilled before waiting, to keep the pool busy.
+        this->ReadAhead();
+        // The parse is waited for without the lock, the other consumers take the next blocks meanwhile.
+        lock.unlock();
+        block.done.get();
+        lock.lock();
+        this->batches.insert(this->batches.end(), block.batches->begin(), block.batches->end());
+    }
+    auto batch = this->batches.front();
+    this->batches.pop_front();
+    return batch;
+}
+
+std::shared_ptr<arrow::Schema> CsvStreamReader::Schema() const {
+    return this->schema;
+}
+
+size_t CsvStreamReader::NumWorkers() const {
+    return this->num_threads;
+}
+
+std::shared_ptr<arrow::Buffer> CsvStreamReader::ReadBlock() {
+    auto block = this->partial_line;
+    this->partial_line = nullptr;
+    while (!this->is_eof) {
+        auto read_res = this->input->Read(this->read_options.block_size);
+        RAISE_ON_ARROW_FAILURE(read_res.status());
+        auto data = read_res.ValueOrDie();
+        if (data->size() == 0) {
+            this->is_eof = true;
+            break;
+        }
+        if (block != nullptr) {
+            auto concat_res = arrow::ConcatenateBuffers({block, data});
+            RAISE_ON_ARROW_FAILURE(concat_res.status());
+            block = concat_res.ValueOrDie();
+        } else {
+            block = data;
+        }
+
+        // Lines longer than the block are read until their end.
+        const int64_t length = WholeLinesLength(*block);
+        if (length > 0) {
+            if (length < block->size()) {
+                this->partial_line = arrow::SliceBuffer(block, length);
+            }
+            return arrow::SliceBuffer(block, 0, length);
+        }
+    }
+    // Last line of the file, without a line end.
+    return block != nullptr && block->size() > 0 ? block : nullptr;
+}
+
+void CsvStreamReader::ReadAhead() {
+    while (this->parsed_blocks.size() < this->read_ahead) {
+        auto block = this->ReadBlock();
+        if (block == nullptr) {
+            return;
+        }
+        ParsedBlock parsed;
+        parsed.batches = std::make_shared<std::vector<std::shared_ptr<arrow::RecordBatch>>>();
+        parsed.done = this->pool.Submit([this, block, batches = parsed.batches]() {
+            *batches = TableBatches(this->ParseBlock(block));
+        });
+        this->parsed_blocks.push_back(std::move(parsed));
+    }
+}
+
+std::shared_ptr<arrow::Table> CsvStreamReader::ParseBlock(const std::shared_ptr<arrow::Buffer>& block) const {
+    auto block_options = this->read_options;
+    block_options.use_threads = false;
+    // The whole block is parsed at once, into a single chunk.
+    block_options.block_size = static_cast<int32_t>(
+            std::min<int64_t>(block->size() + 1, std::numeric_limits<int32_t>::max()));
+
+    auto reader_res = arrow::csv::TableReader::Make(arrow::default_memory_pool(),
+                                                    std::make_shared<arrow::io::BufferReader>(block),
+                                                    block_options,
+                                                    this->parse_options,
+                                                    this->convert_options);
+    RAISE_ON_ARROW_FAILURE(reader_res.status());
+    auto table_res = reader_res.ValueOrDie()->Read();
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    return table_res.ValueOrDie();
+}
+
+}  // namespace vinum::operators
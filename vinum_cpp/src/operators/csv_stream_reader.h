@@ -0,0 +1,84 @@
+#pragma once
+
+#include "batch_source.h"
+#include "common/thread_pool.h"
+
+#include <arrow/api.h>
+#include <arrow/csv/api.h>
+#include <arrow/io/api.h>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vinum::operators {
+
+/**
+ * Streaming reader of a CSV file, parsing the blocks of the file on a thread pool.
+ *
+ * The file is read in blocks of read_options.block_size bytes, cut after the last line end
+ * of the block, so that every block holds whole lines and is parsed independently.
+ * The first block is parsed on construction, with the header and the type inference of
+ * the options, the following blocks are parsed with the column names of the first one and
+ * the types inferred from the first block with rows.
+ *
+ * Up to read_ahead blocks are read and parsed ahead of the consumer, the reading stops
+ * once as many parsed blocks wait for the consumer, so the memory stays bounded.
+ * The blocks are taken by the consumers in the order of the file, a single consumer
+ * gets the batches in the order of the file.
+ *
+ * Blocks are only cut on line ends, so parse_options.newlines_in_values is not supported.
+ */
+class CsvStreamReader : public BatchSource {
+public:
+    CsvStreamReader(const std::string& path,
+                    const arrow::csv::ReadOptions& read_options,
+                    const arrow::csv::ParseOptions& parse_options,
+                    size_t num_threads,
+                    size_t read_ahead);
+
+    // Next batch of the file, any worker may take any batch.
+    std::shared_ptr<arrow::RecordBatch> Next(size_t worker_idx = 0) override;
+
+    [[nodiscard]] std::shared_ptr<arrow::Schema> Schema() const override;
+
+    [[nodiscard]] size_t NumWorkers() const override;
+
+private:
+    // Batches of a block, set by the parsing task once done is ready.
+    struct ParsedBlock {
+        std::future<void> done;
+        std::shared_ptr<std::vector<std::shared_ptr<arrow::RecordBatch>>> batches;
+    };
+
+    std::shared_ptr<arrow::io::InputStream> input;
+    arrow::csv::ReadOptions read_options;
+    const arrow::csv::ParseOptions parse_options;
+    arrow::csv::ConvertOptions convert_options;
+    const size_t num_threads;
+    const size_t read_ahead;
+
+    std::shared_ptr<arrow::Schema> schema;
+    std::shared_ptr<arrow::Buffer> partial_line = nullptr;      // Lines after the last line end read so far
+    bool is_eof = false;
+
+    std::deque<ParsedBlock> parsed_blocks;
+    std::deque<std::shared_ptr<arrow::RecordBatch>> batches;
+    std::mutex mutex;
+
+    // Last member, so that the parsing tasks finish before the rest of the reader is destroyed.
+    common::ThreadPool pool;
+
+    // Next block of whole lines, nullptr at the end of the file.
+    std::shared_ptr<arrow::Buffer> ReadBlock();
+
+    void ReadAhead();
+
+    // Table of the block, parsed with the current options.
+    [[nodiscard]] std::shared_ptr<arrow::Table> ParseBlock(const std::shared_ptr<arrow::Buffer>& block) const;
+};
+
+}  // namespace vinum::operators
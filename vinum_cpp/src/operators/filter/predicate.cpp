@@ -0,0 +1,503 @@
+#include "predicate.h"
+
+#include <arrow/util/bit_util.h>
+#include <arrow/util/string_view.h>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+
+namespace vinum::operators::filter {
+
+namespace {
+
+inline const uint8_t* ValidityBitmap(const arrow::ArrayData& data) {
+    return data.buffers[0] != nullptr && data.GetNullCount() > 0 ? data.buffers[0]->data() : nullptr;
+}
+
+template<typename T, typename V>
+struct NumericColumn {
+    const T* values;
+    const uint8_t* validity;
+    int64_t offset;
+
+    explicit NumericColumn(const arrow::ArrayData& data)
+            : values(data.GetValues<T>(1)), validity(ValidityBitmap(data)), offset(data.offset) {}
+
+    [[nodiscard]] inline bool IsValid(uint32_t row) const {
+        return validity == nullptr || arrow::BitUtil::GetBit(validity, offset + row);
+    }
+
+    [[nodiscard]] inline V Value(uint32_t row) const {
+        return static_cast<V>(values[row]);
+    }
+};
+
+template<typename OFFSET_TYPE>
+struct StringColumn {
+    const OFFSET_TYPE* offsets;
+    const char* data;
+    const uint8_t* validity;
+    int64_t offset;
+
+    explicit StringColumn(const arrow::ArrayData& array_data)
+            : offsets(array_data.GetValues<OFFSET_TYPE>(1)),
+              data(array_data.buffers[2] != nullptr
+                   ? reinterpret_cast<const char*>(array_data.buffers[2]->data()) : ""),
+              validity(ValidityBitmap(array_data)),
+              offset(array_data.offset) {}
+
+    [[nodiscard]] inline bool IsValid(uint32_t row) const {
+        return validity == nullptr || arrow::BitUtil::GetBit(validity, offset + row);
+    }
+
+    [[nodiscard]] inline arrow::util::string_view Value(uint32_t row) const {
+        return arrow::util::string_view(data + offsets[row], offsets[row + 1] - offsets[row]);
+    }
+};
+
+template<typename V>
+struct Constant {
+    V value;
+
+    [[nodiscard]] inline bool IsValid(uint32_t) const {
+        return true;
+    }
+
+    [[nodiscard]] inline V Value(uint32_t) const {
+        return value;
+    }
+};
+
+// Appends the input rows where both operands are valid and cmp(lhs, rhs) == want_true, without branches.
+template<typename CMP, typename LHS, typename RHS>
+void SelectRows(const LHS& lhs, const RHS& rhs, const SelectionVector& input, bool want_true,
+                SelectionVector& output) {
+    const size_t begin = output.size();
+    output.resize(begin + input.size());
+    uint32_t* out = output.data() + begin;
+    size_t num_selected = 0;
+    const CMP cmp;
+    for (uint32_t row : input) {
+        out[num_selected] = row;
+        num_selected += lhs.IsValid(row) & rhs.IsValid(row) & (cmp(lhs.Value(row), rhs.Value(row)) == want_true);
+    }
+    output.resize(begin + num_selected);
+}
+
+// Operands are created from the batch by the MAKE_LHS and MAKE_RHS functors, once per batch.
+template<typename MAKE_LHS, typename MAKE_RHS>
+std::function<void(const arrow::RecordBatch&, const SelectionVector&, bool, SelectionVector&)>
+MakeCompareKernel(CompareOp op, MAKE_LHS make_lhs, MAKE_RHS make_rhs) {
+    return [op, make_lhs, make_rhs](const arrow::RecordBatch& batch, const SelectionVector& input,
+                                    bool want_true, SelectionVector& output) {
+        const auto lhs = make_lhs(batch);
+        const auto rhs = make_rhs(batch);
+        switch (op) {
+            case CompareOp::EQUALS:
+                SelectRows<std::equal_to<>>(lhs, rhs, input, want_true, output);
+                break;
+            case CompareOp::NOT_EQUALS:
+                SelectRows<std::not_equal_to<>>(lhs, rhs, input, want_true, output);
+                break;
+            case CompareOp::LESS:
+                SelectRows<std::less<>>(lhs, rhs, input, want_true, output);
+                break;
+            case CompareOp::LESS_EQUAL:
+                SelectRows<std::less_equal<>>(lhs, rhs, input, want_true, output);
+                break;
+            case CompareOp::GREATER:
+                SelectRows<std::greater<>>(lhs, rhs, input, want_true, output);
+                break;
+            case CompareOp::GREATER_EQUAL:
+                SelectRows<std::greater_equal<>>(lhs, rhs, input, want_true, output);
+                break;
+        }
+    };
+}
+
+// Calls func(T{}) with the C type of the numeric column type, returns false for the other types.
+template<typename FUNC>
+bool VisitNumericType(arrow::Type::type type_id, FUNC&& func) {
+    switch (type_id) {
+        case arrow::Type::INT8:
+            func(int8_t{});
+            return true;
+        case arrow::Type::INT16:
+            func(int16_t{});
+            return true;
+        case arrow::Type::INT32:
+            func(int32_t{});
+            return true;
+        case arrow::Type::INT64:
+            func(int64_t{});
+            return true;
+        case arrow::Type::UINT8:
+            func(uint8_t{});
+            return true;
+        case arrow::Type::UINT16:
+            func(uint16_t{});
+            return true;
+        case arrow::Type::UINT32:
+            func(uint32_t{});
+            return true;
+        case arrow::Type::FLOAT:
+            func(float{});
+            return true;
+        case arrow::Type::DOUBLE:
+            func(double{});
+            return true;
+        default:
+            return false;
+    }
+}
+
+template<typename FUNC>
+bool VisitStringType(arrow::Type::type type_id, FUNC&& func) {
+    switch (type_id) {
+        case arrow::Type::STRING:
+            func(int32_t{});
+            return true;
+        case arrow::Type::LARGE_STRING:
+            func(int64_t{});
+            return true;
+        default:
+            return false;
+    }
+}
+
+CompareOp MirrorOp(CompareOp op) {
+    switch (op) {
+        case CompareOp::LESS:
+            return CompareOp::GREATER;
+        case CompareOp::LESS_EQUAL:
+            return CompareOp::GREATER_EQUAL;
+        case CompareOp::GREATER:
+            return CompareOp::LESS;
+        case CompareOp::GREATER_EQUAL:
+            return CompareOp::LESS_EQUAL;
+        default:
+            return op;
+    }
+}
+
+}  // namespace
+
+
+int Predicate::AddNode(Node node) {
+    for (int arg : node.args) {
+        if (arg < 0 || arg >= static_cast<int>(this->nodes.size())) {
+            throw std::runtime_error("Predicate argument must refer to a node built before.");
+        }
+    }
+    this->nodes.push_back(std::move(node));
+    this->is_bound = false;
+    return static_cast<int>(this->nodes.size()) - 1;
+}
+
+const Predicate::Node& Predicate::Arg(int node_idx) const {
+    return this->nodes[node_idx];
+}
+
+bool Predicate::IsLiteral(const Node& node) const {
+    return node.type == NodeType::INT_LITERAL
+           || node.type == NodeType::DOUBLE_LITERAL
+           || node.type == NodeType::STRING_LITERAL;
+}
+
+int Predicate::Column(const std::string& name) {
+    Node node{NodeType::COLUMN};
+    node.name = name;
+    return this->AddNode(std::move(node));
+}
+
+int Predicate::IntLiteral(int64_t value) {
+    Node node{NodeType::INT_LITERAL};
+    node.int_value = value;
+    return this->AddNode(std::move(node));
+}
+
+int Predicate::DoubleLiteral(double value) {
+    Node node{NodeType::DOUBLE_LITERAL};
+    node.double_value = value;
+    return this->AddNode(std::move(node));
+}
+
+int Predicate::StringLiteral(const std::string& value) {
+    Node node{NodeType::STRING_LITERAL};
+    node.name = value;
+    return this->AddNode(std::move(node));
+}
+
+int Predicate::Compare(CompareOp op, int lhs, int rhs) {
+    Node node{NodeType::COMPARE, {lhs, rhs}, op};
+    const auto is_operand = [this](int arg) {
+        return arg >= 0 && arg < static_cast<int>(this->nodes.size())
+               && (this->nodes[arg].type == NodeType::COLUMN || this->IsLiteral(this->nodes[arg]));
+    };
+    if (!is_operand(lhs) || !is_operand(rhs)) {
+        throw std::runtime_error("Comparison arguments must be columns or literals.");
+    }
+    // Kernels take the column on the left: 5 < col is evaluated as col > 5.
+    if (this->IsLiteral(this->nodes[lhs]) && !this->IsLiteral(this->nodes[rhs])) {
+        node.args = {rhs, lhs};
+        node.op = MirrorOp(op);
+    }
+    return this->AddNode(std::move(node));
+}
+
+int Predicate::IsNull(int arg) {
+    if (arg < 0 || arg >= static_cast<int>(this->nodes.size()) || this->nodes[arg].type != NodeType::COLUMN) {
+        throw std::runtime_error("IS NULL argument must be a column.");
+    }
+    return this->AddNode(Node{NodeType::IS_NULL, {arg}});
+}
+
+int Predicate::And(const std::vector<int>& args) {
+    return this->AddNode(Node{NodeType::AND, args});
+}
+
+int Predicate::Or(const std::vector<int>& args) {
+    return this->AddNode(Node{NodeType::OR, args});
+}
+
+int Predicate::Not(int arg) {
+    return this->AddNode(Node{NodeType::NOT, {arg}});
+}
+
+bool Predicate::Bind(const arrow::Schema& schema) {
+    if (this->nodes.empty()) {
+        throw std::runtime_error("Predicate is empty.");
+    }
+    this->is_bound = false;
+    for (auto& node : this->nodes) {
+        switch (node.type) {
+            case NodeType::COLUMN:
+                node.col_idx = schema.GetFieldIndex(node.name);
+                if (node.col_idx < 0) {
+                    return false;
+                }
+                break;
+            case NodeType::COMPARE:
+                if (!this->BindCompare(node, schema)) {
+                    return false;
+                }
+                break;
+            case NodeType::IS_NULL: {
+                const int col_idx = this->Arg(node.args[0]).col_idx;
+                const bool is_null_type = schema.field(col_idx)->type()->id() == arrow::Type::NA;
+                node.kernel = [col_idx, is_null_type](const arrow::RecordBatch& batch, const SelectionVector& input,
+                                                      bool want_true, SelectionVector& output) {
+                    const auto& data = *batch.column_data(col_idx);
+                    const uint8_t* validity = ValidityBitmap(data);
+                    for (uint32_t row : input) {
+                        const bool is_null = is_null_type
+                                || (validity != nullptr && !arrow::BitUtil::GetBit(validity, data.offset + row));
+                        if (is_null == want_true) {
+                            output.push_back(row);
+                        }
+                    }
+                };
+                break;
+            }
+            case NodeType::AND:
+            case NodeType::OR:
+            case NodeType::NOT:
+                if (node.args.empty()) {
+                    return false;
+                }
+                for (int arg : node.args) {
+                    const auto arg_type = this->Arg(arg).type;
+                    if (arg_type == NodeType::COLUMN || this->IsLiteral(this->Arg(arg))) {
+                        return false;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    const auto root_type = this->nodes.back().type;
+    this->is_bound = root_type != NodeType::COLUMN && !this->IsLiteral(this->nodes.back());
+    return this->is_bound;
+}
+
+bool Predicate::BindCompare(Node& node, const arrow::Schema& schema) {
+    const Node& lhs = this->Arg(node.args[0]);
+    const Node& rhs = this->Arg(node.args[1]);
+    if (lhs.type != NodeType::COLUMN) {
+        // Comparisons of two literals are left to the expressions engine.
+        return false;
+    }
+    const int lhs_idx = lhs.col_idx;
+    const auto lhs_type = schema.field(lhs_idx)->type()->id();
+
+    bool is_bound = false;
+    if (rhs.type == NodeType::COLUMN) {
+        const int rhs_idx = rhs.col_idx;
+        const auto rhs_type = schema.field(rhs_idx)->type()->id();
+        VisitNumericType(lhs_type, [&](auto lhs_value) {
+            using LHS_T = decltype(lhs_value);
+            VisitNumericType(rhs_type, [&](auto rhs_value) {
+                using RHS_T = decltype(rhs_value);
+                using V = std::conditional_t<std::is_floating_point_v<LHS_T> || std::is_floating_point_v<RHS_T>,
+                                             double, int64_t>;
+                node.kernel = MakeCompareKernel(
+                        node.op,
+                        [lhs_idx](const arrow::RecordBatch& batch) {
+                            return NumericColumn<LHS_T, V>(*batch.column_data(lhs_idx));
+                        },
+                        [rhs_idx](const arrow::RecordBatch& batch) {
+                            return NumericColumn<RHS_T, V>(*batch.column_data(rhs_idx));
+                        });
+                is_bound = true;
+            });
+        });
+        VisitStringType(lhs_type, [&](auto lhs_offset) {
+            using LHS_OFFSET = decltype(lhs_offset);
+            VisitStringType(rhs_type, [&](auto rhs_offset) {
+                using RHS_OFFSET = decltype(rhs_offset);
+                node.kernel = MakeCompareKernel(
+                        node.op,
+                        [lhs_idx](const arrow::RecordBatch& batch) {
+                            return StringColumn<LHS_OFFSET>(*batch.column_data(lhs_idx));
+                        },
+                        [rhs_idx](const arrow::RecordBatch& batch) {
+                            return StringColumn<RHS_OFFSET>(*batch.column_data(rhs_idx));
+                        });
+                is_bound = true;
+            });
+        });
+    } else if (rhs.type == NodeType::STRING_LITERAL) {
+        const std::string literal = rhs.name;
+        VisitStringType(lhs_type, [&](auto lhs_offset) {
+            using LHS_OFFSET = decltype(lhs_offset);
+            node.kernel = MakeCompareKernel(
+                    node.op,
+                    [lhs_idx](const arrow::RecordBatch& batch) {
+                        return StringColumn<LHS_OFFSET>(*batch.column_data(lhs_idx));
+                    },
+                    [literal](const arrow::RecordBatch&) {
+                        return Constant<arrow::util::string_view>{arrow::util::string_view(literal)};
+                    });
+            is_bound = true;
+        });
+    } else {
+        const bool is_double_literal = rhs.type == NodeType::DOUBLE_LITERAL;
+        const int64_t int_literal = rhs.int_value;
+        const double double_literal = is_double_literal ? rhs.double_value : static_cast<double>(rhs.int_value);
+        VisitNumericType(lhs_type, [&](auto lhs_value) {
+            using LHS_T = decltype(lhs_value);
+            if (is_double_literal || std::is_floating_point_v<LHS_T>) {
+                // Integer columns are compared with a fractional literal as doubles.
+                node.kernel = MakeCompareKernel(
+                        node.op,
+                        [lhs_idx](const arrow::RecordBatch& batch) {
+                            return NumericColumn<LHS_T, double>(*batch.column_data(lhs_idx));
+                        },
+                        [double_literal](const arrow::RecordBatch&) {
+                            return Constant<double>{double_literal};
+                        });
+            } else {
+                node.kernel = MakeCompareKernel(
+                        node.op,
+                        [lhs_idx](const arrow::RecordBatch& batch) {
+                            return NumericColumn<LHS_T, int64_t>(*batch.column_data(lhs_idx));
+                        },
+                        [int_literal](const arrow::RecordBatch&) {
+                            return Constant<int64_t>{int_literal};
+                        });
+            }
+            is_bound = true;
+        });
+    }
+    return is_bound;
+}
+
+void Predicate::Eval(int node_idx, const arrow::RecordBatch& batch, const SelectionVector& input,
+                     bool want_true, SelectionVector& output) const {
+    const Node& node = this->nodes[node_idx];
+    switch (node.type) {
+        case NodeType::COMPARE:
+        case NodeType::IS_NULL:
+            node.kernel(batch, input, want_true, output);
+            return;
+        case NodeType::NOT:
+            this->Eval(node.args[0], batch, input, !want_true, output);
+            return;
+        case NodeType::AND:
+        case NodeType::OR: {
+            const bool all_args = (node.type == NodeType::AND) == want_true;
+            if (all_args) {
+                // AND is TRUE (OR is FALSE) if all of the arguments are, the rows are refined argument by argument.
+                SelectionVector rows, next_rows;
+                const SelectionVector* current = &input;
+                for (int arg : node.args) {
+                    next_rows.clear();
+                    this->Eval(arg, batch, *current, want_true, next_rows);
+                    rows.swap(next_rows);
+                    current = &rows;
+                    if (rows.empty()) {
+                        break;
+                    }
+                }
+                output.insert(output.end(), current->begin(), current->end());
+            } else {
+                // AND is FALSE (OR is TRUE) if any of the arguments is, every argument is evaluated
+                // only on the rows not selected by the preceding ones.
+                SelectionVector remaining, selected, matched, tmp;
+                const SelectionVector* current = &input;
+                for (int arg : node.args) {
+                    matched.clear();
+                    this->Eval(arg, batch, *current, want_true, matched);
+                    if (matched.empty()) {
+                        continue;
+                    }
+                    tmp.clear();
+                    std::set_union(selected.begin(), selected.end(), matched.begin(), matched.end(),
+                                   std::back_inserter(tmp));
+                    selected.swap(tmp);
+
+                    tmp.clear();
+                    std::set_difference(current->begin(), current->end(), matched.begin(), matched.end(),
+                                        std::back_inserter(tmp));
+                    remaining.swap(tmp);
+                    current = &remaining;
+                    if (remaining.empty()) {
+                        break;
+                    }
+                }
+                output.insert(output.end(), selected.begin(), selected.end());
+            }
+            return;
+        }
+        default:
+            throw std::runtime_error("Predicate node is not a boolean expression.");
+    }
+}
+
+SelectionVector Predicate::Select(const arrow::RecordBatch& batch) const {
+    if (!this->is_bound) {
+        throw std::runtime_error("Predicate must be bound to the schema before the evaluation.");
+    }
+    SelectionVector all_rows(batch.num_rows());
+    std::iota(all_rows.begin(), all_rows.end(), 0);
+
+    SelectionVector selection;
+    selection.reserve(all_rows.size());
+    this->Eval(static_cast<int>(this->nodes.size()) - 1, batch, all_rows, true, selection);
+    return selection;
+}
+
+std::shared_ptr<arrow::RecordBatch> Predicate::Filter(const std::shared_ptr<arrow::RecordBatch>& batch) const {
+    const auto selection = this->Select(*batch);
+    if (static_cast<int64_t>(selection.size()) == batch->num_rows()) {
+        return batch;
+    }
+    return TakeSelected(batch, SelectionToArray(selection));
+}
+
+}  // namespace vinum::operators::filter
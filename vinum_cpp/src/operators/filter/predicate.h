@@ -0,0 +1,100 @@
+#pragma once
+
+#include "selection.h"
+
+#include <arrow/api.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace vinum::operators::filter {
+
+enum class CompareOp {
+    EQUALS, NOT_EQUALS, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL
+};
+
+/**
+ * Boolean predicate evaluated natively into a SelectionVector.
+ *
+ * The predicate is built once from the expression tree, as a flat program of nodes:
+ * every builder method appends a node and returns its index, arguments are the indices of
+ * the nodes built before, and the last node is the root of the predicate.
+ * Bind() resolves the columns against the batch schema and compiles every comparison
+ * into a kernel specialized for the types of its operands.
+ *
+ * Select() evaluates the predicate with the SQL three-valued logic, a row is selected only
+ * if the predicate is TRUE. Every node is evaluated only on the rows left by the preceding
+ * arguments, so the conjuncts of an AND are evaluated on the shrinking selection, and the
+ * arguments of an OR only on the rows not selected yet.
+ */
+class Predicate {
+public:
+    int Column(const std::string& name);
+
+    int IntLiteral(int64_t value);
+
+    int DoubleLiteral(double value);
+
+    int StringLiteral(const std::string& value);
+
+    int Compare(CompareOp op, int lhs, int rhs);
+
+    int IsNull(int arg);
+
+    int And(const std::vector<int>& args);
+
+    int Or(const std::vector<int>& args);
+
+    int Not(int arg);
+
+    // Compile the kernels for the schema, returns false if any of the operand types is not supported.
+    bool Bind(const arrow::Schema& schema);
+
+    [[nodiscard]] SelectionVector Select(const arrow::RecordBatch& batch) const;
+
+    [[nodiscard]] std::shared_ptr<arrow::RecordBatch> Filter(const std::shared_ptr<arrow::RecordBatch>& batch) const;
+
+private:
+    enum class NodeType {
+        COLUMN, INT_LITERAL, DOUBLE_LITERAL, STRING_LITERAL, COMPARE, IS_NULL, AND, OR, NOT
+    };
+
+    // Appends the rows of the input for which the node evaluates to want_true (TRUE or FALSE, never NULL).
+    using Kernel = std::function<void(const arrow::RecordBatch& batch,
+                                      const SelectionVector& input,
+                                      bool want_true,
+                                      SelectionVector& output)>;
+
+    struct Node {
+        NodeType type;
+        std::vector<int> args;
+        CompareOp op = CompareOp::EQUALS;
+
+        std::string name;               // Column name or string literal
+        int64_t int_value = 0;
+        double double_value = 0;
+
+        int col_idx = -1;
+        Kernel kernel;
+    };
+
+    std::vector<Node> nodes;
+    bool is_bound = false;
+
+    int AddNode(Node node);
+
+    const Node& Arg(int node_idx) const;
+
+    [[nodiscard]] bool IsLiteral(const Node& node) const;
+
+    bool BindCompare(Node& node, const arrow::Schema& schema);
+
+    void Eval(int node_idx, const arrow::RecordBatch& batch, const SelectionVector& input,
+              bool want_true, SelectionVector& output) const;
+};
+
+}  // namespace vinum::operators::filter
@@ -0,0 +1,58 @@
+#include "selection.h"
+
+#include "common/util.h"
+
+#include <arrow/compute/api.h>
+
+#include <iostream>
+#include <unordered_set>
+
+
+namespace vinum::operators::filter {
+
+std::shared_ptr<arrow::Array> SelectionToArray(const SelectionVector& selection) {
+    arrow::UInt32Builder indices_builder;
+    std::shared_ptr<arrow::Array> indices;
+    RAISE_ON_ARROW_FAILURE(indices_builder.AppendValues(selection.data(), selection.size()));
+    RAISE_ON_ARROW_FAILURE(indices_builder.Finish(&indices));
+    return indices;
+}
+
+std::shared_ptr<arrow::RecordBatch> TakeSelected(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                 const std::shared_ptr<arrow::Array>& selection) {
+    if (selection == nullptr || selection->length() == batch->num_rows()) {
+        return batch;
+    }
+    auto take_res = arrow::compute::Take(arrow::Datum(batch), arrow::Datum(selection));
+    if (!take_res.ok()) {
+        throw std::runtime_error("Failed to take the selected rows: " + take_res.status().ToString());
+    }
+    return take_res.ValueOrDie().record_batch();
+}
+
+std::shared_ptr<arrow::RecordBatch> TakeSelectedColumns(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                        const std::shared_ptr<arrow::Array>& selection,
+                                                        const std::vector<std::string>& col_names) {
+    if (selection == nullptr || selection->length() == batch->num_rows()) {
+        return batch;
+    }
+    const std::unordered_set<std::string> taken_cols(col_names.begin(), col_names.end());
+    const int64_t num_rows = selection->length();
+
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (int col_idx = 0; col_idx < batch->num_columns(); col_idx++) {
+        const auto& column = batch->column(col_idx);
+        if (taken_cols.count(batch->schema()->field(col_idx)->name()) == 0) {
+            columns.push_back(column->Slice(0, num_rows));
+            continue;
+        }
+        auto take_res = arrow::compute::Take(*column, *selection);
+        if (!take_res.ok()) {
+            throw std::runtime_error("Failed to take the selected rows: " + take_res.status().ToString());
+        }
+        columns.push_back(take_res.ValueOrDie());
+    }
+    return arrow::RecordBatch::Make(batch->schema(), num_rows, columns);
+}
+
+}  // namespace vinum::operators::filter
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <arrow/api.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace vinum::operators::filter {
+
+// Sorted indices of the selected rows of a batch.
+using SelectionVector = std::vector<uint32_t>;
+
+// UInt32 array of the selected rows, as accepted by the Next() of the operators.
+std::shared_ptr<arrow::Array> SelectionToArray(const SelectionVector& selection);
+
+// Rows of the batch at the selection, all the rows if the selection is nullptr.
+std::shared_ptr<arrow::RecordBatch> TakeSelected(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                 const std::shared_ptr<arrow::Array>& selection);
+
+/**
+ * Rows of the batch at the selection, gathering only the columns in col_names.
+ *
+ * The other columns are zero-copy slices of the batch of the selection length, so that the schema
+ * of the batch, and the column indices an operator resolved on its first batch, stay valid.
+ * Their values are meaningless, the caller must not read them.
+ */
+std::shared_ptr<arrow::RecordBatch> TakeSelectedColumns(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                        const std::shared_ptr<arrow::Array>& selection,
+                                                        const std::vector<std::string>& col_names);
+
+}  // namespace vinum::operators::filter
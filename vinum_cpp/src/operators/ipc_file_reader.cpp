@@ -0,0 +1,57 @@
+#include "ipc_file_reader.h"
+
+#include "common/util.h"
+
+#include <algorithm>
+#include <iostream>
+
+
+namespace vinum::operators {
+
+IpcFileReader::IpcFileReader(const std::string& path, int64_t morsel_size, size_t num_workers)
+        : morsel_size(morsel_size), num_workers(std::max<size_t>(num_workers, 1)) {
+    if (morsel_size <= 0) {
+        throw std::runtime_error("Morsel size must be positive: " + std::to_string(morsel_size));
+    }
+    auto file_res = arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ);
+    RAISE_ON_ARROW_FAILURE(file_res.status());
+    this->file = file_res.ValueOrDie();
+
+    auto reader_res = arrow::ipc::RecordBatchFileReader::Open(this->file);
+    if (!reader_res.ok()) {
+        throw std::runtime_error("Failed to open Arrow IPC file " + path + ": "
+                                 + reader_res.status().ToString());
+    }
+    this->reader = reader_res.ValueOrDie();
+}
+
+std::shared_ptr<arrow::RecordBatch> IpcFileReader::Next(size_t worker_idx) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    while (this->batch == nullptr || this->batch_offset >= this->batch->num_rows()) {
+        if (this->next_batch_idx >= this->reader->num_record_batches()) {
+            this->batch = nullptr;
+            return nullptr;
+        }
+        auto batch_res = this->reader->ReadRecordBatch(this->next_batch_idx++);
+        RAISE_ON_ARROW_FAILURE(batch_res.status());
+        this->batch = batch_res.ValueOrDie();
+        this->batch_offset = 0;
+    }
+    auto morsel = this->batch->Slice(this->batch_offset, this->morsel_size);
+    this->batch_offset += morsel->num_rows();
+    return morsel;
+}
+
+std::shared_ptr<arrow::Schema> IpcFileReader::Schema() const {
+    return this->reader->schema();
+}
+
+size_t IpcFileReader::NumWorkers() const {
+    return this->num_workers;
+}
+
+int IpcFileReader::NumRecordBatches() const {
+    return this->reader->num_record_batches();
+}
+
+}  // namespace vinum::operators
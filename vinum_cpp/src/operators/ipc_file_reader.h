@@ -0,0 +1,50 @@
+#pragma once
+
+#include "batch_source.h"
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace vinum::operators {
+
+/**
+ * Reader of a memory-mapped Arrow IPC file (Feather v2).
+ *
+ * The buffers of the record batches point into the mapping of the file, nothing is copied,
+ * so opening the file only reads its footer, and the processes querying the same file share
+ * the physical pages of the page cache.
+ * Record batches of more than morsel_size rows are split into zero-copy slices, so that
+ * the workers share the large batches. Batches of compressed files are decompressed on read.
+ */
+class IpcFileReader : public BatchSource {
+public:
+    IpcFileReader(const std::string& path, int64_t morsel_size, size_t num_workers);
+
+    // Next morsel of the file, any worker may take any morsel.
+    std::shared_ptr<arrow::RecordBatch> Next(size_t worker_idx = 0) override;
+
+    [[nodiscard]] std::shared_ptr<arrow::Schema> Schema() const override;
+
+    [[nodiscard]] size_t NumWorkers() const override;
+
+    [[nodiscard]] int NumRecordBatches() const;
+
+private:
+    std::shared_ptr<arrow::io::MemoryMappedFile> file;
+    std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader;
+    const int64_t morsel_size;
+    const size_t num_workers;
+
+    int next_batch_idx = 0;
+    std::shared_ptr<arrow::RecordBatch> batch = nullptr;     // Record batch being sliced
+    int64_t batch_offset = 0;
+    // The file reader decodes the dictionaries on the first read, it is not thread-safe.
+    std::mutex mutex;
+};
+
+}  // namespace vinum::operators
@@ -0,0 +1,279 @@
+#include "hash_join.h"
+
+#include "operators/sort/sort.h"
+#include "common/util.h"
+
+#include <arrow/compute/api.h>
+#include <arrow/util/bit_util.h>
+
+#include <iostream>
+
+
+namespace vinum::operators::join {
+
+namespace {
+
+std::vector<int> LookupKeyIndices(const std::vector<std::string>& key_names, const arrow::Schema& schema) {
+    std::vector<int> key_indices;
+    for (const auto& key_name : key_names) {
+        const int col_idx = schema.GetFieldIndex(key_name);
+        if (col_idx < 0) {
+            throw std::runtime_error("Join column not found: " + key_name);
+        }
+        key_indices.push_back(col_idx);
+    }
+    return key_indices;
+}
+
+// Integer types of a single key hashed as its value, the same as the direct keys of SingleNumericalHashAggregate.
+bool IsIntKeyType(arrow::Type::type type_id) {
+    switch (type_id) {
+        case arrow::Type::INT8:
+        case arrow::Type::INT16:
+        case arrow::Type::INT32:
+        case arrow::Type::INT64:
+        case arrow::Type::UINT8:
+        case arrow::Type::UINT16:
+        case arrow::Type::UINT32:
+        case arrow::Type::UINT64:
+        case arrow::Type::DATE32:
+        case arrow::Type::DATE64:
+        case arrow::Type::TIME32:
+        case arrow::Type::TIME64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::DURATION:
+        case arrow::Type::INTERVAL_MONTHS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+template<typename T>
+void ReadIntKeysTyped(const arrow::ArrayData& data, std::vector<uint64_t>& keys) {
+    const T* values = data.GetValues<T>(1);
+    keys.resize(data.length);
+    for (int64_t row_idx = 0; row_idx < data.length; row_idx++) {
+        keys[row_idx] = static_cast<uint64_t>(values[row_idx]);
+    }
+}
+
+// Keys of an integer column cast to uint64_t, the keys of the NULL rows are undefined.
+void ReadIntKeys(const arrow::ArrayData& data, std::vector<uint64_t>& keys) {
+    switch (data.type->id()) {
+        case arrow::Type::INT8:
+            return ReadIntKeysTyped<int8_t>(data, keys);
+        case arrow::Type::INT16:
+            return ReadIntKeysTyped<int16_t>(data, keys);
+        case arrow::Type::INT32:
+        case arrow::Type::DATE32:
+        case arrow::Type::TIME32:
+        case arrow::Type::INTERVAL_MONTHS:
+            return ReadIntKeysTyped<int32_t>(data, keys);
+        case arrow::Type::INT64:
+        case arrow::Type::DATE64:
+        case arrow::Type::TIME64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::DURATION:
+            return ReadIntKeysTyped<int64_t>(data, keys);
+        case arrow::Type::UINT8:
+            return ReadIntKeysTyped<uint8_t>(data, keys);
+        case arrow::Type::UINT16:
+            return ReadIntKeysTyped<uint16_t>(data, keys);
+        case arrow::Type::UINT32:
+            return ReadIntKeysTyped<uint32_t>(data, keys);
+        case arrow::Type::UINT64:
+            return ReadIntKeysTyped<uint64_t>(data, keys);
+        default:
+            throw std::runtime_error("Not an integer join key: " + data.type->ToString());
+    }
+}
+
+inline bool IsNull(const arrow::ArrayData& data, int64_t row_idx) {
+    return data.buffers[0] != nullptr && !arrow::BitUtil::GetBit(data.buffers[0]->data(), data.offset + row_idx);
+}
+
+std::shared_ptr<arrow::RecordBatch> TakeRows(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                             const std::shared_ptr<arrow::Array>& indices,
+                                             arrow::MemoryPool* pool) {
+    arrow::compute::ExecContext ctx(pool);
+    auto take_res = arrow::compute::Take(arrow::Datum(batch), arrow::Datum(indices),
+                                         arrow::compute::TakeOptions::Defaults(), &ctx);
+    if (!take_res.ok()) {
+        throw std::runtime_error("Failed to take the joined rows: " + take_res.status().ToString());
+    }
+    return take_res.ValueOrDie().record_batch();
+}
+
+}  // namespace
+
+
+HashJoin::HashJoin(const std::vector<std::string>& probe_keys,
+                   const std::vector<std::string>& build_keys,
+                   JoinType join_type)
+        : probe_key_names(probe_keys), build_key_names(build_keys), join_type(join_type) {
+    if (probe_keys.empty() || probe_keys.size() != build_keys.size()) {
+        throw std::runtime_error("Join requires the same non-zero number of keys on both sides.");
+    }
+}
+
+void HashJoin::Build(const std::shared_ptr<arrow::Table>& build_table) {
+    if (this->build_batch != nullptr) {
+        throw std::runtime_error("Build side of the join is already built.");
+    }
+    this->build_batch = build_table->num_rows() > 0
+            ? sort::TableToBatch(build_table, this->memory.ArrowPool())
+            : sort::MakeEmptyBatch(build_table->schema());
+
+    const auto build_key_indices = LookupKeyIndices(this->build_key_names, *this->build_batch->schema());
+    this->is_int_key = build_key_indices.size() == 1
+            && IsIntKeyType(this->build_batch->schema()->field(build_key_indices[0])->type()->id());
+    this->next_rows.assign(this->build_batch->num_rows(), NO_ROW);
+    if (this->is_int_key) {
+        this->BuildIntKeys(*this->build_batch->column(build_key_indices[0])->data());
+    } else {
+        this->BuildEncodedKeys(build_key_indices);
+    }
+
+    // Slots of the hash table with their info bytes.
+    const size_t table_bytes = this->build_rows.mask() > 0
+            ? (this->build_rows.mask() + 1) * (sizeof(decltype(this->build_rows)::value_type) + 1)
+            : 0;
+    this->memory.Resize(static_cast<int64_t>(
+            table_bytes + this->arena.BytesReserved()
+            + this->int_chain_ids.MemoryUsage() + this->int_chains.capacity() * sizeof(RowChain)
+            + this->next_rows.capacity() * sizeof(int64_t)));
+}
+
+void HashJoin::BuildEncodedKeys(const std::vector<int>& build_key_indices) {
+    aggregate::BatchKeyEncoder build_encoder(*this->build_batch->schema(), build_key_indices);
+    build_encoder.Encode(*this->build_batch);
+
+    const int64_t num_rows = this->build_batch->num_rows();
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        if (build_encoder.HasNull(row_idx)) {
+            continue;
+        }
+        const auto key = build_encoder.Key(row_idx);
+        auto chain = this->build_rows.find(key);
+        if (chain == this->build_rows.end()) {
+            // Encoded keys of the batch are released with the encoder, so the key bytes are copied into the arena.
+            const aggregate::EncodedKey stored_key {this->arena.Copy(key.data, key.size), key.size, key.hash};
+            this->build_rows.emplace(stored_key, RowChain{row_idx, row_idx});
+        } else {
+            this->next_rows[chain->second.last_row] = row_idx;
+            chain->second.last_row = row_idx;
+        }
+    }
+}
+
+void HashJoin::BuildIntKeys(const arrow::ArrayData& keys_data) {
+    std::vector<uint64_t> keys;
+    ReadIntKeys(keys_data, keys);
+    for (int64_t row_idx = 0; row_idx < keys_data.length; row_idx++) {
+        if (IsNull(keys_data, row_idx)) {
+            continue;
+        }
+        const auto key = keys[row_idx];
+        bool is_new_key;
+        const auto chain_id = this->int_chain_ids.FindOrInsert(
+                key, aggregate::IntGroupTable::Hash(key), this->int_chains.size(), is_new_key);
+        if (is_new_key) {
+            this->int_chains.push_back(RowChain{row_idx, row_idx});
+        } else {
+            auto& chain = this->int_chains[chain_id];
+            this->next_rows[chain.last_row] = row_idx;
+            chain.last_row = row_idx;
+        }
+    }
+}
+
+void HashJoin::CheckKeyTypes(const arrow::Schema& probe_schema) const {
+    const auto& build_schema = *this->build_batch->schema();
+    for (size_t key_idx = 0; key_idx < this->probe_key_indices.size(); key_idx++) {
+        const auto& probe_type = probe_schema.field(this->probe_key_indices[key_idx])->type();
+        const auto& build_type = build_schema.GetFieldByName(this->build_key_names[key_idx])->type();
+        if (!probe_type->Equals(*build_type)) {
+            throw std::runtime_error("Types of the join keys differ: " + this->probe_key_names[key_idx]
+                                     + " " + probe_type->ToString() + ", " + this->build_key_names[key_idx]
+                                     + " " + build_type->ToString());
+        }
+    }
+}
+
+std::shared_ptr<arrow::RecordBatch> HashJoin::Next(const std::shared_ptr<arrow::RecordBatch>& probe_batch) {
+    if (this->build_batch == nullptr) {
+        throw std::runtime_error("Build side of the join must be built before the probe.");
+    }
+    if (this->probe_key_indices.empty()) {
+        this->probe_key_indices = LookupKeyIndices(this->probe_key_names, *probe_batch->schema());
+        this->CheckKeyTypes(*probe_batch->schema());
+        if (!this->is_int_key) {
+            this->probe_encoder = aggregate::BatchKeyEncoder(*probe_batch->schema(), this->probe_key_indices);
+        }
+    }
+
+    arrow::Int64Builder probe_indices_builder(this->memory.ArrowPool());
+    arrow::Int64Builder build_indices_builder(this->memory.ArrowPool());
+    const int64_t num_rows = probe_batch->num_rows();
+    RAISE_ON_ARROW_FAILURE(probe_indices_builder.Reserve(num_rows));
+    RAISE_ON_ARROW_FAILURE(build_indices_builder.Reserve(num_rows));
+    // Chain is nullptr if the probe row has no match.
+    const auto append_matches = [&](int64_t row_idx, const RowChain* chain) {
+        if (chain != nullptr) {
+            for (int64_t build_row = chain->first_row; build_row != NO_ROW; build_row = this->next_rows[build_row]) {
+                RAISE_ON_ARROW_FAILURE(probe_indices_builder.Append(row_idx));
+                RAISE_ON_ARROW_FAILURE(build_indices_builder.Append(build_row));
+            }
+        } else if (this->join_type == JoinType::LEFT) {
+            RAISE_ON_ARROW_FAILURE(probe_indices_builder.Append(row_idx));
+            RAISE_ON_ARROW_FAILURE(build_indices_builder.AppendNull());
+        }
+    };
+
+    if (this->is_int_key) {
+        const auto& keys_data = *probe_batch->column(this->probe_key_indices[0])->data();
+        ReadIntKeys(keys_data, this->probe_int_keys);
+        for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+            const RowChain* chain = nullptr;
+            if (!IsNull(keys_data, row_idx)) {
+                const auto key = this->probe_int_keys[row_idx];
+                const auto chain_id = this->int_chain_ids.Find(key, aggregate::IntGroupTable::Hash(key));
+                if (chain_id != aggregate::IntGroupTable::EMPTY) {
+                    chain = &this->int_chains[chain_id];
+                }
+            }
+            append_matches(row_idx, chain);
+        }
+    } else {
+        this->probe_encoder.Encode(*probe_batch);
+        for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+            const RowChain* chain = nullptr;
+            if (!this->probe_encoder.HasNull(row_idx)) {
+                const auto found = this->build_rows.find(this->probe_encoder.Key(row_idx));
+                if (found != this->build_rows.end()) {
+                    chain = &found->second;
+                }
+            }
+            append_matches(row_idx, chain);
+        }
+    }
+
+    std::shared_ptr<arrow::Array> probe_indices, build_indices;
+    RAISE_ON_ARROW_FAILURE(probe_indices_builder.Finish(&probe_indices));
+    RAISE_ON_ARROW_FAILURE(build_indices_builder.Finish(&build_indices));
+
+    // Null build indices of the unmatched rows of a LEFT join are taken as NULL values.
+    const auto probe_side = TakeRows(probe_batch, probe_indices, this->memory.ArrowPool());
+    const auto build_side = TakeRows(this->build_batch, build_indices, this->memory.ArrowPool());
+
+    std::vector<std::shared_ptr<arrow::Field>> fields = probe_side->schema()->fields();
+    std::vector<std::shared_ptr<arrow::Array>> columns = probe_side->columns();
+    for (int col_idx = 0; col_idx < build_side->num_columns(); col_idx++) {
+        fields.push_back(build_side->schema()->field(col_idx));
+        columns.push_back(build_side->column(col_idx));
+    }
+    return arrow::RecordBatch::Make(arrow::schema(fields), probe_indices->length(), columns);
+}
+
+}  // namespace vinum::operators::join
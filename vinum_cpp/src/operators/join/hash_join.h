@@ -0,0 +1,87 @@
+#pragma once
+
+#include "operators/aggregate/key_encoding.h"
+#include "operators/aggregate/int_group_table.h"
+#include "common/arena.h"
+#include "common/memory_pool.h"
+
+#include "common/robin_hood.h"
+
+#include <arrow/api.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vinum::operators::join {
+
+enum class JoinType {
+    INNER, LEFT
+};
+
+/**
+ * Hash join of the streamed probe side with an in-memory build side.
+ *
+ * Build() chains the build rows of every distinct key. A single integer key is hashed as an integer,
+ * with the IntGroupTable of SingleNumericalHashAggregate, the other keys are encoded with the key
+ * encoding of CompositeKeyHashAggregate. Next() looks up the keys of a probe batch and returns
+ * the joined rows: the columns of the probe batch followed by the columns of the build table,
+ * both gathered with Take() on the matched row indices.
+ *
+ * Key columns must have the same types on both sides. Rows with a NULL key never match,
+ * a LEFT join emits them, as well as probe rows without a match, with NULL build columns.
+ * Matches of a probe row are emitted in the build table order.
+ */
+class HashJoin {
+public:
+    HashJoin(const std::vector<std::string>& probe_keys,
+             const std::vector<std::string>& build_keys,
+             JoinType join_type);
+
+    void Build(const std::shared_ptr<arrow::Table>& build_table);
+
+    std::shared_ptr<arrow::RecordBatch> Next(const std::shared_ptr<arrow::RecordBatch>& probe_batch);
+
+    // The build batch and the joined rows are allocated from the pool, the hash table is reserved in it.
+    // Must be called before Build().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool) {
+        this->memory.SetPool(pool);
+    }
+
+private:
+    static constexpr int64_t NO_ROW = -1;
+
+    // First and last build rows of a key, the rows in between are linked by next_rows.
+    struct RowChain {
+        int64_t first_row;
+        int64_t last_row;
+    };
+
+    const std::vector<std::string> probe_key_names;
+    const std::vector<std::string> build_key_names;
+    const JoinType join_type;
+
+    std::shared_ptr<arrow::RecordBatch> build_batch = nullptr;
+    std::vector<int64_t> next_rows;     // Next build row of the same key, NO_ROW at the end of the chain
+    common::MemoryReservation memory;   // Bytes of the chains of the build rows
+
+    // Chains of the encoded keys.
+    robin_hood::unordered_map<aggregate::EncodedKey, RowChain, aggregate::EncodedKeyHasher> build_rows;
+    common::Arena arena;                // Bytes of the build keys
+
+    // Chains of a single integer key, int_chain_ids maps the key to its index in int_chains.
+    bool is_int_key = false;
+    aggregate::IntGroupTable int_chain_ids;
+    std::vector<RowChain> int_chains;
+
+    std::vector<int> probe_key_indices;
+    aggregate::BatchKeyEncoder probe_encoder;
+    std::vector<uint64_t> probe_int_keys;
+
+    void BuildEncodedKeys(const std::vector<int>& build_key_indices);
+    void BuildIntKeys(const arrow::ArrayData& keys_data);
+
+    void CheckKeyTypes(const arrow::Schema& probe_schema) const;
+};
+
+}  // namespace vinum::operators::join
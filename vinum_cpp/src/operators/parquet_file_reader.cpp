@@ -0,0 +1,84 @@
+#include "parquet_file_reader.h"
+
+#include "common/util.h"
+
+#include <arrow/io/api.h>
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+
+
+namespace vinum::operators {
+
+namespace {
+
+void CollectLeafColumns(const parquet::arrow::SchemaField& field, std::vector<int>& column_indices) {
+    if (field.is_leaf()) {
+        column_indices.push_back(field.column_index);
+        return;
+    }
+    for (const auto& child : field.children) {
+        CollectLeafColumns(child, column_indices);
+    }
+}
+
+}  // namespace
+
+
+ParquetFileReader::ParquetFileReader(const std::string& path,
+                                     const std::vector<std::string>& column_names,
+                                     const std::vector<int>& row_groups,
+                                     int64_t batch_size,
+                                     size_t num_workers)
+        : num_row_groups(static_cast<int>(row_groups.size())),
+          num_workers(std::max<size_t>(num_workers, 1)) {
+    if (batch_size <= 0) {
+        throw std::runtime_error("Batch size must be positive: " + std::to_string(batch_size));
+    }
+    auto file_res = arrow::io::ReadableFile::Open(path);
+    RAISE_ON_ARROW_FAILURE(file_res.status());
+
+    parquet::ArrowReaderProperties properties(this->num_workers > 1);
+    properties.set_batch_size(batch_size);
+    parquet::arrow::FileReaderBuilder builder;
+    RAISE_ON_ARROW_FAILURE(builder.Open(file_res.ValueOrDie()));
+    RAISE_ON_ARROW_FAILURE(builder.properties(properties)->Build(&this->file_reader));
+
+    // A column of a nested type is read with all of its leaf columns.
+    const std::unordered_set<std::string> names(column_names.begin(), column_names.end());
+    std::vector<int> column_indices;
+    size_t num_found = 0;
+    for (const auto& field : this->file_reader->manifest().schema_fields) {
+        if (names.count(field.field->name()) > 0) {
+            CollectLeafColumns(field, column_indices);
+            num_found++;
+        }
+    }
+    if (num_found != names.size()) {
+        throw std::runtime_error("Parquet file " + path + " does not have all of the columns of the query.");
+    }
+    RAISE_ON_ARROW_FAILURE(this->file_reader->GetRecordBatchReader(row_groups, column_indices,
+                                                                   &this->batch_reader));
+}
+
+std::shared_ptr<arrow::RecordBatch> ParquetFileReader::Next(size_t worker_idx) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::shared_ptr<arrow::RecordBatch> batch;
+    RAISE_ON_ARROW_FAILURE(this->batch_reader->ReadNext(&batch));
+    return batch;
+}
+
+std::shared_ptr<arrow::Schema> ParquetFileReader::Schema() const {
+    return this->batch_reader->schema();
+}
+
+size_t ParquetFileReader::NumWorkers() const {
+    return this->num_workers;
+}
+
+int ParquetFileReader::NumRowGroups() const {
+    return this->num_row_groups;
+}
+
+}  // namespace vinum::operators
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "batch_source.h"
+
+#include <arrow/api.h>
+#include <parquet/arrow/reader.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vinum::operators {
+
+/**
+ * Streaming reader of a Parquet file, reading only the given columns and row groups.
+ *
+ * The column chunks of the other columns and the skipped row groups, usually pruned
+ * by the min/max statistics of the query predicate, are never read nor decoded.
+ * The row groups are decoded lazily, one at a time, in batches of batch_size rows.
+ * The columns of a row group are decoded in parallel if num_workers > 1.
+ */
+class ParquetFileReader : public BatchSource {
+public:
+    ParquetFileReader(const std::string& path,
+                      const std::vector<std::string>& column_names,
+                      const std::vector<int>& row_groups,
+                      int64_t batch_size,
+                      size_t num_workers);
+
+    // Next batch of the file, any worker may take any batch.
+    std::shared_ptr<arrow::RecordBatch> Next(size_t worker_idx = 0) override;
+
+    [[nodiscard]] std::shared_ptr<arrow::Schema> Schema() const override;
+
+    [[nodiscard]] size_t NumWorkers() const override;
+
+    [[nodiscard]] int NumRowGroups() const;
+
+private:
+    std::unique_ptr<parquet::arrow::FileReader> file_reader;
+    std::unique_ptr<arrow::RecordBatchReader> batch_reader;
+    const int num_row_groups;
+    const size_t num_workers;
+    std::mutex mutex;
+};
+
+}  // namespace vinum::operators
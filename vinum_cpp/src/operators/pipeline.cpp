@@ -0,0 +1,70 @@
+#include "pipeline.h"
+
+
+namespace vinum::operators {
+
+Pipeline::Pipeline(BatchSource& source,
+                   const std::vector<std::string>& col_names,
+                   filter::Predicate* predicate)
+        : source(source), col_names(col_names), predicate(predicate) {
+    this->Bind(*source.Schema());
+}
+
+bool Pipeline::Next(std::shared_ptr<arrow::RecordBatch>& batch,
+                    std::shared_ptr<arrow::Array>& selection,
+                    size_t worker_idx) {
+    batch = this->source.Next(worker_idx);
+    if (batch == nullptr) {
+        return false;
+    }
+    this->num_batches++;
+
+    batch = this->Project(batch);
+    selection = nullptr;
+    if (this->predicate != nullptr) {
+        const auto selected_rows = this->predicate->Select(*batch);
+        if (static_cast<int64_t>(selected_rows.size()) < batch->num_rows()) {
+            selection = filter::SelectionToArray(selected_rows);
+        }
+    }
+    return true;
+}
+
+void Pipeline::Bind(const arrow::Schema& table_schema) {
+    if (this->col_names.empty()) {
+        for (int col_idx = 0; col_idx < table_schema.num_fields(); col_idx++) {
+            this->col_indices.push_back(col_idx);
+        }
+    } else {
+        for (const auto& col_name : this->col_names) {
+            const int col_idx = table_schema.GetFieldIndex(col_name);
+            if (col_idx < 0) {
+                throw std::runtime_error("Pipeline column not found: " + col_name);
+            }
+            this->col_indices.push_back(col_idx);
+        }
+    }
+
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (const int col_idx : this->col_indices) {
+        fields.push_back(table_schema.field(col_idx));
+    }
+    auto projected_schema = arrow::schema(fields);
+    if (this->predicate != nullptr && !this->predicate->Bind(*projected_schema)) {
+        throw std::runtime_error("Predicate is not supported for the schema: " + projected_schema->ToString());
+    }
+    this->schema = projected_schema;
+}
+
+std::shared_ptr<arrow::RecordBatch> Pipeline::Project(const std::shared_ptr<arrow::RecordBatch>& batch) const {
+    if (this->col_names.empty()) {
+        return batch;
+    }
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (const int col_idx : this->col_indices) {
+        columns.push_back(batch->column(col_idx));
+    }
+    return arrow::RecordBatch::Make(this->schema, batch->num_rows(), columns);
+}
+
+}  // namespace vinum::operators
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "batch_source.h"
+#include "operators/filter/predicate.h"
+#include "common/thread_pool.h"
+
+#include <arrow/api.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace vinum::operators {
+
+/**
+ * Scan of a table or a stream fused with an optional filter, driving the batches into a sink
+ * entirely in C++.
+ *
+ * Every batch of the source is projected to col_names and evaluated by the predicate into
+ * a selection, the batch and its selection are passed to the Next() of the sink, an aggregate
+ * or a sort. So the selected rows are only gathered by the sink, for the columns it reads,
+ * and the caller receives nothing but the number of batches, the result stays in the sink.
+ *
+ * Run() with more than one thread runs a worker per thread, up to the workers of the source,
+ * eg every worker takes the morsels of its own range of a ParallelTableBatchReader and steals
+ * the rest, and calls the Next() of the sink concurrently, which only the parallel aggregates support.
+ */
+class Pipeline {
+public:
+    // Empty col_names keeps all the columns, a nullptr predicate selects all the rows.
+    Pipeline(BatchSource& source,
+             const std::vector<std::string>& col_names,
+             filter::Predicate* predicate);
+
+    // Next batch of the worker and the selection of its rows, nullptr if all the rows are selected.
+    // Returns false once the source is exhausted. Workers may call it concurrently.
+    bool Next(std::shared_ptr<arrow::RecordBatch>& batch,
+              std::shared_ptr<arrow::Array>& selection,
+              size_t worker_idx = 0);
+
+    // Feed all the batches of the scan to the sink, returns the number of batches.
+    template<typename SINK>
+    int64_t Run(SINK& sink, size_t num_threads = 1) {
+        const size_t num_workers = std::min(num_threads, this->source.NumWorkers());
+        auto worker = [this, &sink](size_t worker_idx) {
+            std::shared_ptr<arrow::RecordBatch> batch;
+            std::shared_ptr<arrow::Array> selection;
+            while (this->Next(batch, selection, worker_idx)) {
+                sink.Next(batch, selection);
+            }
+        };
+        if (num_workers <= 1) {
+            worker(0);
+        } else {
+            common::ThreadPool pool(num_workers);
+            pool.ParallelFor(num_workers, worker);
+        }
+        return this->num_batches;
+    }
+
+private:
+    BatchSource& source;
+    const std::vector<std::string> col_names;
+    filter::Predicate* predicate;
+
+    std::shared_ptr<arrow::Schema> schema;      // Projected schema
+    std::vector<int> col_indices;
+    std::atomic<int64_t> num_batches {0};
+
+    void Bind(const arrow::Schema& table_schema);
+
+    [[nodiscard]] std::shared_ptr<arrow::RecordBatch> Project(const std::shared_ptr<arrow::RecordBatch>& batch) const;
+};
+
+}  // namespace vinum::operators
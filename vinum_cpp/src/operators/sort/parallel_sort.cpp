@@ -0,0 +1,217 @@
+#include "parallel_sort.h"
+
+#include "common/util.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace vinum::operators::sort {
+
+ParallelSort::ParallelSort(const std::vector<std::string>& cols,
+                           const std::vector<SortOrder>& order,
+                           size_t num_threads,
+                           int64_t min_run_rows) :
+        sort_cols(cols), sort_order(order), min_run_rows(min_run_rows), pool(num_threads) {}
+
+ParallelSort::~ParallelSort() {
+    // Sorting tasks reference the runs, don't destroy them under the running tasks.
+    for (auto& future : this->run_futures) {
+        if (future.valid()) {
+            future.wait();
+        }
+    }
+}
+
+void ParallelSort::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    if (this->schema == nullptr) {
+        this->schema = batch->schema();
+    }
+    if (batch->num_rows() == 0) {
+        return;
+    }
+    this->batches.push_back(batch);
+    this->buffered_rows += batch->num_rows();
+
+    if (this->buffered_rows >= this->min_run_rows) {
+        this->SubmitRun();
+    }
+}
+
+void ParallelSort::SubmitRun() {
+    auto table_res = arrow::Table::FromRecordBatches(this->schema, this->batches);
+    if (!table_res.ok()) {
+        throw std::runtime_error("Failed to create table from record batches." + table_res.status().ToString());
+    }
+    this->batches.clear();
+    this->buffered_rows = 0;
+
+    this->runs.push_back(nullptr);
+    auto& run = this->runs.back();
+    this->run_futures.push_back(this->pool.Submit([this, &run, table = table_res.ValueOrDie()]() {
+        auto* memory_pool = this->memory.ArrowPool();
+        run = TableToBatch(SortTable(table, this->sort_cols, this->sort_order, -1, memory_pool), memory_pool);
+    }));
+}
+
+void ParallelSort::WaitForRuns() {
+    // Wait for all the tasks before rethrowing, as they reference the runs.
+    for (auto& future : this->run_futures) {
+        future.wait();
+    }
+    for (auto& future : this->run_futures) {
+        future.get();
+    }
+    this->run_futures.clear();
+}
+
+std::shared_ptr<arrow::RecordBatch> ParallelSort::Sorted() {
+    if (!this->batches.empty()) {
+        this->SubmitRun();
+    }
+    this->WaitForRuns();
+
+    if (this->schema == nullptr) {
+        throw std::runtime_error("Failed to create table from record batches, no batches received.");
+    }
+    if (this->runs.empty()) {
+        return MakeEmptyBatch(this->schema);
+    }
+    if (this->runs.size() == 1) {
+        return this->runs[0];
+    }
+
+    std::vector<bool> descending;
+    for (const auto& order : this->sort_order) {
+        descending.push_back(order == SortOrder::DESC);
+    }
+    const RowComparator comparator(*this->schema, this->sort_cols, descending);
+
+    const size_t num_runs = this->runs.size();
+    size_t largest_run = 0;
+    for (size_t run_idx = 1; run_idx < num_runs; run_idx++) {
+        if (this->runs[run_idx]->num_rows() > this->runs[largest_run]->num_rows()) {
+            largest_run = run_idx;
+        }
+    }
+    const int64_t largest_rows = this->runs[largest_run]->num_rows();
+    const auto num_partitions = static_cast<size_t>(
+            std::max<int64_t>(1, std::min<int64_t>(this->pool.Size() * 4, largest_rows)));
+
+    // bounds[partition_idx][run_idx] is the first row of the run in the partition,
+    // partition p > 0 starts with the splitter row largest_rows * p / num_partitions of the largest run.
+    std::vector<std::vector<int64_t>> bounds(num_partitions + 1, std::vector<int64_t>(num_runs, 0));
+    for (size_t run_idx = 0; run_idx < num_runs; run_idx++) {
+        bounds[num_partitions][run_idx] = this->runs[run_idx]->num_rows();
+    }
+    if (num_partitions > 1) {
+        this->pool.ParallelFor(num_partitions - 1, [this, &comparator, &bounds, largest_run, largest_rows,
+                                                    num_partitions, num_runs](size_t idx) {
+            const size_t partition_idx = idx + 1;
+            const auto& splitter_run = *this->runs[largest_run];
+            const int64_t splitter_row = largest_rows * static_cast<int64_t>(partition_idx) / num_partitions;
+
+            for (size_t run_idx = 0; run_idx < num_runs; run_idx++) {
+                if (run_idx == largest_run) {
+                    bounds[partition_idx][run_idx] = splitter_row;
+                    continue;
+                }
+                // Number of rows of the run merged before the splitter, ties go to the earlier run.
+                const auto& run = *this->runs[run_idx];
+                const bool ties_before = run_idx < largest_run;
+                int64_t low = 0;
+                int64_t high = run.num_rows();
+                while (low < high) {
+                    const int64_t mid = low + (high - low) / 2;
+                    const bool is_before = ties_before
+                            ? !comparator.Less(splitter_run, splitter_row, run, mid)
+                            : comparator.Less(run, mid, splitter_run, splitter_row);
+                    if (is_before) {
+                        low = mid + 1;
+                    } else {
+                        high = mid;
+                    }
+                }
+                bounds[partition_idx][run_idx] = low;
+            }
+        });
+    }
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> merged(num_partitions);
+    this->pool.ParallelFor(num_partitions, [this, &comparator, &bounds, &merged](size_t partition_idx) {
+        merged[partition_idx] = this->MergePartition(comparator, bounds[partition_idx], bounds[partition_idx + 1]);
+    });
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> non_empty;
+    for (const auto& partition : merged) {
+        if (partition != nullptr) {
+            non_empty.push_back(partition);
+        }
+    }
+    auto table_res = arrow::Table::FromRecordBatches(this->schema, non_empty);
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    return TableToBatch(table_res.ValueOrDie(), this->memory.ArrowPool());
+}
+
+std::shared_ptr<arrow::RecordBatch> ParallelSort::MergePartition(const RowComparator& comparator,
+                                                                 const std::vector<int64_t>& begin,
+                                                                 const std::vector<int64_t>& end) const {
+    // Slices of the runs in the run order, offset of every slice in their concatenation.
+    std::vector<std::shared_ptr<arrow::RecordBatch>> slices;
+    std::vector<int64_t> offsets;
+    int64_t num_rows = 0;
+    for (size_t run_idx = 0; run_idx < this->runs.size(); run_idx++) {
+        const int64_t length = end[run_idx] - begin[run_idx];
+        if (length > 0) {
+            slices.push_back(this->runs[run_idx]->Slice(begin[run_idx], length));
+            offsets.push_back(num_rows);
+            num_rows += length;
+        }
+    }
+    if (slices.empty()) {
+        return nullptr;
+    }
+    if (slices.size() == 1) {
+        return slices[0];
+    }
+
+    std::vector<int64_t> rows(slices.size(), 0);
+    const auto merges_after = [&slices, &rows, &comparator](size_t left, size_t right) {
+        if (comparator.Less(*slices[right], rows[right], *slices[left], rows[left])) {
+            return true;
+        }
+        if (comparator.Less(*slices[left], rows[left], *slices[right], rows[right])) {
+            return false;
+        }
+        return right < left;
+    };
+    std::vector<size_t> heap;
+    for (size_t slice_idx = 0; slice_idx < slices.size(); slice_idx++) {
+        heap.push_back(slice_idx);
+    }
+    std::make_heap(heap.begin(), heap.end(), merges_after);
+
+    arrow::Int64Builder indices_builder(this->memory.ArrowPool());
+    RAISE_ON_ARROW_FAILURE(indices_builder.Reserve(num_rows));
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), merges_after);
+        const size_t slice_idx = heap.back();
+        indices_builder.UnsafeAppend(offsets[slice_idx] + rows[slice_idx]);
+        if (++rows[slice_idx] == slices[slice_idx]->num_rows()) {
+            heap.pop_back();
+        } else {
+            std::push_heap(heap.begin(), heap.end(), merges_after);
+        }
+    }
+
+    std::shared_ptr<arrow::Array> indices;
+    RAISE_ON_ARROW_FAILURE(indices_builder.Finish(&indices));
+    auto table_res = arrow::Table::FromRecordBatches(this->schema, slices);
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    arrow::compute::ExecContext ctx(this->memory.ArrowPool());
+    auto take_res = arrow::compute::Take(arrow::Datum(table_res.ValueOrDie()), arrow::Datum(indices),
+                                         arrow::compute::TakeOptions::Defaults(), &ctx);
+    RAISE_ON_ARROW_FAILURE(take_res.status());
+    return TableToBatch(take_res.ValueOrDie().table(), this->memory.ArrowPool());
+}
+
+}  // namespace vinum::operators::sort
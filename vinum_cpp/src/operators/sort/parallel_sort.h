@@ -0,0 +1,81 @@
+#pragma once
+
+#include "sort.h"
+#include "row_comparator.h"
+#include "common/thread_pool.h"
+
+#include <arrow/api.h>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vinum::operators::sort {
+
+/**
+ * Multi-threaded in-memory sort.
+ *
+ * Next() groups the incoming batches into runs of at least min_run_rows rows and sorts
+ * every run on the thread pool, while the following batches are received.
+ *
+ * Sorted() merges the sorted runs in parallel: the merged output is split into a few
+ * partitions per thread by splitter rows sampled from the largest run, every run is
+ * split at the position of each splitter by a binary search, then the run slices of each
+ * partition are k-way merged by a separate task and the partitions are concatenated.
+ *
+ * Rows with equal sort keys keep their input order, as with Sort.
+ * Next() must not be called concurrently.
+ */
+class ParallelSort {
+public:
+    static constexpr int64_t MIN_RUN_ROWS = 1 << 16;
+
+    ParallelSort(const std::vector<std::string>& sort_cols,
+                 const std::vector<SortOrder>& sort_order,
+                 size_t num_threads,
+                 int64_t min_run_rows = MIN_RUN_ROWS);
+
+    ~ParallelSort();
+
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch);
+
+    // The rows are buffered, so the selected rows of the batch are gathered on arrival.
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch, const std::shared_ptr<arrow::Array>& selection) {
+        this->Next(filter::TakeSelected(batch, selection));
+    }
+
+    // All the sorted rows in a single batch.
+    std::shared_ptr<arrow::RecordBatch> Sorted();
+
+    // Sorted runs and the merged rows are allocated from the pool, must be called before Next().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool) {
+        this->memory.SetPool(pool);
+    }
+
+private:
+    const std::vector<std::string> sort_cols;
+    const std::vector<SortOrder> sort_order;
+    const int64_t min_run_rows;
+
+    common::ThreadPool pool;
+    common::MemoryReservation memory;
+
+    std::shared_ptr<arrow::Schema> schema = nullptr;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;    // Batches of the next run
+    int64_t buffered_rows = 0;
+
+    // Sorted runs in the input order, deque keeps the references of the sorting tasks valid.
+    std::deque<std::shared_ptr<arrow::RecordBatch>> runs;
+    std::vector<std::future<void>> run_futures;
+
+    void SubmitRun();
+    void WaitForRuns();
+
+    std::shared_ptr<arrow::RecordBatch> MergePartition(const RowComparator& comparator,
+                                                       const std::vector<int64_t>& begin,
+                                                       const std::vector<int64_t>& end) const;
+};
+
+}  // namespace vinum::operators::sort
@@ -0,0 +1,127 @@
+#include "row_comparator.h"
+
+#include <cmath>
+#include <type_traits>
+
+
+namespace vinum::operators::sort {
+
+namespace {
+
+template<typename ARRAY_TYPE>
+class TypedColumnComparator : public ColumnComparator {
+public:
+    explicit TypedColumnComparator(bool descending) : descending(descending) {}
+
+    int Compare(const arrow::Array& left, int64_t left_idx,
+                const arrow::Array& right, int64_t right_idx) const override {
+        const auto& left_arr = static_cast<const ARRAY_TYPE&>(left);
+        const auto& right_arr = static_cast<const ARRAY_TYPE&>(right);
+
+        const bool left_null = left_arr.IsNull(left_idx);
+        const bool right_null = right_arr.IsNull(right_idx);
+        if (left_null || right_null) {
+            return static_cast<int>(left_null) - static_cast<int>(right_null);
+        }
+
+        const auto left_val = left_arr.GetView(left_idx);
+        const auto right_val = right_arr.GetView(right_idx);
+        if constexpr (std::is_floating_point_v<decltype(left_val)>) {
+            const bool left_nan = std::isnan(left_val);
+            const bool right_nan = std::isnan(right_val);
+            if (left_nan || right_nan) {
+                return static_cast<int>(left_nan) - static_cast<int>(right_nan);
+            }
+        }
+
+        const int cmp = left_val < right_val ? -1 : (right_val < left_val ? 1 : 0);
+        return this->descending ? -cmp : cmp;
+    }
+
+private:
+    const bool descending;
+};
+
+template<typename ARRAY_TYPE>
+std::unique_ptr<ColumnComparator> MakeTyped(bool descending) {
+    return std::make_unique<TypedColumnComparator<ARRAY_TYPE>>(descending);
+}
+
+}  // namespace
+
+
+std::unique_ptr<ColumnComparator> MakeColumnComparator(const arrow::DataType& type, bool descending) {
+    switch (type.id()) {
+        case arrow::Type::INT8:
+            return MakeTyped<arrow::Int8Array>(descending);
+        case arrow::Type::INT16:
+            return MakeTyped<arrow::Int16Array>(descending);
+        case arrow::Type::INT32:
+            return MakeTyped<arrow::Int32Array>(descending);
+        case arrow::Type::INT64:
+            return MakeTyped<arrow::Int64Array>(descending);
+        case arrow::Type::UINT8:
+            return MakeTyped<arrow::UInt8Array>(descending);
+        case arrow::Type::UINT16:
+            return MakeTyped<arrow::UInt16Array>(descending);
+        case arrow::Type::UINT32:
+            return MakeTyped<arrow::UInt32Array>(descending);
+        case arrow::Type::UINT64:
+            return MakeTyped<arrow::UInt64Array>(descending);
+        case arrow::Type::FLOAT:
+            return MakeTyped<arrow::FloatArray>(descending);
+        case arrow::Type::DOUBLE:
+            return MakeTyped<arrow::DoubleArray>(descending);
+        case arrow::Type::DATE32:
+            return MakeTyped<arrow::Date32Array>(descending);
+        case arrow::Type::DATE64:
+            return MakeTyped<arrow::Date64Array>(descending);
+        case arrow::Type::TIME32:
+            return MakeTyped<arrow::Time32Array>(descending);
+        case arrow::Type::TIME64:
+            return MakeTyped<arrow::Time64Array>(descending);
+        case arrow::Type::TIMESTAMP:
+            return MakeTyped<arrow::TimestampArray>(descending);
+        case arrow::Type::DURATION:
+            return MakeTyped<arrow::DurationArray>(descending);
+        case arrow::Type::STRING:
+            return MakeTyped<arrow::StringArray>(descending);
+        case arrow::Type::BINARY:
+            return MakeTyped<arrow::BinaryArray>(descending);
+        case arrow::Type::LARGE_STRING:
+            return MakeTyped<arrow::LargeStringArray>(descending);
+        case arrow::Type::LARGE_BINARY:
+            return MakeTyped<arrow::LargeBinaryArray>(descending);
+        default:
+            throw std::runtime_error("Merge of sorted runs is not supported for the type: " + type.ToString());
+    }
+}
+
+
+RowComparator::RowComparator(const arrow::Schema& schema,
+                             const std::vector<std::string>& sort_cols,
+                             const std::vector<bool>& descending) {
+    for (size_t i = 0, len = sort_cols.size(); i < len; i++) {
+        const int col_idx = schema.GetFieldIndex(sort_cols[i]);
+        if (col_idx < 0) {
+            throw std::runtime_error("Sort column not found: " + sort_cols[i]);
+        }
+        this->col_indices.push_back(col_idx);
+        this->comparators.push_back(MakeColumnComparator(*schema.field(col_idx)->type(), descending[i]));
+    }
+}
+
+bool RowComparator::Less(const arrow::RecordBatch& left, int64_t left_idx,
+                         const arrow::RecordBatch& right, int64_t right_idx) const {
+    for (size_t i = 0, len = this->col_indices.size(); i < len; i++) {
+        const int col_idx = this->col_indices[i];
+        const int cmp = this->comparators[i]->Compare(*left.column(col_idx), left_idx,
+                                                      *right.column(col_idx), right_idx);
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+    }
+    return false;
+}
+
+}  // namespace vinum::operators::sort
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <arrow/api.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace vinum::operators::sort {
+
+/**
+ * Compares the values of a sort column, possibly from different record batches.
+ *
+ * Values are ordered the same way arrow::compute::SortIndices() orders them:
+ * NaNs and nulls are placed at the end regardless of the sort order, NaNs before nulls.
+ */
+class ColumnComparator {
+public:
+    virtual ~ColumnComparator() = default;
+
+    // Negative, zero or positive if left[left_idx] goes before, ties with or goes after right[right_idx].
+    virtual int Compare(const arrow::Array& left, int64_t left_idx,
+                        const arrow::Array& right, int64_t right_idx) const = 0;
+};
+
+std::unique_ptr<ColumnComparator> MakeColumnComparator(const arrow::DataType& type, bool descending);
+
+
+// Lexicographic order of the rows on several sort columns.
+class RowComparator {
+public:
+    RowComparator(const arrow::Schema& schema,
+                  const std::vector<std::string>& sort_cols,
+                  const std::vector<bool>& descending);
+
+    [[nodiscard]] bool Less(const arrow::RecordBatch& left, int64_t left_idx,
+                            const arrow::RecordBatch& right, int64_t right_idx) const;
+
+private:
+    std::vector<int> col_indices;
+    std::vector<std::unique_ptr<ColumnComparator>> comparators;
+};
+
+}  // namespace vinum::operators::sort
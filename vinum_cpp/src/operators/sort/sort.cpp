@@ -1,28 +1,99 @@
 #include "sort.h"
 
+#include "common/spill_file.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+#include <arrow/type_traits.h>
+
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 
 namespace vinum::operators::sort {
 
-Sort::Sort(const std::vector<std::string>& cols,
-           const std::vector<SortOrder>& order) :
-        sort_cols(cols), sort_order(order) {}
+namespace {
 
-void Sort::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
-    this->batches.push_back(batch);
+// Bytes of the values of a variable width array within its slice, the offsets are not included.
+template<typename OFFSET>
+size_t VarWidthValuesBytes(const arrow::ArrayData& data) {
+    if (data.length == 0) {
+        return 0;
+    }
+    const auto* offsets = data.GetValues<OFFSET>(1);
+    return static_cast<size_t>(offsets[data.length] - offsets[0]);
 }
 
-std::shared_ptr<arrow::RecordBatch> Sort::Sorted() {
-    auto create_tbl_res = arrow::Table::FromRecordBatches(this->batches);
-    if (!create_tbl_res.ok()) {
-        throw std::runtime_error("Failed to create table from record batches." + create_tbl_res.status().ToString());
+// Size of the rows of the array, only the range of a sliced array is accounted, so that the slices
+// of a chunk add up to the size of the chunk. Dictionaries and the children of the nested types
+// are accounted with the entire buffers.
+size_t ArrayDataBytes(const arrow::ArrayData& data) {
+    const auto length = static_cast<size_t>(data.length);
+    const size_t bitmap_bytes = !data.buffers.empty() && data.buffers[0] != nullptr ? (length + 7) / 8 : 0;
+    const auto& type = *data.type;
+    switch (type.id()) {
+        case arrow::Type::STRING:
+        case arrow::Type::BINARY:
+            return bitmap_bytes + (length + 1) * sizeof(int32_t) + VarWidthValuesBytes<int32_t>(data);
+        case arrow::Type::LARGE_STRING:
+        case arrow::Type::LARGE_BINARY:
+            return bitmap_bytes + (length + 1) * sizeof(int64_t) + VarWidthValuesBytes<int64_t>(data);
+        case arrow::Type::DICTIONARY: {
+            const auto index_width = static_cast<const arrow::DictionaryType&>(type).index_type()->bit_width();
+            return bitmap_bytes + length * index_width / 8
+                   + (data.dictionary != nullptr ? ArrayDataBytes(*data.dictionary) : 0);
+        }
+        default:
+            break;
+    }
+    if (arrow::is_fixed_width(type.id())) {
+        const auto bit_width = static_cast<size_t>(static_cast<const arrow::FixedWidthType&>(type).bit_width());
+        return bitmap_bytes + (length * bit_width + 7) / 8;
     }
-    auto table = create_tbl_res.ValueOrDie();
 
+    size_t bytes = 0;
+    for (const auto& buffer : data.buffers) {
+        if (buffer != nullptr) {
+            bytes += buffer->size();
+        }
+    }
+    for (const auto& child : data.child_data) {
+        bytes += ArrayDataBytes(*child);
+    }
+    return bytes;
+}
+
+// Size of the rows of the batch, see ArrayDataBytes().
+size_t BatchBytes(const arrow::RecordBatch& batch) {
+    size_t bytes = 0;
+    for (int col_idx = 0; col_idx < batch.num_columns(); col_idx++) {
+        bytes += ArrayDataBytes(*batch.column(col_idx)->data());
+    }
+    return bytes;
+}
+
+// Splits the table into batches of at most batch_size rows, zero-copy.
+std::vector<std::shared_ptr<arrow::RecordBatch>> TableToBatches(const std::shared_ptr<arrow::Table>& table,
+                                                                int64_t batch_size) {
+    std::vector<std::shared_ptr<arrow::RecordBatch>> result;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(batch_size);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&result));
+    return result;
+}
+
+}  // namespace
+
+
+std::shared_ptr<arrow::Table> SortTable(const std::shared_ptr<arrow::Table>& table,
+                                        const std::vector<std::string>& sort_cols,
+                                        const std::vector<SortOrder>& sort_order,
+                                        int64_t max_rows,
+                                        arrow::MemoryPool* pool) {
     std::vector<arrow::compute::SortKey> sort_keys;
-    for (size_t i = 0, len = this->sort_cols.size(); i < len; i++) {
-        const auto& col_name = this->sort_cols[i];
-        const auto& order = this->sort_order[i] == SortOrder::ASC
+    for (size_t i = 0, len = sort_cols.size(); i < len; i++) {
+        const auto& col_name = sort_cols[i];
+        const auto& order = sort_order[i] == SortOrder::ASC
                 ? arrow::compute::SortOrder::Ascending
                 : arrow::compute::SortOrder::Descending;
         sort_keys.emplace_back(col_name, order);
@@ -30,37 +101,308 @@ std::shared_ptr<arrow::RecordBatch> Sort::Sorted() {
 
     auto table_datum = arrow::Datum{*table};
     arrow::compute::SortOptions sort_options(sort_keys);
-    auto sort_result = arrow::compute::SortIndices(table_datum, sort_options);
-    if (!sort_result.ok()) {
-        throw std::runtime_error("Failed to sort table.");
-    }
+    arrow::compute::ExecContext ctx(pool);
+    auto sort_result = arrow::compute::SortIndices(table_datum, sort_options, &ctx);
+    RAISE_ON_ARROW_FAILURE(sort_result.status());
     auto sorted_indices = sort_result.ValueOrDie();
-
-    arrow::Datum sorted_datum;
-    auto take_res = arrow::compute::Take(table_datum, arrow::Datum(sorted_indices));
-    if (!take_res.ok()) {
-        throw std::runtime_error("Failed to take table in sorted order.");
+    if (max_rows >= 0 && max_rows < sorted_indices->length()) {
+        sorted_indices = sorted_indices->Slice(0, max_rows);
     }
+
+    auto take_res = arrow::compute::Take(table_datum, arrow::Datum(sorted_indices),
+                                         arrow::compute::TakeOptions::Defaults(), &ctx);
+    RAISE_ON_ARROW_FAILURE(take_res.status());
     auto tbl = take_res.ValueOrDie().table();
 
     // There should only be one chunk, just an extra check.
     assert(tbl->column(0)->num_chunks() <= 1);
-    auto comb_res = tbl->CombineChunks();
-    if (!comb_res.ok()) {
-        throw std::runtime_error("Failed to combine table's chunks.");
-    }
-    auto sorted_table = comb_res.ValueOrDie();
+    return tbl;
+}
+
+std::shared_ptr<arrow::RecordBatch> TableToBatch(const std::shared_ptr<arrow::Table>& table,
+                                                 arrow::MemoryPool* pool) {
+    auto comb_res = table->CombineChunks(pool);
+    RAISE_ON_ARROW_FAILURE(comb_res.status());
+    auto combined_table = comb_res.ValueOrDie();
 
-    auto reader = arrow::TableBatchReader(*sorted_table);
+    auto reader = arrow::TableBatchReader(*combined_table);
     // Let's ensure that the entire table is converted into a single RecordBatch
-    reader.set_chunksize(sorted_table->num_rows() + 1);
+    reader.set_chunksize(combined_table->num_rows() + 1);
     auto batch_res = reader.Next();
-    if (!comb_res.ok()) {
+    if (!batch_res.ok()) {
         throw std::runtime_error("Failed to convert table to a record batch.");
     }
 
     return batch_res.ValueOrDie();
 }
 
+std::shared_ptr<arrow::RecordBatch> MakeEmptyBatch(const std::shared_ptr<arrow::Schema>& schema) {
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (const auto& field : schema->fields()) {
+        auto column_res = arrow::MakeArrayOfNull(field->type(), 0);
+        RAISE_ON_ARROW_FAILURE(column_res.status());
+        columns.push_back(column_res.ValueOrDie());
+    }
+    return arrow::RecordBatch::Make(schema, 0, columns);
+}
+
+
+Sort::Sort(const std::vector<std::string>& cols,
+           const std::vector<SortOrder>& order) :
+        sort_cols(cols), sort_order(order) {}
+
+Sort::Sort(const std::vector<std::string>& cols,
+           const std::vector<SortOrder>& order,
+           size_t memory_limit,
+           const std::string& spill_dir,
+           int64_t output_batch_size) :
+        sort_cols(cols), sort_order(order),
+        memory_limit(memory_limit), spill_dir(spill_dir), output_batch_size(output_batch_size) {
+    if (output_batch_size <= 0) {
+        throw std::runtime_error("Output batch size must be positive.");
+    }
+}
+
+Sort::~Sort() {
+    this->RemoveSpillFiles();
+}
+
+void Sort::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    if (this->schema == nullptr) {
+        this->schema = batch->schema();
+    }
+    this->batches.push_back(batch);
+    this->stats.num_batches++;
+    this->stats.num_rows += batch->num_rows();
+    this->buffered_bytes += BatchBytes(*batch);
+
+    if (this->memory_limit > 0) {
+        common::ScopedTimer timer(this->stats.sort_nanos);
+        if (this->buffered_bytes > this->memory_limit
+                || !this->memory.TryResize(static_cast<int64_t>(this->buffered_bytes))) {
+            this->SpillRun();
+        }
+    }
+    this->memory.Resize(static_cast<int64_t>(this->buffered_bytes));
+}
+
+std::shared_ptr<arrow::Table>
+Sort::SortBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& input,
+                  arrow::MemoryPool* pool) const {
+    auto create_tbl_res = this->schema != nullptr
+            ? arrow::Table::FromRecordBatches(this->schema, input)
+            : arrow::Table::FromRecordBatches(input);
+    if (!create_tbl_res.ok()) {
+        throw std::runtime_error("Failed to create table from record batches." + create_tbl_res.status().ToString());
+    }
+    return SortTable(create_tbl_res.ValueOrDie(), this->sort_cols, this->sort_order, -1, pool);
+}
+
+std::shared_ptr<arrow::RecordBatch> Sort::Sorted() {
+    if (this->stats.num_spilled_runs == 0) {
+        common::ScopedTimer timer(this->stats.sort_nanos);
+        auto* memory_pool = this->memory.ArrowPool();
+        return TableToBatch(this->SortBatches(this->batches, memory_pool), memory_pool);
+    }
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> sorted_batches;
+    while (auto batch = this->NextSorted()) {
+        sorted_batches.push_back(batch);
+    }
+    auto table_res = arrow::Table::FromRecordBatches(this->schema, sorted_batches);
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    return TableToBatch(table_res.ValueOrDie(), this->memory.ArrowPool());
+}
+
+std::shared_ptr<arrow::RecordBatch> Sort::NextSorted() {
+    common::ScopedTimer timer(this->stats.sort_nanos);
+    if (!this->is_merging) {
+        this->StartMerge();
+    }
+
+    // A single run is already sorted, no need to merge.
+    if (this->runs.size() == 1) {
+        return this->runs[0].NextBatch();
+    }
+    return this->MergeNext();
+}
+
+void Sort::SpillRun() {
+    // The run is written out right away, it's allocated from the default pool,
+    // so that spilling does not fail on the limit of the query pool.
+    auto sorted_table = this->SortBatches(this->batches, arrow::default_memory_pool());
+    this->batches.clear();
+    this->buffered_bytes = 0;
+    this->memory.Resize(0);
+
+    SortedRun run;
+    run.path = common::MakeSpillFilePath(this->spill_dir, "vinum_sort", this->runs.size());
+    // Register the run before writing, so that the file is removed if writing fails.
+    this->runs.push_back(run);
+
+    auto file_res = arrow::io::FileOutputStream::Open(run.path);
+    RAISE_ON_ARROW_FAILURE(file_res.status());
+    auto file = file_res.ValueOrDie();
+    auto writer_res = arrow::ipc::MakeFileWriter(file, this->schema);
+    RAISE_ON_ARROW_FAILURE(writer_res.status());
+    auto writer = writer_res.ValueOrDie();
+
+    for (const auto& batch : TableToBatches(sorted_table, this->output_batch_size)) {
+        RAISE_ON_ARROW_FAILURE(writer->WriteRecordBatch(*batch));
+    }
+    RAISE_ON_ARROW_FAILURE(writer->Close());
+
+    auto position_res = file->Tell();
+    RAISE_ON_ARROW_FAILURE(position_res.status());
+    this->stats.bytes_spilled += position_res.ValueOrDie();
+    this->stats.num_spilled_runs++;
+    RAISE_ON_ARROW_FAILURE(file->Close());
+}
+
+void Sort::StartMerge() {
+    this->is_merging = true;
+    if (this->schema == nullptr) {
+        return;
+    }
+
+    for (auto& run : this->runs) {
+        auto file_res = arrow::io::ReadableFile::Open(run.path);
+        RAISE_ON_ARROW_FAILURE(file_res.status());
+        auto reader_res = arrow::ipc::RecordBatchFileReader::Open(file_res.ValueOrDie());
+        RAISE_ON_ARROW_FAILURE(reader_res.status());
+        run.file_reader = reader_res.ValueOrDie();
+    }
+
+    if (!this->batches.empty()) {
+        SortedRun run;
+        auto sorted_table = this->SortBatches(this->batches, this->memory.ArrowPool());
+        run.batches = this->output_batch_size > 0
+                ? TableToBatches(sorted_table, this->output_batch_size)
+                : std::vector<std::shared_ptr<arrow::RecordBatch>>{TableToBatch(sorted_table, this->memory.ArrowPool())};
+        this->runs.push_back(run);
+        this->batches.clear();
+        this->buffered_bytes = 0;
+        this->memory.Resize(0);
+    }
+
+    if (this->runs.size() <= 1) {
+        return;
+    }
+
+    std::vector<bool> descending;
+    for (const auto& order : this->sort_order) {
+        descending.push_back(order == SortOrder::DESC);
+    }
+    this->comparator = std::make_unique<RowComparator>(*this->schema, this->sort_cols, descending);
+
+    this->cursors.resize(this->runs.size());
+    for (size_t run_idx = 0; run_idx < this->runs.size(); run_idx++) {
+        this->cursors[run_idx].batch = this->runs[run_idx].NextBatch();
+        if (this->cursors[run_idx].batch != nullptr) {
+            this->merge_heap.push_back(run_idx);
+        }
+    }
+    std::make_heap(this->merge_heap.begin(), this->merge_heap.end(),
+                   [this](size_t left, size_t right) { return this->MergesAfter(left, right); });
+}
+
+bool Sort::MergesAfter(size_t left_run, size_t right_run) const {
+    const auto& left = this->cursors[left_run];
+    const auto& right = this->cursors[right_run];
+    if (this->comparator->Less(*right.batch, right.row_idx, *left.batch, left.row_idx)) {
+        return true;
+    }
+    if (this->comparator->Less(*left.batch, left.row_idx, *right.batch, right.row_idx)) {
+        return false;
+    }
+    // Ties are taken from the earlier run, which keeps the input order of equal rows.
+    return right_run < left_run;
+}
+
+std::shared_ptr<arrow::RecordBatch> Sort::MergeNext() {
+    if (this->merge_heap.empty()) {
+        this->RemoveSpillFiles();
+        return nullptr;
+    }
+
+    // Output rows are taken from the current batches of the runs, and from the batches
+    // the runs advance to while the output batch is filled.
+    std::vector<std::shared_ptr<arrow::RecordBatch>> sources;
+    int64_t sources_rows = 0;
+    for (size_t run_idx : this->merge_heap) {
+        auto& cursor = this->cursors[run_idx];
+        cursor.source_offset = sources_rows;
+        sources.push_back(cursor.batch);
+        sources_rows += cursor.batch->num_rows();
+    }
+
+    const auto merges_after = [this](size_t left, size_t right) { return this->MergesAfter(left, right); };
+    arrow::Int64Builder indices_builder(this->memory.ArrowPool());
+    RAISE_ON_ARROW_FAILURE(indices_builder.Reserve(this->output_batch_size));
+    int64_t num_rows = 0;
+    while (!this->merge_heap.empty() && num_rows < this->output_batch_size) {
+        std::pop_heap(this->merge_heap.begin(), this->merge_heap.end(), merges_after);
+        const size_t run_idx = this->merge_heap.back();
+        auto& cursor = this->cursors[run_idx];
+        indices_builder.UnsafeAppend(cursor.source_offset + cursor.row_idx);
+        num_rows++;
+
+        if (++cursor.row_idx == cursor.batch->num_rows()) {
+            cursor.batch = this->runs[run_idx].NextBatch();
+            cursor.row_idx = 0;
+            if (cursor.batch == nullptr) {
+                this->merge_heap.pop_back();
+                continue;
+            }
+            cursor.source_offset = sources_rows;
+            sources.push_back(cursor.batch);
+            sources_rows += cursor.batch->num_rows();
+        }
+        std::push_heap(this->merge_heap.begin(), this->merge_heap.end(), merges_after);
+    }
+
+    std::shared_ptr<arrow::Array> indices;
+    RAISE_ON_ARROW_FAILURE(indices_builder.Finish(&indices));
+
+    auto sources_res = arrow::Table::FromRecordBatches(this->schema, sources);
+    RAISE_ON_ARROW_FAILURE(sources_res.status());
+    arrow::compute::ExecContext ctx(this->memory.ArrowPool());
+    auto take_res = arrow::compute::Take(arrow::Datum(sources_res.ValueOrDie()), arrow::Datum(indices),
+                                         arrow::compute::TakeOptions::Defaults(), &ctx);
+    RAISE_ON_ARROW_FAILURE(take_res.status());
+    return TableToBatch(take_res.ValueOrDie().table(), this->memory.ArrowPool());
+}
+
+std::shared_ptr<arrow::RecordBatch> Sort::SortedRun::NextBatch() {
+    if (this->file_reader != nullptr) {
+        while (this->next_batch_idx < this->file_reader->num_record_batches()) {
+            auto batch_res = this->file_reader->ReadRecordBatch(this->next_batch_idx++);
+            RAISE_ON_ARROW_FAILURE(batch_res.status());
+            if (batch_res.ValueOrDie()->num_rows() > 0) {
+                return batch_res.ValueOrDie();
+            }
+        }
+        return nullptr;
+    }
+
+    while (this->next_batch_idx < static_cast<int>(this->batches.size())) {
+        auto batch = std::move(this->batches[this->next_batch_idx++]);
+        if (batch->num_rows() > 0) {
+            return batch;
+        }
+    }
+    return nullptr;
+}
+
+void Sort::RemoveSpillFiles() {
+    for (auto& run : this->runs) {
+        run.file_reader = nullptr;
+        if (!run.path.empty()) {
+            std::remove(run.path.c_str());
+            run.path.clear();
+        }
+    }
+}
+
 
 }  // namespace vinum::operators::sort
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "row_comparator.h"
+#include "common/memory_pool.h"
+#include "operators/filter/selection.h"
+
 #include <arrow/api.h>
 #include <arrow/compute/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
 
 #include <memory>
 
@@ -11,21 +17,125 @@ enum class SortOrder {
     ASC, DESC
 };
 
+// Sorts the table, keeping the max_rows first rows if max_rows is not negative.
+std::shared_ptr<arrow::Table> SortTable(const std::shared_ptr<arrow::Table>& table,
+                                        const std::vector<std::string>& sort_cols,
+                                        const std::vector<SortOrder>& sort_order,
+                                        int64_t max_rows = -1,
+                                        arrow::MemoryPool* pool = arrow::default_memory_pool());
+
+// Combines the chunks of the table into a single batch.
+std::shared_ptr<arrow::RecordBatch> TableToBatch(const std::shared_ptr<arrow::Table>& table,
+                                                 arrow::MemoryPool* pool = arrow::default_memory_pool());
+
+// Batch of the schema without rows.
+std::shared_ptr<arrow::RecordBatch> MakeEmptyBatch(const std::shared_ptr<arrow::Schema>& schema);
+
+// Activity of a Sort.
+struct SortStats {
+    uint64_t bytes_spilled = 0;      // Bytes written to the spill files
+    uint32_t num_spilled_runs = 0;   // Number of sorted runs written to the spill files
+    int64_t num_batches = 0;         // Batches received by Next()
+    int64_t num_rows = 0;            // Rows received by Next()
+    int64_t sort_nanos = 0;          // Time spent sorting, spilling and merging the runs
+};
+
+/**
+ * Sort operator.
+ *
+ * Without a memory limit the batches are kept in memory and sorted at once.
+ *
+ * With a memory limit, the batches are buffered until their size exceeds the limit,
+ * then the buffered batches are sorted into a run, which is written to an Arrow IPC file
+ * in spill_dir. NextSorted() k-way merges the spilled runs and the run of the remaining
+ * buffered batches, only the current batch of every run is held in memory.
+ *
+ * With a memory pool, the buffered batches are reserved in the pool and the sorted rows are
+ * allocated from it. With a memory limit, a batch not fitting the pool spills the buffered batches,
+ * otherwise it fails with MemoryLimitError.
+ *
+ * Rows with equal sort keys keep their input order.
+ */
 class Sort {
 public:
     explicit Sort(const std::vector<std::string>& sort_cols,
                   const std::vector<SortOrder>& sort_order);
 
+    Sort(const std::vector<std::string>& sort_cols,
+         const std::vector<SortOrder>& sort_order,
+         size_t memory_limit,
+         const std::string& spill_dir,
+         int64_t output_batch_size);
+
+    ~Sort();
+
     void Next(const std::shared_ptr<arrow::RecordBatch>& batch);
 
+    // The rows are buffered, so the selected rows of the batch are gathered on arrival.
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch, const std::shared_ptr<arrow::Array>& selection) {
+        this->Next(filter::TakeSelected(batch, selection));
+    }
+
+    // All the sorted rows in a single batch.
     std::shared_ptr<arrow::RecordBatch> Sorted();
 
+    // Next batch of at most output_batch_size sorted rows, nullptr once all the rows were returned.
+    std::shared_ptr<arrow::RecordBatch> NextSorted();
+
+    [[nodiscard]] const SortStats& Stats() const {
+        return this->stats;
+    }
+
+    // Must be called before Next().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool) {
+        this->memory.SetPool(pool);
+    }
 
 private:
+    // Sorted run, either spilled to a file or kept in memory.
+    struct SortedRun {
+        std::string path;
+        std::shared_ptr<arrow::ipc::RecordBatchFileReader> file_reader = nullptr;
+        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;   // Batches of an in-memory run
+        int next_batch_idx = 0;
+
+        std::shared_ptr<arrow::RecordBatch> NextBatch();
+    };
+
+    // Merge position in a run.
+    struct RunCursor {
+        std::shared_ptr<arrow::RecordBatch> batch = nullptr;
+        int64_t row_idx = 0;
+        int64_t source_offset = 0;  // Offset of the batch in the sources of the current output batch
+    };
+
     std::vector<std::string> sort_cols;
     std::vector<SortOrder> sort_order;
 
+    const size_t memory_limit = 0;      // 0 disables spilling
+    const std::string spill_dir;
+    const int64_t output_batch_size = 0;
+
+    std::shared_ptr<arrow::Schema> schema = nullptr;
     std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    size_t buffered_bytes = 0;
+    common::MemoryReservation memory;   // Bytes of the buffered batches
+
+    std::vector<SortedRun> runs;
+    std::vector<RunCursor> cursors;
+    std::vector<size_t> merge_heap;     // Indices of the runs which have rows left
+    std::unique_ptr<RowComparator> comparator = nullptr;
+    bool is_merging = false;
+    SortStats stats;
+
+    std::shared_ptr<arrow::Table> SortBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& input,
+                                              arrow::MemoryPool* pool) const;
+    void SpillRun();
+    void StartMerge();
+    // Whether the current row of left_run is merged after the current row of right_run.
+    [[nodiscard]] bool MergesAfter(size_t left_run, size_t right_run) const;
+    std::shared_ptr<arrow::RecordBatch> MergeNext();
+    void RemoveSpillFiles();
 };
 
 
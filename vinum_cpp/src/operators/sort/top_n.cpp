@@ -0,0 +1,103 @@
+#include "top_n.h"
+
+#include "common/util.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace vinum::operators::sort {
+
+TopN::TopN(const std::vector<std::string>& cols,
+           const std::vector<SortOrder>& order,
+           int64_t limit,
+           int64_t offset) :
+        sort_cols(cols), sort_order(order), limit(limit), offset(offset), num_best(limit + offset) {
+    if (limit < 0 || offset < 0) {
+        throw std::runtime_error("Limit and offset of TopN must not be negative.");
+    }
+}
+
+void TopN::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    if (this->schema == nullptr) {
+        this->schema = batch->schema();
+        std::vector<bool> descending;
+        for (const auto& order : this->sort_order) {
+            descending.push_back(order == SortOrder::DESC);
+        }
+        this->comparator = std::make_unique<RowComparator>(*this->schema, this->sort_cols, descending);
+    }
+    if (this->num_best == 0) {
+        return;
+    }
+
+    auto candidates = this->SelectCandidates(batch);
+    if (candidates->num_rows() == 0) {
+        return;
+    }
+    this->batches.push_back(candidates);
+    this->buffered_rows += candidates->num_rows();
+
+    if (this->buffered_rows > 2 * this->num_best) {
+        this->Compact();
+    }
+}
+
+std::shared_ptr<arrow::RecordBatch>
+TopN::SelectCandidates(const std::shared_ptr<arrow::RecordBatch>& batch) const {
+    if (this->threshold_batch == nullptr) {
+        return batch;
+    }
+
+    // Rows tying with the threshold row come later in the input, so they can't be among the best rows.
+    arrow::Int64Builder indices_builder(this->memory.ArrowPool());
+    RAISE_ON_ARROW_FAILURE(indices_builder.Reserve(batch->num_rows()));
+    for (int64_t row_idx = 0; row_idx < batch->num_rows(); row_idx++) {
+        if (this->comparator->Less(*batch, row_idx, *this->threshold_batch, this->threshold_row)) {
+            indices_builder.UnsafeAppend(row_idx);
+        }
+    }
+    if (indices_builder.length() == batch->num_rows()) {
+        return batch;
+    }
+
+    std::shared_ptr<arrow::Array> indices;
+    RAISE_ON_ARROW_FAILURE(indices_builder.Finish(&indices));
+    arrow::compute::ExecContext ctx(this->memory.ArrowPool());
+    auto take_res = arrow::compute::Take(arrow::Datum(batch), arrow::Datum(indices),
+                                         arrow::compute::TakeOptions::Defaults(), &ctx);
+    RAISE_ON_ARROW_FAILURE(take_res.status());
+    return take_res.ValueOrDie().record_batch();
+}
+
+void TopN::Compact() {
+    auto table_res = arrow::Table::FromRecordBatches(this->schema, this->batches);
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    auto* memory_pool = this->memory.ArrowPool();
+    auto best = TableToBatch(
+            SortTable(table_res.ValueOrDie(), this->sort_cols, this->sort_order, this->num_best, memory_pool),
+            memory_pool);
+
+    this->batches = {best};
+    this->buffered_rows = best->num_rows();
+    if (best->num_rows() == this->num_best) {
+        this->threshold_batch = best;
+        this->threshold_row = this->num_best - 1;
+    }
+}
+
+std::shared_ptr<arrow::RecordBatch> TopN::Result() {
+    if (this->schema == nullptr) {
+        throw std::runtime_error("TopN received no record batches.");
+    }
+
+    if (this->buffered_rows > 0) {
+        this->Compact();
+        const auto& best = this->batches[0];
+        const int64_t slice_offset = std::min(this->offset, best->num_rows());
+        return best->Slice(slice_offset, std::min(this->limit, best->num_rows() - slice_offset));
+    }
+
+    return MakeEmptyBatch(this->schema);
+}
+
+}  // namespace vinum::operators::sort
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "sort.h"
+#include "row_comparator.h"
+
+#include <arrow/api.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vinum::operators::sort {
+
+/**
+ * Top-N operator, equivalent to Sort followed by a slice of the [offset, offset + limit) rows.
+ *
+ * Only the best offset + limit rows seen so far are kept. Once that many rows were seen,
+ * a row of a new batch is buffered only if it goes strictly before the current last best row,
+ * and the buffered rows are sorted and truncated to the best offset + limit rows every time
+ * they exceed twice that many. Memory is O(offset + limit + batch size) instead of O(input).
+ *
+ * Rows with equal sort keys keep their input order, as with Sort.
+ */
+class TopN {
+public:
+    TopN(const std::vector<std::string>& sort_cols,
+         const std::vector<SortOrder>& sort_order,
+         int64_t limit,
+         int64_t offset);
+
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch);
+
+    // Only the best rows of the batches are kept, the selected rows of the batch are gathered on arrival.
+    void Next(const std::shared_ptr<arrow::RecordBatch>& batch, const std::shared_ptr<arrow::Array>& selection) {
+        this->Next(filter::TakeSelected(batch, selection));
+    }
+
+    std::shared_ptr<arrow::RecordBatch> Result();
+
+    // The candidate and the best rows are allocated from the pool, must be called before Next().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool) {
+        this->memory.SetPool(pool);
+    }
+
+private:
+    const std::vector<std::string> sort_cols;
+    const std::vector<SortOrder> sort_order;
+    const int64_t limit;
+    const int64_t offset;
+    const int64_t num_best;      // offset + limit
+
+    std::shared_ptr<arrow::Schema> schema = nullptr;
+    std::unique_ptr<RowComparator> comparator = nullptr;
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    int64_t buffered_rows = 0;
+    common::MemoryReservation memory;
+
+    // Last of the best rows, set once num_best rows were seen.
+    std::shared_ptr<arrow::RecordBatch> threshold_batch = nullptr;
+    int64_t threshold_row = 0;
+
+    std::shared_ptr<arrow::RecordBatch> SelectCandidates(const std::shared_ptr<arrow::RecordBatch>& batch) const;
+    void Compact();
+};
+
+}  // namespace vinum::operators::sort
@@ -1,5 +1,12 @@
 #include "table_batch_reader.h"
 
+#include <arrow/type_traits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
 namespace vinum::operators {
 
 TableBatchReader::TableBatchReader(const std::shared_ptr<arrow::Table>& in_table) : table(in_table) {
@@ -15,4 +22,142 @@ void TableBatchReader::SetBatchSize(int64_t batch_size) {
     this->reader->set_chunksize(batch_size);
 }
 
+
+// Bytes of the values of a variable width column, the offsets are not included.
+template<typename ARRAY_TYPE>
+static int64_t VarWidthValuesBytes(const arrow::ChunkedArray& column) {
+    int64_t num_bytes = 0;
+    for (const auto& chunk : column.chunks()) {
+        const auto& array = static_cast<const ARRAY_TYPE&>(*chunk);
+        if (array.length() > 0) {
+            num_bytes += array.value_offset(array.length()) - array.value_offset(0);
+        }
+    }
+    return num_bytes;
+}
+
+int64_t AverageRowWidth(const std::shared_ptr<arrow::Table>& table, const std::vector<std::string>& column_names) {
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+    if (column_names.empty()) {
+        columns = table->columns();
+    } else {
+        for (const auto& col_name : column_names) {
+            auto column = table->GetColumnByName(col_name);
+            if (column == nullptr) {
+                throw std::runtime_error("Column not found: " + col_name);
+            }
+            columns.push_back(column);
+        }
+    }
+
+    const auto num_rows = std::max<int64_t>(table->num_rows(), 1);
+    double row_width = 0;
+    for (const auto& column : columns) {
+        const auto& type = *column->type();
+        switch (type.id()) {
+            case arrow::Type::STRING:
+            case arrow::Type::BINARY:
+                row_width += sizeof(int32_t)
+                        + static_cast<double>(VarWidthValuesBytes<arrow::BinaryArray>(*column)) / num_rows;
+                break;
+            case arrow::Type::LARGE_STRING:
+            case arrow::Type::LARGE_BINARY:
+                row_width += sizeof(int64_t)
+                        + static_cast<double>(VarWidthValuesBytes<arrow::LargeBinaryArray>(*column)) / num_rows;
+                break;
+            default:
+                // Dictionaries are fixed width, of the width of their indices. Nested types are not
+                // scanned natively, a pointer per row is close enough.
+                if (arrow::is_fixed_width(type.id())) {
+                    row_width += static_cast<const arrow::FixedWidthType&>(type).bit_width() / 8.0;
+                } else {
+                    row_width += sizeof(int64_t);
+                }
+        }
+    }
+    return std::max<int64_t>(static_cast<int64_t>(std::ceil(row_width)), 1);
+}
+
+int64_t AdaptiveBatchSize(int64_t row_width, int64_t max_batch_size) {
+    const auto batch_size = ADAPTIVE_BATCH_BYTES / std::max<int64_t>(row_width, 1);
+    return std::min(std::max(batch_size, MIN_ADAPTIVE_BATCH_SIZE), max_batch_size);
+}
+
+
+ParallelTableBatchReader::ParallelTableBatchReader(const std::shared_ptr<arrow::Table>& in_table,
+                                                   int64_t morsel_size,
+                                                   size_t num_workers)
+        : table(in_table), ranges(std::max<size_t>(num_workers, 1)) {
+    if (morsel_size <= 0) {
+        throw std::runtime_error("Morsel size must be positive: " + std::to_string(morsel_size));
+    }
+
+    // Morsels are cut at the chunk boundaries of every column.
+    std::vector<int64_t> boundaries {0, this->table->num_rows()};
+    for (int col_idx = 0; col_idx < this->table->num_columns(); col_idx++) {
+        std::vector<int64_t> offsets;
+        int64_t offset = 0;
+        for (const auto& chunk : this->table->column(col_idx)->chunks()) {
+            offsets.push_back(offset);
+            boundaries.push_back(offset);
+            offset += chunk->length();
+        }
+        this->chunk_offsets.push_back(std::move(offsets));
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    for (size_t idx = 0; idx + 1 < boundaries.size(); idx++) {
+        for (int64_t offset = boundaries[idx]; offset < boundaries[idx + 1]; offset += morsel_size) {
+            this->morsels.push_back(Morsel{offset, std::min(morsel_size, boundaries[idx + 1] - offset)});
+        }
+    }
+
+    const auto num_morsels = static_cast<int64_t>(this->morsels.size());
+    const auto num_ranges = static_cast<int64_t>(this->ranges.size());
+    for (int64_t range_idx = 0; range_idx < num_ranges; range_idx++) {
+        this->ranges[range_idx].next = range_idx * num_morsels / num_ranges;
+        this->ranges[range_idx].end = (range_idx + 1) * num_morsels / num_ranges;
+    }
+}
+
+std::shared_ptr<arrow::RecordBatch> ParallelTableBatchReader::Next(size_t worker_idx) {
+    const size_t num_ranges = this->ranges.size();
+    for (size_t step = 0; step < num_ranges; step++) {
+        auto& range = this->ranges[(worker_idx + step) % num_ranges];
+        // Exhausted ranges are skipped without the increment, so that their positions stay bounded.
+        if (range.next.load(std::memory_order_relaxed) >= range.end) {
+            continue;
+        }
+        const int64_t morsel_idx = range.next.fetch_add(1, std::memory_order_relaxed);
+        if (morsel_idx < range.end) {
+            return this->MakeBatch(this->morsels[morsel_idx]);
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<arrow::Schema> ParallelTableBatchReader::Schema() const {
+    return this->table->schema();
+}
+
+size_t ParallelTableBatchReader::NumWorkers() const {
+    return this->ranges.size();
+}
+
+int64_t ParallelTableBatchReader::NumMorsels() const {
+    return static_cast<int64_t>(this->morsels.size());
+}
+
+std::shared_ptr<arrow::RecordBatch> ParallelTableBatchReader::MakeBatch(const Morsel& morsel) const {
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (int col_idx = 0; col_idx < this->table->num_columns(); col_idx++) {
+        const auto& offsets = this->chunk_offsets[col_idx];
+        const auto chunk_idx = std::upper_bound(offsets.begin(), offsets.end(), morsel.offset) - offsets.begin() - 1;
+        const auto& chunk = this->table->column(col_idx)->chunk(static_cast<int>(chunk_idx));
+        columns.push_back(chunk->Slice(morsel.offset - offsets[chunk_idx], morsel.length));
+    }
+    return arrow::RecordBatch::Make(this->table->schema(), morsel.length, columns);
+}
+
 }  // namespace vinum::operators
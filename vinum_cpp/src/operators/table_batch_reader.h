@@ -1,11 +1,28 @@
 #pragma once
 
+#include "batch_source.h"
+
 #include <arrow/api.h>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace vinum::operators {
 
+// Target size of the columns of a batch of the adaptive batch size, so that a batch stays in the L2 cache.
+constexpr int64_t ADAPTIVE_BATCH_BYTES = 1 << 20;
+constexpr int64_t MIN_ADAPTIVE_BATCH_SIZE = 1024;
+
+// Average size of a row of the columns in bytes, of all the columns if column_names is empty.
+// Variable width columns count their offsets and the average length of their values.
+int64_t AverageRowWidth(const std::shared_ptr<arrow::Table>& table, const std::vector<std::string>& column_names);
+
+// Rows of the batches of ADAPTIVE_BATCH_BYTES, of at least MIN_ADAPTIVE_BATCH_SIZE and at most max_batch_size rows.
+int64_t AdaptiveBatchSize(int64_t row_width, int64_t max_batch_size);
+
 class TableBatchReader {
 public:
     explicit TableBatchReader(const std::shared_ptr<arrow::Table>& table);
@@ -20,4 +37,50 @@ private:
 
 };
 
+/**
+ * Reader of a table by several workers, splitting the table into zero-copy morsels.
+ *
+ * A morsel is a slice of at most morsel_size rows, which never crosses a chunk boundary of
+ * any of the columns, so every column of the morsel is a slice of a single chunk.
+ * The morsels are split into contiguous ranges, one per worker. A worker takes the morsels
+ * of its own range first, then steals the remaining morsels of the other ranges, so that
+ * the workers stay busy when the cost of the morsels is skewed.
+ * Taking a morsel is a single atomic increment of the position of a range, Next() is lock-free
+ * and may be called concurrently, from any number of threads with distinct worker indices.
+ */
+class ParallelTableBatchReader : public BatchSource {
+public:
+    ParallelTableBatchReader(const std::shared_ptr<arrow::Table>& table,
+                             int64_t morsel_size,
+                             size_t num_workers);
+
+    // Next morsel of the worker, nullptr once all the morsels are taken.
+    std::shared_ptr<arrow::RecordBatch> Next(size_t worker_idx) override;
+
+    [[nodiscard]] std::shared_ptr<arrow::Schema> Schema() const override;
+
+    [[nodiscard]] size_t NumWorkers() const override;
+
+    [[nodiscard]] int64_t NumMorsels() const;
+
+private:
+    struct Morsel {
+        int64_t offset;
+        int64_t length;
+    };
+
+    // Morsels [next, end) of a worker, aligned to avoid false sharing of the positions.
+    struct alignas(64) MorselRange {
+        std::atomic<int64_t> next {0};
+        int64_t end = 0;
+    };
+
+    std::shared_ptr<arrow::Table> table;
+    std::vector<Morsel> morsels;
+    std::vector<std::vector<int64_t>> chunk_offsets;     // First row of every chunk, per column
+    std::vector<MorselRange> ranges;
+
+    [[nodiscard]] std::shared_ptr<arrow::RecordBatch> MakeBatch(const Morsel& morsel) const;
+};
+
 }  // namespace vinum::operators
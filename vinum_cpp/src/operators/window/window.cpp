@@ -0,0 +1,285 @@
+#include "window.h"
+
+#include "operators/aggregate/agg_func_factory.h"
+#include "operators/sort/sort.h"
+#include "common/array_iterators.h"
+#include "common/util.h"
+
+#include <arrow/compute/api.h>
+
+#include <iostream>
+
+
+namespace vinum::operators::window {
+
+namespace {
+
+aggregate::AggFuncType ToAggFuncType(WindowFuncType func) {
+    switch (func) {
+        case WindowFuncType::COUNT:
+            return aggregate::AggFuncType::COUNT;
+        case WindowFuncType::COUNT_STAR:
+            return aggregate::AggFuncType::COUNT_STAR;
+        case WindowFuncType::MIN:
+            return aggregate::AggFuncType::MIN;
+        case WindowFuncType::MAX:
+            return aggregate::AggFuncType::MAX;
+        case WindowFuncType::SUM:
+            return aggregate::AggFuncType::SUM;
+        case WindowFuncType::AVG:
+            return aggregate::AggFuncType::AVG;
+        default:
+            throw std::runtime_error("Window function is not an aggregate.");
+    }
+}
+
+std::shared_ptr<arrow::RecordBatch> ConcatenateBatches(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+                                                       arrow::MemoryPool* pool) {
+    if (batches.size() == 1) {
+        return batches[0];
+    }
+    auto table_res = arrow::Table::FromRecordBatches(batches);
+    RAISE_ON_ARROW_FAILURE(table_res.status());
+    return sort::TableToBatch(table_res.ValueOrDie(), pool);
+}
+
+}  // namespace
+
+
+Window::Window(const std::vector<std::string>& partition_cols,
+               const std::vector<std::string>& order_cols,
+               const std::vector<WindowFuncDef>& funcs)
+        : partition_cols(partition_cols), order_cols(order_cols), funcs(funcs) {}
+
+void Window::EnsureInit(const std::shared_ptr<arrow::Schema>& batch_schema) {
+    if (this->schema != nullptr) {
+        return;
+    }
+    this->schema = batch_schema;
+    this->partition_comparator = std::make_unique<sort::RowComparator>(
+            *this->schema, this->partition_cols, std::vector<bool>(this->partition_cols.size(), false));
+
+    std::vector<std::string> peer_cols(this->partition_cols);
+    peer_cols.insert(peer_cols.end(), this->order_cols.begin(), this->order_cols.end());
+    this->peer_comparator = std::make_unique<sort::RowComparator>(
+            *this->schema, peer_cols, std::vector<bool>(peer_cols.size(), false));
+}
+
+bool Window::IsNewPartition(const arrow::RecordBatch& left, int64_t left_idx,
+                            const arrow::RecordBatch& right, int64_t right_idx) const {
+    // The comparator is ascending, whatever the sort order of the input, so both directions are compared.
+    return this->partition_comparator->Less(left, left_idx, right, right_idx)
+            || this->partition_comparator->Less(right, right_idx, left, left_idx);
+}
+
+std::shared_ptr<arrow::RecordBatch> Window::Next(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    this->EnsureInit(batch->schema());
+    const int64_t num_rows = batch->num_rows();
+    if (num_rows == 0) {
+        return nullptr;
+    }
+
+    // Start of the last partition of the batch.
+    int64_t last_start = num_rows - 1;
+    while (last_start > 0 && !this->IsNewPartition(*batch, last_start - 1, *batch, last_start)) {
+        last_start--;
+    }
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> completed;
+    if (last_start > 0) {
+        completed.swap(this->pending);
+        completed.push_back(batch->Slice(0, last_start));
+        this->pending.push_back(batch->Slice(last_start));
+    } else if (!this->pending.empty()) {
+        const auto& last_batch = *this->pending.back();
+        if (this->IsNewPartition(last_batch, last_batch.num_rows() - 1, *batch, 0)) {
+            completed.swap(this->pending);
+        }
+        this->pending.push_back(batch);
+    } else {
+        this->pending.push_back(batch);
+    }
+
+    if (completed.empty()) {
+        return nullptr;
+    }
+    return this->Evaluate(completed);
+}
+
+std::shared_ptr<arrow::RecordBatch> Window::Finish() {
+    if (this->schema == nullptr) {
+        return nullptr;
+    }
+    if (this->pending.empty()) {
+        if (this->has_output) {
+            return nullptr;
+        }
+        // Window columns of an empty input, so that the output schema is known.
+        return this->Evaluate({sort::MakeEmptyBatch(this->schema)});
+    }
+    std::vector<std::shared_ptr<arrow::RecordBatch>> completed;
+    completed.swap(this->pending);
+    return this->Evaluate(completed);
+}
+
+std::shared_ptr<arrow::RecordBatch> Window::Evaluate(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+    this->has_output = true;
+    const auto batch = ConcatenateBatches(batches, this->memory.ArrowPool());
+    const int64_t num_rows = batch->num_rows();
+
+    // The first row of every partition, and of every peer group.
+    std::vector<uint8_t> new_partition(num_rows);
+    std::vector<uint8_t> new_peer(num_rows);
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        new_partition[row_idx] = row_idx == 0 || this->IsNewPartition(*batch, row_idx - 1, *batch, row_idx);
+        new_peer[row_idx] = new_partition[row_idx]
+                || this->peer_comparator->Less(*batch, row_idx - 1, *batch, row_idx)
+                || this->peer_comparator->Less(*batch, row_idx, *batch, row_idx - 1);
+    }
+
+    auto fields = batch->schema()->fields();
+    auto columns = batch->columns();
+    for (const auto& func : this->funcs) {
+        std::shared_ptr<arrow::Array> column;
+        switch (func.func) {
+            case WindowFuncType::ROW_NUMBER:
+            case WindowFuncType::RANK:
+            case WindowFuncType::DENSE_RANK:
+                column = this->Rank(func, new_partition, new_peer);
+                break;
+            case WindowFuncType::LAG:
+            case WindowFuncType::LEAD:
+                column = this->Offset(func, *batch, new_partition);
+                break;
+            default:
+                column = this->Aggregate(func, *batch, new_partition, new_peer);
+        }
+        fields.push_back(arrow::field(func.out_col_name, column->type()));
+        columns.push_back(column);
+    }
+    return arrow::RecordBatch::Make(arrow::schema(fields), num_rows, columns);
+}
+
+std::shared_ptr<arrow::Array> Window::Rank(const WindowFuncDef& func,
+                                           const std::vector<uint8_t>& new_partition,
+                                           const std::vector<uint8_t>& new_peer) const {
+    const auto num_rows = static_cast<int64_t>(new_partition.size());
+    arrow::UInt64Builder builder(this->memory.ArrowPool());
+    RAISE_ON_ARROW_FAILURE(builder.Resize(num_rows));
+
+    uint64_t row_number = 0;
+    uint64_t rank = 0;
+    uint64_t dense_rank = 0;
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        if (new_partition[row_idx]) {
+            row_number = 0;
+            dense_rank = 0;
+        }
+        row_number++;
+        if (new_peer[row_idx]) {
+            rank = row_number;
+            dense_rank++;
+        }
+        switch (func.func) {
+            case WindowFuncType::ROW_NUMBER:
+                builder.UnsafeAppend(row_number);
+                break;
+            case WindowFuncType::RANK:
+                builder.UnsafeAppend(rank);
+                break;
+            default:
+                builder.UnsafeAppend(dense_rank);
+        }
+    }
+
+    std::shared_ptr<arrow::Array> array;
+    RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+    return array;
+}
+
+std::shared_ptr<arrow::Array> Window::Offset(const WindowFuncDef& func,
+                                             const arrow::RecordBatch& batch,
+                                             const std::vector<uint8_t>& new_partition) const {
+    const int64_t num_rows = batch.num_rows();
+    arrow::Int64Builder indices_builder(this->memory.ArrowPool());
+    RAISE_ON_ARROW_FAILURE(indices_builder.Reserve(num_rows));
+
+    // End of the partition of every row, scanned backwards.
+    std::vector<int64_t> partition_end(num_rows);
+    for (int64_t row_idx = num_rows - 1, end = num_rows; row_idx >= 0; row_idx--) {
+        partition_end[row_idx] = end;
+        if (new_partition[row_idx]) {
+            end = row_idx;
+        }
+    }
+
+    const int64_t offset = func.func == WindowFuncType::LAG ? -func.offset : func.offset;
+    int64_t partition_start = 0;
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        if (new_partition[row_idx]) {
+            partition_start = row_idx;
+        }
+        const int64_t source_idx = row_idx + offset;
+        if (source_idx >= partition_start && source_idx < partition_end[row_idx]) {
+            indices_builder.UnsafeAppend(source_idx);
+        } else {
+            indices_builder.UnsafeAppendNull();
+        }
+    }
+
+    std::shared_ptr<arrow::Array> indices;
+    RAISE_ON_ARROW_FAILURE(indices_builder.Finish(&indices));
+    arrow::compute::ExecContext ctx(this->memory.ArrowPool());
+    auto take_res = arrow::compute::Take(arrow::Datum(batch.GetColumnByName(func.column_name)),
+                                         arrow::Datum(indices),
+                                         arrow::compute::TakeOptions::Defaults(), &ctx);
+    RAISE_ON_ARROW_FAILURE(take_res.status());
+    return take_res.ValueOrDie().make_array();
+}
+
+std::shared_ptr<arrow::Array> Window::Aggregate(const WindowFuncDef& func,
+                                                const arrow::RecordBatch& batch,
+                                                const std::vector<uint8_t>& new_partition,
+                                                const std::vector<uint8_t>& new_peer) const {
+    const int64_t num_rows = batch.num_rows();
+    const aggregate::AggFuncDef agg_def {ToAggFuncType(func.func), func.column_name, func.out_col_name};
+    const auto agg_func = aggregate::agg_func_factory(agg_def, batch.schema());
+    agg_func->SetMemoryPool(this->memory.ArrowPool());
+
+    const auto array = agg_def.column_name.empty() ? batch.column(0) : batch.GetColumnByName(agg_def.column_name);
+    auto array_iter = common::array_iter_factory(
+            agg_def.column_name.empty() ? arrow::Type::NA : array->type_id());
+    array_iter->SetArray(array);
+    agg_func->SetArrayIter(std::move(array_iter));
+
+    // Every partition is a group, its state is summarized once per row of every peer group.
+    uint32_t group_id = 0;
+    int64_t peer_start = 0;
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        if (new_partition[row_idx]) {
+            if (row_idx > 0) {
+                group_id++;
+            }
+            agg_func->Init(row_idx);
+        } else {
+            agg_func->Update(group_id);
+        }
+        if (new_peer[row_idx]) {
+            peer_start = row_idx;
+        }
+        if (row_idx + 1 == num_rows || new_peer[row_idx + 1]) {
+            for (int64_t peer_idx = peer_start; peer_idx <= row_idx; peer_idx++) {
+                agg_func->Summarize(group_id, group_id + 1);
+            }
+        }
+    }
+
+    auto result = agg_func->Result();
+    if (result->length() != num_rows) {
+        // SUM switches to Decimal128 once it overflows, which cannot be done midway through the rows.
+        throw std::runtime_error("Running " + func.out_col_name + " overflows the output type.");
+    }
+    return result;
+}
+
+}  // namespace vinum::operators::window
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "common/memory_pool.h"
+#include "operators/aggregate/agg_funcs.h"
+#include "operators/sort/row_comparator.h"
+
+#include <arrow/api.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace vinum::operators::window {
+
+enum class WindowFuncType {
+    ROW_NUMBER, RANK, DENSE_RANK, COUNT, COUNT_STAR, MIN, MAX, SUM, AVG, LAG, LEAD
+};
+
+struct WindowFuncDef {
+    WindowFuncType func;
+    std::string column_name;
+    std::string out_col_name;
+    int64_t offset = 1;     // Offset of LAG/LEAD
+};
+
+/**
+ * Window operator.
+ *
+ * Input batches must be sorted by the partition columns, then by the order columns,
+ * ie the output of sort::Sort on partition_cols + order_cols. The window functions are
+ * evaluated in a single pass over every partition and appended as new columns to the rows.
+ *
+ * Rows are buffered only until their partition ends: Next() returns the rows of all the
+ * partitions completed by the batch, the rows of the last partition are returned once
+ * the next partition starts, or by Finish().
+ *
+ * Frames are the SQL default, from the start of the partition to the last peer of the row,
+ * ie the last row with the same order keys. Aggregates reuse the accumulators of agg_funcs.h,
+ * a partition is accumulated as a single group and summarized at the end of every peer group.
+ * Without order columns all the rows of a partition are peers.
+ * LAG/LEAD are NULL when the offset row is out of the partition.
+ */
+class Window {
+public:
+    Window(const std::vector<std::string>& partition_cols,
+           const std::vector<std::string>& order_cols,
+           const std::vector<WindowFuncDef>& funcs);
+
+    // Rows of the partitions completed by the batch with the window columns, nullptr if none was completed.
+    std::shared_ptr<arrow::RecordBatch> Next(const std::shared_ptr<arrow::RecordBatch>& batch);
+
+    // Rows of the last partition, a batch without rows if there were no rows at all,
+    // nullptr if no batch was received.
+    std::shared_ptr<arrow::RecordBatch> Finish();
+
+    // The window columns are allocated from the pool, must be called before Next().
+    void SetMemoryPool(const std::shared_ptr<common::QueryMemoryPool>& pool) {
+        this->memory.SetPool(pool);
+    }
+
+private:
+    const std::vector<std::string> partition_cols;
+    const std::vector<std::string> order_cols;
+    const std::vector<WindowFuncDef> funcs;
+
+    std::shared_ptr<arrow::Schema> schema = nullptr;
+    std::unique_ptr<sort::RowComparator> partition_comparator = nullptr;
+    std::unique_ptr<sort::RowComparator> peer_comparator = nullptr;
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> pending;   // Rows of the last, unfinished partition
+    bool has_output = false;
+    common::MemoryReservation memory;
+
+    void EnsureInit(const std::shared_ptr<arrow::Schema>& batch_schema);
+
+    // Whether the right row starts a new partition, given the left row is the row before it.
+    [[nodiscard]] bool IsNewPartition(const arrow::RecordBatch& left, int64_t left_idx,
+                                      const arrow::RecordBatch& right, int64_t right_idx) const;
+
+    // Evaluates the window functions over the batches, which hold complete partitions only.
+    std::shared_ptr<arrow::RecordBatch> Evaluate(const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches);
+
+    std::shared_ptr<arrow::Array> Rank(const WindowFuncDef& func,
+                                       const std::vector<uint8_t>& new_partition,
+                                       const std::vector<uint8_t>& new_peer) const;
+
+    std::shared_ptr<arrow::Array> Offset(const WindowFuncDef& func,
+                                         const arrow::RecordBatch& batch,
+                                         const std::vector<uint8_t>& new_partition) const;
+
+    std::shared_ptr<arrow::Array> Aggregate(const WindowFuncDef& func,
+                                            const arrow::RecordBatch& batch,
+                                            const std::vector<uint8_t>& new_partition,
+                                            const std::vector<uint8_t>& new_peer) const;
+};
+
+}  // namespace vinum::operators::window
@@ -1,6 +1,17 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <set>
+#include <thread>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
 #include <arrow/csv/api.h>
 #include <arrow/compute/api.h>
 #include <arrow/io/api.h>
@@ -10,10 +21,20 @@
 #include <arrow/testing/gtest_util.h>
 
 #include "operators/aggregate/base_aggregate.h"
+#include "operators/aggregate/composite_key_hash_aggregate.h"
+#include "operators/aggregate/dictionary_hash_aggregate.h"
 #include "operators/aggregate/generic_hash_aggregate.h"
 #include "operators/aggregate/single_numerical_hash_aggregate.h"
 #include "operators/aggregate/multi_numerical_hash_aggregate.h"
 #include "operators/aggregate/one_group_aggregate.h"
+#include "operators/aggregate/parallel_hash_aggregate.h"
+#include "operators/aggregate/spilling_hash_aggregate.h"
+#include "operators/filter/predicate.h"
+#include "operators/join/hash_join.h"
+#include "operators/pipeline.h"
+#include "operators/table_batch_reader.h"
+#include "operators/window/window.h"
+#include "common/memory_pool.h"
 #include "common/util.h"
 
 using AggFuncDef = vinum::operators::aggregate::AggFuncDef;
@@ -21,7 +42,13 @@ using AggFuncType = vinum::operators::aggregate::AggFuncType;
 using SingleNumericalHashAggregate = vinum::operators::aggregate::SingleNumericalHashAggregate;
 using MultiNumericalHashAggregate = vinum::operators::aggregate::MultiNumericalHashAggregate;
 using GenericHashAggregate = vinum::operators::aggregate::GenericHashAggregate;
+using CompositeKeyHashAggregate = vinum::operators::aggregate::CompositeKeyHashAggregate;
+using DictionaryHashAggregate = vinum::operators::aggregate::DictionaryHashAggregate;
 using OneGroupAggregate = vinum::operators::aggregate::OneGroupAggregate;
+template<typename AGG>
+using ParallelHashAggregate = vinum::operators::aggregate::ParallelHashAggregate<AGG>;
+template<typename AGG>
+using SpillingHashAggregate = vinum::operators::aggregate::SpillingHashAggregate<AGG>;
 
 struct AggTestDef {
     std::vector<std::string> groupby_cols;
@@ -132,6 +159,247 @@ std::shared_ptr<arrow::RecordBatch> aggregate_and_sort(vinum::operators::aggrega
     return sorted_batch;
 }
 
+std::shared_ptr<arrow::Table> create_synthetic_table(int64_t num_rows, int64_t num_keys) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> key_dist(0, num_keys - 1);
+    std::uniform_int_distribution<int32_t> int_dist(-1000, 1000);
+    std::uniform_real_distribution<double_t> double_dist(0, 100);
+    std::bernoulli_distribution null_dist(0.05);
+
+    arrow::Int64Builder key_builder;
+    arrow::Int64Builder second_key_builder;
+    arrow::Int64Builder zero_key_builder;
+    arrow::StringBuilder str_key_builder;
+    arrow::Int32Builder int_builder;
+    arrow::DoubleBuilder double_builder;
+    arrow::BooleanBuilder bool_builder;
+    for (int64_t row_idx = 0; row_idx < num_rows; row_idx++) {
+        auto key = key_dist(gen);
+        if (null_dist(gen)) {
+            RAISE_ON_ARROW_FAILURE(key_builder.AppendNull());
+        } else {
+            RAISE_ON_ARROW_FAILURE(key_builder.Append(key));
+        }
+        RAISE_ON_ARROW_FAILURE(second_key_builder.Append(key % 7));
+        RAISE_ON_ARROW_FAILURE(zero_key_builder.Append(0));
+        RAISE_ON_ARROW_FAILURE(str_key_builder.Append("key_" + std::to_string(key)));
+
+        if (null_dist(gen)) {
+            RAISE_ON_ARROW_FAILURE(int_builder.AppendNull());
+            RAISE_ON_ARROW_FAILURE(double_builder.AppendNull());
+            RAISE_ON_ARROW_FAILURE(bool_builder.AppendNull());
+        } else {
+            auto int_val = int_dist(gen);
+            RAISE_ON_ARROW_FAILURE(int_builder.Append(int_val));
+            RAISE_ON_ARROW_FAILURE(double_builder.Append(double_dist(gen)));
+            RAISE_ON_ARROW_FAILURE(bool_builder.Append(int_val > 0));
+        }
+    }
+
+    std::shared_ptr<arrow::Array> keys, second_keys, zero_keys, str_keys, ints, doubles, bools;
+    RAISE_ON_ARROW_FAILURE(key_builder.Finish(&keys));
+    RAISE_ON_ARROW_FAILURE(second_key_builder.Finish(&second_keys));
+    RAISE_ON_ARROW_FAILURE(zero_key_builder.Finish(&zero_keys));
+    RAISE_ON_ARROW_FAILURE(str_key_builder.Finish(&str_keys));
+    RAISE_ON_ARROW_FAILURE(int_builder.Finish(&ints));
+    RAISE_ON_ARROW_FAILURE(double_builder.Finish(&doubles));
+    RAISE_ON_ARROW_FAILURE(bool_builder.Finish(&bools));
+
+    std::vector<std::shared_ptr<arrow::Field>> schema_vector = {
+            arrow::field("key", arrow::int64()),
+            arrow::field("second_key", arrow::int64()),
+            arrow::field("zero_key", arrow::int64()),
+            arrow::field("str_key", arrow::utf8()),
+            arrow::field("int_val", arrow::int32()),
+            arrow::field("double_val", arrow::float64()),
+            arrow::field("bool_val", arrow::boolean()),
+    };
+    auto schema = std::make_shared<arrow::Schema>(schema_vector);
+    return arrow::Table::Make(schema, {keys, second_keys, zero_keys, str_keys, ints, doubles, bools});
+}
+
+std::vector<AggFuncDef> synthetic_agg_funcs() {
+    return {
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::COUNT, "int_val", "count_int"},
+            AggFuncDef{AggFuncType::MIN, "int_val", "min_int"},
+            AggFuncDef{AggFuncType::MAX, "double_val", "max_double"},
+            AggFuncDef{AggFuncType::MAX, "str_key", "max_str"},
+            AggFuncDef{AggFuncType::MIN, "bool_val", "min_bool"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+            AggFuncDef{AggFuncType::SUM, "double_val", "sum_double"},
+            AggFuncDef{AggFuncType::AVG, "int_val", "avg_int"},
+            AggFuncDef{AggFuncType::AVG, "double_val", "avg_double"},
+    };
+}
+
+// Integer and string aggregates only, so that the result does not depend on the order of merging.
+std::vector<AggFuncDef> order_independent_agg_funcs() {
+    return {
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::COUNT, "int_val", "count_int"},
+            AggFuncDef{AggFuncType::MIN, "int_val", "min_int"},
+            AggFuncDef{AggFuncType::MAX, "str_key", "max_str"},
+            AggFuncDef{AggFuncType::MIN, "bool_val", "min_bool"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+            AggFuncDef{AggFuncType::SUM, "key", "sum_key"},
+            AggFuncDef{AggFuncType::AVG, "int_val", "avg_int"},
+    };
+}
+
+/**
+ * Run the same aggregation with the row-at-a-time and the vectorized update paths,
+ * check that the results are identical and print the time taken by each path.
+ */
+template<typename AGG>
+void compare_row_and_vectorized(const std::vector<std::string>& groupby_cols,
+                                const std::shared_ptr<arrow::Table>& table,
+                                const initializer_list<int> sort_cols = {0}) {
+    AGG row_agg(groupby_cols, groupby_cols, synthetic_agg_funcs());
+    row_agg.SetVectorized(false);
+    AGG vectorized_agg(groupby_cols, groupby_cols, synthetic_agg_funcs());
+    vectorized_agg.SetVectorized(true);
+
+    auto start = std::chrono::steady_clock::now();
+    auto row_batch = aggregate_and_sort(row_agg, table, sort_cols);
+    auto row_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    auto vectorized_batch = aggregate_and_sort(vectorized_agg, table, sort_cols);
+    auto vectorized_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << "* Row path: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(row_time).count() << " ms"
+              << ", vectorized path: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(vectorized_time).count() << " ms"
+              << std::endl;
+
+    ASSERT_BATCHES_EQUAL(*row_batch, *vectorized_batch);
+}
+
+/**
+ * Feed the batches of the table to the parallel aggregate from num_threads threads
+ * and check that the result is identical to the serial one.
+ */
+template<typename AGG>
+void compare_serial_and_parallel(const std::vector<std::string>& groupby_cols,
+                                 const std::shared_ptr<arrow::Table>& table,
+                                 size_t num_threads,
+                                 const initializer_list<int> sort_cols = {0}) {
+    const auto agg_funcs = order_independent_agg_funcs();
+    AGG serial_agg(groupby_cols, groupby_cols, agg_funcs);
+    auto serial_batch = aggregate_and_sort(serial_agg, table, sort_cols);
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 14);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    ParallelHashAggregate<AGG> parallel_agg(groupby_cols, groupby_cols, agg_funcs, num_threads);
+    std::atomic<size_t> next_batch{0};
+    std::vector<std::thread> threads;
+    for (size_t thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+        threads.emplace_back([&]() {
+            size_t batch_idx;
+            while ((batch_idx = next_batch++) < batches.size()) {
+                parallel_agg.Next(batches[batch_idx]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::shared_ptr<arrow::RecordBatch> parallel_batch;
+    ASSERT_OK(sort_table(parallel_agg.Result(), parallel_batch, sort_cols));
+
+    ASSERT_BATCHES_EQUAL(*serial_batch, *parallel_batch);
+}
+
+
+/**
+ * Aggregate the table with a memory limit small enough to spill several times
+ * and check that the result is identical to the in-memory one.
+ * agg_cols is a subset of groupby_cols, so that the projection of the spilled keys is covered too.
+ */
+template<typename AGG>
+void compare_in_memory_and_spilling(const std::vector<std::string>& groupby_cols,
+                                    const std::vector<std::string>& agg_cols,
+                                    const std::shared_ptr<arrow::Table>& table,
+                                    size_t memory_limit,
+                                    const initializer_list<int> sort_cols = {0}) {
+    AGG in_memory_agg(groupby_cols, agg_cols, order_independent_agg_funcs());
+    auto in_memory_batch = aggregate_and_sort(in_memory_agg, table, sort_cols);
+
+    SpillingHashAggregate<AGG> spilling_agg(groupby_cols, agg_cols, order_independent_agg_funcs(),
+                                            memory_limit, ::testing::TempDir());
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 14);
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (reader.ReadNext(&batch).ok() && batch != nullptr) {
+        spilling_agg.Next(batch);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> spilling_batch;
+    ASSERT_OK(sort_table(spilling_agg.Result(), spilling_batch, sort_cols));
+
+    const auto& stats = spilling_agg.Stats();
+    std::cout << "* Spilled " << stats.bytes_spilled << " bytes in " << stats.num_spills
+              << " spills, " << stats.num_partitions << " partitions" << std::endl;
+    EXPECT_GT(stats.num_spills, 1);
+    EXPECT_GT(stats.bytes_spilled, 0);
+
+    ASSERT_BATCHES_EQUAL(*in_memory_batch, *spilling_batch);
+}
+
+/**
+ * Concatenate the batches returned by NextResult(), checking that none of them exceeds batch_size groups.
+ */
+template<typename AGG>
+std::shared_ptr<arrow::RecordBatch> stream_results(AGG& agg, int64_t batch_size, size_t& num_batches) {
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while ((batch = agg.NextResult(batch_size)) != nullptr) {
+        EXPECT_LE(batch->num_rows(), batch_size);
+        batches.push_back(batch);
+    }
+    EXPECT_EQ(agg.NextResult(batch_size), nullptr);
+    num_batches = batches.size();
+    return vinum::operators::aggregate::concatenate_batches(batches);
+}
+
+/**
+ * Feed the batches of the table to the aggregate and check that the streamed result
+ * is identical to the one returned at once by Result().
+ */
+template<typename AGG, typename... ARGS>
+void compare_result_and_streamed(const std::vector<std::string>& groupby_cols,
+                                 const std::shared_ptr<arrow::Table>& table,
+                                 int64_t batch_size,
+                                 const initializer_list<int> sort_cols,
+                                 ARGS... args) {
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 14);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    AGG agg(groupby_cols, groupby_cols, order_independent_agg_funcs(), args...);
+    AGG streamed_agg(groupby_cols, groupby_cols, order_independent_agg_funcs(), args...);
+    for (const auto& batch : batches) {
+        agg.Next(batch);
+        streamed_agg.Next(batch);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    ASSERT_OK(sort_table(agg.Result(), result_batch, sort_cols));
+
+    size_t num_batches;
+    std::shared_ptr<arrow::RecordBatch> streamed_batch;
+    ASSERT_OK(sort_table(stream_results(streamed_agg, batch_size, num_batches), streamed_batch, sort_cols));
+
+    EXPECT_GE(num_batches, result_batch->num_rows() / batch_size);
+    ASSERT_BATCHES_EQUAL(*result_batch, *streamed_batch);
+}
 
 class HashAggTestFixture : public ::testing::Test {
 protected:
@@ -823,6 +1091,16 @@ TEST_F(HashAggTestFixture, Generic_StringGrp_DoubleArgFuncs) {
     ASSERT_BATCHES_EQUAL(*test_def.result_batch, *sorted_batch);
 }
 
+TEST_F(HashAggTestFixture, Composite_StringGrp_DoubleArgFuncs) {
+    auto test_def = this->string_grp__double_arg_funcs;
+    CompositeKeyHashAggregate agg(test_def.groupby_cols,
+                                  test_def.agg_cols, test_def.agg_funcs);
+
+    auto sorted_batch = aggregate_and_sort(agg, test_table);
+
+    ASSERT_BATCHES_EQUAL(*test_def.result_batch, *sorted_batch);
+}
+
 TEST_F(HashAggTestFixture, Single_DoubleGrp_IntArgFuncs) {
     auto test_def = this->double_grp__int_arg_funcs;
     SingleNumericalHashAggregate agg(test_def.groupby_cols,
@@ -943,6 +1221,26 @@ TEST_F(HashAggTestFixture, Generic_MultiIntGrp_DateArgFuncs) {
     ASSERT_BATCHES_EQUAL(*test_def.result_batch, *sorted_batch);
 }
 
+TEST_F(HashAggTestFixture, Composite_MultiIntGrp_DateArgFuncs) {
+    auto test_def = this->multi_int_grp__date_arg_funcs;
+    CompositeKeyHashAggregate agg(test_def.groupby_cols,
+                                  test_def.agg_cols, test_def.agg_funcs);
+
+    auto sorted_batch = aggregate_and_sort(agg, test_table, {0, 1, 2, 3});
+
+    ASSERT_BATCHES_EQUAL(*test_def.result_batch, *sorted_batch);
+}
+
+TEST_F(HashAggTestFixture, Composite_BooleanGrp_DateArgFuncs) {
+    auto test_def = this->boolean_grp__date_arg_funcs;
+    CompositeKeyHashAggregate agg(test_def.groupby_cols,
+                                  test_def.agg_cols, test_def.agg_funcs);
+
+    auto sorted_batch = aggregate_and_sort(agg, test_table, {1});
+
+    ASSERT_BATCHES_EQUAL(*test_def.result_batch, *sorted_batch);
+}
+
 TEST_F(HashAggTestFixture, BooleanGrp_DateArgFuncs) {
     auto test_def = this->boolean_grp__date_arg_funcs;
     GenericHashAggregate agg(test_def.groupby_cols,
@@ -1002,6 +1300,1005 @@ TEST_F(HashAggTestFixture, EmptyTable_AggFuncs) {
     ASSERT_BATCHES_EQUAL(*test_def.result_batch, *res_batch);
 }
 
+TEST(VectorizedHashAggTest, Single_Int64Grp) {
+    auto table = create_synthetic_table(1 << 20, 10000);
+    compare_row_and_vectorized<SingleNumericalHashAggregate>({"key"}, table);
+}
+
+TEST(VectorizedHashAggTest, Single_Int32Grp) {
+    auto table = create_synthetic_table(1 << 18, 10000);
+    compare_row_and_vectorized<SingleNumericalHashAggregate>({"int_val"}, table);
+}
+
+TEST(VectorizedHashAggTest, Single_DoubleGrp) {
+    auto table = create_synthetic_table(1 << 18, 10000);
+    compare_row_and_vectorized<SingleNumericalHashAggregate>({"double_val"}, table);
+}
+
+TEST(VectorizedHashAggTest, Multi_Int64Grp) {
+    auto table = create_synthetic_table(1 << 20, 10000);
+    compare_row_and_vectorized<MultiNumericalHashAggregate>({"key", "second_key"}, table, {0, 1});
+}
+
+TEST(VectorizedHashAggTest, Generic_StringGrp) {
+    auto table = create_synthetic_table(1 << 18, 1000);
+    compare_row_and_vectorized<GenericHashAggregate>({"str_key"}, table);
+}
+
+TEST(VectorizedHashAggTest, NoGrp_ReduceKernels) {
+    // Integer aggregates only, so that the result does not depend on the order of summation.
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::COUNT, "key", "count_key"},
+            AggFuncDef{AggFuncType::MIN, "int_val", "min_int"},
+            AggFuncDef{AggFuncType::MAX, "key", "max_key"},
+            AggFuncDef{AggFuncType::MAX, "double_val", "max_double"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+            AggFuncDef{AggFuncType::SUM, "key", "sum_key"},
+            AggFuncDef{AggFuncType::AVG, "int_val", "avg_int"},
+            AggFuncDef{AggFuncType::AVG, "key", "avg_key"},
+    });
+    // Odd number of rows, so that the batches are not aligned to the SIMD blocks.
+    auto table = create_synthetic_table((1 << 20) + 37, 1 << 30);
+
+    OneGroupAggregate one_group_agg(agg_funcs);
+    SingleNumericalHashAggregate hash_agg({"zero_key"}, {}, agg_funcs);
+    hash_agg.SetVectorized(false);
+
+    auto one_group_batch = aggregate_and_sort(one_group_agg, table);
+    auto hash_batch = aggregate_and_sort(hash_agg, table);
+
+    ASSERT_BATCHES_EQUAL(*hash_batch, *one_group_batch);
+}
+
+TEST(CompositeKeyHashAggTest, MixedGrp) {
+    auto table = create_synthetic_table(1 << 18, 1000);
+    const std::vector<std::string> groupby_cols({"str_key", "second_key", "bool_val"});
+
+    GenericHashAggregate generic_agg(groupby_cols, groupby_cols, synthetic_agg_funcs());
+    CompositeKeyHashAggregate composite_agg(groupby_cols, groupby_cols, synthetic_agg_funcs());
+
+    auto start = std::chrono::steady_clock::now();
+    auto generic_batch = aggregate_and_sort(generic_agg, table, {0, 1, 2});
+    auto generic_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    auto composite_batch = aggregate_and_sort(composite_agg, table, {0, 1, 2});
+    auto composite_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << "* Generic: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(generic_time).count() << " ms"
+              << ", composite key: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(composite_time).count() << " ms"
+              << std::endl;
+
+    ASSERT_BATCHES_EQUAL(*generic_batch, *composite_batch);
+}
+
+/**
+ * Dictionary encode the column, each half of the table gets its own dictionary.
+ */
+std::shared_ptr<arrow::Table> dictionary_encode_column(const std::shared_ptr<arrow::Table>& table,
+                                                       const std::string& col_name) {
+    const int col_idx = table->schema()->GetFieldIndex(col_name);
+    const int64_t mid = table->num_rows() >> 1;
+    const auto column = table->column(col_idx);
+
+    arrow::ArrayVector chunks;
+    for (const auto& slice : {column->Slice(0, mid), column->Slice(mid)}) {
+        auto encoded = arrow::compute::DictionaryEncode(slice).ValueOrDie().chunked_array();
+        chunks.insert(chunks.end(), encoded->chunks().begin(), encoded->chunks().end());
+    }
+    auto encoded_column = std::make_shared<arrow::ChunkedArray>(chunks);
+    return table->SetColumn(col_idx, arrow::field(col_name, encoded_column->type()), encoded_column).ValueOrDie();
+}
+
+TEST(DictionaryHashAggTest, StringGrp) {
+    auto table = create_synthetic_table(1 << 18, 1000);
+    auto dict_table = dictionary_encode_column(table, "str_key");
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::COUNT, "int_val", "count_int"},
+            AggFuncDef{AggFuncType::MIN, "int_val", "min_int"},
+            AggFuncDef{AggFuncType::MAX, "double_val", "max_double"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+            AggFuncDef{AggFuncType::AVG, "double_val", "avg_double"},
+    });
+
+    GenericHashAggregate generic_agg({"str_key"}, {"str_key"}, agg_funcs);
+    DictionaryHashAggregate dict_agg({"str_key"}, {"str_key"}, agg_funcs);
+
+    auto start = std::chrono::steady_clock::now();
+    auto generic_batch = aggregate_and_sort(generic_agg, table);
+    auto generic_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    auto dict_batch = aggregate_and_sort(dict_agg, dict_table);
+    auto dict_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << "* Generic: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(generic_time).count() << " ms"
+              << ", dictionary: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(dict_time).count() << " ms"
+              << std::endl;
+
+    ASSERT_BATCHES_EQUAL(*generic_batch, *dict_batch);
+}
+
+TEST(DictionaryHashAggTest, DictionaryPerBatch) {
+    auto slice = create_synthetic_table(1 << 12, 1000);
+    const int col_idx = slice->schema()->GetFieldIndex("str_key");
+    auto shared_dict = arrow::compute::DictionaryEncode(slice->column(col_idx)).ValueOrDie().chunked_array();
+
+    // Every batch has its own equal dictionary, as read from a stream, or all the batches share one.
+    std::vector<std::shared_ptr<arrow::Table>> own_dict_slices, shared_dict_slices;
+    for (int idx = 0; idx < 64; idx++) {
+        auto own_dict = arrow::compute::DictionaryEncode(slice->column(col_idx)).ValueOrDie().chunked_array();
+        own_dict_slices.push_back(
+                slice->SetColumn(col_idx, arrow::field("str_key", own_dict->type()), own_dict).ValueOrDie());
+        shared_dict_slices.push_back(
+                slice->SetColumn(col_idx, arrow::field("str_key", shared_dict->type()), shared_dict).ValueOrDie());
+    }
+    auto own_dict_table = arrow::ConcatenateTables(own_dict_slices).ValueOrDie();
+    auto shared_dict_table = arrow::ConcatenateTables(shared_dict_slices).ValueOrDie();
+
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+    });
+    DictionaryHashAggregate own_dict_agg({"str_key"}, {"str_key"}, agg_funcs);
+    DictionaryHashAggregate shared_dict_agg({"str_key"}, {"str_key"}, agg_funcs);
+    for (auto [agg, table] : {std::make_pair(&own_dict_agg, own_dict_table),
+                              std::make_pair(&shared_dict_agg, shared_dict_table)}) {
+        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+        auto reader = arrow::TableBatchReader(*table);
+        RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+        for (const auto& batch : batches) {
+            agg->Next(batch);
+        }
+    }
+
+    // Equal dictionaries are kept once.
+    EXPECT_EQ(own_dict_agg.MemoryUsage(), shared_dict_agg.MemoryUsage());
+
+    std::shared_ptr<arrow::RecordBatch> own_dict_batch, shared_dict_batch;
+    ASSERT_OK(sort_table(own_dict_agg.Result(), own_dict_batch, {0}));
+    ASSERT_OK(sort_table(shared_dict_agg.Result(), shared_dict_batch, {0}));
+    ASSERT_BATCHES_EQUAL(*shared_dict_batch, *own_dict_batch);
+
+    compare_result_and_streamed<DictionaryHashAggregate>({"str_key"}, own_dict_table, 100, {0});
+}
+
+TEST(DictionaryHashAggTest, Parallel_StringGrp) {
+    auto table = dictionary_encode_column(create_synthetic_table(1 << 18, 1000), "str_key");
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+    });
+    DictionaryHashAggregate serial_agg({"str_key"}, {"str_key"}, agg_funcs);
+    auto serial_batch = aggregate_and_sort(serial_agg, table);
+
+    ParallelHashAggregate<DictionaryHashAggregate> parallel_agg({"str_key"}, {"str_key"}, agg_funcs, 2);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+    std::vector<std::thread> threads;
+    for (const auto& batch : batches) {
+        threads.emplace_back([&parallel_agg, batch]() { parallel_agg.Next(batch); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::shared_ptr<arrow::RecordBatch> parallel_batch;
+    ASSERT_OK(sort_table(parallel_agg.Result(), parallel_batch, {0}));
+
+    ASSERT_BATCHES_EQUAL(*serial_batch, *parallel_batch);
+}
+
+/**
+ * Small key range goes through the direct indexed groups of SingleNumericalHashAggregate,
+ * MultiNumericalHashAggregate always hashes the keys.
+ */
+TEST(DirectIndexHashAggTest, Single_SmallRangeGrp) {
+    auto table = create_synthetic_table(1 << 18, 1000);
+    SingleNumericalHashAggregate single_agg({"key"}, {"key"}, synthetic_agg_funcs());
+    MultiNumericalHashAggregate multi_agg({"key"}, {"key"}, synthetic_agg_funcs());
+
+    ASSERT_BATCHES_EQUAL(*aggregate_and_sort(multi_agg, table), *aggregate_and_sort(single_agg, table));
+}
+
+// The first batch fits the direct window, the second one does not.
+TEST(DirectIndexHashAggTest, Single_GrowingRangeGrp) {
+    auto table = arrow::ConcatenateTables({create_synthetic_table(1 << 16, 1000),
+                                           create_synthetic_table(1 << 16, 100000)}).ValueOrDie();
+    SingleNumericalHashAggregate single_agg({"key"}, {"key"}, synthetic_agg_funcs());
+    MultiNumericalHashAggregate multi_agg({"key"}, {"key"}, synthetic_agg_funcs());
+
+    ASSERT_BATCHES_EQUAL(*aggregate_and_sort(multi_agg, table), *aggregate_and_sort(single_agg, table));
+}
+
+TEST(SpillingHashAggTest, Single_Int64Grp) {
+    auto table = create_synthetic_table(1 << 18, 100000);
+    compare_in_memory_and_spilling<SingleNumericalHashAggregate>({"key"}, {"key"}, table, 1 << 20);
+}
+
+TEST(SpillingHashAggTest, Multi_Int64Grp_ProjectedKeys) {
+    auto table = create_synthetic_table(1 << 18, 100000);
+    compare_in_memory_and_spilling<MultiNumericalHashAggregate>(
+            {"zero_key", "key"}, {"key"}, table, 1 << 20);
+}
+
+TEST(SpillingHashAggTest, Composite_MixedGrp) {
+    auto table = create_synthetic_table(1 << 18, 100000);
+    compare_in_memory_and_spilling<CompositeKeyHashAggregate>(
+            {"str_key", "bool_val"}, {"str_key", "bool_val"}, table, 1 << 20, {0, 1});
+}
+
+TEST(SpillingHashAggTest, Dictionary_StringGrp) {
+    auto table = dictionary_encode_column(create_synthetic_table(1 << 18, 100000), "str_key");
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"},
+            AggFuncDef{AggFuncType::SUM, "int_val", "sum_int"},
+            AggFuncDef{AggFuncType::AVG, "int_val", "avg_int"},
+    });
+    DictionaryHashAggregate in_memory_agg({"str_key"}, {"str_key"}, agg_funcs);
+    auto in_memory_batch = aggregate_and_sort(in_memory_agg, table);
+
+    SpillingHashAggregate<DictionaryHashAggregate> spilling_agg({"str_key"}, {"str_key"}, agg_funcs,
+                                                                1 << 16, ::testing::TempDir());
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 14);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+    for (const auto& batch : batches) {
+        spilling_agg.Next(batch);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> spilling_batch;
+    ASSERT_OK(sort_table(spilling_agg.Result(), spilling_batch, {0}));
+
+    EXPECT_GT(spilling_agg.Stats().num_spills, 1);
+    ASSERT_BATCHES_EQUAL(*in_memory_batch, *spilling_batch);
+}
+
+TEST(SpillingHashAggTest, Single_Int64Grp_NoSpill) {
+    auto table = create_synthetic_table(1 << 16, 100);
+    SingleNumericalHashAggregate in_memory_agg({"key"}, {"key"}, order_independent_agg_funcs());
+    SpillingHashAggregate<SingleNumericalHashAggregate> spilling_agg({"key"}, {"key"}, order_independent_agg_funcs(),
+                                                                     1 << 30, ::testing::TempDir());
+    auto in_memory_batch = aggregate_and_sort(in_memory_agg, table);
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+    for (const auto& batch : batches) {
+        spilling_agg.Next(batch);
+    }
+    std::shared_ptr<arrow::RecordBatch> spilling_batch;
+    ASSERT_OK(sort_table(spilling_agg.Result(), spilling_batch, {0}));
+
+    EXPECT_EQ(spilling_agg.Stats().num_spills, 0);
+    ASSERT_BATCHES_EQUAL(*in_memory_batch, *spilling_batch);
+}
+
+TEST(ParallelHashAggTest, Composite_MixedGrp) {
+    auto table = create_synthetic_table(1 << 18, 1000);
+    compare_serial_and_parallel<CompositeKeyHashAggregate>({"str_key", "key"}, table, 4, {0, 1});
+}
+
+TEST(ParallelHashAggTest, Single_Int64Grp) {
+    auto table = create_synthetic_table(1 << 20, 100000);
+    compare_serial_and_parallel<SingleNumericalHashAggregate>({"key"}, table, 4);
+}
+
+TEST(ParallelHashAggTest, Multi_Int64Grp) {
+    auto table = create_synthetic_table(1 << 20, 10000);
+    compare_serial_and_parallel<MultiNumericalHashAggregate>({"key", "second_key"}, table, 4, {0, 1});
+}
+
+TEST(ParallelHashAggTest, Generic_StringGrp) {
+    auto table = create_synthetic_table(1 << 18, 1000);
+    compare_serial_and_parallel<GenericHashAggregate>({"str_key"}, table, 3);
+}
+
+TEST(ParallelHashAggTest, Single_Int64Grp_OneThread) {
+    auto table = create_synthetic_table(1 << 16, 100);
+    compare_serial_and_parallel<SingleNumericalHashAggregate>({"key"}, table, 1);
+}
+
+
+/**
+ * Microbenchmark of the hash probes of SingleNumericalHashAggregate,
+ * run with --gtest_also_run_disabled_tests --gtest_filter='HashProbeBenchmark.*'.
+ * Keys are spread over the whole int64 range, so that the direct indexed window is not used.
+ */
+TEST(HashProbeBenchmark, DISABLED_Single_Int64Grp) {
+    for (int64_t num_keys : {int64_t{1000}, int64_t{1000000}, int64_t{50000000}}) {
+        const int64_t num_rows = std::max<int64_t>(num_keys, 1 << 23);
+        std::mt19937_64 gen(42);
+        std::uniform_int_distribution<uint64_t> key_dist(0, num_keys - 1);
+
+        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+        const auto schema = arrow::schema({arrow::field("key", arrow::int64())});
+        for (int64_t batch_begin = 0; batch_begin < num_rows; batch_begin += 1 << 16) {
+            arrow::Int64Builder key_builder;
+            const int64_t batch_rows = std::min<int64_t>(1 << 16, num_rows - batch_begin);
+            RAISE_ON_ARROW_FAILURE(key_builder.Reserve(batch_rows));
+            for (int64_t row_idx = 0; row_idx < batch_rows; row_idx++) {
+                key_builder.UnsafeAppend(static_cast<int64_t>(key_dist(gen) * 0x9E3779B97F4A7C15ULL));
+            }
+            std::shared_ptr<arrow::Array> keys;
+            RAISE_ON_ARROW_FAILURE(key_builder.Finish(&keys));
+            batches.push_back(arrow::RecordBatch::Make(schema, batch_rows, {keys}));
+        }
+
+        SingleNumericalHashAggregate agg({"key"}, {"key"}, {AggFuncDef{AggFuncType::COUNT_STAR, "", "count_star"}});
+        const auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__) || defined(_M_X64)
+        const auto start_cycles = __rdtsc();
+#endif
+        for (const auto& batch : batches) {
+            agg.Next(batch);
+        }
+#if defined(__x86_64__) || defined(_M_X64)
+        const auto cycles = __rdtsc() - start_cycles;
+#endif
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "* " << num_keys << " keys, " << num_rows << " rows: "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / static_cast<double>(num_rows)
+                  << " ns/row";
+#if defined(__x86_64__) || defined(_M_X64)
+        std::cout << ", " << cycles / static_cast<double>(num_rows) << " cycles/row";
+#endif
+        std::cout << std::endl;
+    }
+}
+
+TEST(StringStateColumnTest, SetAndCompact) {
+    vinum::operators::aggregate::StringStateColumn states;
+    states.Append("abc");
+    states.AppendNull();
+    states.Resize(3);
+    states.Set(2, "de");
+
+    // Shorter values reuse the space of the previous value, longer ones are appended.
+    states.Set(0, "x");
+    states.Set(1, "longer value");
+    EXPECT_EQ(states[0], "x");
+    EXPECT_EQ(states[1], "longer value");
+    EXPECT_EQ(states[2], "de");
+    EXPECT_EQ(states.DataLength(0, 3), 15);
+
+    // Enough replaced values to compact the buffer several times.
+    const std::string long_value(1 << 12, 'z');
+    for (int idx = 0; idx < 2048; idx++) {
+        states.Set(idx % 2, long_value + std::to_string(idx));
+    }
+    EXPECT_EQ(states[0], long_value + "2046");
+    EXPECT_EQ(states[1], long_value + "2047");
+    EXPECT_EQ(states[2], "de");
+    EXPECT_LT(states.MemoryUsage(), 1 << 23);
+}
+
+TEST(StreamingResultTest, Single_Int64Grp) {
+    auto table = create_synthetic_table(1 << 16, 10000);
+    compare_result_and_streamed<SingleNumericalHashAggregate>({"key"}, table, 1000, {0});
+}
+
+TEST(StreamingResultTest, Composite_MixedGrp) {
+    auto table = create_synthetic_table(1 << 16, 1000);
+    compare_result_and_streamed<CompositeKeyHashAggregate>({"str_key", "bool_val"}, table, 100, {0, 1});
+}
+
+TEST(StreamingResultTest, Parallel_Generic_StringGrp) {
+    auto table = create_synthetic_table(1 << 16, 1000);
+    compare_result_and_streamed<ParallelHashAggregate<GenericHashAggregate>>({"str_key"}, table, 64, {0}, 4);
+}
+
+TEST(StreamingResultTest, Spilling_Single_Int64Grp) {
+    auto table = create_synthetic_table(1 << 18, 100000);
+    compare_result_and_streamed<SpillingHashAggregate<SingleNumericalHashAggregate>>(
+            {"key"}, table, 4096, {0}, 1 << 20, ::testing::TempDir());
+}
+
+TEST(StreamingResultTest, NoGroups) {
+    auto table = create_synthetic_table(1 << 10, 100)->Slice(0, 0);
+    SingleNumericalHashAggregate agg({"key"}, {"key"}, order_independent_agg_funcs());
+    auto reader = arrow::TableBatchReader(*table);
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (reader.ReadNext(&batch).ok() && batch != nullptr) {
+        agg.Next(batch);
+    }
+
+    auto result = agg.NextResult(16);
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->num_rows(), 0);
+    EXPECT_EQ(agg.NextResult(16), nullptr);
+}
+
+TEST(HashJoinTest, StringAndIntKeys) {
+    auto build_schema = arrow::schema({arrow::field("name", arrow::utf8()),
+                                       arrow::field("id", arrow::int64()),
+                                       arrow::field("val", arrow::int64())});
+    auto build_table = arrow::Table::Make(build_schema, {
+            create_flat_array<std::string, arrow::StringBuilder>({"a", "b", "a", "c"}, {1, 1, 1, 1}),
+            create_array<int64_t, arrow::Int64Builder>({1, 2, 1, 0}, {true, true, true, false}),
+            create_array<int64_t, arrow::Int64Builder>({10, 20, 30, 40}, {true, true, true, true}),
+    });
+    auto probe_schema = arrow::schema({arrow::field("key", arrow::int64()),
+                                       arrow::field("str", arrow::utf8())});
+    auto probe_batch = arrow::RecordBatch::Make(probe_schema, 4, {
+            create_array<int64_t, arrow::Int64Builder>({1, 2, 0, 3}, {true, true, false, true}),
+            create_flat_array<std::string, arrow::StringBuilder>({"a", "a", "c", "c"}, {1, 1, 1, 1}),
+    });
+
+    vinum::operators::join::HashJoin inner_join({"str", "key"}, {"name", "id"},
+                                                vinum::operators::join::JoinType::INNER);
+    inner_join.Build(build_table);
+    auto inner_batch = inner_join.Next(probe_batch);
+    ASSERT_EQ(inner_batch->num_columns(), 5);
+    auto expected_inner_vals = create_array<int64_t, arrow::Int64Builder>({10, 30}, {true, true});
+    ASSERT_ARRAYS_EQUAL(*inner_batch->column(4), *expected_inner_vals);
+
+    vinum::operators::join::HashJoin left_join({"str", "key"}, {"name", "id"},
+                                               vinum::operators::join::JoinType::LEFT);
+    left_join.Build(build_table);
+    auto left_batch = left_join.Next(probe_batch);
+    // Rows with a NULL or missing key are kept with NULL build columns.
+    auto expected_left_keys = create_array<int64_t, arrow::Int64Builder>({1, 1, 2, 0, 3},
+                                                                         {true, true, true, false, true});
+    auto expected_left_vals = create_array<int64_t, arrow::Int64Builder>({10, 30, 0, 0, 0},
+                                                                         {true, true, false, false, false});
+    ASSERT_ARRAYS_EQUAL(*left_batch->column(0), *expected_left_keys);
+    ASSERT_ARRAYS_EQUAL(*left_batch->column(4), *expected_left_vals);
+
+    vinum::operators::join::HashJoin mismatched_join({"key"}, {"name"}, vinum::operators::join::JoinType::INNER);
+    mismatched_join.Build(build_table);
+    EXPECT_THROW(mismatched_join.Next(probe_batch), std::runtime_error);
+}
+
+TEST(HashJoinTest, SingleIntKey) {
+    auto build_schema = arrow::schema({arrow::field("id", arrow::int32()),
+                                       arrow::field("val", arrow::int64())});
+    auto build_table = arrow::Table::Make(build_schema, {
+            create_array<int32_t, arrow::Int32Builder>({1, -2, 1, 0}, {true, true, true, false}),
+            create_array<int64_t, arrow::Int64Builder>({10, 20, 30, 40}, {true, true, true, true}),
+    });
+    auto probe_schema = arrow::schema({arrow::field("key", arrow::int32())});
+    auto probe_batch = arrow::RecordBatch::Make(probe_schema, 4, {
+            create_array<int32_t, arrow::Int32Builder>({1, -2, 0, 3}, {true, true, false, true}),
+    });
+
+    vinum::operators::join::HashJoin inner_join({"key"}, {"id"}, vinum::operators::join::JoinType::INNER);
+    inner_join.Build(build_table);
+    auto inner_batch = inner_join.Next(probe_batch);
+    auto expected_inner_vals = create_array<int64_t, arrow::Int64Builder>({10, 30, 20}, {true, true, true});
+    ASSERT_ARRAYS_EQUAL(*inner_batch->column(2), *expected_inner_vals);
+
+    vinum::operators::join::HashJoin left_join({"key"}, {"id"}, vinum::operators::join::JoinType::LEFT);
+    left_join.Build(build_table);
+    auto left_batch = left_join.Next(probe_batch);
+    auto expected_left_keys = create_array<int32_t, arrow::Int32Builder>({1, 1, -2, 0, 3},
+                                                                         {true, true, true, false, true});
+    auto expected_left_vals = create_array<int64_t, arrow::Int64Builder>({10, 30, 20, 0, 0},
+                                                                         {true, true, true, false, false});
+    ASSERT_ARRAYS_EQUAL(*left_batch->column(0), *expected_left_keys);
+    ASSERT_ARRAYS_EQUAL(*left_batch->column(2), *expected_left_vals);
+}
+
+TEST(PredicateTest, ThreeValuedLogic) {
+    using vinum::operators::filter::CompareOp;
+    using vinum::operators::filter::Predicate;
+    using vinum::operators::filter::SelectionVector;
+
+    auto schema = arrow::schema({arrow::field("a", arrow::int32()),
+                                 arrow::field("b", arrow::float64()),
+                                 arrow::field("s", arrow::utf8())});
+    auto batch = arrow::RecordBatch::Make(schema, 6, {
+            create_array<int32_t, arrow::Int32Builder>({1, 5, 7, 3, 10, 2}, {true, true, true, false, true, true}),
+            create_array<double, arrow::DoubleBuilder>({0.5, 2.5, 1.0, 9.0, 3.0, 8.0},
+                                                       {true, false, true, true, true, true}),
+            create_flat_array<std::string, arrow::StringBuilder>({"x", "y", "x", "x", "", "z"}, {1, 1, 1, 1, 0, 1}),
+    });
+
+    // NOT (a > 2 AND s = 'x'): rows with a NULL conjunct and no FALSE one are not selected.
+    Predicate not_and;
+    const int a_greater = not_and.Compare(CompareOp::LESS, not_and.IntLiteral(2), not_and.Column("a"));
+    const int s_equals = not_and.Compare(CompareOp::EQUALS, not_and.Column("s"), not_and.StringLiteral("x"));
+    not_and.Not(not_and.And({a_greater, s_equals}));
+    ASSERT_TRUE(not_and.Bind(*schema));
+    EXPECT_EQ(not_and.Select(*batch), SelectionVector({0, 1, 5}));
+
+    // NOT (a = 1 OR b > 2.9)
+    Predicate not_or;
+    const int a_equals = not_or.Compare(CompareOp::EQUALS, not_or.Column("a"), not_or.IntLiteral(1));
+    const int b_greater = not_or.Compare(CompareOp::GREATER, not_or.Column("b"), not_or.DoubleLiteral(2.9));
+    not_or.Not(not_or.Or({a_equals, b_greater}));
+    ASSERT_TRUE(not_or.Bind(*schema));
+    EXPECT_EQ(not_or.Select(*batch), SelectionVector({2}));
+
+    Predicate columns;
+    columns.Or({columns.Compare(CompareOp::LESS, columns.Column("a"), columns.Column("b")),
+                columns.IsNull(columns.Column("s"))});
+    ASSERT_TRUE(columns.Bind(*schema));
+    EXPECT_EQ(columns.Select(*batch), SelectionVector({4, 5}));
+    EXPECT_EQ(columns.Filter(batch)->num_rows(), 2);
+
+    Predicate unsupported;
+    unsupported.Compare(CompareOp::EQUALS, unsupported.Column("s"), unsupported.IntLiteral(1));
+    EXPECT_FALSE(unsupported.Bind(*schema));
+}
+
+TEST(SelectionTest, AggregateSelectedRows) {
+    using vinum::operators::filter::SelectionToArray;
+    using vinum::operators::filter::SelectionVector;
+
+    auto table = create_synthetic_table(1 << 12, 100);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 10);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    CompositeKeyHashAggregate agg({"str_key"}, {"str_key"}, order_independent_agg_funcs());
+    CompositeKeyHashAggregate selected_agg({"str_key"}, {"str_key"}, order_independent_agg_funcs());
+    for (const auto& batch : batches) {
+        SelectionVector selection;
+        for (uint32_t row_idx = 0; row_idx < batch->num_rows(); row_idx += 3) {
+            selection.push_back(row_idx);
+        }
+        const auto selection_array = SelectionToArray(selection);
+        auto taken = arrow::compute::Take(arrow::Datum(batch), arrow::Datum(selection_array));
+        agg.Next(taken.ValueOrDie().record_batch());
+        selected_agg.Next(batch, selection_array);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> result_batch, selected_batch;
+    ASSERT_OK(sort_table(agg.Result(), result_batch, {0}));
+    ASSERT_OK(sort_table(selected_agg.Result(), selected_batch, {0}));
+    ASSERT_BATCHES_EQUAL(*result_batch, *selected_batch);
+}
+
+TEST(PipelineTest, FilteredParallelAggregate) {
+    using vinum::operators::filter::CompareOp;
+    using vinum::operators::filter::Predicate;
+
+    auto table = create_synthetic_table(1 << 16, 1000);
+    Predicate predicate;
+    predicate.Compare(CompareOp::GREATER, predicate.Column("int_val"), predicate.IntLiteral(0));
+    ASSERT_TRUE(predicate.Bind(*table->schema()));
+
+    SingleNumericalHashAggregate agg({"key"}, {"key"}, order_independent_agg_funcs());
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 12);
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (reader.ReadNext(&batch).ok() && batch != nullptr) {
+        agg.Next(predicate.Filter(batch));
+    }
+
+    ParallelHashAggregate<SingleNumericalHashAggregate> pipeline_agg(
+            {"key"}, {"key"}, order_independent_agg_funcs(), 4);
+    vinum::operators::ParallelTableBatchReader pipeline_reader(table, 1 << 12, 4);
+    vinum::operators::Pipeline pipeline(pipeline_reader, {"key", "str_key", "int_val", "bool_val"}, &predicate);
+    EXPECT_EQ(pipeline.Run(pipeline_agg, 4), 16);
+
+    std::shared_ptr<arrow::RecordBatch> result_batch, pipeline_batch;
+    ASSERT_OK(sort_table(agg.Result(), result_batch, {0}));
+    ASSERT_OK(sort_table(pipeline_agg.Result(), pipeline_batch, {0}));
+    ASSERT_BATCHES_EQUAL(*result_batch, *pipeline_batch);
+}
+
+TEST(ParallelTableBatchReaderTest, ChunkAlignedMorsels) {
+    auto constant_array = [](int64_t length, int64_t value) {
+        arrow::Int64Builder builder;
+        RAISE_ON_ARROW_FAILURE(builder.AppendValues(std::vector<int64_t>(length, value)));
+        std::shared_ptr<arrow::Array> array;
+        RAISE_ON_ARROW_FAILURE(builder.Finish(&array));
+        return array;
+    };
+    // Columns with different chunk boundaries: rows [0, 10), [10, 25) and [0, 7), [7, 7), [7, 25).
+    auto first_column = std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+            constant_array(10, 1), constant_array(15, 2)});
+    auto second_column = std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+            constant_array(7, 3), constant_array(0, 0), constant_array(18, 4)});
+    auto table = arrow::Table::Make(arrow::schema({arrow::field("a", arrow::int64()),
+                                                   arrow::field("b", arrow::int64())}),
+                                    {first_column, second_column});
+
+    // Morsels of at most 4 rows of [0, 7), [7, 10) and [10, 25).
+    vinum::operators::ParallelTableBatchReader reader(table, 4, 3);
+    EXPECT_EQ(reader.NumMorsels(), 2 + 1 + 4);
+
+    std::atomic<int64_t> num_rows {0};
+    std::atomic<int64_t> sum {0};
+    std::vector<std::thread> workers;
+    for (size_t worker_idx = 0; worker_idx < 4; worker_idx++) {
+        workers.emplace_back([&, worker_idx]() {
+            // More threads than ranges, the extra worker only steals.
+            while (auto batch = reader.Next(worker_idx)) {
+                EXPECT_LE(batch->num_rows(), 4);
+                num_rows += batch->num_rows();
+                for (int col_idx = 0; col_idx < 2; col_idx++) {
+                    const auto& values = std::static_pointer_cast<arrow::Int64Array>(batch->column(col_idx));
+                    for (int64_t row_idx = 0; row_idx < batch->num_rows(); row_idx++) {
+                        sum += values->Value(row_idx);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(num_rows, 25);
+    EXPECT_EQ(sum, 10 * 1 + 15 * 2 + 7 * 3 + 18 * 4);
+    EXPECT_EQ(reader.Next(0), nullptr);
+}
+
+TEST(HashAggTest, CountDistinct) {
+    auto table = create_synthetic_table(1 << 16, 1 << 12);
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::COUNT_DISTINCT, "str_key", "distinct_str"},
+            AggFuncDef{AggFuncType::COUNT_DISTINCT, "int_val", "distinct_int"},
+            AggFuncDef{AggFuncType::COUNT_DISTINCT, "bool_val", "distinct_bool"},
+    });
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 12);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    std::vector<std::set<std::string>> distinct_strs(7);
+    std::vector<std::set<int32_t>> distinct_ints(7);
+    for (const auto& batch : batches) {
+        const auto& keys = std::static_pointer_cast<arrow::Int64Array>(batch->GetColumnByName("second_key"));
+        const auto& strs = std::static_pointer_cast<arrow::StringArray>(batch->GetColumnByName("str_key"));
+        const auto& int_vals = std::static_pointer_cast<arrow::Int32Array>(batch->GetColumnByName("int_val"));
+        for (int64_t row_idx = 0; row_idx < batch->num_rows(); row_idx++) {
+            auto key = keys->Value(row_idx);
+            distinct_strs[key].insert(strs->GetString(row_idx));
+            if (int_vals->IsValid(row_idx)) {
+                distinct_ints[key].insert(int_vals->Value(row_idx));
+            }
+        }
+    }
+
+    // Serial, parallel and spilling aggregates all merge the per-group sets exactly.
+    SingleNumericalHashAggregate serial_agg({"second_key"}, {"second_key"}, agg_funcs);
+    ParallelHashAggregate<SingleNumericalHashAggregate> parallel_agg({"second_key"}, {"second_key"}, agg_funcs, 4);
+    SpillingHashAggregate<SingleNumericalHashAggregate> spilling_agg(
+            {"second_key"}, {"second_key"}, agg_funcs, 1, ::testing::TempDir());
+    for (const auto& batch : batches) {
+        serial_agg.Next(batch);
+        parallel_agg.Next(batch);
+        spilling_agg.Next(batch);
+    }
+
+    for (auto agg_result : {serial_agg.Result(), parallel_agg.Result(), spilling_agg.Result()}) {
+        std::shared_ptr<arrow::RecordBatch> result;
+        ASSERT_OK(sort_table(agg_result, result, {0}));
+        ASSERT_EQ(result->num_rows(), 7);
+        const auto& str_col = std::static_pointer_cast<arrow::UInt64Array>(result->GetColumnByName("distinct_str"));
+        const auto& int_col = std::static_pointer_cast<arrow::UInt64Array>(result->GetColumnByName("distinct_int"));
+        const auto& bool_col = std::static_pointer_cast<arrow::UInt64Array>(result->GetColumnByName("distinct_bool"));
+        for (int64_t key = 0; key < 7; key++) {
+            EXPECT_EQ(str_col->Value(key), distinct_strs[key].size());
+            EXPECT_EQ(int_col->Value(key), distinct_ints[key].size());
+            EXPECT_EQ(bool_col->Value(key), 2);
+        }
+    }
+}
+
+TEST(HashAggTest, ApproxCountDistinctAndPercentile) {
+    auto table = create_synthetic_table(1 << 16, 1 << 14);
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::APPROX_COUNT_DISTINCT, "str_key", "distinct_str"},
+            AggFuncDef{AggFuncType::APPROX_PERCENTILE, "double_val", "median_double", 0.5},
+            AggFuncDef{AggFuncType::APPROX_PERCENTILE, "int_val", "p90_int", 0.9},
+    });
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 12);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    // Exact values of every group of second_key.
+    std::vector<std::set<std::string>> distinct_strs(7);
+    std::vector<std::vector<double>> doubles(7), ints(7);
+    for (const auto& batch : batches) {
+        const auto& keys = std::static_pointer_cast<arrow::Int64Array>(batch->GetColumnByName("second_key"));
+        const auto& strs = std::static_pointer_cast<arrow::StringArray>(batch->GetColumnByName("str_key"));
+        const auto& double_vals = std::static_pointer_cast<arrow::DoubleArray>(batch->GetColumnByName("double_val"));
+        const auto& int_vals = std::static_pointer_cast<arrow::Int32Array>(batch->GetColumnByName("int_val"));
+        for (int64_t row_idx = 0; row_idx < batch->num_rows(); row_idx++) {
+            auto key = keys->Value(row_idx);
+            distinct_strs[key].insert(strs->GetString(row_idx));
+            if (double_vals->IsValid(row_idx)) {
+                doubles[key].push_back(double_vals->Value(row_idx));
+                ints[key].push_back(int_vals->Value(row_idx));
+            }
+        }
+    }
+
+    // Partial states of the threads are merged, the sketches must stay within their error bounds.
+    ParallelHashAggregate<SingleNumericalHashAggregate> agg({"second_key"}, {"second_key"}, agg_funcs, 4);
+    std::atomic<size_t> next_batch{0};
+    std::vector<std::thread> threads;
+    for (size_t thread_idx = 0; thread_idx < 4; thread_idx++) {
+        threads.emplace_back([&]() {
+            size_t batch_idx;
+            while ((batch_idx = next_batch++) < batches.size()) {
+                agg.Next(batches[batch_idx]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::shared_ptr<arrow::RecordBatch> result;
+    ASSERT_OK(sort_table(agg.Result(), result, {0}));
+    ASSERT_EQ(result->num_rows(), 7);
+    const auto& distinct_col = std::static_pointer_cast<arrow::UInt64Array>(result->GetColumnByName("distinct_str"));
+    const auto& median_col = std::static_pointer_cast<arrow::DoubleArray>(result->GetColumnByName("median_double"));
+    const auto& p90_col = std::static_pointer_cast<arrow::DoubleArray>(result->GetColumnByName("p90_int"));
+    for (int64_t key = 0; key < 7; key++) {
+        const double exact_distinct = distinct_strs[key].size();
+        EXPECT_NEAR(distinct_col->Value(key), exact_distinct, exact_distinct * 0.05);
+
+        std::sort(doubles[key].begin(), doubles[key].end());
+        std::sort(ints[key].begin(), ints[key].end());
+        EXPECT_NEAR(median_col->Value(key), doubles[key][doubles[key].size() / 2], 1.0);
+        EXPECT_NEAR(p90_col->Value(key), ints[key][ints[key].size() * 9 / 10], 20.0);
+    }
+}
+
+TEST(HashAggTest, ApproxAggregatesOfNaN) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto schema = arrow::schema({arrow::field("key", arrow::int64()),
+                                 arrow::field("val", arrow::float64())});
+    auto table = arrow::Table::Make(schema, {
+            create_array<int64_t, arrow::Int64Builder>({0, 0, 0, 0, 0, 0, 1, 1},
+                                                       {true, true, true, true, true, true, true, true}),
+            create_array<double, arrow::DoubleBuilder>({1, nan, 3, std::nan("1"), 0.0, -0.0, nan, -nan},
+                                                       {true, true, true, true, true, true, true, true}),
+    });
+    std::vector<AggFuncDef> agg_funcs({
+            AggFuncDef{AggFuncType::APPROX_COUNT_DISTINCT, "val", "distinct_val"},
+            AggFuncDef{AggFuncType::APPROX_PERCENTILE, "val", "p0", 0},
+            AggFuncDef{AggFuncType::APPROX_PERCENTILE, "val", "p50", 0.5},
+            AggFuncDef{AggFuncType::APPROX_PERCENTILE, "val", "p100", 1},
+    });
+
+    // The NaNs are one distinct value, like the signed zeros, and are skipped by the digests.
+    SingleNumericalHashAggregate agg({"key"}, {"key"}, agg_funcs);
+    auto result = aggregate_and_sort(agg, table);
+    ASSERT_EQ(result->num_rows(), 2);
+    const auto& distinct_col = std::static_pointer_cast<arrow::UInt64Array>(result->GetColumnByName("distinct_val"));
+    const auto& p0_col = std::static_pointer_cast<arrow::DoubleArray>(result->GetColumnByName("p0"));
+    const auto& p50_col = std::static_pointer_cast<arrow::DoubleArray>(result->GetColumnByName("p50"));
+    const auto& p100_col = std::static_pointer_cast<arrow::DoubleArray>(result->GetColumnByName("p100"));
+    EXPECT_EQ(distinct_col->Value(0), 4);
+    EXPECT_EQ(distinct_col->Value(1), 1);
+    EXPECT_EQ(p0_col->Value(0), 0);
+    EXPECT_EQ(p100_col->Value(0), 3);
+    EXPECT_GE(p50_col->Value(0), 0);
+    EXPECT_LE(p50_col->Value(0), 3);
+    EXPECT_TRUE(p0_col->IsNull(1));
+    EXPECT_TRUE(p50_col->IsNull(1));
+    EXPECT_TRUE(p100_col->IsNull(1));
+}
+
+TEST(WindowTest, PartitionsAcrossBatches) {
+    using vinum::operators::window::WindowFuncDef;
+    using vinum::operators::window::WindowFuncType;
+
+    auto schema = arrow::schema({arrow::field("key", arrow::int64()),
+                                 arrow::field("ord", arrow::int32())});
+    // Sorted by key, ord. The partition of key 2 spans both batches.
+    auto first_batch = arrow::RecordBatch::Make(schema, 4, {
+            create_array<int64_t, arrow::Int64Builder>({1, 1, 2, 2}, {true, true, true, true}),
+            create_array<int32_t, arrow::Int32Builder>({1, 2, 1, 1}, {true, true, true, true}),
+    });
+    auto second_batch = arrow::RecordBatch::Make(schema, 4, {
+            create_array<int64_t, arrow::Int64Builder>({2, 3, 3, 3}, {true, true, true, true}),
+            create_array<int32_t, arrow::Int32Builder>({2, 1, 2, 2}, {true, true, true, true}),
+    });
+
+    vinum::operators::window::Window window({"key"}, {"ord"}, {
+            WindowFuncDef{WindowFuncType::ROW_NUMBER, "", "row_number"},
+            WindowFuncDef{WindowFuncType::RANK, "", "rank"},
+            WindowFuncDef{WindowFuncType::DENSE_RANK, "", "dense_rank"},
+            WindowFuncDef{WindowFuncType::SUM, "ord", "running_sum"},
+            WindowFuncDef{WindowFuncType::LAG, "ord", "prev_ord"},
+    });
+
+    auto check = [](const std::shared_ptr<arrow::RecordBatch>& batch,
+                    initializer_list<uint64_t> row_number,
+                    initializer_list<uint64_t> rank,
+                    initializer_list<uint64_t> dense_rank,
+                    initializer_list<int64_t> running_sum,
+                    initializer_list<int32_t> prev_ord) {
+        ASSERT_NE(batch, nullptr);
+        ASSERT_EQ(batch->num_columns(), 7);
+        const std::vector<bool> all_valid(row_number.size(), true);
+        std::vector<bool> prev_valid(all_valid);
+        prev_valid[0] = false;
+
+        arrow::UInt64Builder uint_builder;
+        std::shared_ptr<arrow::Array> expected;
+        for (const auto& [col_name, vals] : {std::make_pair("row_number", row_number),
+                                             std::make_pair("rank", rank),
+                                             std::make_pair("dense_rank", dense_rank)}) {
+            ASSERT_OK(uint_builder.AppendValues(std::vector<uint64_t>(vals), all_valid));
+            ASSERT_OK(uint_builder.Finish(&expected));
+            ASSERT_ARRAYS_EQUAL(*batch->GetColumnByName(col_name), *expected);
+        }
+
+        arrow::Int64Builder sum_builder;
+        ASSERT_OK(sum_builder.AppendValues(std::vector<int64_t>(running_sum), all_valid));
+        ASSERT_OK(sum_builder.Finish(&expected));
+        ASSERT_ARRAYS_EQUAL(*batch->GetColumnByName("running_sum"), *expected);
+
+        arrow::Int32Builder lag_builder;
+        ASSERT_OK(lag_builder.AppendValues(std::vector<int32_t>(prev_ord), prev_valid));
+        ASSERT_OK(lag_builder.Finish(&expected));
+        ASSERT_ARRAYS_EQUAL(*batch->GetColumnByName("prev_ord"), *expected);
+    };
+
+    // Every batch returns the partitions it completed, the last one is returned by Finish().
+    check(window.Next(first_batch), {1, 2}, {1, 2}, {1, 2}, {1, 3}, {0, 1});
+    check(window.Next(second_batch), {1, 2, 3}, {1, 1, 3}, {1, 1, 2}, {2, 2, 4}, {0, 1, 1});
+    check(window.Finish(), {1, 2, 3}, {1, 2, 2}, {1, 2, 2}, {1, 5, 5}, {0, 1, 2});
+}
+
+TEST(HashAggTest, AggregateStats) {
+    auto table = create_synthetic_table(1 << 16, 10000);
+    std::vector<AggFuncDef> agg_funcs({AggFuncDef{AggFuncType::COUNT_STAR, "", "cnt"}});
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 12);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    CompositeKeyHashAggregate serial_agg({"str_key"}, {"str_key"}, agg_funcs);
+    ParallelHashAggregate<CompositeKeyHashAggregate> parallel_agg({"str_key"}, {"str_key"}, agg_funcs, 4);
+    for (const auto& batch : batches) {
+        serial_agg.Next(batch);
+        parallel_agg.Next(batch);
+    }
+    const auto serial_result = serial_agg.Result();
+    const auto serial_stats = serial_agg.AggStats();
+    EXPECT_EQ(serial_stats.num_batches, static_cast<int64_t>(batches.size()));
+    EXPECT_EQ(serial_stats.num_rows, table->num_rows());
+    EXPECT_EQ(serial_stats.num_groups, serial_result->num_rows());
+    EXPECT_GE(serial_stats.table_capacity, serial_stats.num_groups);
+    EXPECT_GT(serial_stats.num_resizes, 0);
+    EXPECT_GT(serial_stats.LoadFactor(), 0);
+    EXPECT_LE(serial_stats.LoadFactor(), 1);
+
+    // Inputs of the partials add up, the groups are the merged ones.
+    const auto parallel_result = parallel_agg.Result();
+    const auto parallel_stats = parallel_agg.AggStats();
+    EXPECT_EQ(parallel_stats.num_rows, table->num_rows());
+    EXPECT_EQ(parallel_stats.num_groups, parallel_result->num_rows());
+    EXPECT_EQ(parallel_stats.num_groups, serial_stats.num_groups);
+}
+
+TEST(HashAggTest, EstimateNumGroups) {
+    using vinum::operators::aggregate::estimate_num_groups;
+
+    EXPECT_EQ(estimate_num_groups(0, 0, 1 << 20), 0);
+    EXPECT_EQ(estimate_num_groups(100, 1 << 14, 1 << 14), 100);
+    EXPECT_EQ(estimate_num_groups(1 << 14, 1 << 14, 1 << 20), 1 << 20);
+    // Few keys are all seen in the sample.
+    EXPECT_NEAR(estimate_num_groups(100, 1 << 14, 1 << 20), 100, 1);
+
+    // Sample of 1 << 14 rows of keys drawn uniformly from 100000 values.
+    const auto sample_groups = static_cast<int64_t>(-100000 * std::expm1(-16384.0 / 100000));
+    EXPECT_NEAR(estimate_num_groups(sample_groups, 1 << 14, 1 << 20), 100000, 5000);
+}
+
+TEST(HashAggTest, ReserveEstimatedGroups) {
+    auto table = create_synthetic_table(1 << 16, 10000);
+    std::vector<AggFuncDef> agg_funcs({AggFuncDef{AggFuncType::COUNT_STAR, "", "cnt"}});
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 12);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    CompositeKeyHashAggregate agg({"str_key"}, {"str_key"}, agg_funcs);
+    CompositeKeyHashAggregate reserved_agg({"str_key"}, {"str_key"}, agg_funcs);
+    reserved_agg.SetExpectedRows(table->num_rows());
+    for (const auto& batch : batches) {
+        agg.Next(batch);
+        reserved_agg.Next(batch);
+    }
+    const auto result = agg.Result();
+    const auto reserved_result = reserved_agg.Result();
+    EXPECT_EQ(reserved_result->num_rows(), result->num_rows());
+
+    const auto stats = agg.AggStats();
+    const auto reserved_stats = reserved_agg.AggStats();
+    EXPECT_EQ(stats.estimated_groups, 0);
+    EXPECT_GE(reserved_stats.estimated_groups, reserved_stats.num_groups);
+    EXPECT_LE(reserved_stats.estimated_groups, table->num_rows());
+    EXPECT_GE(reserved_stats.table_capacity, reserved_stats.estimated_groups);
+    EXPECT_LE(reserved_stats.num_resizes, stats.num_resizes);
+
+    // Mostly distinct keys extrapolated to far more rows than the pool can hold.
+    auto wide_table = create_synthetic_table(1 << 16, 1 << 30);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> wide_batches;
+    auto wide_reader = arrow::TableBatchReader(*wide_table);
+    wide_reader.set_chunksize(1 << 12);
+    RAISE_ON_ARROW_FAILURE(wide_reader.ReadAll(&wide_batches));
+
+    const int64_t limit = 1 << 26;
+    CompositeKeyHashAggregate capped_agg({"str_key"}, {"str_key"}, agg_funcs);
+    capped_agg.SetMemoryPool(std::make_shared<vinum::common::QueryMemoryPool>(limit));
+    capped_agg.SetExpectedRows(int64_t(1) << 40);
+    for (const auto& batch : wide_batches) {
+        capped_agg.Next(batch);
+    }
+    const auto capped_stats = capped_agg.AggStats();
+    EXPECT_GT(capped_stats.estimated_groups, 0);
+    EXPECT_LT(capped_stats.estimated_groups, limit);
+    EXPECT_LE(capped_stats.memory_bytes, limit);
+}
+
+TEST(HashAggTest, QueryMemoryPool) {
+    using vinum::common::MemoryLimitError;
+    using vinum::common::QueryMemoryPool;
+
+    auto table = create_synthetic_table(1 << 16, 10000);
+    std::vector<AggFuncDef> agg_funcs({AggFuncDef{AggFuncType::COUNT_STAR, "", "cnt"}});
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto reader = arrow::TableBatchReader(*table);
+    reader.set_chunksize(1 << 12);
+    RAISE_ON_ARROW_FAILURE(reader.ReadAll(&batches));
+
+    auto pool = std::make_shared<QueryMemoryPool>();
+    std::shared_ptr<arrow::RecordBatch> result;
+    {
+        CompositeKeyHashAggregate agg({"str_key"}, {"str_key"}, agg_funcs);
+        agg.SetMemoryPool(pool);
+        for (const auto& batch : batches) {
+            agg.Next(batch);
+        }
+        EXPECT_GT(pool->ReservedBytes(), 0);
+        result = agg.Result();
+    }
+    // Reservations are released with the aggregate, the result is still allocated from the pool.
+    EXPECT_EQ(pool->ReservedBytes(), 0);
+    EXPECT_GT(pool->bytes_allocated(), 0);
+    EXPECT_GE(pool->max_memory(), pool->bytes_allocated());
+    const auto peak = pool->max_memory();
+    result = nullptr;
+    EXPECT_EQ(pool->bytes_allocated(), 0);
+
+    auto limited_pool = std::make_shared<QueryMemoryPool>(peak / 4);
+    CompositeKeyHashAggregate limited_agg({"str_key"}, {"str_key"}, agg_funcs);
+    limited_agg.SetMemoryPool(limited_pool);
+    EXPECT_THROW({
+        for (const auto& batch : batches) {
+            limited_agg.Next(batch);
+        }
+        limited_agg.Result();
+    }, MemoryLimitError);
+
+    // The spilling aggregate spills the groups once the pool is full.
+    auto spilling_pool = std::make_shared<QueryMemoryPool>(peak / 4);
+    SpillingHashAggregate<CompositeKeyHashAggregate> spilling_agg({"str_key"}, {"str_key"}, agg_funcs,
+                                                                  1 << 30, ::testing::TempDir());
+    spilling_agg.SetMemoryPool(spilling_pool);
+    for (const auto& batch : batches) {
+        spilling_agg.Next(batch);
+    }
+    EXPECT_GT(spilling_agg.Stats().num_spills, 0);
+}
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);